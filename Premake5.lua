@@ -391,6 +391,13 @@ function AddProjects(groupName, folders)
 				optimize "on"
 
 				links(ProjLinksRelease)
+
+				-- Projects that can read pack files get their resources packed into a single file for shipping
+				if os.isfile(path.join(proj, "src/Utils/PackFile.h")) then
+					postbuildcommands {
+						"(\"%{cfg.buildtarget.abspath}\" --build-pack \"" .. resdir .. "\" --pack-output \"" .. absdir .. "\\res.pak\")"
+					}
+				end
 	end
 
 end
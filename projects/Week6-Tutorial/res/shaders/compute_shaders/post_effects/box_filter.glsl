@@ -0,0 +1,56 @@
+#version 430
+
+// Applies a 3x3 (or 5x5) filter kernel to an image. Each work group loads it's tile of the image
+// plus an apron of RADIUS pixels into shared memory once, and all of the taps are read from there
+#pragma feature FILTER_5X5
+
+#ifdef FILTER_5X5
+    #define RADIUS 2
+#else
+    #define RADIUS 1
+#endif
+#define KERNEL_SIZE (RADIUS * 2 + 1)
+#define TILE_SIZE   16
+#define CACHE_SIZE  (TILE_SIZE + RADIUS * 2)
+
+layout(local_size_x = TILE_SIZE, local_size_y = TILE_SIZE) in;
+
+// Image from the previous pass
+uniform layout(binding = 0) sampler2D s_Image;
+// The effect's output
+layout(binding = 0, rgba8) uniform writeonly image2D o_Output;
+
+uniform float u_Filter[KERNEL_SIZE * KERNEL_SIZE];
+
+#include "../../fragments/frame_uniforms.glsl"
+
+shared vec3 s_Cache[CACHE_SIZE][CACHE_SIZE];
+
+void main() {
+    // Our images are render size targets, which may be larger than the area that was rendered to
+    ivec2 size = ivec2(u_Viewport.zw);
+    ivec2 local = ivec2(gl_LocalInvocationID.xy);
+    ivec2 cacheOrigin = ivec2(gl_WorkGroupID.xy) * TILE_SIZE - RADIUS;
+
+    // The cache is larger than the work group, so some threads load more than one texel. Clamping
+    // the coordinates matches the clamp to edge sampling of the fragment version
+    for (int y = local.y; y < CACHE_SIZE; y += TILE_SIZE) {
+        for (int x = local.x; x < CACHE_SIZE; x += TILE_SIZE) {
+            s_Cache[y][x] = texelFetch(s_Image, clamp(cacheOrigin + ivec2(x, y), ivec2(0), size - 1), 0).rgb;
+        }
+    }
+    barrier();
+
+    ivec2 pixel = ivec2(gl_GlobalInvocationID.xy);
+    if (any(greaterThanEqual(pixel, size))) {
+        return;
+    }
+
+    vec3 accumulator = vec3(0);
+    for (int iy = 0; iy < KERNEL_SIZE; iy++) {
+        for (int ix = 0; ix < KERNEL_SIZE; ix++) {
+            accumulator += s_Cache[local.y + iy][local.x + ix] * u_Filter[iy * KERNEL_SIZE + ix];
+        }
+    }
+    imageStore(o_Output, pixel, vec4(accumulator, 1.0));
+}
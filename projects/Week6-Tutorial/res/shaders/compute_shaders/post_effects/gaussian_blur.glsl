@@ -0,0 +1,59 @@
+#version 430
+
+// One direction of a separable gaussian blur. Each work group handles a run of GROUP_SIZE pixels
+// along a row (or column), loading the run plus an apron of MAX_RADIUS pixels on either side into
+// shared memory so that each texel is only fetched once
+#pragma feature VERTICAL
+
+#define GROUP_SIZE 128
+#define MAX_RADIUS 32
+#define CACHE_SIZE (GROUP_SIZE + MAX_RADIUS * 2)
+
+#ifdef VERTICAL
+    layout(local_size_x = 1, local_size_y = GROUP_SIZE) in;
+    #define AXIS(v) (v).y
+    const ivec2 STEP = ivec2(0, 1);
+#else
+    layout(local_size_x = GROUP_SIZE, local_size_y = 1) in;
+    #define AXIS(v) (v).x
+    const ivec2 STEP = ivec2(1, 0);
+#endif
+
+// The image to blur
+uniform layout(binding = 0) sampler2D s_Image;
+// Where to write the blurred image
+layout(binding = 0, rgba16f) uniform writeonly image2D o_Output;
+
+// The number of pixels on either side of the center to sample, up to MAX_RADIUS
+uniform int   u_Radius;
+// The gaussian weights, starting at the center tap
+uniform float u_Weights[MAX_RADIUS + 1];
+// The size of the area to blur, our targets may be larger than this (ex: render size targets)
+uniform ivec2 u_ImageSize;
+
+shared vec3 s_Cache[CACHE_SIZE];
+
+void main() {
+    ivec2 size = u_ImageSize;
+    ivec2 pixel = ivec2(gl_GlobalInvocationID.xy);
+    int local = int(AXIS(gl_LocalInvocationID));
+
+    // The start of our cache along the blur axis, the other axis is the same for the whole group
+    ivec2 cacheOrigin = pixel - STEP * (local + MAX_RADIUS);
+
+    for (int ix = local; ix < CACHE_SIZE; ix += GROUP_SIZE) {
+        s_Cache[ix] = texelFetch(s_Image, clamp(cacheOrigin + STEP * ix, ivec2(0), size - 1), 0).rgb;
+    }
+    barrier();
+
+    if (any(greaterThanEqual(pixel, size))) {
+        return;
+    }
+
+    int center = local + MAX_RADIUS;
+    vec3 accumulator = s_Cache[center] * u_Weights[0];
+    for (int ix = 1; ix <= u_Radius; ix++) {
+        accumulator += (s_Cache[center - ix] + s_Cache[center + ix]) * u_Weights[ix];
+    }
+    imageStore(o_Output, pixel, vec4(accumulator, 1.0));
+}
@@ -0,0 +1,93 @@
+#version 430
+
+// Compute version of fragment_shaders/post_effects/outline.glsl. Each work group loads the depth and
+// normals for it's tile plus an apron of MAX_OFFSET pixels into shared memory once, so the 5 taps
+// that every pixel takes from each G-Buffer layer are read from there
+
+#define TILE_SIZE  16
+// The largest offset of the corner taps, matches the maximum scale in OutlineEffect
+#define MAX_OFFSET 5
+#define CACHE_SIZE (TILE_SIZE + MAX_OFFSET * 2)
+
+layout(local_size_x = TILE_SIZE, local_size_y = TILE_SIZE) in;
+
+uniform layout(binding = 0) sampler2D s_Image;
+uniform layout(binding = 1) sampler2D s_Depth;
+uniform layout(binding = 2) sampler2D s_Normals;
+// The effect's output
+layout(binding = 0, rgba8) uniform writeonly image2D o_Output;
+
+uniform vec4  u_OutlineColor;
+uniform float u_Scale;
+uniform float u_DepthThreshold;
+uniform float u_NormalThreshold;
+uniform float u_DepthNormThreshold;
+uniform float u_DepthNormThresholdScale;
+
+#include "../../fragments/frame_uniforms.glsl"
+
+// Normals in xyz, depth in w
+shared vec4 s_Cache[CACHE_SIZE][CACHE_SIZE];
+
+vec4 Fetch(ivec2 local) {
+    return s_Cache[local.y + MAX_OFFSET][local.x + MAX_OFFSET];
+}
+
+void main() {
+    // Our images are render size targets, which may be larger than the area that was rendered to
+    ivec2 size = ivec2(u_Viewport.zw);
+    ivec2 local = ivec2(gl_LocalInvocationID.xy);
+    ivec2 cacheOrigin = ivec2(gl_WorkGroupID.xy) * TILE_SIZE - MAX_OFFSET;
+
+    for (int y = local.y; y < CACHE_SIZE; y += TILE_SIZE) {
+        for (int x = local.x; x < CACHE_SIZE; x += TILE_SIZE) {
+            ivec2 coord = clamp(cacheOrigin + ivec2(x, y), ivec2(0), size - 1);
+            s_Cache[y][x] = vec4(texelFetch(s_Normals, coord, 0).rgb * 2 - 1, texelFetch(s_Depth, coord, 0).r);
+        }
+    }
+    barrier();
+
+    ivec2 pixel = ivec2(gl_GlobalInvocationID.xy);
+    if (any(greaterThanEqual(pixel, size))) {
+        return;
+    }
+
+    float halfScale = u_Scale * 0.5f;
+    int lower = min(int(floor(halfScale)), MAX_OFFSET);
+    int upper = min(int(ceil(halfScale)), MAX_OFFSET);
+
+    // The same x shape as the fragment version, in whole pixels
+    vec4 center = Fetch(local);
+    vec4 s0 = Fetch(local + ivec2(-lower, -lower));
+    vec4 s1 = Fetch(local + ivec2( upper,  upper));
+    vec4 s2 = Fetch(local + ivec2( lower, -lower));
+    vec4 s3 = Fetch(local + ivec2(-upper,  upper));
+
+    // The view direction through the center of this pixel
+    vec2 ndc = ((vec2(pixel) + 0.5) / vec2(size)) * 2 - 1;
+    vec3 viewDir = normalize((u_InvProjection * vec4(ndc, 0, 1)).xyz);
+
+    // Compute a threshold term based on the dot product between the camera and the normal
+    float nDotV = 1 - dot(center.xyz, -viewDir);
+    float normalThreshold = clamp((nDotV - u_DepthNormThreshold) / (1 - u_DepthNormThreshold), 0, 1);
+    normalThreshold = normalThreshold * u_DepthNormThresholdScale + 1;
+
+    // Robert's cross depth
+    float dDiff0 = s1.w - s0.w;
+    float dDiff1 = s3.w - s2.w;
+
+    float edgeDepth = sqrt(pow(dDiff0, 2) + pow(dDiff1, 2)) * 64;
+    edgeDepth = edgeDepth > u_DepthThreshold * normalThreshold * center.w ? 1 : 0;
+
+    // Robert's cross normals
+    vec3 nDiff0 = s1.xyz - s0.xyz;
+    vec3 nDiff1 = s3.xyz - s2.xyz;
+
+    float edgeNorm = sqrt(dot(nDiff0, nDiff0) + dot(nDiff1, nDiff1));
+    edgeNorm = edgeNorm > u_NormalThreshold ? 1 : 0;
+
+    float edgeFactor = max(edgeDepth, edgeNorm) * u_OutlineColor.a;
+
+    vec3 color = texelFetch(s_Image, pixel, 0).rgb;
+    imageStore(o_Output, pixel, vec4(mix(color, u_OutlineColor.rgb, edgeFactor), 1.0));
+}
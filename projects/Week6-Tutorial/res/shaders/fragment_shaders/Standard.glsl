@@ -3,6 +3,7 @@
 #include "../fragments/fs_common_inputs.glsl"
 #include "../fragments/multiple_point_lights.glsl"
 #include "../fragments/color_correction.glsl"
+#include "../fragments/lod_fade.glsl"
 
 //out vec4 frag_color;
 
@@ -10,6 +11,7 @@ layout(location = 0) out vec4 frag_color;
 layout(location = 1) out vec4 normals;
 layout(location = 2) out vec4 emissive;
 layout(location = 3) out vec3 view_pos;
+layout(location = 4) out vec2 motion;
 
 struct AmbientLight
 {
@@ -77,6 +79,8 @@ vec3 getDiffuseLightColor(DiffuseLight diffuseLight,vec3 normal)
 
 void main()
 {
+		ApplyLodFade();
+
 		vec4 textureColor = texture(texColor, inUV);
 		vec3 vertNormal = normalize(inNormal);
 
@@ -124,6 +128,7 @@ void main()
 
 		normals = vec4(vertNormal,1.0);
 		view_pos=inViewPos;
+		motion = CalcMotionVector(inClipPos, inPrevClipPos);
 }
 //Rim Lighting code from built from
 //https://shadowmint.gitbooks.io/unity-material-shaders/content/shaders/surface/rim_lighting.html
\ No newline at end of file
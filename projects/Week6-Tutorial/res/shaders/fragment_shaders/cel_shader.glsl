@@ -2,12 +2,14 @@
 
 #include "../fragments/fs_common_inputs.glsl"
 #include "../fragments/frame_uniforms.glsl"
+#include "../fragments/lod_fade.glsl"
 
 // We output a single color to the color buffer
 layout(location = 0) out vec4 albedo_specPower;
 layout(location = 1) out vec4 normal_metallic;
 layout(location = 2) out vec4 emissive;
 layout(location = 3) out vec3 view_pos;
+layout(location = 4) out vec2 motion;
 
 // Represents a collection of attributes that would define a material
 // For instance, you can think of this like material settings in 
@@ -26,6 +28,8 @@ uniform sampler1D s_ToonTerm;
 
 // https://learnopengl.com/Advanced-Lighting/Advanced-Lighting
 void main() {	
+	ApplyLodFade();
+
 	// Get albedo from the material
 	vec4 albedoColor = texture(u_Material.AlbedoMap, inUV);
 
@@ -61,4 +65,5 @@ void main() {
 	emissive = texture(u_Material.EmissiveMap, inUV);
 	
 	view_pos = inViewPos;
+	motion = CalcMotionVector(inClipPos, inPrevClipPos);
 }
\ No newline at end of file
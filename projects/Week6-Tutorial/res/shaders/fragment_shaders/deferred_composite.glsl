@@ -9,15 +9,17 @@ uniform layout(binding = 2) sampler2D s_DiffuseAccumulation;
 uniform layout(binding = 3) sampler2D s_SpecularAccumulation;
 uniform layout(binding = 4) sampler2D s_Emissive;
 
-#include "../fragments/frame_uniforms.glsl"
+#define NO_GBUFFER_SAMPLERS
+#include "../fragments/deferred_post_common.glsl"
 #include "../fragments/color_correction.glsl"
 #include "../fragments/multiple_point_lights.glsl"
 
 void main() {
-    vec3 albedo = texture(s_Albedo, inUV).rgb;
-    vec3 diffuse = texture(s_DiffuseAccumulation, inUV).rgb;
-    vec3 specular = texture(s_SpecularAccumulation, inUV).rgb;
-    vec4 emissive = texture(s_Emissive, inUV);
+    vec2 uv = ScaleUV(inUV);
+    vec3 albedo = texture(s_Albedo, uv).rgb;
+    vec3 diffuse = texture(s_DiffuseAccumulation, uv).rgb;
+    vec3 specular = texture(s_SpecularAccumulation, uv).rgb;
+    vec4 emissive = texture(s_Emissive, uv);
 
 	outColor = vec4(albedo * (diffuse + specular + (emissive.rgb * emissive.a)), 1.0);
 }
\ No newline at end of file
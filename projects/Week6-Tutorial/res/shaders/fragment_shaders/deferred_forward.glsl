@@ -2,11 +2,15 @@
 
 #include "../fragments/fs_common_inputs.glsl"
 
+// Materials without a given map use a variant that skips sampling it, see Material::SetKeyword
+#pragma feature HAS_ALBEDO_MAP HAS_EMISSIVE_MAP HAS_NORMAL_MAP HAS_METALLIC_SHININESS_MAP ALPHA_TEST
+
 // We output a single color to the color buffer
 layout(location = 0) out vec4 albedo_specPower;
 layout(location = 1) out vec4 normal_metallic;
 layout(location = 2) out vec4 emissive;
 layout(location = 3) out vec3 view_pos;
+layout(location = 4) out vec2 motion;
 
 // Represents a collection of attributes that would define a material
 // For instance, you can think of this like material settings in 
@@ -22,37 +26,60 @@ struct Material {
 uniform Material u_Material;
 
 #include "../fragments/frame_uniforms.glsl"
+#include "../fragments/lod_fade.glsl"
 
 // https://learnopengl.com/Advanced-Lighting/Advanced-Lighting
 void main() {
+	ApplyLodFade();
+
 	// Get albedo from the material
+#ifdef HAS_ALBEDO_MAP
 	vec4 albedoColor = texture(u_Material.AlbedoMap, inUV);
+#else
+	vec4 albedoColor = vec4(1.0);
+#endif
 
 	// We can use another texture to store things like our lighting settings
+#ifdef HAS_METALLIC_SHININESS_MAP
 	vec4 lightingParams = texture(u_Material.MetallicShininessMap, inUV);
+#else
+	vec4 lightingParams = vec4(0.0);
+#endif
 
 	// Discarding fragments who's alpha is below the material's threshold
+#ifdef ALPHA_TEST
 	if (albedoColor.a < u_Material.DiscardThreshold) {
 		discard;
 	}
+#endif
 
 	// Extract albedo from material, and store shininess
 	albedo_specPower = vec4(albedoColor.rgb, 1.0f);//lightingParams.x);
 	
 	// Normalize our input normal
+#ifdef HAS_NORMAL_MAP
     // Read our tangent from the map, and convert from the [0,1] range to [-1,1] range
     vec3 normal = texture(u_Material.NormalMap, inUV).rgb;
     normal = normal * 2.0 - 1.0;
 
     // Here we apply the TBN matrix to transform the normal from tangent space to view space
     normal = normalize(inTBN * normal);
+#else
+	// Without a normal map we use the surface normal, which is the same as a flat (0, 0, 1) tangent space normal
+	vec3 normal = normalize(inTBN[2]);
+#endif
 	
 	// Map [-1, 1] to [0, 1]
 	normal = clamp((normal + 1) / 2.0, 0, 1);
 	normal_metallic = vec4(normal, lightingParams.y);
 
 	// Extract emissive from the material
+#ifdef HAS_EMISSIVE_MAP
 	emissive = texture(u_Material.EmissiveMap, inUV);
+#else
+	emissive = vec4(0.0);
+#endif
 
 	view_pos = inViewPos;
+	motion = CalcMotionVector(inClipPos, inPrevClipPos);
 }
\ No newline at end of file
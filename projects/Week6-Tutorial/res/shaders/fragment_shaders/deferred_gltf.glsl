@@ -0,0 +1,83 @@
+#version 430
+
+#include "../fragments/fs_common_inputs.glsl"
+
+// Maps that the material doesn't have are replaced by their factors, which is what a white texture would give us
+#pragma feature HAS_BASE_COLOR_MAP HAS_METALLIC_ROUGHNESS_MAP HAS_NORMAL_MAP HAS_EMISSIVE_MAP ALPHA_TEST
+
+// We output a single color to the color buffer
+layout(location = 0) out vec4 albedo_specPower;
+layout(location = 1) out vec4 normal_metallic;
+layout(location = 2) out vec4 emissive;
+layout(location = 3) out vec3 view_pos;
+layout(location = 4) out vec2 motion;
+
+// The metallic-roughness material model from glTF 2.0, each texture is multiplied by it's factor
+struct Material {
+	sampler2D BaseColorMap;
+	// Roughness in the green channel, metallic in the blue channel
+	sampler2D MetallicRoughnessMap;
+	sampler2D NormalMap;
+	sampler2D EmissiveMap;
+	vec4      BaseColorFactor;
+	float     MetallicFactor;
+	float     RoughnessFactor;
+	float     NormalScale;
+	vec3      EmissiveFactor;
+	// Fragments with an alpha below this are discarded, 0 for opaque materials
+	float     AlphaCutoff;
+};
+// Create a uniform for the material
+uniform Material u_Material;
+
+#include "../fragments/frame_uniforms.glsl"
+#include "../fragments/lod_fade.glsl"
+
+void main() {
+	ApplyLodFade();
+
+#ifdef HAS_BASE_COLOR_MAP
+	vec4 baseColor = texture(u_Material.BaseColorMap, inUV) * u_Material.BaseColorFactor;
+#else
+	vec4 baseColor = u_Material.BaseColorFactor;
+#endif
+#ifdef ALPHA_TEST
+	if (baseColor.a < u_Material.AlphaCutoff) {
+		discard;
+	}
+#endif
+
+#ifdef HAS_METALLIC_ROUGHNESS_MAP
+	vec4 metallicRoughness = texture(u_Material.MetallicRoughnessMap, inUV);
+#else
+	vec4 metallicRoughness = vec4(1.0);
+#endif
+	float roughness = metallicRoughness.g * u_Material.RoughnessFactor;
+	float metallic = metallicRoughness.b * u_Material.MetallicFactor;
+
+	// Our lighting uses a specular power in the 0-1 range, smoother surfaces get tighter highlights
+	albedo_specPower = vec4(baseColor.rgb, 1.0 - roughness);
+
+#ifdef HAS_NORMAL_MAP
+	// Read our normal from the map and convert from the [0,1] range to [-1,1], then into view space
+	vec3 normal = texture(u_Material.NormalMap, inUV).rgb * 2.0 - 1.0;
+	normal.xy *= u_Material.NormalScale;
+	normal = normalize(inTBN * normal);
+#else
+	// A flat normal map would give us the surface normal
+	vec3 normal = normalize(inTBN[2]);
+#endif
+
+	// Map [-1, 1] to [0, 1]
+	normal = clamp((normal + 1) / 2.0, 0, 1);
+	normal_metallic = vec4(normal, metallic);
+
+#ifdef HAS_EMISSIVE_MAP
+	emissive = vec4(texture(u_Material.EmissiveMap, inUV).rgb * u_Material.EmissiveFactor, 1.0);
+#else
+	emissive = vec4(u_Material.EmissiveFactor, 1.0);
+#endif
+
+	view_pos = inViewPos;
+	motion = CalcMotionVector(inClipPos, inPrevClipPos);
+}
@@ -9,6 +9,7 @@ layout(location = 7) in vec4 inTextureWeights;
 ////////////////////////////////////////////////////////////////
 
 #include "../fragments/frame_uniforms.glsl"
+#include "../fragments/lod_fade.glsl"
 
 ////////////////////////////////////////////////////////////////
 /////////////// Instance Level Uniforms ////////////////////////
@@ -39,9 +40,12 @@ layout(location = 0) out vec4 albedo_specPower;
 layout(location = 1) out vec4 normal_metallic;
 layout(location = 2) out vec4 emissive;
 layout(location = 3) out vec3 view_pos;
+layout(location = 4) out vec2 motion;
 
 // https://learnopengl.com/Advanced-Lighting/Advanced-Lighting
 void main() {
+	ApplyLodFade();
+
 	// Get albedo from the material
 	vec4 albedoColor = 
 		texture(u_Material.DiffuseA, inUV) * inTextureWeights.x +
@@ -76,4 +80,5 @@ void main() {
 		texture(u_Material.EmissiveB, inUV).rgba * inTextureWeights.y;
 		
 	view_pos = inViewPos;
+	motion = CalcMotionVector(inClipPos, inPrevClipPos);
 }
\ No newline at end of file
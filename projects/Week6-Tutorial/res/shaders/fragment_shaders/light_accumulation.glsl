@@ -72,7 +72,7 @@ void main() {
     vec3 albedo = GetAlbedo(inUV);
     vec3 viewPos = GetViewPosition(inUV);
     
-    float specularPow = texture(s_AlbedoSpec, inUV).a;
+    float specularPow = texture(s_AlbedoSpec, ScaleUV(inUV)).a;
 
     vec3 diffuse = vec3(0);
     vec3 specular = vec3(0);
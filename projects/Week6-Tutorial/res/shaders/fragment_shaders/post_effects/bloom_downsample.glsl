@@ -0,0 +1,37 @@
+#version 430
+
+layout(location = 0) in vec2 inUV;
+layout(location = 0) out vec4 outColor;
+
+// The next larger level in the bloom chain
+uniform layout(binding = 1) sampler2D s_Source;
+
+// The size of a single texel in the source image
+uniform vec2 u_TexelSize;
+
+// 13 tap downsample filter from "Next Generation Post Processing in Call of Duty: Advanced Warfare"
+// Made of 5 overlapping 2x2 boxes (4 corner boxes at 1/8 each, and the center box at 1/2), which
+// gives a wide and stable result when sampling with bilinear filtering
+const int   NUM_TAPS = 13;
+const vec2  OFFSETS[NUM_TAPS] = vec2[](
+    vec2(-2.0,  2.0), vec2( 0.0,  2.0), vec2( 2.0,  2.0),
+    vec2(-2.0,  0.0), vec2( 0.0,  0.0), vec2( 2.0,  0.0),
+    vec2(-2.0, -2.0), vec2( 0.0, -2.0), vec2( 2.0, -2.0),
+    vec2(-1.0,  1.0), vec2( 1.0,  1.0),
+    vec2(-1.0, -1.0), vec2( 1.0, -1.0)
+);
+const float WEIGHTS[NUM_TAPS] = float[](
+    0.03125, 0.0625, 0.03125,
+    0.0625,  0.125,  0.0625,
+    0.03125, 0.0625, 0.03125,
+    0.125,   0.125,
+    0.125,   0.125
+);
+
+void main() {
+    vec3 result = vec3(0);
+    for (int ix = 0; ix < NUM_TAPS; ix++) {
+        result += texture(s_Source, inUV + OFFSETS[ix] * u_TexelSize).rgb * WEIGHTS[ix];
+    }
+    outColor = vec4(result, 1.0);
+}
@@ -0,0 +1,46 @@
+#version 430
+
+layout(location = 0) in vec2 inUV;
+layout(location = 0) out vec4 outColor;
+
+// The image from the previous pass
+uniform layout(binding = 0) sampler2D s_Image;
+// The emissive layer of the G-Buffer
+uniform layout(binding = 4) sampler2D s_Emissive;
+
+#define NO_GBUFFER_SAMPLERS
+#include "../../fragments/deferred_post_common.glsl"
+
+// The size of a single texel in the full resolution image
+uniform vec2  u_TexelSize;
+// Brightness above which the scene color contributes to bloom
+uniform float u_Threshold;
+// Width of the soft transition around the threshold
+uniform float u_Knee;
+
+// Offsets for 4 bilinear taps, which together average a 4x4 block of texels so the half
+// resolution image does not alias
+const vec2 OFFSETS[4] = vec2[](
+    vec2(-1.0, -1.0), vec2(1.0, -1.0),
+    vec2(-1.0,  1.0), vec2(1.0,  1.0)
+);
+
+vec3 Prefilter(vec3 color) {
+    float brightness = max(color.r, max(color.g, color.b));
+    float soft = clamp(brightness - u_Threshold + u_Knee, 0.0, 2.0 * u_Knee);
+    soft = (soft * soft) / (4.0 * u_Knee + 0.00001);
+    float contribution = max(soft, brightness - u_Threshold) / max(brightness, 0.00001);
+    return color * contribution;
+}
+
+void main() {
+    vec3 scene    = vec3(0);
+    vec3 emissive = vec3(0);
+    for (int ix = 0; ix < 4; ix++) {
+        vec2 uv = ScaleUV(inUV + OFFSETS[ix] * u_TexelSize);
+        scene += texture(s_Image, uv).rgb;
+        vec4 e = texture(s_Emissive, uv);
+        emissive += e.rgb * e.a;
+    }
+    outColor = vec4(Prefilter(scene * 0.25) + emissive * 0.25, 1.0);
+}
@@ -0,0 +1,41 @@
+#version 430
+
+// With the compute backend each level has already been blurred with a separable gaussian before it's
+// upsampled, so we only need a single bilinear tap instead of the tent filter
+#pragma feature PREBLURRED
+
+layout(location = 0) in vec2 inUV;
+layout(location = 0) out vec4 outColor;
+
+// The next smaller level in the bloom chain, this pass is additively blended onto the larger level
+uniform layout(binding = 1) sampler2D s_Source;
+
+// The size of a single texel in the source image
+uniform vec2  u_TexelSize;
+// Scales the distance between taps, larger values give a wider glow
+uniform float u_Radius;
+
+// 3x3 tent filter
+const int   NUM_TAPS = 9;
+const vec2  OFFSETS[NUM_TAPS] = vec2[](
+    vec2(-1.0,  1.0), vec2(0.0,  1.0), vec2(1.0,  1.0),
+    vec2(-1.0,  0.0), vec2(0.0,  0.0), vec2(1.0,  0.0),
+    vec2(-1.0, -1.0), vec2(0.0, -1.0), vec2(1.0, -1.0)
+);
+const float WEIGHTS[NUM_TAPS] = float[](
+    0.0625, 0.125, 0.0625,
+    0.125,  0.25,  0.125,
+    0.0625, 0.125, 0.0625
+);
+
+void main() {
+#ifdef PREBLURRED
+    vec3 result = texture(s_Source, inUV).rgb;
+#else
+    vec3 result = vec3(0);
+    for (int ix = 0; ix < NUM_TAPS; ix++) {
+        result += texture(s_Source, inUV + OFFSETS[ix] * u_TexelSize * u_Radius).rgb * WEIGHTS[ix];
+    }
+#endif
+    outColor = vec4(result, 1.0);
+}
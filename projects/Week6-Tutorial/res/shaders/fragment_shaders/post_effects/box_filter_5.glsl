@@ -8,13 +8,16 @@ uniform layout(binding = 0) sampler2D s_Image;
 uniform float u_Filter[25];
 uniform vec2 u_PixelSize;
 
+#define NO_GBUFFER_SAMPLERS
+#include "../../fragments/deferred_post_common.glsl"
+
 void main() {
     vec3 accumulator = vec3(0);
     for(int ix = -2; ix <= 2; ix++) {
         for (int iy = -2; iy <= 2; iy++) {
             int index =  (iy + 2) * 5 + (ix + 2);
             vec2 uv = inUV + vec2(u_PixelSize.x * ix, u_PixelSize.y * iy);
-            accumulator += texture(s_Image, uv).rgb * u_Filter[index];
+            accumulator += texture(s_Image, ScaleUV(uv)).rgb * u_Filter[index];
         }
     }
     outColor = accumulator;
@@ -0,0 +1,56 @@
+#version 430
+
+// Blurs the half resolution near and far fields with a fixed number of taps on a disc, so
+// the cost of the blur does not depend on the radius
+layout(location = 0) in vec2 inUV;
+layout(location = 0) out vec4 outNear;
+layout(location = 1) out vec4 outFar;
+
+uniform layout(binding = 2) sampler2D s_Near;
+uniform layout(binding = 3) sampler2D s_Far;
+
+// The size of a half resolution pixel in UV space
+uniform vec2 u_TexelSize;
+
+#include "../../fragments/depth_of_field.glsl"
+
+const int   TAP_COUNT    = 32;
+const float GOLDEN_ANGLE = 2.39996323;
+
+void main() {
+    // Our radius in half resolution pixels
+    float maxRadius = u_MaxRadius * 0.5;
+
+    vec4 farCenter = texture(s_Far, inUV);
+    float farRadius = farCenter.a * maxRadius;
+
+    vec3 near = vec3(0); float nearWeight = 0;
+    vec3 far  = farCenter.rgb; float farWeight = 1;
+
+    for (int ix = 0; ix < TAP_COUNT; ix++) {
+        // Vogel disc, points are evenly distributed over the unit circle
+        float r = sqrt((float(ix) + 0.5) / float(TAP_COUNT));
+        float theta = float(ix) * GOLDEN_ANGLE;
+        vec2 offset = vec2(cos(theta), sin(theta)) * r;
+
+        // The far field gathers over it's own CoC, and only from pixels that would scatter onto us,
+        // so sharp background doesn't get smeared into blurry background
+        float farDist = r * farRadius;
+        vec4 farTap = texture(s_Far, inUV + offset * farRadius * u_TexelSize);
+        float farTapWeight = clamp(farTap.a * maxRadius - farDist + 1.0, 0.0, 1.0) * step(0.0001, farTap.a);
+        far += farTap.rgb * farTapWeight;
+        farWeight += farTapWeight;
+
+        // The near field needs to spread out over in focus pixels, so it always gathers over the
+        // max radius and keeps any taps whose CoC reaches us
+        float nearDist = r * maxRadius;
+        vec4 nearTap = texture(s_Near, inUV + offset * maxRadius * u_TexelSize);
+        float nearTapWeight = clamp(nearTap.a * maxRadius - nearDist + 1.0, 0.0, 1.0);
+        near += nearTap.rgb * nearTapWeight;
+        nearWeight += nearTapWeight;
+    }
+
+    // Near field alpha is it's coverage, we treat half the disc being covered as fully opaque
+    outNear = vec4(near / max(nearWeight, 0.0001), clamp(2.0 * nearWeight / float(TAP_COUNT), 0.0, 1.0));
+    outFar  = vec4(far / farWeight, farCenter.a);
+}
@@ -0,0 +1,49 @@
+#version 430
+
+// Upsamples the blurred near and far fields and blends them with the full resolution image
+layout(location = 0) in vec2 inUV;
+layout(location = 0) out vec3 outColor;
+
+uniform layout(binding = 0) sampler2D s_Image;
+uniform layout(binding = 1) sampler2D s_Depth;
+uniform layout(binding = 2) sampler2D s_Near;
+uniform layout(binding = 3) sampler2D s_Far;
+
+#define NO_GBUFFER_SAMPLERS
+#include "../../fragments/deferred_post_common.glsl"
+#include "../../fragments/depth_of_field.glsl"
+
+// Bilinear upsample of the far field, where each texel is also weighted by how close it's CoC is to
+// ours. This stops blurry background from bleeding over the edges of in focus objects
+vec3 UpsampleFar(float coc) {
+    vec2 size = vec2(textureSize(s_Far, 0));
+    vec2 pos = inUV * size - 0.5;
+    ivec2 base = ivec2(floor(pos));
+    vec2 f = fract(pos);
+    ivec2 maxCoord = ivec2(size) - 1;
+
+    vec4 t00 = texelFetch(s_Far, clamp(base,               ivec2(0), maxCoord), 0);
+    vec4 t10 = texelFetch(s_Far, clamp(base + ivec2(1, 0), ivec2(0), maxCoord), 0);
+    vec4 t01 = texelFetch(s_Far, clamp(base + ivec2(0, 1), ivec2(0), maxCoord), 0);
+    vec4 t11 = texelFetch(s_Far, clamp(base + ivec2(1, 1), ivec2(0), maxCoord), 0);
+
+    vec4 weights = vec4((1 - f.x) * (1 - f.y), f.x * (1 - f.y), (1 - f.x) * f.y, f.x * f.y);
+    weights *= 1.0 / (abs(vec4(t00.a, t10.a, t01.a, t11.a) - coc) + 0.01);
+
+    return (t00.rgb * weights.x + t10.rgb * weights.y + t01.rgb * weights.z + t11.rgb * weights.w) / dot(weights, vec4(1));
+}
+
+void main() {
+    vec3 color = texture(s_Image, ScaleUV(inUV)).rgb;
+    float coc = GetCoc(texelFetch(s_Depth, ivec2(gl_FragCoord.xy), 0).r);
+
+    // Blend in the far field once the blur would be larger than a pixel or two
+    float farCoc = max(coc, 0.0);
+    color = mix(color, UpsampleFar(farCoc), smoothstep(1.0, 3.0, farCoc * u_MaxRadius));
+
+    // The near field goes over top of everything, using it's coverage
+    vec4 near = texture(s_Near, inUV);
+    color = mix(color, near.rgb, near.a);
+
+    outColor = color;
+}
@@ -0,0 +1,40 @@
+#version 430
+
+// Splits the image into near and far fields at half resolution, each storing the
+// color of the pixels in that field, and the field's circle of confusion in alpha
+layout(location = 0) out vec4 outNear;
+layout(location = 1) out vec4 outFar;
+
+uniform layout(binding = 0) sampler2D s_Image;
+uniform layout(binding = 1) sampler2D s_Depth;
+
+#define NO_GBUFFER_SAMPLERS
+#include "../../fragments/deferred_post_common.glsl"
+#include "../../fragments/depth_of_field.glsl"
+
+const ivec2 OFFSETS[4] = ivec2[](ivec2(0, 0), ivec2(1, 0), ivec2(0, 1), ivec2(1, 1));
+
+void main() {
+    // Each of our pixels covers a 2x2 block of the full resolution image
+    ivec2 base = ivec2(gl_FragCoord.xy) * 2;
+    // Our inputs are render size targets, so we stay within the part that has been rendered to
+    ivec2 maxCoord = ivec2(u_Viewport.zw) - 1;
+
+    vec3 near = vec3(0); float nearWeight = 0; float nearCoc = 0;
+    vec3 far  = vec3(0); float farWeight  = 0;
+
+    for (int ix = 0; ix < 4; ix++) {
+        ivec2 coord = min(base + OFFSETS[ix], maxCoord);
+        vec3 color = texelFetch(s_Image, coord, 0).rgb;
+        float coc = GetCoc(texelFetch(s_Depth, coord, 0).r);
+
+        // Weighting by the CoC keeps in-focus pixels from leaking into the blurred fields
+        float n = max(-coc, 0.0);
+        float f = max(coc, 0.0);
+        near += color * n; nearWeight += n; nearCoc = max(nearCoc, n);
+        far  += color * f; farWeight  += f;
+    }
+
+    outNear = vec4(near / max(nearWeight, 0.0001), nearCoc);
+    outFar  = vec4(far  / max(farWeight, 0.0001), farWeight * 0.25);
+}
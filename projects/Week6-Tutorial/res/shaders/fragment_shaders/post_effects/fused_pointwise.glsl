@@ -0,0 +1,76 @@
+#version 430
+
+// Post effects that only read the pixel they are writing to, fused into a single pass. Each effect
+// is enabled by a keyword, so effects that are turned off are compiled out of the variant entirely.
+// Effects are applied in the order their keywords are declared here, the post processing layer will
+// only fuse effects that appear in the stack in this order
+#pragma feature BLOOM TONEMAP COLOR_CORRECTION VIGNETTE
+
+layout(location = 0) in vec2 inUV;
+layout(location = 0) out vec3 outColor;
+
+// Image from the previous pass
+uniform layout(binding = 0) sampler2D s_Image;
+
+#define NO_GBUFFER_SAMPLERS
+#include "../../fragments/deferred_post_common.glsl"
+
+#ifdef BLOOM
+// The top (half resolution) level of the bloom chain
+uniform layout(binding = 1) sampler2D s_Bloom;
+uniform float u_BloomIntensity;
+#endif
+
+#ifdef TONEMAP
+uniform float u_Exposure;
+#endif
+
+#ifdef COLOR_CORRECTION
+uniform layout(binding = 2) sampler3D s_Lut;
+uniform float u_LutStrength;
+#endif
+
+#ifdef VIGNETTE
+uniform vec3  u_VignetteColor;
+uniform float u_VignetteIntensity;
+uniform float u_VignetteRadius;
+uniform float u_VignetteSoftness;
+#endif
+
+#ifdef TONEMAP
+// Krzysztof Narkowicz's fit of the ACES filmic curve
+vec3 ACESFilm(vec3 x) {
+    const float a = 2.51;
+    const float b = 0.03;
+    const float c = 2.43;
+    const float d = 0.59;
+    const float e = 0.14;
+    return clamp((x * (a * x + b)) / (x * (c * x + d) + e), 0.0, 1.0);
+}
+#endif
+
+void main() {
+    vec3 color = texture(s_Image, ScaleUV(inUV)).rgb;
+
+    #ifdef BLOOM
+    color += texture(s_Bloom, inUV).rgb * u_BloomIntensity;
+    #endif
+
+    #ifdef TONEMAP
+    color = ACESFilm(color * u_Exposure);
+    #endif
+
+    #ifdef COLOR_CORRECTION
+    color = mix(color, texture(s_Lut, clamp(color, 0.0, 1.0)).rgb, clamp(u_LutStrength, 0, 1));
+    #endif
+
+    #ifdef VIGNETTE
+    // Correct for aspect ratio so the vignette is round
+    vec2 size = u_Viewport.zw;
+    vec2 offset = (inUV - 0.5) * vec2(size.x / size.y, 1.0);
+    float falloff = smoothstep(u_VignetteRadius, u_VignetteRadius - u_VignetteSoftness, length(offset));
+    color = mix(u_VignetteColor, color, mix(1.0, falloff, u_VignetteIntensity));
+    #endif
+
+    outColor = color;
+}
@@ -0,0 +1,27 @@
+#version 430
+
+// One direction of a separable gaussian blur, this is the fallback for when compute shaders
+// are not available
+layout(location = 0) in vec2 inUV;
+layout(location = 0) out vec3 outColor;
+
+#define MAX_RADIUS 32
+
+uniform layout(binding = 0) sampler2D s_Image;
+
+// The offset between taps in UV space, one pixel along the blur axis
+uniform vec2  u_Direction;
+uniform int   u_Radius;
+uniform float u_Weights[MAX_RADIUS + 1];
+
+#define NO_GBUFFER_SAMPLERS
+#include "../../fragments/deferred_post_common.glsl"
+
+void main() {
+    vec3 accumulator = texture(s_Image, ScaleUV(inUV)).rgb * u_Weights[0];
+    for (int ix = 1; ix <= u_Radius; ix++) {
+        accumulator += texture(s_Image, ScaleUV(inUV + u_Direction * ix)).rgb * u_Weights[ix];
+        accumulator += texture(s_Image, ScaleUV(inUV - u_Direction * ix)).rgb * u_Weights[ix];
+    }
+    outColor = accumulator;
+}
@@ -224,7 +224,7 @@ void main() {
         }
 
         // We'll also grab specular power from the G-Buffer
-        float specularPow = texture(s_AlbedoSpec, inUV).a;
+        float specularPow = texture(s_AlbedoSpec, ScaleUV(inUV)).a;
 
         // Use the structure to calculate a directional light's contribution
         CalcDirectionalLightContribution(viewPos, normal, l, specularPow, diffuse, specular);
@@ -9,6 +9,7 @@ layout(location = 0) out vec4 albedo_specPower;
 layout(location = 1) out vec4 normal_metallic;
 layout(location = 2) out vec4 emissive;
 layout(location = 3) out vec3 view_pos;
+layout(location = 4) out vec2 motion;
 
 void main() {
     vec3 norm = normalize(inNormal);
@@ -17,4 +18,6 @@ void main() {
     normal_metallic = vec4(0.5, 0.5, 1, 0);
     emissive = vec4(0);
     view_pos = vec3(0);
+    // The resolve reprojects the sky using the camera's motion, see taa_resolve.glsl
+    motion = vec2(0);
 }
\ No newline at end of file
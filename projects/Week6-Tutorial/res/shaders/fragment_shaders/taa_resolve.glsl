@@ -0,0 +1,184 @@
+#version 430
+
+// Temporal anti-aliasing resolve. The scene is rendered with a different sub-pixel jitter each frame,
+// and this pass blends the new frame into a history buffer that has been reprojected using motion
+// vectors. To stop stale history from ghosting, it is clipped to the colors found in the neighbourhood
+// of the pixel in the new frame.
+//
+// With UPSAMPLE enabled, the history is larger than the rendered image. Each output pixel takes the new
+// frame's samples weighted by how close they landed to it, so over a few frames the jittered samples
+// fill in the detail that a single low resolution frame is missing
+#pragma feature UPSAMPLE
+
+layout(location = 0) in vec2 inUV;
+layout(location = 0) out vec4 outColor;
+
+// The jittered image for this frame, at the render size
+uniform layout(binding = 0) sampler2D s_Image;
+// Depth and motion vectors from the G-Buffer, at the render size
+uniform layout(binding = 1) sampler2D s_Depth;
+uniform layout(binding = 2) sampler2D s_Motion;
+// The resolved image from the previous frame, at the output size
+uniform layout(binding = 3) sampler2D s_History;
+
+// The size of the rendered image in pixels. The inputs are render size targets, which may be
+// larger than the area that was rendered to (see Framebuffer::Resize)
+uniform ivec2 u_RenderSize;
+// The jitter applied to this frame, in NDC
+uniform vec2  u_Jitter;
+// Takes un-jittered clip space positions from this frame to the previous frame, for pixels
+// that don't have motion vectors (ie: the sky)
+uniform mat4  u_ClipToPrevClip;
+// How much of the history to keep when a pixel is moving quickly or is stationary
+uniform float u_FeedbackMin;
+uniform float u_FeedbackMax;
+// False on the first frame after the history has been reset
+uniform bool  u_HistoryValid;
+
+vec3 RGBToYCoCg(vec3 c) {
+    return vec3(
+         0.25 * c.r + 0.5 * c.g + 0.25 * c.b,
+         0.5  * c.r             - 0.5  * c.b,
+        -0.25 * c.r + 0.5 * c.g - 0.25 * c.b
+    );
+}
+
+vec3 YCoCgToRGB(vec3 c) {
+    return vec3(
+        c.x + c.y - c.z,
+        c.x       + c.z,
+        c.x - c.y - c.z
+    );
+}
+
+// 5 tap approximation of a Catmull-Rom filter, which keeps the history sharper than a bilinear fetch
+// would. Repeatedly resampling with a bilinear filter would blur the image more every frame
+// See: https://gist.github.com/TheRealMJP/c83b8c0f46b63f3a88a5986f8fa982b5
+vec3 SampleHistory(vec2 uv) {
+    vec2 size = vec2(textureSize(s_History, 0));
+    vec2 samplePos = uv * size;
+    vec2 texPos1 = floor(samplePos - 0.5) + 0.5;
+    vec2 f = samplePos - texPos1;
+
+    vec2 w0 = f * (-0.5 + f * (1.0 - 0.5 * f));
+    vec2 w1 = 1.0 + f * f * (-2.5 + 1.5 * f);
+    vec2 w2 = f * (0.5 + f * (2.0 - 1.5 * f));
+    vec2 w3 = f * f * (-0.5 + 0.5 * f);
+
+    vec2 w12 = w1 + w2;
+    vec2 offset12 = w2 / w12;
+
+    vec2 texPos0  = (texPos1 - 1.0) / size;
+    vec2 texPos3  = (texPos1 + 2.0) / size;
+    vec2 texPos12 = (texPos1 + offset12) / size;
+
+    vec3 result =
+        texture(s_History, vec2(texPos12.x, texPos0.y)).rgb  * w12.x * w0.y +
+        texture(s_History, vec2(texPos0.x,  texPos12.y)).rgb * w0.x  * w12.y +
+        texture(s_History, vec2(texPos12.x, texPos12.y)).rgb * w12.x * w12.y +
+        texture(s_History, vec2(texPos3.x,  texPos12.y)).rgb * w3.x  * w12.y +
+        texture(s_History, vec2(texPos12.x, texPos3.y)).rgb  * w12.x * w3.y;
+    float weight = w12.x * w0.y + w0.x * w12.y + w12.x * w12.y + w3.x * w12.y + w12.x * w3.y;
+    return max(result / weight, vec3(0));
+}
+
+// Pulls the history towards the center of the neighbourhood's AABB until it is inside it. Unlike
+// clamping each channel, this doesn't shift the hue of the history
+vec3 ClipToAABB(vec3 history, vec3 minColor, vec3 maxColor) {
+    vec3 center = 0.5 * (maxColor + minColor);
+    vec3 extents = 0.5 * (maxColor - minColor) + 1e-4;
+    vec3 offset = history - center;
+    vec3 units = abs(offset / extents);
+    float maxUnit = max(units.x, max(units.y, units.z));
+    return maxUnit > 1.0 ? center + offset / maxUnit : history;
+}
+
+void main() {
+    ivec2 renderSize = u_RenderSize;
+
+    // Where this output pixel landed in the jittered image, in render pixels
+    vec2 samplePos = (inUV + u_Jitter * 0.5) * vec2(renderSize);
+    ivec2 centerTexel = ivec2(floor(samplePos));
+
+    vec3 moment1 = vec3(0);
+    vec3 moment2 = vec3(0);
+    vec3 minColor = vec3(1e9);
+    vec3 maxColor = vec3(-1e9);
+    vec3 current = vec3(0);
+    float currentWeight = 0;
+    float closestDepth = 2.0;
+    ivec2 closestTexel = centerTexel;
+
+    // Gather the statistics of the 3x3 neighbourhood of render pixels around us
+    for (int iy = -1; iy <= 1; iy++) {
+        for (int ix = -1; ix <= 1; ix++) {
+            ivec2 texel = clamp(centerTexel + ivec2(ix, iy), ivec2(0), renderSize - 1);
+            vec3 color = RGBToYCoCg(texelFetch(s_Image, texel, 0).rgb);
+
+            moment1 += color;
+            moment2 += color * color;
+            minColor = min(minColor, color);
+            maxColor = max(maxColor, color);
+
+            // Weight each sample by how close it is to the center of our pixel (gaussian fit of Blackman-Harris)
+            vec2 delta = vec2(texel) + 0.5 - samplePos;
+            float weight = exp(-2.29 * dot(delta, delta));
+            current += color * weight;
+            currentWeight += weight;
+
+            // We take motion from the closest surface in the neighbourhood, so that the edges of moving
+            // objects are reprojected with the object instead of the background
+            float depth = texelFetch(s_Depth, texel, 0).r;
+            if (depth < closestDepth) {
+                closestDepth = depth;
+                closestTexel = texel;
+            }
+        }
+    }
+    current /= currentWeight;
+
+    // Find where this pixel was last frame
+    vec2 motion;
+    if (closestDepth < 1.0) {
+        motion = texelFetch(s_Motion, closestTexel, 0).xy;
+    } else {
+        vec4 prevClip = u_ClipToPrevClip * vec4(inUV * 2.0 - 1.0, 1.0, 1.0);
+        motion = inUV - (prevClip.xy / prevClip.w * 0.5 + 0.5);
+    }
+    vec2 prevUV = inUV - motion;
+
+    if (!u_HistoryValid || any(lessThan(prevUV, vec2(0))) || any(greaterThan(prevUV, vec2(1)))) {
+        outColor = vec4(YCoCgToRGB(current), 1.0);
+        return;
+    }
+
+    // Tighten the box to the variance of the neighbourhood, which handles outliers better than the min/max alone
+    vec3 mean = moment1 / 9.0;
+    vec3 sigma = sqrt(max(moment2 / 9.0 - mean * mean, vec3(0)));
+    minColor = max(minColor, mean - sigma * 1.25);
+    maxColor = min(maxColor, mean + sigma * 1.25);
+
+    vec3 history = RGBToYCoCg(SampleHistory(prevUV));
+    history = ClipToAABB(history, minColor, maxColor);
+
+    // Fast moving pixels are more likely to be wrong, so we trust their history less
+    vec2 outputSize = vec2(textureSize(s_History, 0));
+    float speed = length(motion * outputSize);
+    float feedback = mix(u_FeedbackMax, u_FeedbackMin, clamp(speed / 8.0, 0.0, 1.0));
+
+#ifdef UPSAMPLE
+    // When there's no sample close to this pixel in the new frame, lean more heavily on the history
+    vec2 nearest = vec2(centerTexel) + 0.5 - samplePos;
+    float confidence = exp(-2.29 * dot(nearest, nearest));
+    feedback = 1.0 - (1.0 - feedback) * confidence;
+#endif
+
+    // Weighing by inverse luma reduces flickering from very bright pixels
+    float currentLumaWeight = 1.0 / (1.0 + current.x);
+    float historyLumaWeight = 1.0 / (1.0 + history.x);
+    float blendCurrent = (1.0 - feedback) * currentLumaWeight;
+    float blendHistory = feedback * historyLumaWeight;
+    vec3 result = (current * blendCurrent + history * blendHistory) / (blendCurrent + blendHistory);
+
+    outColor = vec4(max(YCoCgToRGB(result), vec3(0)), 1.0);
+}
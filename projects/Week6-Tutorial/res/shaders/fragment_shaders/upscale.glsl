@@ -0,0 +1,46 @@
+#version 430
+
+// Scales the image rendered at the dynamic resolution up to the size of the game viewport. By default
+// this is a plain bilinear filter. With SHARPEN enabled, the result is sharpened based on the contrast
+// of the neighbouring source texels (similar to AMD's contrast adaptive sharpening), which recovers some
+// of the detail that the lower resolution loses without ringing on high contrast edges
+#pragma feature SHARPEN
+
+layout(location = 0) in vec2 inUV;
+layout(location = 0) out vec3 outColor;
+
+uniform layout(binding = 0) sampler2D s_Image;
+// The UV scale of the image, since it may be a render size target or the TAA history (see ScaleUV)
+uniform vec4 u_ImageUvScale;
+
+#define NO_GBUFFER_SAMPLERS
+#include "../fragments/deferred_post_common.glsl"
+
+#ifdef SHARPEN
+// Sharpening strength in the 0-1 range
+uniform float u_Sharpness;
+#endif
+
+void main() {
+    vec3 center = texture(s_Image, ScaleUV(inUV, u_ImageUvScale)).rgb;
+
+#ifdef SHARPEN
+    // Neighbours are one texel away in the source image, not the output
+    vec2 texel = 1.0 / (vec2(textureSize(s_Image, 0)) * u_ImageUvScale.xy);
+    vec3 north = texture(s_Image, ScaleUV(inUV + vec2(0, texel.y), u_ImageUvScale)).rgb;
+    vec3 south = texture(s_Image, ScaleUV(inUV - vec2(0, texel.y), u_ImageUvScale)).rgb;
+    vec3 east  = texture(s_Image, ScaleUV(inUV + vec2(texel.x, 0), u_ImageUvScale)).rgb;
+    vec3 west  = texture(s_Image, ScaleUV(inUV - vec2(texel.x, 0), u_ImageUvScale)).rgb;
+
+    vec3 minColor = min(center, min(min(north, south), min(east, west)));
+    vec3 maxColor = max(center, max(max(north, south), max(east, west)));
+
+    // Sharpen less where the neighbourhood already has a lot of contrast, or is close to clipping
+    vec3 amount = sqrt(clamp(min(minColor, 1.0 - maxColor) / max(maxColor, 1e-4), 0.0, 1.0));
+    vec3 weight = -amount * mix(0.125, 0.2, clamp(u_Sharpness, 0.0, 1.0));
+
+    center = (center + (north + south + east + west) * weight) / (1.0 + 4.0 * weight);
+#endif
+
+    outColor = max(center, vec3(0));
+}
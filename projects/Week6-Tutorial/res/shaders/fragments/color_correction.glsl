@@ -1,18 +1,21 @@
 // We need the flags from the frame uniforms
 #include "frame_uniforms.glsl"
 
+// Enabled by the render layer when RenderFlags::EnableColorCorrection is set, so that shaders
+// don't need to branch on the frame flags for every fragment
+#pragma global_feature ENABLE_COLOR_CORRECTION
+
 // Our color correction 3d texture
 uniform layout (binding=14) sampler3D s_ColorCorrection;
 
 // Function for applying color correction
 vec3 ColorCorrect(vec3 inputColor) {
+#ifdef ENABLE_COLOR_CORRECTION
     // If our color correction flag is set, we perform the color lookup
-    if (IsFlagSet(FLAG_ENABLE_COLOR_CORRECTION)) {
-        return texture(s_ColorCorrection, inputColor).rgb;
-    }
+    return texture(s_ColorCorrection, inputColor).rgb;
+#else
     // Otherwise just return the input
-    else {
-        return inputColor;
-    }
+    return inputColor;
+#endif
 }
 
@@ -1,23 +1,41 @@
+#include "frame_uniforms.glsl"
 
+// Render targets are allocated with some headroom (see Framebuffer::Resize), so the image only covers
+// the bottom left corner of them. These take a UV over the rendered image to a UV in the texture, clamped
+// so that bilinear taps along the edge don't pick up texels outside of the image.
+// Scale stores the UV scale in xy, and the largest UV that can be sampled in zw
+vec2 ScaleUV(vec2 uv, vec4 scale) {
+    return min(uv * scale.xy, scale.zw);
+}
+
+// Scales a UV for any texture at the render size (the G-Buffer, lighting buffers and post effect targets)
+vec2 ScaleUV(vec2 uv) {
+    return ScaleUV(uv, u_UvScale);
+}
+
+// Post effects that only need the UV helpers can define this before including this file
+#ifndef NO_GBUFFER_SAMPLERS
 uniform layout(binding=0) sampler2D s_Depth;
 uniform layout(binding=1) sampler2D s_AlbedoSpec;
 uniform layout(binding=2) sampler2D s_NormalsMetallic;
 uniform layout(binding=3) sampler2D s_Emissive;
 uniform layout(binding=4) sampler2D s_Position;
 
+// The G-Buffer getters take UVs over the rendered image, and handle the scaling themselves
 
 vec3 GetNormal(vec2 uv) {
-    return ((texture(s_NormalsMetallic, uv).xyz) * 2) - 1;
+    return ((texture(s_NormalsMetallic, ScaleUV(uv)).xyz) * 2) - 1;
 }
 
 vec3 GetAlbedo(vec2 uv) {
-    return texture(s_AlbedoSpec, uv).rgb;
+    return texture(s_AlbedoSpec, ScaleUV(uv)).rgb;
 }
 
 vec3 GetViewPosition(vec2 uv) {
-    return texture(s_Position, uv).rgb;
+    return texture(s_Position, ScaleUV(uv)).rgb;
 }
 
 float GetDepth(vec2 uv) {
-    return texelFetch(s_Depth, ivec2(uv * textureSize(s_Depth, 0)), 0).r;
-}
\ No newline at end of file
+    return texelFetch(s_Depth, ivec2(uv * u_Viewport.zw), 0).r;
+}
+#endif
@@ -0,0 +1,21 @@
+// Shared helpers for the depth of field passes, the camera's clip planes and lens
+// settings come from the frame uniforms
+
+#include "frame_uniforms.glsl"
+
+// The blur radius of a fully out of focus pixel, in full resolution pixels
+uniform float u_MaxRadius;
+
+// Converts a value from the depth buffer into a distance from the camera
+float LinearizeDepth(float depth) {
+    float ndc = depth * 2.0 - 1.0;
+    return (2.0 * u_ZNear * u_ZFar) / (u_ZFar + u_ZNear - ndc * (u_ZFar - u_ZNear));
+}
+
+// Gets the circle of confusion for a depth buffer value using the thin lens model, as a fraction of
+// the max radius. Negative values are in front of the focal plane, positive are behind it
+float GetCoc(float depth) {
+    float z = LinearizeDepth(depth);
+    float coc = u_Aperture * u_LensDepth * (z - u_FocalDepth) / (z * max(u_FocalDepth - u_LensDepth, 0.0001));
+    return clamp(coc, -1.0, 1.0);
+}
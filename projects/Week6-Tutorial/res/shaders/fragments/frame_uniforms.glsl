@@ -33,6 +33,14 @@ layout (std140, binding = 0) uniform b_FrameLevelUniforms {
     // New for fun, the viewport rectangle on the output (x, y, w, h)
     uniform vec4 u_Viewport;
 
+    // The un-jittered view projection from the previous frame
+    uniform mat4 u_PrevViewProjection;
+    // The sub-pixel offset applied to the projection this frame (xy) and last frame (zw), in NDC
+    uniform vec4 u_Jitter;
+    // Takes UVs over the rendered image to UVs in render size targets (xy), and the largest UV that
+    // can be sampled from them (zw), see ScaleUV in deferred_post_common.glsl
+    uniform vec4 u_UvScale;
+
 };
 
 // Stores uniforms that change every object/instance
@@ -45,6 +53,11 @@ layout (std140, binding = 1) uniform b_InstanceLevelUniforms {
     uniform mat4 u_ModelView;
     // Normal Matrix for transforming normals
     uniform mat4 u_NormalMatrix;
+    // The un-jittered MVP from the previous frame, for motion vectors
+    uniform mat4 u_PrevModelViewProjection;
+    // The progress of a cross-fade between levels of detail, positive for the incoming level,
+    // negative for the outgoing level, and 0 when the object isn't fading (see lod_fade.glsl)
+    uniform float u_LodFade;
 };
 
 #define FLAG_ENABLE_COLOR_CORRECTION (1 << 0)
@@ -57,6 +70,14 @@ bool IsMultipleFlagSet(uint flags) {
     return (u_Flags & flags) == flags;
 }
 
+// Calculates the screen space motion of a point between the previous frame and this one, in UV
+// units. The jitter is removed so that a static scene has no motion
+vec2 CalcMotionVector(vec4 clipPos, vec4 prevClipPos) {
+    vec2 current  = clipPos.xy / clipPos.w - u_Jitter.xy;
+    vec2 previous = prevClipPos.xy / prevClipPos.w;
+    return (current - previous) * 0.5;
+}
+
 float linearize(float depth) {
     return (2 * u_ZNear) / (u_ZFar + u_ZNear - depth * (u_ZFar - u_ZNear));
 }
\ No newline at end of file
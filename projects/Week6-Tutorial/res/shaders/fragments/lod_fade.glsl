@@ -0,0 +1,26 @@
+// Dithered cross-fading between levels of detail. While an object changes levels, the render layer draws
+// both levels with complementary dither patterns, so the switch happens over a few frames instead of popping
+#include "frame_uniforms.glsl"
+
+// A 4x4 ordered dither threshold for this pixel, in the 0-1 range
+float LodDitherThreshold() {
+    const float bayer[16] = float[16](
+         0.0,  8.0,  2.0, 10.0,
+        12.0,  4.0, 14.0,  6.0,
+         3.0, 11.0,  1.0,  9.0,
+        15.0,  7.0, 13.0,  5.0
+    );
+    ivec2 pixel = ivec2(gl_FragCoord.xy) & 3;
+    return (bayer[pixel.y * 4 + pixel.x] + 0.5) / 16.0;
+}
+
+// Discards the fragment if it belongs to the other level of a cross-fade. The incoming level keeps the
+// pixels below the fade amount, and the outgoing level (which has a negative fade) keeps the rest
+void ApplyLodFade() {
+    if (u_LodFade != 0.0) {
+        float threshold = LodDitherThreshold();
+        if (u_LodFade > 0.0 ? threshold >= u_LodFade : threshold < -u_LodFade) {
+            discard;
+        }
+    }
+}
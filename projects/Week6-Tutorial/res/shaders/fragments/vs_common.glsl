@@ -1,5 +1,6 @@
 
-// Vertex inputs
+// Vertex inputs, shaders that need a different layout can #define VS_CUSTOM_INPUTS and declare their own
+#ifndef VS_CUSTOM_INPUTS
 layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec3 inColor;
 layout(location = 2) in vec3 inNormal;
@@ -7,6 +8,7 @@ layout(location = 3) in vec2 inUV;
 
 layout(location = 4) in vec3 inTangent;
 layout(location = 5) in vec3 inBiTangent;
+#endif
 
 // Standard vertex shader outputs
 layout(location = 0) out vec3 outViewPos;
@@ -14,6 +16,15 @@ layout(location = 1) out vec3 outColor;
 layout(location = 2) out vec3 outNormal;
 layout(location = 3) out vec2 outUV;
 layout(location = 4) out mat3 outTBN;
+// Current and previous clip space positions, for motion vectors (see WriteMotionVectors)
+layout(location = 10) out vec4 outClipPos;
+layout(location = 11) out vec4 outPrevClipPos;
 
 // Include the matrices and frame level parameters
 #include "frame_uniforms.glsl"
+
+// Passes the positions the fragment shader needs to write motion vectors. Must be called after gl_Position is set
+void WriteMotionVectors(vec4 prevClipPos) {
+    outClipPos = gl_Position;
+    outPrevClipPos = prevClipPos;
+}
@@ -21,6 +21,7 @@ void main() {
 
     // Transform to world position
 	gl_Position = u_ModelViewProjection * vec4(displacedPos, 1.0);
+	WriteMotionVectors(u_PrevModelViewProjection * vec4(displacedPos, 1.0));
 
 	// Pass vertex pos in world space to frag shader
 	outViewPos = (u_ModelView * vec4(displacedPos, 1.0)).xyz;
@@ -10,12 +10,17 @@ uniform float u_WindSpeed;
 
 void main() {
     // Determine the offset based on our simple wind calcualtion
-    vec3 windFactor = normalize(u_WindDirection) * sin(u_Time * u_WindSpeed) * cos(inPosition.z * u_VerticalScale) * u_WindStrength;
+    vec3 windDir = normalize(u_WindDirection) * cos(inPosition.z * u_VerticalScale) * u_WindStrength;
+    vec3 windFactor = windDir * sin(u_Time * u_WindSpeed);
 	// Calculate the output world position
 	outViewPos = (u_ModelView * vec4(inPosition, 1.0)).xyz + windFactor;
     // Project the world position to determine the screenspace position
 	gl_Position = u_Projection * vec4(outViewPos, 1);
 
+	// The wind is part of the motion, so we need to know where it put us last frame as well
+	vec3 prevWindFactor = windDir * sin((u_Time - u_DeltaTime) * u_WindSpeed);
+	WriteMotionVectors(u_PrevModelViewProjection * vec4(inPosition, 1.0) + u_Projection * vec4(prevWindFactor, 0));
+
 	// Normals
 	outNormal = mat3(u_NormalMatrix) * normalize(inNormal);
 	
@@ -0,0 +1,39 @@
+#version 440
+
+// glTF meshes store their tangents as a vec4, with the handedness of the bitangent in w, and
+// may not have colors or tangents at all
+#define VS_CUSTOM_INPUTS
+layout(location = 0) in vec3 inPosition;
+layout(location = 2) in vec3 inNormal;
+layout(location = 3) in vec2 inUV;
+layout(location = 4) in vec4 inTangent;
+
+// Include our common vertex shader outputs and uniforms
+#include "../fragments/vs_common.glsl"
+
+void main() {
+
+	gl_Position = u_ModelViewProjection * vec4(inPosition, 1.0);
+	WriteMotionVectors(u_PrevModelViewProjection * vec4(inPosition, 1.0));
+
+	// Pass vertex pos in view space to frag shader
+	outViewPos = (u_ModelView * vec4(inPosition, 1.0)).xyz;
+
+	// Normals
+	vec3 N = normalize((u_View * vec4(mat3(u_NormalMatrix) * inNormal, 0)).xyz);
+	outNormal = N;
+
+	// Meshes without tangents leave the attribute at it's default of (0, 0, 0, 1), so we pick any
+	// tangent perpendicular to the normal. Normal maps won't line up, but the surface stays lit
+	vec3 tangent = inTangent.xyz;
+	if (dot(tangent, tangent) < 1e-8) {
+		tangent = abs(inNormal.z) < 0.999 ? cross(inNormal, vec3(0, 0, 1)) : vec3(1, 0, 0);
+	}
+	vec3 T = normalize((u_View * vec4(mat3(u_NormalMatrix) * tangent, 0)).xyz);
+	vec3 B = cross(N, T) * (inTangent.w < 0.0 ? -1.0 : 1.0);
+	outTBN = mat3(T, B, N);
+
+	// Pass our UV coords to the fragment shader
+	outUV = inUV;
+	outColor = vec3(1.0);
+}
@@ -12,6 +12,10 @@
 #include "Utils/FileHelpers.h"
 #include "Utils/ResourceManager/ResourceManager.h"
 #include "Utils/ImGuiHelper.h"
+#include "Utils/ImportCache.h"
+#include "Graphics/GpuMemory.h"
+#include "Utils/PackFile.h"
+#include "Utils/VirtualFileSystem.h"
 
 // Graphics
 #include "Graphics/Buffers/IndexBuffer.h"
@@ -27,6 +31,7 @@
 #include "Graphics/Font.h"
 #include "Graphics/GuiBatcher.h"
 #include "Graphics/Framebuffer.h"
+#include "Graphics/AsyncReadback.h"
 
 // Gameplay
 #include "Gameplay/Material.h"
@@ -61,6 +66,9 @@
 #include "Layers/InstancedRenderingTestLayer.h"
 #include "Layers/ParticleLayer.h"
 #include "Layers/PostProcessingLayer.h"
+#include "Layers/ShaderReloadLayer.h"
+#include "Layers/FrameCaptureLayer.h"
+#include "Layers/ObjLoaderBenchmarkLayer.h"
 
 
 Application* Application::_singleton = nullptr;
@@ -68,6 +76,8 @@ std::string Application::_applicationName = "INFR-2350U - DEMO";
 
 #define DEFAULT_WINDOW_WIDTH 1280
 #define DEFAULT_WINDOW_HEIGHT 720
+#define DEFAULT_IMPORT_CACHE_SIZE_MB 1024
+#define DEFAULT_GPU_MEMORY_BUDGET_MB 1024
 
 Application::Application() :
 	_window(nullptr),
@@ -89,9 +99,40 @@ Application& Application::Get() {
 void Application::Start(int argCount, char** arguments) {
 	LOG_ASSERT(_singleton == nullptr, "Application has already been started!");
 	_singleton = new Application();
+	for (int ix = 1; ix < argCount; ix++) {
+		_singleton->_arguments.push_back(arguments[ix]);
+	}
 	_singleton->_Run();
 }
 
+std::string Application::GetArgument(const std::string& name, const std::string& defaultValue) const {
+	std::string flag = "--" + name;
+	for (size_t ix = 0; ix < _arguments.size(); ix++) {
+		const std::string& arg = _arguments[ix];
+		if (arg == flag) {
+			// The value is the next argument, unless that's another flag
+			if (ix + 1 < _arguments.size() && _arguments[ix + 1].rfind("--", 0) != 0) {
+				return _arguments[ix + 1];
+			}
+			return defaultValue;
+		}
+		if (arg.size() > flag.size() && arg.compare(0, flag.size(), flag) == 0 && arg[flag.size()] == '=') {
+			return arg.substr(flag.size() + 1);
+		}
+	}
+	return defaultValue;
+}
+
+bool Application::HasArgument(const std::string& name) const {
+	std::string flag = "--" + name;
+	for (const std::string& arg : _arguments) {
+		if (arg == flag || (arg.size() > flag.size() && arg.compare(0, flag.size(), flag) == 0 && arg[flag.size()] == '=')) {
+			return true;
+		}
+	}
+	return false;
+}
+
 GLFWwindow* Application::GetWindow() { return _window; }
 
 const glm::ivec2& Application::GetWindowSize() const { return _windowSize; }
@@ -115,11 +156,13 @@ void Application::Quit() {
 }
 
 bool Application::LoadScene(const std::string & path) {
-	if (std::filesystem::exists(path)) {
+	if (FileHelpers::Exists(path)) {
 
 		std::string manifestPath = std::filesystem::path(path).stem().string() + "-manifest.json";
-		if (std::filesystem::exists(manifestPath)) {
+		if (FileHelpers::Exists(manifestPath)) {
 			LOG_INFO("Loading manifest from \"{}\"", manifestPath);
+			// Textures that were just saved may still be writing their blobs
+			AsyncReadback::Flush();
 			ResourceManager::LoadManifest(manifestPath);
 		}
 
@@ -148,6 +191,19 @@ void Application::SaveSettings()
 
 void Application::_Run()
 {
+	// Packing our resources is a build step, so we don't need to start anything else up for it
+	if (HasArgument("build-pack")) {
+		PackFile::Build(GetArgument("build-pack", "res"), GetArgument("pack-output", "res.pak"));
+		return;
+	}
+
+	// Shipping builds read their resources out of a pack rather than loose files, use --no-pack to use
+	// the loose files instead (ex: to hot reload shaders)
+	std::string packPath = GetArgument("pack", "res.pak");
+	if (!HasArgument("no-pack") && std::filesystem::exists(packPath)) {
+		VirtualFileSystem::Mount(packPath);
+	}
+
 	// TODO: Register layers
 	_layers.push_back(std::make_shared<GLAppLayer>());
 	_layers.push_back(std::make_shared<DefaultSceneLayer>());
@@ -155,11 +211,14 @@ void Application::_Run()
 	_layers.push_back(std::make_shared<RenderLayer>());
 	_layers.push_back(std::make_shared<ParticleLayer>());
 	_layers.push_back(std::make_shared<PostProcessingLayer>());
+	_layers.push_back(std::make_shared<FrameCaptureLayer>());
+	_layers.push_back(std::make_shared<ObjLoaderBenchmarkLayer>());
 	_layers.push_back(std::make_shared<InterfaceLayer>());
 
 	// If we're in editor mode, we add all the editor layers
 	if (_isEditor) {
 		_layers.push_back(std::make_shared<ImGuiDebugLayer>());
+		_layers.push_back(std::make_shared<ShaderReloadLayer>());
 	}
 
 	// Either load the settings, or use the defaults
@@ -169,6 +228,10 @@ void Application::_Run()
 	_windowSize.x = JsonGet(_appSettings, "window_width", DEFAULT_WINDOW_WIDTH);
 	_windowSize.y = JsonGet(_appSettings, "window_height", DEFAULT_WINDOW_HEIGHT);
 
+	// Limit how much disk space imported assets can take up
+	ImportCache::SetMaxSize(JsonGet(_appSettings, "import_cache_size_mb", (uint64_t)DEFAULT_IMPORT_CACHE_SIZE_MB) * 1024ull * 1024ull);
+	GpuMemory::SetBudget(JsonGet(_appSettings, "gpu_memory_budget_mb", (uint64_t)DEFAULT_GPU_MEMORY_BUDGET_MB) * 1024ull * 1024ull);
+
 	// By default, we want our viewport to be the whole screen
 	_primaryViewport = { 0, 0, _windowSize.x, _windowSize.y };
 
@@ -220,6 +283,9 @@ void Application::_Run()
 			_HandleSceneChange();
 		}
 
+		// Advance the frame counter for GPU memory tracking, and evict anything stale if we're over budget
+		GpuMemory::Update();
+
 		// Receive events like input and window position/size changes from GLFW
 		glfwPollEvents();
 
@@ -521,6 +587,9 @@ void Application::_PostRender() {
 }
 
 void Application::_Unload() {
+	// Let any outstanding readbacks finish while we still have a context
+	AsyncReadback::Shutdown();
+
 	// Note that we use a reverse iterator for unloading
 	for (auto it = _layers.crbegin(); it != _layers.crend(); it++) {
 		const auto& layer = *it;
@@ -531,6 +600,9 @@ void Application::_Unload() {
 
 	// Clean up ImGui
 	ImGuiHelper::Cleanup();
+
+	// Store when each cached import was last used, so the least recently used ones are evicted first next time
+	ImportCache::SaveManifest();
 }
 
 void Application::_HandleSceneChange() {
@@ -614,6 +686,8 @@ nlohmann::json Application::_GetDefaultAppSettings()
 
 	result["window_width"] = DEFAULT_WINDOW_WIDTH;
 	result["window_height"] = DEFAULT_WINDOW_HEIGHT;
+	result["import_cache_size_mb"] = DEFAULT_IMPORT_CACHE_SIZE_MB;
+	result["gpu_memory_budget_mb"] = DEFAULT_GPU_MEMORY_BUDGET_MB;
 	return result;
 }
 
@@ -34,6 +34,20 @@ public:
 	 */
 	static void Start(int argCount, char** arguments);
 
+	/**
+	 * Gets the value of a command line argument, passed as either --name=value or --name value
+	 * 
+	 * @param name The name of the argument, without the leading dashes
+	 * @param defaultValue The value to return if the argument was not passed
+	 */
+	std::string GetArgument(const std::string& name, const std::string& defaultValue = "") const;
+	/**
+	 * Checks whether a command line argument was passed
+	 * 
+	 * @param name The name of the argument, without the leading dashes
+	 */
+	bool HasArgument(const std::string& name) const;
+
 	/**
 	 * Gets the GLFW window for the application
 	 */
@@ -131,6 +145,8 @@ protected:
 
 	// Stores the current application settings
 	nlohmann::json _appSettings;
+	// The command line arguments, not including the executable path
+	std::vector<std::string> _arguments;
 
 	// The current scene that the application is working on
 	Gameplay::Scene::Sptr _currentScene;
@@ -38,6 +38,7 @@
 #include "Gameplay/Material.h"
 #include "Gameplay/GameObject.h"
 #include "Gameplay/Scene.h"
+#include "Gameplay/GltfImporter.h"
 #include "Gameplay/Components/Light.h"
 
 // Components
@@ -666,6 +667,11 @@ void DefaultSceneLayer::_CreateScene()
 
 			trigger->Add<TriggerVolumeEnterBehaviour>();
 		}
+
+		// A glTF scene can be dropped into the world from the command line, ex: --import-gltf models/Sponza.gltf
+		if (app.HasArgument("import-gltf")) {
+			GltfImporter::ImportScene(scene, app.GetArgument("import-gltf"));
+		}
 		
 		/*GameObject::Sptr shadowCaster = scene->CreateGameObject("Shadow Light");
 		{
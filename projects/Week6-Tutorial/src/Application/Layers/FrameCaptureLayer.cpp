@@ -0,0 +1,54 @@
+#include "FrameCaptureLayer.h"
+
+#include <filesystem>
+
+#include "../Application.h"
+#include "Graphics/AsyncReadback.h"
+
+FrameCaptureLayer::FrameCaptureLayer() :
+	ApplicationLayer(),
+	_interval(0),
+	_directory("captures"),
+	_frameIndex(0)
+{
+	Name = "Frame Capture";
+	Overrides = AppLayerFunctions::OnAppLoad | AppLayerFunctions::OnPostRender;
+}
+
+FrameCaptureLayer::~FrameCaptureLayer() = default;
+
+void FrameCaptureLayer::Capture(const std::string& path)
+{
+	const glm::uvec4& viewport = Application::Get().GetPrimaryViewport();
+	AsyncReadback::ReadFramebuffer(nullptr, RenderTargetAttachment::Color0, viewport, PixelFormat::RGBA, PixelType::UByte, AsyncReadback::PngWriter(path));
+}
+
+void FrameCaptureLayer::OnAppLoad(const nlohmann::json& config)
+{
+	Application& app = Application::Get();
+
+	std::string interval = app.GetArgument("capture-frames", "0");
+	try {
+		_interval = std::stoul(interval);
+	}
+	catch (std::exception&) {
+		LOG_WARN("Invalid value for --capture-frames \"{}\", expected a number of frames", interval);
+		_interval = 0;
+	}
+	_directory = app.GetArgument("capture-dir", _directory);
+
+	if (_interval > 0) {
+		LOG_INFO("Capturing every {} frames to \"{}\"", _interval, _directory);
+	}
+}
+
+void FrameCaptureLayer::OnPostRender()
+{
+	// We run after post processing, but before the interface layer, so the capture contains the game without UI
+	_frameIndex++;
+	if (_interval > 0 && (_frameIndex % _interval) == 0) {
+		char filename[32];
+		snprintf(filename, sizeof(filename), "frame_%06llu.png", (unsigned long long)_frameIndex);
+		Capture((std::filesystem::path(_directory) / filename).string());
+	}
+}
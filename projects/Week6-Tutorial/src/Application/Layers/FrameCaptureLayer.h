@@ -0,0 +1,35 @@
+#pragma once
+#include "../ApplicationLayer.h"
+
+/**
+ * The frame capture layer saves the output of the game to PNG files every N frames, for building
+ * image comparison tests. Captures are read back asynchronously, so they do not stall rendering
+ *
+ * Enabled with the --capture-frames N command line argument, the output directory can be set
+ * with --capture-dir (default "captures")
+ */
+class FrameCaptureLayer final : public ApplicationLayer {
+public:
+	MAKE_PTRS(FrameCaptureLayer)
+
+	FrameCaptureLayer();
+	virtual ~FrameCaptureLayer();
+
+	/**
+	 * Queues a capture of the current contents of the primary viewport
+	 * 
+	 * @param path The path of the PNG file to write
+	 */
+	void Capture(const std::string& path);
+
+	// Inherited from ApplicationLayer
+
+	virtual void OnAppLoad(const nlohmann::json& config) override;
+	virtual void OnPostRender() override;
+
+protected:
+	// How many frames between captures, 0 to disable
+	uint32_t    _interval;
+	std::string _directory;
+	uint64_t    _frameIndex;
+};
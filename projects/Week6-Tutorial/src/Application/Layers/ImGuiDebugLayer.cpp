@@ -15,6 +15,7 @@
 #include "../Windows/DebugWindow.h"
 #include "../Windows/GBufferPreviews.h"
 #include "../Windows/PostProcessingSettingsWindow.h"
+#include "../Windows/GpuMemoryWindow.h"
 
 #include "Graphics/DebugDraw.h"
 
@@ -40,6 +41,7 @@ void ImGuiDebugLayer::OnAppLoad(const nlohmann::json& config)
 	RegisterWindow<DebugWindow>();
 	RegisterWindow<GBufferPreviews>();
 	RegisterWindow<PostProcessingSettingsWindow>();
+	RegisterWindow<GpuMemoryWindow>();
 }
 
 void ImGuiDebugLayer::OnAppUnload()
@@ -0,0 +1,129 @@
+#include "ObjLoaderBenchmarkLayer.h"
+
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <thread>
+
+#include "../Application.h"
+#include "Utils/ObjLoader.h"
+#include "Utils/OptimizedObjLoader.h"
+#include "Utils/FastObjParser.h"
+
+ObjLoaderBenchmarkLayer::ObjLoaderBenchmarkLayer() :
+	ApplicationLayer()
+{
+	Name = "OBJ Loader Benchmark";
+	Overrides = AppLayerFunctions::OnAppLoad;
+}
+
+ObjLoaderBenchmarkLayer::~ObjLoaderBenchmarkLayer() = default;
+
+void ObjLoaderBenchmarkLayer::OnAppLoad(const nlohmann::json& config)
+{
+	Application& app = Application::Get();
+	if (!app.HasArgument("benchmark-obj")) {
+		return;
+	}
+
+	std::string triangles = app.GetArgument("benchmark-obj", "1000000");
+	uint32_t maxTriangles = 0;
+	try {
+		maxTriangles = std::stoul(triangles);
+	}
+	catch (std::exception&) {
+		LOG_WARN("Invalid value for --benchmark-obj \"{}\", expected a number of triangles", triangles);
+		return;
+	}
+	std::filesystem::path directory = app.GetArgument("benchmark-dir", "benchmark");
+	std::filesystem::create_directories(directory);
+
+	// Each mesh is 10x bigger than the last, so we can see how the loaders scale
+	for (uint32_t count = std::max(maxTriangles / 100, 2u); count <= maxTriangles; count *= 10) {
+		std::string path = (directory / ("grid_" + std::to_string(count) + ".obj")).string();
+		_GenerateMesh(path, count);
+		_RunBenchmark(path);
+	}
+}
+
+void ObjLoaderBenchmarkLayer::_GenerateMesh(const std::string& path, uint32_t triangles)
+{
+	// Each cell of the grid is 2 triangles
+	uint32_t size = std::max((uint32_t)std::sqrt(triangles / 2.0f), 1u);
+
+	std::ofstream file(path, std::ios::binary);
+	if (!file) {
+		throw std::runtime_error("Failed to open output file");
+	}
+
+	// Build the file up in a buffer, the streaming operators would make this take longer than the loaders
+	std::string buffer;
+	char line[128];
+	auto flush = [&]() {
+		file.write(buffer.data(), buffer.size());
+		buffer.clear();
+	};
+
+	for (uint32_t y = 0; y <= size; y++) {
+		for (uint32_t x = 0; x <= size; x++) {
+			float u = x / (float)size;
+			float v = y / (float)size;
+			float height = 0.05f * std::sin(u * 40.0f) * std::cos(v * 40.0f);
+			glm::vec3 normal = glm::normalize(glm::vec3(-2.0f * std::cos(u * 40.0f) * std::cos(v * 40.0f), 1.0f, 2.0f * std::sin(u * 40.0f) * std::sin(v * 40.0f)));
+			int length = snprintf(line, sizeof(line), "v %f %f %f\nvt %f %f\nvn %f %f %f\n", u, height, v, u, v, normal.x, normal.y, normal.z);
+			buffer.append(line, length);
+		}
+		if (buffer.size() > 1024 * 1024) { flush(); }
+	}
+	for (uint32_t y = 0; y < size; y++) {
+		for (uint32_t x = 0; x < size; x++) {
+			uint32_t a = y * (size + 1) + x + 1;
+			uint32_t b = a + 1;
+			uint32_t c = a + size + 1;
+			uint32_t d = c + 1;
+			int length = snprintf(line, sizeof(line), "f %u/%u/%u %u/%u/%u %u/%u/%u\nf %u/%u/%u %u/%u/%u %u/%u/%u\n", a, a, a, c, c, c, d, d, d, a, a, a, d, d, d, b, b, b);
+			buffer.append(line, length);
+		}
+		if (buffer.size() > 1024 * 1024) { flush(); }
+	}
+	flush();
+}
+
+void ObjLoaderBenchmarkLayer::_RunBenchmark(const std::string& path)
+{
+	// Times a loader, returning how long it took in milliseconds
+	auto time = [](const std::function<VertexArrayObject::Sptr()>& load) {
+		auto start = std::chrono::high_resolution_clock::now();
+		VertexArrayObject::Sptr result = load();
+		// Make sure the upload has actually happened before we stop the clock
+		glFinish();
+		auto end = std::chrono::high_resolution_clock::now();
+		return std::chrono::duration<double, std::milli>(end - start).count();
+	};
+	// Parses with one of the builder based parsers and uploads the result, so these rows line up with ObjLoader
+	auto parse = [&](const std::function<MeshBuilder<VertexPosNormTexColTangents>*()>& parser) {
+		MeshBuilder<VertexPosNormTexColTangents>* mesh = parser();
+		VertexArrayObject::Sptr result = mesh->Bake();
+		delete mesh;
+		return result;
+	};
+
+	// The import goes straight through ConvertToBinary, LoadFromFile would hit the import cache after the first run
+	std::filesystem::path binPath = std::filesystem::path(path).replace_extension(".bin");
+	std::error_code error;
+	std::filesystem::remove(binPath, error);
+
+	uint32_t threads = std::max(std::thread::hardware_concurrency(), 1u);
+	uintmax_t fileSize = std::filesystem::file_size(path);
+
+	LOG_INFO("OBJ loader benchmark for \"{}\" ({:.1f} MB)", path, fileSize / (1024.0 * 1024.0));
+	LOG_INFO("\tObjLoader (parse + upload):                         {:>10.2f} ms", time([&]() { return ObjLoader::LoadFromFile(path); }));
+	LOG_INFO("\tLegacy stream parser (parse + upload):              {:>10.2f} ms", time([&]() { return parse([&]() { return OptimizedObjLoader::_LoadLegacy(path); }); }));
+	LOG_INFO("\tFastObjParser 1 thread (parse + upload):            {:>10.2f} ms", time([&]() { return parse([&]() { return FastObjParser::LoadFromFile(path, 1); }); }));
+	LOG_INFO("\tFastObjParser {:>2} threads (parse + upload):          {:>10.2f} ms", threads, time([&]() { return parse([&]() { return FastObjParser::LoadFromFile(path, threads); }); }));
+	LOG_INFO("\tOptimizedObjLoader import (parse, LODs, optimize):  {:>10.2f} ms", time([&]() { OptimizedObjLoader::ConvertToBinary(path, binPath.string()); return VertexArrayObject::Sptr(); }));
+	LOG_INFO("\tOptimizedObjLoader binary load (.bin + upload):     {:>10.2f} ms", time([&]() { return OptimizedObjLoader::LoadFromFile(binPath.string()); }));
+	std::filesystem::remove(binPath, error);
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include "../ApplicationLayer.h"
+
+/**
+ * The OBJ loader benchmark generates meshes of increasing size and times our OBJ loaders against them.
+ * ObjLoader, the legacy stream parser and FastObjParser (on one thread and on all of them) are timed
+ * parsing the file and uploading it to a VAO. OptimizedObjLoader is timed separately importing the file
+ * (parsing, generating LODs, optimizing and writing the .bin) and loading the resulting binary. Results
+ * are written to the log
+ *
+ * Enabled with the --benchmark-obj N command line argument, where N is the number of triangles in the
+ * largest mesh (default 1000000). The meshes are written to --benchmark-dir (default "benchmark")
+ */
+class ObjLoaderBenchmarkLayer final : public ApplicationLayer {
+public:
+	MAKE_PTRS(ObjLoaderBenchmarkLayer)
+
+	ObjLoaderBenchmarkLayer();
+	virtual ~ObjLoaderBenchmarkLayer();
+
+	// Inherited from ApplicationLayer
+
+	virtual void OnAppLoad(const nlohmann::json& config) override;
+
+protected:
+	/**
+	 * Writes a bumpy grid with positions, UVs and normals to an OBJ file
+	 *
+	 * @param path The path to write the OBJ file to
+	 * @param triangles The approximate number of triangles to generate
+	 */
+	static void _GenerateMesh(const std::string& path, uint32_t triangles);
+	/**
+	 * Runs all the loaders against a single file, and logs their timings
+	 */
+	static void _RunBenchmark(const std::string& path);
+};
@@ -3,122 +3,184 @@
 #include "Utils/JsonGlmHelpers.h"
 #include "Utils/ImGuiHelper.h"
 #include "Graphics/Framebuffer.h"
+#include "Application/Application.h"
+#include "Application/Layers/RenderLayer.h"
+#include "GaussianBlur.h"
 
 #include <GLM/glm.hpp>
 
-//Code is based on the 5x5 Box Filter code from the tutorials
-
 Bloom::Bloom() :
-	PostProcessingLayer::Effect()
+	PostProcessingLayer::Effect(),
+	Threshold(1.0f),
+	Knee(0.1f),
+	Intensity(1.0f),
+	Radius(1.0f),
+	Iterations(5),
+	_chain()
 {
 	Name = "Bloom";
 	_format = RenderTargetType::ColorRgb8;
 
-	memset(Filter, 0, sizeof(float) * 25);
-	Filter[0] = 0.1f;
-	Filter[1] = 0.25f;
-	Filter[2] = 0.25f;
-	Filter[3] = 0.25f;
-	Filter[4] = 0.1f;
-	Filter[5] = 0.1f;
-	Filter[6] = 0.5f;
-	Filter[7] = 0.5f;
-	Filter[8] = 0.5f;
-	Filter[9] = 0.1f;
-	Filter[10] = 0.1f;
-	Filter[11] = 0.5f;
-	Filter[12] = 1.0f;
-	Filter[13] = 0.5f;
-	Filter[14] = 0.1f;
-	Filter[15] = 0.1f;
-	Filter[16] = 0.5f;
-	Filter[17] = 0.5f;
-	Filter[18] = 0.5f;
-	Filter[19] = 0.1f;
-	Filter[20] = 0.1f;
-	Filter[21] = 0.25f;
-	Filter[22] = 0.5f;
-	Filter[23] = 0.25f;
-	Filter[24] = 0.1f;
-
-	_shader = ResourceManager::CreateAsset<ShaderProgram>(std::unordered_map<ShaderPartType, std::string>{
+	_prefilterShader = ResourceManager::CreateAsset<ShaderProgram>(std::unordered_map<ShaderPartType, std::string>{
+		{ ShaderPartType::Vertex, "shaders/vertex_shaders/fullscreen_quad.glsl" },
+		{ ShaderPartType::Fragment, "shaders/fragment_shaders/post_effects/bloom_prefilter.glsl" }
+	});
+	_downsampleShader = ResourceManager::CreateAsset<ShaderProgram>(std::unordered_map<ShaderPartType, std::string>{
 		{ ShaderPartType::Vertex, "shaders/vertex_shaders/fullscreen_quad.glsl" },
-		{ ShaderPartType::Fragment, "shaders/fragment_shaders/post_effects/bloom.glsl" }
+		{ ShaderPartType::Fragment, "shaders/fragment_shaders/post_effects/bloom_downsample.glsl" }
+	});
+	_upsampleShader = ResourceManager::CreateAsset<ShaderProgram>(std::unordered_map<ShaderPartType, std::string>{
+		{ ShaderPartType::Vertex, "shaders/vertex_shaders/fullscreen_quad.glsl" },
+		{ ShaderPartType::Fragment, "shaders/fragment_shaders/post_effects/bloom_upsample.glsl" }
+	});
+	_blurShader = ResourceManager::CreateAsset<ShaderProgram>(std::unordered_map<ShaderPartType, std::string>{
+		{ ShaderPartType::Compute, "shaders/compute_shaders/post_effects/gaussian_blur.glsl" }
 	});
 }
 
 Bloom::~Bloom() = default;
 
-void Bloom::Apply(const Framebuffer::Sptr& gBuffer)
+void Bloom::PrepareFused(const Framebuffer::Sptr& gBuffer)
 {
-	_shader->Bind();
-	_shader->SetUniform("u_Filter", Filter, 25);
-	_shader->SetUniform("u_PixelSize", glm::vec2(1.0f) / (glm::vec2)gBuffer->GetSize()); 
+	const RenderTargetPool::Sptr& pool = Application::Get().GetLayer<RenderLayer>()->GetRenderTargetPool();
+
+	// Borrow the chain of targets, starting at half resolution. We use a float format so that
+	// the additive upsamples don't clip
+	glm::uvec2 size = glm::uvec2(_output->GetSize()) / 2u;
+	int levels = glm::clamp(Iterations, 1, MAX_ITERATIONS);
+	for (int ix = 0; ix < levels && size.x >= 2 && size.y >= 2; ix++) {
+		_chain.push_back(pool->Acquire(size.x, size.y, RenderTargetType::ColorRgba16F));
+		size /= 2u;
+	}
+	if (_chain.empty()) {
+		_chain.push_back(pool->Acquire(1, 1, RenderTargetType::ColorRgba16F));
+	}
+
+	// Bright pass, the previous pass's image is already in slot 0
+	gBuffer->BindAttachment(RenderTargetAttachment::Color2, 4);
+	_chain[0]->Bind();
+	glViewport(0, 0, _chain[0]->GetWidth(), _chain[0]->GetHeight());
+	_prefilterShader->Bind();
+	_prefilterShader->SetUniform("u_TexelSize"_uh, glm::vec2(1.0f) / glm::vec2(_output->GetSize()));
+	_prefilterShader->SetUniform("u_Threshold"_uh, Threshold);
+	_prefilterShader->SetUniform("u_Knee"_uh, glm::max(Knee, 0.0f));
+	DrawFullscreen();
+
+	// Progressively downsample, each level reads from the one above it
+	_downsampleShader->Bind();
+	for (size_t ix = 1; ix < _chain.size(); ix++) {
+		_chain[ix]->Bind();
+		glViewport(0, 0, _chain[ix]->GetWidth(), _chain[ix]->GetHeight());
+		_chain[ix - 1]->BindAttachment(RenderTargetAttachment::Color0, 1);
+		_downsampleShader->SetUniform("u_TexelSize"_uh, glm::vec2(1.0f) / glm::vec2(_chain[ix - 1]->GetSize()));
+		DrawFullscreen();
+	}
+
+	// Then work our way back up, adding each level onto the next larger one
+	if (_backend == PostEffectBackend::Compute) {
+		_UpsampleCompute();
+	} else {
+		_UpsampleFragment();
+	}
 }
 
-void Bloom::RenderImGui()
+void Bloom::_UpsampleFragment()
 {
-	ImGui::PushID(this);
-
-	ImGui::Columns(5); 
-	for (int iy = 0; iy < 5; iy++) { 
-		for (int ix = 0; ix < 5; ix++) {
-			ImGui::PushID(iy * 5 + ix);
-			ImGui::PushItemWidth(-1);
-			ImGui::InputFloat("", &Filter[iy * 5 + ix], 0.01f);
-			ImGui::PopItemWidth();
-			ImGui::PopID();
-			ImGui::NextColumn();
-		}
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_ONE, GL_ONE);
+	_upsampleShader->Bind();
+	_upsampleShader->SetUniform("u_Radius"_uh, Radius);
+	for (size_t ix = _chain.size() - 1; ix > 0; ix--) {
+		_chain[ix - 1]->Bind();
+		glViewport(0, 0, _chain[ix - 1]->GetWidth(), _chain[ix - 1]->GetHeight());
+		_chain[ix]->BindAttachment(RenderTargetAttachment::Color0, 1);
+		_upsampleShader->SetUniform("u_TexelSize"_uh, glm::vec2(1.0f) / glm::vec2(_chain[ix]->GetSize()));
+		DrawFullscreen();
 	}
-	ImGui::Columns(1);
-
-	if (ImGui::Button("Normalize")) {
-		float sum = 0.0f;
-		for (int ix = 0; ix < 25; ix++) {
-			sum += Filter[ix];
-		}
-		float mult = sum == 0.0f ? 1 : sum;
+	glDisable(GL_BLEND);
+}
 
-		for (int ix = 0; ix < 25; ix++) {
-			Filter[ix] /= mult;
+void Bloom::_UpsampleCompute()
+{
+	const RenderTargetPool::Sptr& pool = Application::Get().GetLayer<RenderLayer>()->GetRenderTargetPool();
+
+	// The tent filter's standard deviation is about 0.7 of it's tap spacing, we go a bit wider since the
+	// gaussian doesn't get the extra spread from the bilinear taps
+	float weights[GaussianBlur::MAX_RADIUS + 1];
+	int radius = GaussianBlur::CalculateWeights(Radius * 1.5f, weights);
+
+	ShaderProgram* upsample = _upsampleShader->GetVariant(_upsampleShader->GetKeywordMask(std::vector<std::string>{ "PREBLURRED" }));
+	for (size_t ix = _chain.size(); ix > 0; ix--) {
+		const Framebuffer::Sptr& level = _chain[ix - 1];
+
+		// Blur the level in place, the horizontal pass goes through a borrowed target of the same size
+		Framebuffer::Sptr intermediate = pool->Acquire(level->GetWidth(), level->GetHeight(), RenderTargetType::ColorRgba16F);
+		level->BindAttachment(RenderTargetAttachment::Color0, 0);
+		GaussianBlur::BlurCompute(_blurShader, intermediate, level, radius, weights);
+		pool->Release(intermediate);
+
+		// The level is sampled by the next upsample, or by the fused pass for the top level
+		glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+
+		if (ix > 1) {
+			glEnable(GL_BLEND);
+			glBlendFunc(GL_ONE, GL_ONE);
+			_chain[ix - 2]->Bind();
+			glViewport(0, 0, _chain[ix - 2]->GetWidth(), _chain[ix - 2]->GetHeight());
+			upsample->Bind();
+			level->BindAttachment(RenderTargetAttachment::Color0, 1);
+			DrawFullscreen();
+			glDisable(GL_BLEND);
 		}
 	}
-	float* temp = ImGui::GetStateStorage()->GetFloatRef(ImGui::GetID("###temp-filler"), 0.0f);
-	ImGui::PushItemWidth(ImGui::GetContentRegionAvailWidth() * 0.75f);
-	ImGui::InputFloat("", temp, 0.1f);
-	ImGui::PopItemWidth();
+}
 
-	ImGui::SameLine();
+void Bloom::ApplyFused(ShaderProgram* shader)
+{
+	// The post processing layer has restored our output, and will draw the composite
+	_chain[0]->BindAttachment(RenderTargetAttachment::Color0, 1);
+	shader->SetUniform("u_BloomIntensity"_uh, Intensity);
+}
 
-	if (ImGui::Button("Fill")) {
-		for (int ix = 0; ix < 25; ix++) { 
-			Filter[ix] = *temp;
-		}
+void Bloom::PostApply()
+{
+	// The composite has been drawn, the chain can go back to the pool
+	const RenderTargetPool::Sptr& pool = Application::Get().GetLayer<RenderLayer>()->GetRenderTargetPool();
+	for (const auto& target : _chain) {
+		pool->Release(target);
 	}
+	_chain.clear();
+}
 
-	ImGui::PopID();
+void Bloom::RenderImGui()
+{
+	LABEL_LEFT(ImGui::DragFloat, "Threshold ", &Threshold, 0.01f, 0.0f, 10.0f);
+	LABEL_LEFT(ImGui::DragFloat, "Knee      ", &Knee, 0.01f, 0.0f, 1.0f);
+	LABEL_LEFT(ImGui::DragFloat, "Intensity ", &Intensity, 0.01f, 0.0f, 10.0f);
+	LABEL_LEFT(ImGui::DragFloat, "Radius    ", &Radius, 0.01f, 0.1f, 4.0f);
+	LABEL_LEFT(ImGui::SliderInt, "Iterations", &Iterations, 1, MAX_ITERATIONS);
 }
 
 Bloom::Sptr Bloom::FromJson(const nlohmann::json& data)
 {
 	Bloom::Sptr result = std::make_shared<Bloom>();
-	result->Enabled = JsonGet(data, "enabled", true);
-	std::vector<float> filter = JsonGet(data, "filter", std::vector<float>(25, 0.0f));
-	for (int ix = 0; ix < 25; ix++) {
-		result->Filter[ix] = filter[ix];
-	}
+	result->Enabled    = JsonGet(data, "enabled", true);
+	result->Threshold  = JsonGet(data, "threshold", result->Threshold);
+	result->Knee       = JsonGet(data, "knee", result->Knee);
+	result->Intensity  = JsonGet(data, "intensity", result->Intensity);
+	result->Radius     = JsonGet(data, "radius", result->Radius);
+	result->Iterations = JsonGet(data, "iterations", result->Iterations);
 	return result;
 }
 
 nlohmann::json Bloom::ToJson() const
 {
-	std::vector<float> filter;
-	for (int ix = 0; ix < 25; ix++) {
-		filter.push_back(Filter[ix]);
-	}
 	return {
 		{ "enabled", Enabled },
-		{ "filter", filter }
+		{ "threshold", Threshold },
+		{ "knee", Knee },
+		{ "intensity", Intensity },
+		{ "radius", Radius },
+		{ "iterations", Iterations }
 	};
 }
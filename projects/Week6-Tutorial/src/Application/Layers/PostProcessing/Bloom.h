@@ -4,17 +4,42 @@
 #include "Graphics/Textures/Texture3D.h"
 #include "Graphics/Framebuffer.h"
 
-//Code is based on the 5x5 Box Filter code from the tutorials
-
+/**
+ * Mip chain bloom, the bright parts of the image (and the G-Buffer's emissive layer) are
+ * extracted into a half resolution target, then progressively downsampled with a 13 tap
+ * filter and upsampled with a tent filter back up the chain before being added to the image
+ *
+ * With the compute backend, each level is instead blurred with the separable gaussian compute
+ * shader (see GaussianBlur) before being added to the next larger level
+ *
+ * The final composite is point-wise, so it is drawn as part of the fused post effect pass
+ */
 class Bloom : public PostProcessingLayer::Effect {
 public:
 	MAKE_PTRS(Bloom);
-	float Filter[25];
+
+	// The maximum number of levels in the downsample chain
+	static const int MAX_ITERATIONS = 8;
+
+	// Brightness above which the scene color will bloom (emissive always blooms)
+	float Threshold;
+	// The width of the soft transition around the threshold
+	float Knee;
+	// The strength of the bloom when added back to the image
+	float Intensity;
+	// Scales the spacing of the upsample taps, larger values give a wider glow
+	float Radius;
+	// The number of levels in the downsample chain, the first being half resolution
+	int   Iterations;
 
 	Bloom();
 	virtual ~Bloom();
 
-	virtual void Apply(const Framebuffer::Sptr& gBuffer) override;
+	virtual const char* GetFusionKeyword() const override { return "BLOOM"; }
+	virtual PostEffectBackend GetBackends() const override { return PostEffectBackend::Fragment | PostEffectBackend::Compute; }
+	virtual void PrepareFused(const Framebuffer::Sptr& gBuffer) override;
+	virtual void ApplyFused(ShaderProgram* shader) override;
+	virtual void PostApply() override;
 	virtual void RenderImGui() override;
 
 	// Inherited from IResource
@@ -23,5 +48,20 @@ public:
 	virtual nlohmann::json ToJson() const override;
 	
 protected:
-	ShaderProgram::Sptr _shader;
-};
\ No newline at end of file
+	ShaderProgram::Sptr _prefilterShader;
+	ShaderProgram::Sptr _downsampleShader;
+	ShaderProgram::Sptr _upsampleShader;
+	ShaderProgram::Sptr _blurShader;
+
+	// The chain of targets borrowed from the render target pool for the current frame
+	std::vector<Framebuffer::Sptr> _chain;
+
+	/**
+	 * Blurs each level of the chain with the compute shader, adding it onto the next larger level
+	 */
+	void _UpsampleCompute();
+	/**
+	 * Upsamples each level of the chain with the tent filter, adding it onto the next larger level
+	 */
+	void _UpsampleFragment();
+};
@@ -9,8 +9,9 @@
 BoxFilter3x3::BoxFilter3x3() :
 	PostProcessingLayer::Effect()
 {
-	Name = "Box Filter";
-	_format = RenderTargetType::ColorRgb8;
+	Name = "Box Filter 3x3";
+	// RGBA so that the compute backend can write to it with image stores
+	_format = RenderTargetType::ColorRgba8;
 
 	// Zero the memory, then set center pixel to 1.0
 	memset(Filter, 0, sizeof(float) * 9);
@@ -20,6 +21,9 @@ BoxFilter3x3::BoxFilter3x3() :
 		{ ShaderPartType::Vertex, "shaders/vertex_shaders/fullscreen_quad.glsl" },
 		{ ShaderPartType::Fragment, "shaders/fragment_shaders/post_effects/box_filter_3.glsl" }
 	});
+	_computeShader = ResourceManager::CreateAsset<ShaderProgram>(std::unordered_map<ShaderPartType, std::string>{
+		{ ShaderPartType::Compute, "shaders/compute_shaders/post_effects/box_filter.glsl" }
+	});
 }
 
 BoxFilter3x3::~BoxFilter3x3() = default;
@@ -27,8 +31,16 @@ BoxFilter3x3::~BoxFilter3x3() = default;
 void BoxFilter3x3::Apply(const Framebuffer::Sptr& gBuffer)
 {
 	_shader->Bind(); 
-	_shader->SetUniform("u_Filter", Filter, 9); 
-	_shader->SetUniform("u_PixelSize", glm::vec2(1.0f) / (glm::vec2)gBuffer->GetSize()); 
+	_shader->SetUniform("u_Filter"_uh, Filter, 9); 
+	_shader->SetUniform("u_PixelSize"_uh, glm::vec2(1.0f) / (glm::vec2)gBuffer->GetSize()); 
+}
+
+void BoxFilter3x3::ApplyCompute(const Framebuffer::Sptr& gBuffer)
+{
+	_computeShader->Bind();
+	_computeShader->SetUniform("u_Filter"_uh, Filter, 9);
+	BindImage(_output, 0);
+	DispatchCompute(glm::uvec2(_output->GetSize()), glm::uvec2(16));
 }
 
 void BoxFilter3x3::RenderImGui()
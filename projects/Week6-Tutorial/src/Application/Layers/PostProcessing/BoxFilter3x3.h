@@ -12,7 +12,9 @@ public:
 	BoxFilter3x3();
 	virtual ~BoxFilter3x3();
 
+	virtual PostEffectBackend GetBackends() const override { return PostEffectBackend::Fragment | PostEffectBackend::Compute; }
 	virtual void Apply(const Framebuffer::Sptr& gBuffer) override;
+	virtual void ApplyCompute(const Framebuffer::Sptr& gBuffer) override;
 	virtual void RenderImGui() override;
 
 	// Inherited from IResource
@@ -22,5 +24,6 @@ public:
 
 protected:
 	ShaderProgram::Sptr _shader;
+	ShaderProgram::Sptr _computeShader;
 };
 
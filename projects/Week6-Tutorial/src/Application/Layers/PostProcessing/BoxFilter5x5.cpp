@@ -9,8 +9,9 @@
 BoxFilter5x5::BoxFilter5x5() :
 	PostProcessingLayer::Effect()
 {
-	Name = "Box Filter";
-	_format = RenderTargetType::ColorRgb8;
+	Name = "Box Filter 5x5";
+	// RGBA so that the compute backend can write to it with image stores
+	_format = RenderTargetType::ColorRgba8;
 
 	memset(Filter, 0, sizeof(float) * 25);
 	Filter[12] = 1.0f;
@@ -19,6 +20,9 @@ BoxFilter5x5::BoxFilter5x5() :
 		{ ShaderPartType::Vertex, "shaders/vertex_shaders/fullscreen_quad.glsl" },
 		{ ShaderPartType::Fragment, "shaders/fragment_shaders/post_effects/box_filter_5.glsl" }
 	});
+	_computeShader = ResourceManager::CreateAsset<ShaderProgram>(std::unordered_map<ShaderPartType, std::string>{
+		{ ShaderPartType::Compute, "shaders/compute_shaders/post_effects/box_filter.glsl" }
+	});
 }
 
 BoxFilter5x5::~BoxFilter5x5() = default;
@@ -26,8 +30,18 @@ BoxFilter5x5::~BoxFilter5x5() = default;
 void BoxFilter5x5::Apply(const Framebuffer::Sptr& gBuffer)
 {
 	_shader->Bind();
-	_shader->SetUniform("u_Filter", Filter, 25);
-	_shader->SetUniform("u_PixelSize", glm::vec2(1.0f) / (glm::vec2)gBuffer->GetSize()); 
+	_shader->SetUniform("u_Filter"_uh, Filter, 25);
+	_shader->SetUniform("u_PixelSize"_uh, glm::vec2(1.0f) / (glm::vec2)gBuffer->GetSize()); 
+}
+
+void BoxFilter5x5::ApplyCompute(const Framebuffer::Sptr& gBuffer)
+{
+	// The 5x5 kernel is a variant of the same shader with a wider apron
+	ShaderProgram* shader = _computeShader->GetVariant(_computeShader->GetKeywordMask(std::vector<std::string>{ "FILTER_5X5" }));
+	shader->Bind();
+	shader->SetUniform("u_Filter"_uh, Filter, 25);
+	BindImage(_output, 0);
+	DispatchCompute(glm::uvec2(_output->GetSize()), glm::uvec2(16));
 }
 
 void BoxFilter5x5::RenderImGui()
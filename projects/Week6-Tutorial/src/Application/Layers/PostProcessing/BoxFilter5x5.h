@@ -12,7 +12,9 @@ public:
 	BoxFilter5x5();
 	virtual ~BoxFilter5x5();
 
+	virtual PostEffectBackend GetBackends() const override { return PostEffectBackend::Fragment | PostEffectBackend::Compute; }
 	virtual void Apply(const Framebuffer::Sptr& gBuffer) override;
+	virtual void ApplyCompute(const Framebuffer::Sptr& gBuffer) override;
 	virtual void RenderImGui() override;
 
 	// Inherited from IResource
@@ -22,4 +24,5 @@ public:
 
 protected:
 	ShaderProgram::Sptr _shader;
+	ShaderProgram::Sptr _computeShader;
 };
\ No newline at end of file
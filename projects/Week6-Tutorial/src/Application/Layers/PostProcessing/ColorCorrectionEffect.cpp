@@ -8,18 +8,12 @@ ColorCorrectionEffect::ColorCorrectionEffect() :
 
 ColorCorrectionEffect::ColorCorrectionEffect(bool defaultLut) :
 	PostProcessingLayer::Effect(),
-	_shader(nullptr),
 	_strength(0.25f),
 	Lut(nullptr)
 {
 	Name = "Color Correction";
 	_format = RenderTargetType::ColorRgb8;
 
-	_shader = ResourceManager::CreateAsset<ShaderProgram>(std::unordered_map<ShaderPartType, std::string>{
-		{ ShaderPartType::Vertex, "shaders/vertex_shaders/fullscreen_quad.glsl" },
-		{ ShaderPartType::Fragment, "shaders/fragment_shaders/post_effects/color_correction.glsl" }
-	});
-
 	if (defaultLut) {
 		Lut = ResourceManager::CreateAsset<Texture3D>("luts/CoolLUT.cube");
 	}
@@ -27,11 +21,13 @@ ColorCorrectionEffect::ColorCorrectionEffect(bool defaultLut) :
 
 ColorCorrectionEffect::~ColorCorrectionEffect() = default;
 
-void ColorCorrectionEffect::Apply(const Framebuffer::Sptr& gBuffer)
+void ColorCorrectionEffect::ApplyFused(ShaderProgram* shader)
 {
-	_shader->Bind();
-	Lut->Bind(1);
-	_shader->SetUniform("u_Strength", _strength);
+	// Without a LUT we just pass the image through
+	if (Lut != nullptr) {
+		Lut->Bind(2);
+	}
+	shader->SetUniform("u_LutStrength"_uh, Lut != nullptr ? _strength : 0.0f);
 }
 
 void ColorCorrectionEffect::RenderImGui()
@@ -12,7 +12,8 @@ public:
 	ColorCorrectionEffect(bool defaultLut);
 	virtual ~ColorCorrectionEffect();
 
-	virtual void Apply(const Framebuffer::Sptr& gBuffer) override;
+	virtual const char* GetFusionKeyword() const override { return "COLOR_CORRECTION"; }
+	virtual void ApplyFused(ShaderProgram* shader) override;
 	virtual void RenderImGui() override;
 
 	// Inherited from IResource
@@ -21,7 +22,6 @@ public:
 	virtual nlohmann::json ToJson() const override;
 
 protected:
-	ShaderProgram::Sptr _shader;
 	float _strength;
 };
 
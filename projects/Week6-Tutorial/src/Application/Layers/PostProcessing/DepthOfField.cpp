@@ -7,14 +7,27 @@
 
 DepthOfField::DepthOfField() :
 	PostProcessingLayer::Effect(),
-	_shader(nullptr)
+	MaxRadius(16.0f),
+	_prefilterShader(nullptr),
+	_blurShader(nullptr),
+	_shader(nullptr),
+	_fields(nullptr),
+	_blurredFields(nullptr)
 {
 	Name = "Depth of Field";
 	_format = RenderTargetType::ColorRgb8;
 
+	_prefilterShader = ResourceManager::CreateAsset<ShaderProgram>(std::unordered_map<ShaderPartType, std::string>{
+		{ ShaderPartType::Vertex, "shaders/vertex_shaders/fullscreen_quad.glsl" },
+		{ ShaderPartType::Fragment, "shaders/fragment_shaders/post_effects/dof_prefilter.glsl" }
+	});
+	_blurShader = ResourceManager::CreateAsset<ShaderProgram>(std::unordered_map<ShaderPartType, std::string>{
+		{ ShaderPartType::Vertex, "shaders/vertex_shaders/fullscreen_quad.glsl" },
+		{ ShaderPartType::Fragment, "shaders/fragment_shaders/post_effects/dof_blur.glsl" }
+	});
 	_shader = ResourceManager::CreateAsset<ShaderProgram>(std::unordered_map<ShaderPartType, std::string>{
 		{ ShaderPartType::Vertex, "shaders/vertex_shaders/fullscreen_quad.glsl" },
-		{ ShaderPartType::Fragment, "shaders/fragment_shaders/post_effects/depth_of_field.glsl" }
+		{ ShaderPartType::Fragment, "shaders/fragment_shaders/post_effects/dof_composite.glsl" }
 	});
 }
 
@@ -22,8 +35,58 @@ DepthOfField::~DepthOfField() = default;
 
 void DepthOfField::Apply(const Framebuffer::Sptr& gBuffer)
 {
-	_shader->Bind();
+	const RenderTargetPool::Sptr& pool = Application::Get().GetLayer<RenderLayer>()->GetRenderTargetPool();
+
+	// Both fields are stored in one half resolution target, so the prefilter and blur can each be done in one pass
+	FramebufferDescriptor description = FramebufferDescriptor();
+	description.Width  = glm::max(_output->GetWidth() / 2, 1u);
+	description.Height = glm::max(_output->GetHeight() / 2, 1u);
+	description.RenderTargets[RenderTargetAttachment::Color0] = RenderTargetDescriptor(RenderTargetType::ColorRgba16F);
+	description.RenderTargets[RenderTargetAttachment::Color1] = RenderTargetDescriptor(RenderTargetType::ColorRgba16F);
+	_fields        = pool->Acquire(description);
+	_blurredFields = pool->Acquire(description);
+
 	gBuffer->BindAttachment(RenderTargetAttachment::Depth, 1);
+
+	// Split the image into near and far fields, the previous pass's image is already in slot 0
+	_fields->Bind();
+	glViewport(0, 0, _fields->GetWidth(), _fields->GetHeight());
+	_prefilterShader->Bind();
+	_SetFocusUniforms(_prefilterShader);
+	DrawFullscreen();
+
+	// Blur both fields
+	_blurredFields->Bind();
+	_fields->BindAttachment(RenderTargetAttachment::Color0, 2);
+	_fields->BindAttachment(RenderTargetAttachment::Color1, 3);
+	_blurShader->Bind();
+	_blurShader->SetUniform("u_TexelSize"_uh, glm::vec2(1.0f) / glm::vec2(_fields->GetSize()));
+	_SetFocusUniforms(_blurShader);
+	DrawFullscreen();
+
+	// Restore our output, the post processing layer will draw the composite
+	_output->Bind();
+	glViewport(0, 0, _output->GetWidth(), _output->GetHeight());
+	_blurredFields->BindAttachment(RenderTargetAttachment::Color0, 2);
+	_blurredFields->BindAttachment(RenderTargetAttachment::Color1, 3);
+
+	_shader->Bind();
+	_SetFocusUniforms(_shader);
+}
+
+void DepthOfField::PostApply()
+{
+	const RenderTargetPool::Sptr& pool = Application::Get().GetLayer<RenderLayer>()->GetRenderTargetPool();
+	pool->Release(_fields);
+	pool->Release(_blurredFields);
+	_fields = nullptr;
+	_blurredFields = nullptr;
+}
+
+void DepthOfField::_SetFocusUniforms(const ShaderProgram::Sptr& shader)
+{
+	// The camera's clip planes and lens settings come from the frame uniforms
+	shader->SetUniform("u_MaxRadius"_uh, MaxRadius);
 }
 
 void DepthOfField::RenderImGui()
@@ -35,18 +98,21 @@ void DepthOfField::RenderImGui()
 		ImGui::DragFloat("Lens Dist. ", &cam->LensDepth,  0.01f, 0.001f, 50.0f);
 		ImGui::DragFloat("Aperture   ", &cam->Aperture,   0.1f, 0.1f, 60.0f);
 	}
+	ImGui::DragFloat("Max Radius ", &MaxRadius, 0.1f, 1.0f, 64.0f);
 }
 
 DepthOfField::Sptr DepthOfField::FromJson(const nlohmann::json& data)
 {
 	DepthOfField::Sptr result = std::make_shared<DepthOfField>();
-	result->Enabled = JsonGet(data, "enabled", true);
+	result->Enabled   = JsonGet(data, "enabled", true);
+	result->MaxRadius = JsonGet(data, "max_radius", result->MaxRadius);
 	return result;
 }
 
 nlohmann::json DepthOfField::ToJson() const
 {
 	return {
-		{ "enabled", Enabled }
+		{ "enabled", Enabled },
+		{ "max_radius", MaxRadius }
 	};
 }
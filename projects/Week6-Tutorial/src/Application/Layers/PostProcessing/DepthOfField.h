@@ -5,14 +5,24 @@
 #include "Graphics/Textures/Texture3D.h"
 #include "Graphics/Framebuffer.h"
 
+/**
+ * Depth of field using the main camera's focus settings. The circle of confusion is computed
+ * from the G-Buffer depth, and the image is split into near and far fields at half resolution.
+ * Each field is blurred with a fixed number of taps, so the cost stays the same regardless of the
+ * blur radius, and then blended back over the full resolution image with a depth aware upsample
+ */
 class DepthOfField : public PostProcessingLayer::Effect {
 public:
 	MAKE_PTRS(DepthOfField);
 
+	// The blur radius for pixels that are fully out of focus, in pixels
+	float MaxRadius;
+
 	DepthOfField();
 	virtual ~DepthOfField();
 
 	virtual void Apply(const Framebuffer::Sptr& gBuffer) override;
+	virtual void PostApply() override;
 	virtual void RenderImGui() override;
 
 	// Inherited from IResource
@@ -21,5 +31,16 @@ public:
 	virtual nlohmann::json ToJson() const override;
 
 protected:
+	ShaderProgram::Sptr _prefilterShader;
+	ShaderProgram::Sptr _blurShader;
 	ShaderProgram::Sptr _shader;
-};
\ No newline at end of file
+
+	// Half resolution near (Color0) and far (Color1) fields, borrowed from the target pool during Apply
+	Framebuffer::Sptr _fields;
+	Framebuffer::Sptr _blurredFields;
+
+	/**
+	 * Sets the uniforms shared by all of our passes, the camera's focus comes from the frame uniforms
+	 */
+	void _SetFocusUniforms(const ShaderProgram::Sptr& shader);
+};
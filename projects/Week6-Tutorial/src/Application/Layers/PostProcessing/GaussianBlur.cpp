@@ -0,0 +1,135 @@
+#include "GaussianBlur.h"
+#include "Utils/ResourceManager/ResourceManager.h"
+#include "Utils/JsonGlmHelpers.h"
+#include "Utils/ImGuiHelper.h"
+#include "Application/Application.h"
+#include "Application/Layers/RenderLayer.h"
+
+#include <GLM/glm.hpp>
+
+GaussianBlur::GaussianBlur() :
+	PostProcessingLayer::Effect(),
+	Sigma(2.0f),
+	_shader(nullptr),
+	_computeShader(nullptr),
+	_intermediate(nullptr),
+	_radius(0),
+	_weights()
+{
+	Name = "Gaussian Blur";
+	// Both of our backends write to the same format, so that the compute shader only needs one image format
+	_format = RenderTargetType::ColorRgba16F;
+
+	_shader = ResourceManager::CreateAsset<ShaderProgram>(std::unordered_map<ShaderPartType, std::string>{
+		{ ShaderPartType::Vertex, "shaders/vertex_shaders/fullscreen_quad.glsl" },
+		{ ShaderPartType::Fragment, "shaders/fragment_shaders/post_effects/gaussian_blur.glsl" }
+	});
+	_computeShader = ResourceManager::CreateAsset<ShaderProgram>(std::unordered_map<ShaderPartType, std::string>{
+		{ ShaderPartType::Compute, "shaders/compute_shaders/post_effects/gaussian_blur.glsl" }
+	});
+}
+
+GaussianBlur::~GaussianBlur() = default;
+
+int GaussianBlur::CalculateWeights(float sigma, float weights[MAX_RADIUS + 1])
+{
+	sigma = glm::max(sigma, 0.01f);
+	int radius = glm::clamp((int)glm::ceil(sigma * 3.0f), 1, MAX_RADIUS);
+
+	// Calculate the weights for one side of the kernel, then normalize them so the whole kernel sums to 1
+	float sum = 0.0f;
+	for (int ix = 0; ix <= radius; ix++) {
+		weights[ix] = glm::exp(-(float)(ix * ix) / (2.0f * sigma * sigma));
+		sum += ix == 0 ? weights[ix] : weights[ix] * 2.0f;
+	}
+	for (int ix = 0; ix <= radius; ix++) {
+		weights[ix] /= sum;
+	}
+	return radius;
+}
+
+void GaussianBlur::BlurCompute(const ShaderProgram::Sptr& shader, const Framebuffer::Sptr& intermediate, const Framebuffer::Sptr& output, int radius, const float* weights)
+{
+	glm::uvec2 size = glm::uvec2(output->GetSize());
+
+	// Horizontal pass, the source image is already in slot 0
+	shader->Bind();
+	shader->SetUniform("u_Radius"_uh, radius);
+	shader->SetUniform("u_Weights"_uh, weights, MAX_RADIUS + 1);
+	shader->SetUniform("u_ImageSize"_uh, glm::ivec2(size));
+	BindImage(intermediate, 0);
+	DispatchCompute(size, glm::uvec2(128, 1));
+
+	// The vertical pass reads what the horizontal pass wrote
+	glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+
+	ShaderProgram* vertical = shader->GetVariant(shader->GetKeywordMask(std::vector<std::string>{ "VERTICAL" }));
+	vertical->Bind();
+	vertical->SetUniform("u_Radius"_uh, radius);
+	vertical->SetUniform("u_Weights"_uh, weights, MAX_RADIUS + 1);
+	vertical->SetUniform("u_ImageSize"_uh, glm::ivec2(size));
+	intermediate->BindAttachment(RenderTargetAttachment::Color0, 0);
+	BindImage(output, 0);
+	DispatchCompute(size, glm::uvec2(1, 128));
+}
+
+void GaussianBlur::_Prepare()
+{
+	_radius = CalculateWeights(Sigma, _weights);
+
+	const RenderTargetPool::Sptr& pool = Application::Get().GetLayer<RenderLayer>()->GetRenderTargetPool();
+	_intermediate = pool->Acquire(_output->GetWidth(), _output->GetHeight(), _format);
+}
+
+void GaussianBlur::Apply(const Framebuffer::Sptr& gBuffer)
+{
+	_Prepare();
+	glm::vec2 texelSize = glm::vec2(1.0f) / glm::vec2(_output->GetSize());
+
+	// Horizontal pass, the previous pass's image is already in slot 0
+	_intermediate->Bind();
+	_shader->Bind();
+	_shader->SetUniform("u_Radius"_uh, _radius);
+	_shader->SetUniform("u_Weights"_uh, _weights, MAX_RADIUS + 1);
+	_shader->SetUniform("u_Direction"_uh, glm::vec2(texelSize.x, 0.0f));
+	DrawFullscreen();
+
+	// Restore our output for the vertical pass, which the post processing layer will draw
+	_output->Bind();
+	_intermediate->BindAttachment(RenderTargetAttachment::Color0, 0);
+	_shader->SetUniform("u_Direction"_uh, glm::vec2(0.0f, texelSize.y));
+}
+
+void GaussianBlur::ApplyCompute(const Framebuffer::Sptr& gBuffer)
+{
+	_Prepare();
+	BlurCompute(_computeShader, _intermediate, _output, _radius, _weights);
+}
+
+void GaussianBlur::PostApply()
+{
+	const RenderTargetPool::Sptr& pool = Application::Get().GetLayer<RenderLayer>()->GetRenderTargetPool();
+	pool->Release(_intermediate);
+	_intermediate = nullptr;
+}
+
+void GaussianBlur::RenderImGui()
+{
+	LABEL_LEFT(ImGui::DragFloat, "Sigma", &Sigma, 0.05f, 0.1f, MAX_RADIUS / 3.0f);
+}
+
+GaussianBlur::Sptr GaussianBlur::FromJson(const nlohmann::json& data)
+{
+	GaussianBlur::Sptr result = std::make_shared<GaussianBlur>();
+	result->Enabled = JsonGet(data, "enabled", true);
+	result->Sigma   = JsonGet(data, "sigma", result->Sigma);
+	return result;
+}
+
+nlohmann::json GaussianBlur::ToJson() const
+{
+	return {
+		{ "enabled", Enabled },
+		{ "sigma", Sigma }
+	};
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include "Application/Layers/PostProcessingLayer.h"
+#include "Graphics/ShaderProgram.h"
+#include "Graphics/Framebuffer.h"
+
+/**
+ * A separable gaussian blur, done as a horizontal pass into an intermediate target followed by
+ * a vertical pass into the output. With the compute backend, each pass caches a run of pixels
+ * in shared memory so the image is only fetched once per pass
+ */
+class GaussianBlur : public PostProcessingLayer::Effect {
+public:
+	MAKE_PTRS(GaussianBlur);
+
+	// The maximum number of pixels on either side of the center that will be sampled
+	static const int MAX_RADIUS = 32;
+
+	// The standard deviation of the gaussian, in pixels. The radius is 3 sigma
+	float Sigma;
+
+	GaussianBlur();
+	virtual ~GaussianBlur();
+
+	virtual PostEffectBackend GetBackends() const override { return PostEffectBackend::Fragment | PostEffectBackend::Compute; }
+	virtual void Apply(const Framebuffer::Sptr& gBuffer) override;
+	virtual void ApplyCompute(const Framebuffer::Sptr& gBuffer) override;
+	virtual void PostApply() override;
+	virtual void RenderImGui() override;
+
+	/**
+	 * Calculates the weights for one side of a normalized gaussian kernel
+	 * @param sigma   The standard deviation of the gaussian, in pixels
+	 * @param weights Receives the weights, starting at the center tap
+	 * @returns The number of pixels on either side of the center that need to be sampled
+	 */
+	static int CalculateWeights(float sigma, float weights[MAX_RADIUS + 1]);
+	/**
+	 * Blurs the image in texture slot 0 with the compute shader, as a horizontal pass into the
+	 * intermediate target followed by a vertical pass into the output. Both targets must be RGBA16F
+	 * and the same size, the caller is responsible for the memory barrier after the vertical pass
+	 * @param shader       A program made from compute_shaders/post_effects/gaussian_blur.glsl
+	 * @param intermediate The target for the horizontal pass
+	 * @param output       The target for the vertical pass, this may be the source image
+	 * @param radius       The radius returned by CalculateWeights
+	 * @param weights      The weights from CalculateWeights
+	 */
+	static void BlurCompute(const ShaderProgram::Sptr& shader, const Framebuffer::Sptr& intermediate, const Framebuffer::Sptr& output, int radius, const float* weights);
+
+	// Inherited from IResource
+
+	GaussianBlur::Sptr FromJson(const nlohmann::json& data);
+	virtual nlohmann::json ToJson() const override;
+
+protected:
+	ShaderProgram::Sptr _shader;
+	ShaderProgram::Sptr _computeShader;
+
+	// Holds the result of the horizontal pass, borrowed from the target pool
+	Framebuffer::Sptr _intermediate;
+
+	int   _radius;
+	float _weights[MAX_RADIUS + 1];
+
+	/**
+	 * Updates the radius and weights from Sigma, and borrows the intermediate target
+	 */
+	void _Prepare();
+};
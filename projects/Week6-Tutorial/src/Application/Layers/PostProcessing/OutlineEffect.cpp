@@ -3,9 +3,12 @@
 #include "Utils/JsonGlmHelpers.h"
 #include "Utils/ImGuiHelper.h"
 
+#include <GLM/glm.hpp>
+
 OutlineEffect::OutlineEffect() :
 	PostProcessingLayer::Effect(),
 	_shader(nullptr),
+	_computeShader(nullptr),
 	_outlineColor(glm::vec4(0, 0, 0, 1)),
 	_scale(1.0f),
 	_depthThreshold(0.1f),
@@ -14,34 +17,50 @@ OutlineEffect::OutlineEffect() :
 	_depthNormalThresholdScale(4)
 {
 	Name = "Outline Effect";
-	_format = RenderTargetType::ColorRgb8;
+	// RGBA so that the compute backend can write to it with image stores
+	_format = RenderTargetType::ColorRgba8;
 
 	_shader = ResourceManager::CreateAsset<ShaderProgram>(std::unordered_map<ShaderPartType, std::string>{
 		{ ShaderPartType::Vertex, "shaders/vertex_shaders/fullscreen_quad.glsl" },
 		{ ShaderPartType::Fragment, "shaders/fragment_shaders/post_effects/outline.glsl" }
 	}); 
+	_computeShader = ResourceManager::CreateAsset<ShaderProgram>(std::unordered_map<ShaderPartType, std::string>{
+		{ ShaderPartType::Compute, "shaders/compute_shaders/post_effects/outline.glsl" }
+	});
 }
 
 OutlineEffect::~OutlineEffect() = default;
 
-void OutlineEffect::Apply(const Framebuffer::Sptr& gBuffer)
+void OutlineEffect::_SetUniforms(const ShaderProgram::Sptr& shader, const Framebuffer::Sptr& gBuffer)
 {
-	_shader->Bind();
-	_shader->SetUniform("u_OutlineColor", _outlineColor);
-	_shader->SetUniform("u_Scale", _scale);
-	_shader->SetUniform("u_DepthThreshold", _depthThreshold);
-	_shader->SetUniform("u_NormalThreshold", _normalThreshold);
-	_shader->SetUniform("u_DepthNormThreshold", _depthNormalThreshold);
-	_shader->SetUniform("u_DepthNormThresholdScale", _depthNormalThresholdScale);
-	_shader->SetUniform("u_PixelSize", glm::vec2(1.0f) / (glm::vec2)gBuffer->GetSize());
+	shader->Bind();
+	shader->SetUniform("u_OutlineColor"_uh, _outlineColor);
+	shader->SetUniform("u_Scale"_uh, glm::clamp(_scale, 0.0f, (float)MAX_SCALE));
+	shader->SetUniform("u_DepthThreshold"_uh, _depthThreshold);
+	shader->SetUniform("u_NormalThreshold"_uh, _normalThreshold);
+	shader->SetUniform("u_DepthNormThreshold"_uh, _depthNormalThreshold);
+	shader->SetUniform("u_DepthNormThresholdScale"_uh, _depthNormalThresholdScale);
 	gBuffer->BindAttachment(RenderTargetAttachment::Depth, 1);
 	gBuffer->BindAttachment(RenderTargetAttachment::Color1, 2); // The normal buffer
 }
 
+void OutlineEffect::Apply(const Framebuffer::Sptr& gBuffer)
+{
+	_SetUniforms(_shader, gBuffer);
+	_shader->SetUniform("u_PixelSize"_uh, glm::vec2(1.0f) / (glm::vec2)gBuffer->GetSize());
+}
+
+void OutlineEffect::ApplyCompute(const Framebuffer::Sptr& gBuffer)
+{
+	_SetUniforms(_computeShader, gBuffer);
+	BindImage(_output, 0);
+	DispatchCompute(glm::uvec2(_output->GetSize()), glm::uvec2(16));
+}
+
 void OutlineEffect::RenderImGui()
 {
 	LABEL_LEFT(ImGui::ColorEdit4,   "Color", &_outlineColor.x);
-	LABEL_LEFT(ImGui::SliderFloat,  "Scale", &_scale, 0.1f, 10.0f);
+	LABEL_LEFT(ImGui::SliderFloat,  "Scale", &_scale, 0.1f, (float)MAX_SCALE);
 	LABEL_LEFT(ImGui::SliderFloat,  "Depth Threshold", &_depthThreshold, 0.0f, 1.0f);
 	LABEL_LEFT(ImGui::SliderFloat, "Norm. Threshold", &_normalThreshold, 0.0f, 1.0f);
 	LABEL_LEFT(ImGui::SliderFloat, "Depth Norm. Threshold", &_depthNormalThreshold, 0.0f, 1.0f);
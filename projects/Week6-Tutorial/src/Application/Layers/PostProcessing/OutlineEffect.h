@@ -3,14 +3,23 @@
 #include "Graphics/ShaderProgram.h"
 #include "Graphics/Textures/Texture3D.h"
 
+/**
+ * Draws outlines where there are edges in the G-Buffer's depth or normals. With the compute
+ * backend, each work group caches the depth and normals for it's tile in shared memory
+ */
 class OutlineEffect : public PostProcessingLayer::Effect {
 public:
 	MAKE_PTRS(OutlineEffect);
 
+	// The largest outline scale, this limits how far the compute shader's tile apron extends
+	static const int MAX_SCALE = 10;
+
 	OutlineEffect();
 	virtual ~OutlineEffect();
 
+	virtual PostEffectBackend GetBackends() const override { return PostEffectBackend::Fragment | PostEffectBackend::Compute; }
 	virtual void Apply(const Framebuffer::Sptr& gBuffer) override;
+	virtual void ApplyCompute(const Framebuffer::Sptr& gBuffer) override;
 	virtual void RenderImGui() override;
 
 	// Inherited from IResource
@@ -20,6 +29,7 @@ public:
 
 protected:
 	ShaderProgram::Sptr _shader;
+	ShaderProgram::Sptr _computeShader;
 	glm::vec4           _outlineColor;
 	float               _scale;
 	float               _depthThreshold;
@@ -27,6 +37,10 @@ protected:
 	float               _depthNormalThreshold;
 	float               _depthNormalThresholdScale;
 
+	/**
+	 * Sets the uniforms that are shared by both backends, and binds the G-Buffer layers we need
+	 */
+	void _SetUniforms(const ShaderProgram::Sptr& shader, const Framebuffer::Sptr& gBuffer);
 };
 
 
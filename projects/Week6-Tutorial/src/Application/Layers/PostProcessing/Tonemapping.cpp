@@ -0,0 +1,39 @@
+#include "Tonemapping.h"
+#include "Utils/JsonGlmHelpers.h"
+#include "Utils/ImGuiHelper.h"
+
+Tonemapping::Tonemapping() :
+	PostProcessingLayer::Effect(),
+	Exposure(1.0f)
+{
+	Name = "Tonemapping";
+	_format = RenderTargetType::ColorRgb8;
+}
+
+Tonemapping::~Tonemapping() = default;
+
+void Tonemapping::ApplyFused(ShaderProgram* shader)
+{
+	shader->SetUniform("u_Exposure"_uh, Exposure);
+}
+
+void Tonemapping::RenderImGui()
+{
+	LABEL_LEFT(ImGui::DragFloat, "Exposure", &Exposure, 0.01f, 0.0f, 10.0f);
+}
+
+Tonemapping::Sptr Tonemapping::FromJson(const nlohmann::json& data)
+{
+	Tonemapping::Sptr result = std::make_shared<Tonemapping>();
+	result->Enabled  = JsonGet(data, "enabled", true);
+	result->Exposure = JsonGet(data, "exposure", result->Exposure);
+	return result;
+}
+
+nlohmann::json Tonemapping::ToJson() const
+{
+	return {
+		{ "enabled", Enabled },
+		{ "exposure", Exposure }
+	};
+}
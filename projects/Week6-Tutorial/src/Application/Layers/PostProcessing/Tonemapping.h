@@ -0,0 +1,27 @@
+#pragma once
+#include "Application/Layers/PostProcessingLayer.h"
+#include "Graphics/ShaderProgram.h"
+
+/**
+ * Maps the image through the ACES filmic curve after applying an exposure
+ */
+class Tonemapping : public PostProcessingLayer::Effect {
+public:
+	MAKE_PTRS(Tonemapping);
+
+	// Multiplier applied to the image before the curve
+	float Exposure;
+
+	Tonemapping();
+	virtual ~Tonemapping();
+
+	virtual const char* GetFusionKeyword() const override { return "TONEMAP"; }
+	virtual void ApplyFused(ShaderProgram* shader) override;
+	virtual void RenderImGui() override;
+
+	// Inherited from IResource
+
+	Tonemapping::Sptr FromJson(const nlohmann::json& data);
+	virtual nlohmann::json ToJson() const override;
+};
+
@@ -0,0 +1,54 @@
+#include "Vignette.h"
+#include "Utils/JsonGlmHelpers.h"
+#include "Utils/ImGuiHelper.h"
+
+Vignette::Vignette() :
+	PostProcessingLayer::Effect(),
+	Color(glm::vec3(0.0f)),
+	Intensity(0.75f),
+	Radius(0.75f),
+	Softness(0.45f)
+{
+	Name = "Vignette";
+	_format = RenderTargetType::ColorRgb8;
+}
+
+Vignette::~Vignette() = default;
+
+void Vignette::ApplyFused(ShaderProgram* shader)
+{
+	shader->SetUniform("u_VignetteColor"_uh, Color);
+	shader->SetUniform("u_VignetteIntensity"_uh, Intensity);
+	shader->SetUniform("u_VignetteRadius"_uh, Radius);
+	shader->SetUniform("u_VignetteSoftness"_uh, glm::max(Softness, 0.001f));
+}
+
+void Vignette::RenderImGui()
+{
+	LABEL_LEFT(ImGui::ColorEdit3, "Color    ", &Color.x);
+	LABEL_LEFT(ImGui::SliderFloat, "Intensity", &Intensity, 0.0f, 1.0f);
+	LABEL_LEFT(ImGui::DragFloat, "Radius   ", &Radius, 0.01f, 0.0f, 2.0f);
+	LABEL_LEFT(ImGui::DragFloat, "Softness ", &Softness, 0.01f, 0.001f, 2.0f);
+}
+
+Vignette::Sptr Vignette::FromJson(const nlohmann::json& data)
+{
+	Vignette::Sptr result = std::make_shared<Vignette>();
+	result->Enabled   = JsonGet(data, "enabled", true);
+	result->Color     = JsonGet(data, "color", result->Color);
+	result->Intensity = JsonGet(data, "intensity", result->Intensity);
+	result->Radius    = JsonGet(data, "radius", result->Radius);
+	result->Softness  = JsonGet(data, "softness", result->Softness);
+	return result;
+}
+
+nlohmann::json Vignette::ToJson() const
+{
+	return {
+		{ "enabled", Enabled },
+		{ "color", Color },
+		{ "intensity", Intensity },
+		{ "radius", Radius },
+		{ "softness", Softness }
+	};
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include "Application/Layers/PostProcessingLayer.h"
+#include "Graphics/ShaderProgram.h"
+
+/**
+ * Darkens (or tints) the edges of the screen
+ */
+class Vignette : public PostProcessingLayer::Effect {
+public:
+	MAKE_PTRS(Vignette);
+
+	// The color that the edges of the screen fade to
+	glm::vec3 Color;
+	// How much of the vignette color is blended in at the edges, 0-1
+	float Intensity;
+	// The distance from the center of the screen that the vignette ends at, in screen heights
+	float Radius;
+	// The width of the fade between the image and the vignette color
+	float Softness;
+
+	Vignette();
+	virtual ~Vignette();
+
+	virtual const char* GetFusionKeyword() const override { return "VIGNETTE"; }
+	virtual void ApplyFused(ShaderProgram* shader) override;
+	virtual void RenderImGui() override;
+
+	// Inherited from IResource
+
+	Vignette::Sptr FromJson(const nlohmann::json& data);
+	virtual nlohmann::json ToJson() const override;
+};
+
@@ -7,10 +7,22 @@
 #include "PostProcessing/BoxFilter3x3.h"
 #include "PostProcessing/BoxFilter5x5.h"
 #include "PostProcessing/OutlineEffect.h"
+#include "PostProcessing/GaussianBlur.h"
 #include "PostProcessing/Bloom.h"
+#include "PostProcessing/DepthOfField.h"
+#include "PostProcessing/Tonemapping.h"
+#include "PostProcessing/Vignette.h"
+
+#include "Utils/ResourceManager/ResourceManager.h"
 
 PostProcessingLayer::PostProcessingLayer() :
-	ApplicationLayer()
+	ApplicationLayer(),
+	_effects(),
+	_quadVAO(nullptr),
+	_fusedShader(nullptr),
+	_fusedRun(),
+	_fusedMask(0),
+	_computeSupported(false)
 {
 	Name = "Post Processing";
 	Overrides =
@@ -28,24 +40,33 @@ void PostProcessingLayer::AddEffect(const Effect::Sptr& effect) {
 
 void PostProcessingLayer::OnAppLoad(const nlohmann::json& config)
 {
-	// Loads some effects in
-	_effects.push_back(std::make_shared<ColorCorrectionEffect>());
-	_effects.push_back(std::make_shared<Bloom>());
+	// Compute shaders are core as of 4.3
+	_computeSupported = GLAD_GL_VERSION_4_3 != 0;
+	if (!_computeSupported) {
+		LOG_WARN("Compute shaders are not supported, post effects will use the fragment backend");
+	}
 
-	//GetEffect<OutlineEffect>()->Enabled = false;
+	// Loads some effects in, everything after the filters is point-wise so they will be drawn in a single pass
+	_effects.push_back(std::make_shared<OutlineEffect>());
+	_effects.push_back(std::make_shared<DepthOfField>());
+	_effects.push_back(std::make_shared<GaussianBlur>());
+	_effects.push_back(std::make_shared<BoxFilter3x3>());
+	_effects.push_back(std::make_shared<BoxFilter5x5>());
+	_effects.push_back(std::make_shared<Bloom>());
+	_effects.push_back(std::make_shared<Tonemapping>());
+	_effects.push_back(std::make_shared<ColorCorrectionEffect>());
+	_effects.push_back(std::make_shared<Vignette>());
 
-	Application& app = Application::Get();
-	const glm::uvec4& viewport = app.GetPrimaryViewport();
+	GetEffect<OutlineEffect>()->Enabled = false;
+	GetEffect<DepthOfField>()->Enabled = false;
+	GetEffect<GaussianBlur>()->Enabled = false;
+	GetEffect<BoxFilter3x3>()->Enabled = false;
+	GetEffect<BoxFilter5x5>()->Enabled = false;
+	GetEffect<Tonemapping>()->Enabled = false;
+	GetEffect<Vignette>()->Enabled = false;
 
-	// Initialize all the effect's output FBOs (inefficient) 
-	for (const auto& effect : _effects) {
-		FramebufferDescriptor fboDesc = FramebufferDescriptor();
-		fboDesc.Width  = viewport.z * effect->_outputScale.x;
-		fboDesc.Height = viewport.w * effect->_outputScale.y;
-		fboDesc.RenderTargets[RenderTargetAttachment::Color0] = RenderTargetDescriptor(effect->_format);
-
-		effect->_output = std::make_shared<Framebuffer>(fboDesc);
-	}
+	// Note that effects no longer own their outputs, they borrow them from the
+	// render layer's target pool while rendering
 
 	// We need a mesh for drawing fullscreen quads
 	glm::vec2 positions[6] = {
@@ -60,6 +81,13 @@ void PostProcessingLayer::OnAppLoad(const nlohmann::json& config)
 	_quadVAO->AddVertexBuffer(vbo, {
 		BufferAttribute(0, 2, AttributeType::Float, sizeof(glm::vec2), 0, AttribUsage::Position)
 	});
+
+	// Point-wise effects are toggled in this shader via keywords, so only the effects that are enabled get compiled in
+	_fusedShader = ResourceManager::CreateAsset<ShaderProgram>(std::unordered_map<ShaderPartType, std::string>{
+		{ ShaderPartType::Vertex, "shaders/vertex_shaders/fullscreen_quad.glsl" },
+		{ ShaderPartType::Fragment, "shaders/fragment_shaders/post_effects/fused_pointwise.glsl" }
+	});
+	_fusedShader->SetDebugName("Fused Post Effects");
 }
 
 void PostProcessingLayer::OnPostRender()
@@ -71,6 +99,7 @@ void PostProcessingLayer::OnPostRender()
 	const RenderLayer::Sptr& renderer = app.GetLayer<RenderLayer>();
 	const Framebuffer::Sptr& output = renderer->GetRenderOutput();
 	const Framebuffer::Sptr& gBuffer = renderer->GetGBuffer();
+	const RenderTargetPool::Sptr& pool = renderer->GetRenderTargetPool();
 
 	// Stores the input FBO to the effect, we start with the renderlayer's output 
 	Framebuffer::Sptr current = output;
@@ -87,38 +116,30 @@ void PostProcessingLayer::OnPostRender()
 	for (const auto& effect : _effects) {
 		// Only render if it's enabled
 		if (effect->Enabled) {
-			// Bind the FBO and make sure we're rendering to the whole thing
-			effect->_output->Bind();
-			glViewport(0, 0, effect->_output->GetWidth(), effect->_output->GetHeight());
-
-			// Bind color 0 from previous pass to texture slot 0 so our effects can access
-			current->BindAttachment(RenderTargetAttachment::Color0, 0);
-
-			// Apply the effect and render the fullscreen quad
-			effect->Apply(gBuffer);
-			_quadVAO->Draw();
-
-			// Unbind output and set it as input for next pass
-			effect->_output->Unbind();
-			current = effect->_output;
+			uint32_t fusionBit = (EnableFusion || _fusedRun.empty()) ? _GetFusionBit(effect) : 0;
+
+			// The fused shader applies effects in keyword order, so if this effect can't be appended
+			// to the pending run, we need to draw the run before we continue
+			if (!_fusedRun.empty() && fusionBit <= _fusedMask) {
+				_ApplyFused(gBuffer, output, current);
+				fusionBit = _GetFusionBit(effect);
+			}
+
+			if (fusionBit != 0) {
+				_fusedRun.push_back(effect.get());
+				_fusedMask |= fusionBit;
+			} else {
+				_ApplyEffect(effect, gBuffer, output, current);
+			}
 		}
 	}
+	if (!_fusedRun.empty()) {
+		_ApplyFused(gBuffer, output, current);
+	}
 	_quadVAO->Unbind();
 
-	// Restore viewport to game viewport
-	glViewport(viewport.x, viewport.y, viewport.z, viewport.w);
-
-	// Bind the output of our post processing as the source for the blit
-	current->Bind(FramebufferBinding::Read);
-	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
-
-	// Blit the color buffer to our game window
-	current->Blit(
-		{ 0, 0, current->GetWidth(), current->GetHeight() },
-		{ viewport.x, viewport.y, viewport.x + viewport.z, viewport.y + viewport.w },
-		BufferFlags::Color,
-		MagFilter::Linear
-	);
+	// Scale the output of our post processing up to the game window, this also restores the game viewport
+	renderer->Present(current);
 
 	gBuffer->Bind(FramebufferBinding::Read);
 	current->Blit(
@@ -129,6 +150,11 @@ void PostProcessingLayer::OnPostRender()
 	);
 
 	gBuffer->Unbind();
+
+	// Return the final effect's output to the pool
+	if (current != output) {
+		pool->Release(current);
+	}
 }
 
 void PostProcessingLayer::OnSceneLoad()
@@ -147,12 +173,140 @@ void PostProcessingLayer::OnSceneUnload()
 
 void PostProcessingLayer::OnWindowResize(const glm::ivec2& oldSize, const glm::ivec2& newSize)
 {
+	// Outputs come from the render target pool, which will create targets of the new size as needed
 	for (const auto& effect : _effects) {
 		effect->OnWindowResize(oldSize, newSize);
-		effect->_output->Resize(newSize.x, newSize.y);
 	}
 }
 
+uint32_t PostProcessingLayer::_GetFusionBit(const Effect::Sptr& effect) const
+{
+	const char* keyword = effect->GetFusionKeyword();
+	// Fused effects all share one target, so they need to be rendering at full resolution
+	if (keyword == nullptr || _fusedShader == nullptr || effect->_outputScale != glm::vec2(1.0f)) {
+		return 0;
+	}
+	return _fusedShader->GetKeywordMask(std::vector<std::string>{ keyword });
+}
+
+PostEffectBackend PostProcessingLayer::_SelectBackend(const Effect* effect) const
+{
+	PostEffectBackend backends = effect->GetBackends();
+
+	// Image stores need a format that can be used with image load/store, which excludes the 3 channel formats.
+	// Fused effects only use compute for their own intermediate passes, so their output format doesn't matter
+	bool imageFormat = effect->GetFusionKeyword() != nullptr ||
+		effect->_format == RenderTargetType::ColorRgba8 || effect->_format == RenderTargetType::ColorRgba16F;
+	if (*(backends & PostEffectBackend::Compute) && _computeSupported && imageFormat) {
+		if (EnableCompute || !*(backends & PostEffectBackend::Fragment)) {
+			return PostEffectBackend::Compute;
+		}
+	}
+	if (*(backends & PostEffectBackend::Fragment)) {
+		return PostEffectBackend::Fragment;
+	}
+
+	LOG_ASSERT(false, "Post effect \"{}\" has no backend that can be used on this device", effect->Name);
+	return PostEffectBackend::None;
+}
+
+void PostProcessingLayer::_ApplyEffect(const Effect::Sptr& effect, const Framebuffer::Sptr& gBuffer, const Framebuffer::Sptr& input, Framebuffer::Sptr& current)
+{
+	const RenderLayer::Sptr& renderer = Application::Get().GetLayer<RenderLayer>();
+	const RenderTargetPool::Sptr& pool = renderer->GetRenderTargetPool();
+
+	PostEffectBackend backend = _SelectBackend(effect.get());
+	if (backend == PostEffectBackend::None) {
+		return;
+	}
+
+	// Borrow a target for the effect's output, this will re-use the memory from an earlier effect if possible
+	// Effects run at the render size, we only scale up to the window once the whole stack is done
+	glm::uvec2 size = glm::max(glm::uvec2(glm::vec2(renderer->GetRenderSize()) * effect->_outputScale), glm::uvec2(1));
+	effect->_output = pool->Acquire(size.x, size.y, effect->_format);
+	effect->_backend = backend;
+
+	if (backend == PostEffectBackend::Compute) {
+		// Bind color 0 from previous pass to texture slot 0 so our effects can access
+		current->BindAttachment(RenderTargetAttachment::Color0, 0);
+
+		effect->ApplyCompute(gBuffer);
+		effect->PostApply();
+
+		// Make sure our image stores are visible to whatever samples or blits the output next
+		glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_FRAMEBUFFER_BARRIER_BIT);
+	} else {
+		// Bind the FBO and make sure we're rendering to the whole thing
+		effect->_output->Bind();
+		glViewport(0, 0, effect->_output->GetWidth(), effect->_output->GetHeight());
+
+		// Bind color 0 from previous pass to texture slot 0 so our effects can access
+		current->BindAttachment(RenderTargetAttachment::Color0, 0);
+
+		// Apply the effect and render the fullscreen quad
+		effect->Apply(gBuffer);
+		_quadVAO->Draw();
+		effect->PostApply();
+
+		// Unbind output and set it as input for next pass
+		effect->_output->Unbind();
+	}
+
+	// The previous pass's output has been consumed, so we can hand it back to the pool
+	if (current != input) {
+		pool->Release(current);
+	}
+	current = effect->_output;
+	effect->_output = nullptr;
+	effect->_backend = PostEffectBackend::None;
+}
+
+void PostProcessingLayer::_ApplyFused(const Framebuffer::Sptr& gBuffer, const Framebuffer::Sptr& input, Framebuffer::Sptr& current)
+{
+	const RenderLayer::Sptr& renderer = Application::Get().GetLayer<RenderLayer>();
+	const RenderTargetPool::Sptr& pool = renderer->GetRenderTargetPool();
+
+	// All the effects in the run share one output, we use the format of the last one since it's the one that
+	// the rest of the stack would have seen
+	glm::uvec2 size = glm::max(glm::uvec2(renderer->GetRenderSize()), glm::uvec2(1));
+	Framebuffer::Sptr target = pool->Acquire(size.x, size.y, _fusedRun.back()->_format);
+
+	// Let the effects render any passes they need before the fused pass, these may change the bound target
+	current->BindAttachment(RenderTargetAttachment::Color0, 0);
+	for (Effect* effect : _fusedRun) {
+		effect->_output = target;
+		effect->_backend = _SelectBackend(effect);
+		effect->PrepareFused(gBuffer);
+	}
+
+	target->Bind();
+	glViewport(0, 0, target->GetWidth(), target->GetHeight());
+	current->BindAttachment(RenderTargetAttachment::Color0, 0);
+
+	// Select the variant with only the enabled effects compiled in, and let each effect set up it's inputs
+	ShaderProgram* shader = _fusedShader->GetVariant(_fusedMask);
+	shader->Bind();
+	for (Effect* effect : _fusedRun) {
+		effect->ApplyFused(shader);
+	}
+	_quadVAO->Draw();
+
+	for (Effect* effect : _fusedRun) {
+		effect->PostApply();
+		effect->_output = nullptr;
+		effect->_backend = PostEffectBackend::None;
+	}
+	target->Unbind();
+
+	if (current != input) {
+		pool->Release(current);
+	}
+	current = target;
+
+	_fusedRun.clear();
+	_fusedMask = 0;
+}
+
 const std::vector<PostProcessingLayer::Effect::Sptr>& PostProcessingLayer::GetEffects() const
 {
 	return _effects;
@@ -162,3 +316,16 @@ void PostProcessingLayer::Effect::DrawFullscreen()
 {
 	glDrawArrays(GL_TRIANGLES, 0, 6);
 }
+
+void PostProcessingLayer::Effect::BindImage(const Framebuffer::Sptr& target, int unit, GLenum access)
+{
+	Texture2D::Sptr texture = target->GetTextureAttachment(RenderTargetAttachment::Color0);
+	LOG_ASSERT(texture != nullptr, "Framebuffer does not have a Color0 texture to bind as an image");
+	glBindImageTexture(unit, texture->GetHandle(), 0, GL_FALSE, 0, access, *texture->GetFormat());
+}
+
+void PostProcessingLayer::Effect::DispatchCompute(const glm::uvec2& size, const glm::uvec2& groupSize)
+{
+	glm::uvec2 groups = (size + groupSize - 1u) / groupSize;
+	glDispatchCompute(groups.x, groups.y, 1);
+}
@@ -3,6 +3,16 @@
 #include "Application/ApplicationLayer.h"
 #include "Utils/Macros.h"
 #include "Graphics/VertexArrayObject.h"
+#include "Graphics/ShaderProgram.h"
+
+/**
+ * The ways that a post processing effect can be rendered
+ */
+ENUM_FLAGS(PostEffectBackend, uint32_t,
+	None     = 0,
+	Fragment = 1 << 0, // The effect is drawn as a fullscreen quad into it's output
+	Compute  = 1 << 1  // The effect writes to it's output using compute shaders and image stores
+)
 
 /**
  * The post processing layer will handle rendering effects after the primary
@@ -29,10 +39,53 @@ public:
 
 		/**
 		 * Overload this in derived classes to apply the effect. Texture slot 0
-		 * will contain the image from the previous pass
+		 * will contain the image from the previous pass. Point-wise effects do not
+		 * need to implement this, see GetFusionKeyword
+		 * @param gBuffer The G-Buffer from the deferred rendering pipeline
+		 */
+		virtual void Apply(const Framebuffer::Sptr& gBuffer) {}
+		/**
+		 * Invoked after the effect's fullscreen quad has been drawn, effects should
+		 * release any transient targets they borrowed during Apply here
+		 */
+		virtual void PostApply() {}
+
+		/**
+		 * Effects that only read the pixel they are writing to (ex: color grading) can
+		 * be fused with their neighbours into a single pass. These effects should return
+		 * their keyword in the fused shader (post_effects/fused_pointwise.glsl), and
+		 * implement ApplyFused instead of Apply
+		 * @returns The effect's keyword, or nullptr if the effect needs it's own pass
+		 */
+		virtual const char* GetFusionKeyword() const { return nullptr; }
+		/**
+		 * Invoked before the fused pass is drawn, allowing the effect to render any
+		 * intermediate passes it needs (ex: the bloom chain). Texture slot 0 will contain
+		 * the image from the previous pass, and the effect may change the bound framebuffer
+		 * and texture slots. Fused effects that support the compute backend may use it for
+		 * these passes when it has been selected (see _backend)
+		 * @param gBuffer The G-Buffer from the deferred rendering pipeline
+		 */
+		virtual void PrepareFused(const Framebuffer::Sptr& gBuffer) {}
+		/**
+		 * Overload this in fusable effects to bind the effect's textures and set it's
+		 * uniforms on the fused shader. The shader is already bound
+		 * @param shader The variant of the fused shader being drawn
+		 */
+		virtual void ApplyFused(ShaderProgram* shader) {}
+		/**
+		 * Gets the backends that this effect can be rendered with. Effects that support the compute
+		 * backend will use it when available, otherwise the fragment backend is used as a fallback
+		 */
+		virtual PostEffectBackend GetBackends() const { return PostEffectBackend::Fragment; }
+		/**
+		 * Overload this in effects that support the compute backend. Texture slot 0 will contain
+		 * the image from the previous pass, and the effect must write every pixel of it's output
+		 * (see BindImage). The layer will insert a memory barrier once the effect is done
 		 * @param gBuffer The G-Buffer from the deferred rendering pipeline
 		 */
-		virtual void Apply(const Framebuffer::Sptr& gBuffer) = 0;
+		virtual void ApplyCompute(const Framebuffer::Sptr& gBuffer) {}
+
 		/**
 		 * Allows this effect to perform logic when a new scene is loaded
 		 */
@@ -43,7 +96,8 @@ public:
 		virtual void OnSceneUnload() {}
 		/**
 		 * Allows this effect to perform additional logic when the window is resized
-		 * Note that the output framebuffer will already be resized by the post processing layer
+		 * Note that output framebuffers are borrowed from a pool each frame, so they will
+		 * already match the new size
 		 */
 		virtual void OnWindowResize(const glm::ivec2& oldSize, const glm::ivec2& newSize) {}
 		/**
@@ -58,19 +112,49 @@ public:
 		 */
 		void DrawFullscreen();
 
+		/**
+		 * Binds the Color0 attachment of a framebuffer as an image, so that compute shaders can
+		 * access it with image load/store
+		 * @param target The framebuffer to bind the color attachment of
+		 * @param unit   The image unit to bind to
+		 * @param access The access the shader needs (GL_READ_ONLY, GL_WRITE_ONLY or GL_READ_WRITE)
+		 */
+		static void BindImage(const Framebuffer::Sptr& target, int unit, GLenum access = GL_WRITE_ONLY);
+		/**
+		 * Dispatches enough work groups of the given size to cover an image, the bound compute
+		 * shader should discard any invocations that fall outside of the image
+		 * @param size      The size of the image in pixels
+		 * @param groupSize The local size of the compute shader
+		 */
+		static void DispatchCompute(const glm::uvec2& size, const glm::uvec2& groupSize);
+
 	protected:
 		friend class PostProcessingLayer;
 
-		// The output that this effect will render into
+		// The output that this effect will render into, only valid during Apply. This
+		// is a transient target from the RenderLayer's target pool
 		Framebuffer::Sptr _output = nullptr;
 		// The scaling between this effect's output and the screen size, default 1
 		glm::vec2 _outputScale = glm::vec2(1);
 		// The render target format for the effect's buffer
 		RenderTargetType _format = RenderTargetType::ColorRgba8;
+		// The backend that the layer selected for this effect, only valid while the effect is rendering
+		PostEffectBackend _backend = PostEffectBackend::None;
 		
 		Effect() = default;
 	};
 
+	/**
+	 * True if consecutive point-wise effects should be fused into a single pass,
+	 * false to render each effect in it's own pass (useful for debugging)
+	 */
+	bool EnableFusion = true;
+	/**
+	 * True if effects that support compute shaders should use them, false to force
+	 * all effects to use the fragment backend
+	 */
+	bool EnableCompute = true;
+
 	PostProcessingLayer();
 	virtual ~PostProcessingLayer();
 
@@ -112,4 +196,32 @@ protected:
 
 	std::vector<Effect::Sptr> _effects;
 	VertexArrayObject::Sptr _quadVAO;
+
+	// Shader that all point-wise effects are fused into, effects are toggled via keywords
+	ShaderProgram::Sptr _fusedShader;
+	// The point-wise effects that are waiting to be drawn in a fused pass
+	std::vector<Effect*> _fusedRun;
+	// The keywords for the effects in _fusedRun
+	uint32_t _fusedMask;
+	// True if the context supports compute shaders (GL 4.3)
+	bool _computeSupported;
+
+	/**
+	 * Determines which backend an effect should be rendered with, or None if it can't be rendered
+	 */
+	PostEffectBackend _SelectBackend(const Effect* effect) const;
+
+	/**
+	 * Gets the keyword bit for the effect in the fused shader, or 0 if the effect
+	 * cannot be fused
+	 */
+	uint32_t _GetFusionBit(const Effect::Sptr& effect) const;
+	/**
+	 * Applies a single effect into a new target, and replaces current with the result
+	 */
+	void _ApplyEffect(const Effect::Sptr& effect, const Framebuffer::Sptr& gBuffer, const Framebuffer::Sptr& input, Framebuffer::Sptr& current);
+	/**
+	 * Draws all the effects in _fusedRun in a single pass, and replaces current with the result
+	 */
+	void _ApplyFused(const Framebuffer::Sptr& gBuffer, const Framebuffer::Sptr& input, Framebuffer::Sptr& current);
 };
\ No newline at end of file
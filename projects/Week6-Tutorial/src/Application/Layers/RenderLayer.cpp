@@ -4,10 +4,14 @@
 #include "Gameplay/Components/Camera.h"
 #include "Graphics/DebugDraw.h"
 #include "Graphics/Textures/TextureCube.h"
+#include "Graphics/AsyncReadback.h"
 #include "../Timing.h"
 #include "Gameplay/Components/ComponentManager.h"
 #include "Gameplay/Components/RenderComponent.h"
 #include "Gameplay/Components/Light.h"
+#include "Utils/JsonGlmHelpers.h"
+
+#include <cfloat>
 
 // GLM math library
 #include <GLM/glm.hpp>
@@ -25,7 +29,20 @@ RenderLayer::RenderLayer() :
 	_frameUniforms(nullptr),
 	_instanceUniforms(nullptr),
 	_renderFlags(RenderFlags::None),
-	_clearColor({ 0.1f, 0.1f, 0.1f, 1.0f })
+	_clearColor({ 0.1f, 0.1f, 0.1f, 1.0f }),
+	_dynamicResolution(std::make_shared<DynamicResolution>()),
+	_gpuTimer(nullptr),
+	_outputSize(0),
+	_targetGranularity(64),
+	_targetShrinkDelay(120),
+	_lodPixelError(1.0f),
+	_lodHysteresis(0.15f),
+	_lodFadeTime(0.25f),
+	_temporalAA(std::make_shared<TemporalAntiAliasing>()),
+	_viewProjection(1.0f),
+	_prevViewProjection(1.0f),
+	_jitter(0.0f),
+	_frameIndex(0)
 {
 	Name = "Rendering";
 	Overrides = 
@@ -42,22 +59,55 @@ void RenderLayer::OnPreRender()
 
 	Application& app = Application::Get();
 
+	// Let the pool clean up any targets that have gone stale
+	_targetPool->NextFrame();
+
+	// Hand any GPU readbacks that have finished off to their callbacks
+	AsyncReadback::Poll();
+
+	// If nothing presented the last frame, make sure it's timing doesn't run into this one
+	_gpuTimer->End();
+
+	// Feed the latest GPU timings to the dynamic resolution controller, this will resize
+	// our targets if the scale changed (or the controller was turned on or off)
+	float gpuTime = 0.0f;
+	if (_gpuTimer->Poll(gpuTime)) {
+		_dynamicResolution->Update(gpuTime);
+	}
+	// Give the G-Buffer a chance to give back memory it hasn't needed for a while
+	_primaryFBO->NextFrame();
+	_ResizeTargets();
+
+	// Time everything up until the scene is presented, see Present
+	_gpuTimer->Begin();
+
 	// Clear the color and depth buffers
-	const glm::vec4 colors[4] = {
+	const glm::vec4 colors[5] = {
 		glm::vec4(0.0f),
 		glm::vec4(0.5f, 0.5f, 0.5f, 0.0f),
 		glm::vec4(0.0f),
+		glm::vec4(0.0f),
 		glm::vec4(0.0f)
 	};
 
 	_primaryFBO->Bind();
 	// Clear the framebuffer. Note that this also binds and sets the viewport
-	_ClearFramebuffer(_primaryFBO, colors, 4);
+	_ClearFramebuffer(_primaryFBO, colors, 5);
 
 	
 	// Grab shorthands to the camera and shader from the scene
 	Camera::Sptr camera = app.CurrentScene()->MainCamera;
 
+	// Jitter the projection for TAA, this needs to happen before anything grabs the camera's matrices for this frame
+	_frameIndex++;
+	glm::vec2 jitter = _temporalAA->Enabled ? _temporalAA->NextJitter(_primaryFBO->GetSize(), _outputSize) : glm::vec2(0.0f);
+	_jitter = glm::vec4(jitter, glm::vec2(_jitter));
+	camera->SetJitter(jitter);
+
+	// Motion vectors are measured with the un-jittered matrices, so that only actual motion shows up in them
+	_prevViewProjection = _frameIndex == 1 ? camera->GetUnjitteredProjection() * camera->GetView() : _viewProjection;
+	_viewProjection = camera->GetUnjitteredProjection() * camera->GetView();
+
 	// Cache the camera's viewprojection
 	glm::mat4 viewProj = camera->GetViewProjection();
 	DebugDrawer::Get().SetViewProjection(viewProj);
@@ -173,6 +223,8 @@ void RenderLayer::_AccumulateLighting()
 		{ ambient, 1.0f },         // diffuse (multiplicative)
 		{ 0.0f, 0.0f, 0.0f, 1.0f } // specular (additive)
 	};
+	// The lighting buffer is only needed until we've composited, so we borrow it from the pool
+	_AcquireLightingBuffer();
 	_lightingFBO->Bind();
 	_ClearFramebuffer(_lightingFBO, colors, 2);
 
@@ -278,21 +330,21 @@ void RenderLayer::_AccumulateLighting()
 			shadowCam->GetProjectionMask()->Bind(6);
 		}
 
-		//_shadowShader->SetUniformMatrix("u_ClipToShadow", clipToShadow); 
-		_shadowShader->SetUniformMatrix("u_ViewToShadow", viewToShadow); 
+		//_shadowShader->SetUniformMatrix("u_ClipToShadow"_uh, clipToShadow); 
+		_shadowShader->SetUniformMatrix("u_ViewToShadow"_uh, viewToShadow); 
 
 		// Get color and normalize it (strip the alpha)
 		glm::vec4 color = shadowCam->GetColor();
 		color *= color.w;
 
-		_shadowShader->SetUniform("u_LightDirViewspace", lightDirViewSpace);
-		_shadowShader->SetUniform("u_ShadowBias", shadowCam->Bias);
-		_shadowShader->SetUniform("u_NormalBias", shadowCam->NormalBias);
-		_shadowShader->SetUniform("u_Attenuation", 1/shadowCam->Range);
-		_shadowShader->SetUniform("u_Intensity", shadowCam->Intensity);
-		_shadowShader->SetUniform("u_LightColor", (glm::vec3)color);
-		_shadowShader->SetUniform("u_LightPosViewspace", lightPosViewSpace);
-		_shadowShader->SetUniform("u_ShadowFlags", *shadowCam->Flags);
+		_shadowShader->SetUniform("u_LightDirViewspace"_uh, lightDirViewSpace);
+		_shadowShader->SetUniform("u_ShadowBias"_uh, shadowCam->Bias);
+		_shadowShader->SetUniform("u_NormalBias"_uh, shadowCam->NormalBias);
+		_shadowShader->SetUniform("u_Attenuation"_uh, 1/shadowCam->Range);
+		_shadowShader->SetUniform("u_Intensity"_uh, shadowCam->Intensity);
+		_shadowShader->SetUniform("u_LightColor"_uh, (glm::vec3)color);
+		_shadowShader->SetUniform("u_LightPosViewspace"_uh, lightPosViewSpace);
+		_shadowShader->SetUniform("u_ShadowFlags"_uh, *shadowCam->Flags);
 
 		// Draw the fullscreen quad to accumulate the lights
 		_fullscreenQuad->Draw();
@@ -347,6 +399,20 @@ void RenderLayer::_Composite()
 	scene->DrawSkybox();
 
 	_outputBuffer->Unbind();
+
+	// We're done with the lighting buffer, other passes can use the memory now. We keep our
+	// reference so that the debug windows can still preview it
+	_targetPool->Release(_lightingFBO);
+}
+
+void RenderLayer::_AcquireLightingBuffer() {
+	FramebufferDescriptor fboDescriptor;
+	fboDescriptor.Width  = _primaryFBO->GetWidth();
+	fboDescriptor.Height = _primaryFBO->GetHeight();
+	fboDescriptor.RenderTargets[RenderTargetAttachment::Color0] = RenderTargetDescriptor(RenderTargetType::ColorRgba8); // Diffuse
+	fboDescriptor.RenderTargets[RenderTargetAttachment::Color1] = RenderTargetDescriptor(RenderTargetType::ColorRgba8); // Specular
+
+	_lightingFBO = _targetPool->Acquire(fboDescriptor);
 }
 
 void RenderLayer::_ClearFramebuffer(Framebuffer::Sptr& buffer, const glm::vec4* colors, int layers) {
@@ -366,7 +432,7 @@ void RenderLayer::_ClearFramebuffer(Framebuffer::Sptr& buffer, const glm::vec4*
 
 	// Bind our clear shader, and draw a fullscreen quad with all the clear colors
 	_clearShader->Bind();
-	_clearShader->SetUniform<glm::vec4>("ClearColors", colors, layers);
+	_clearShader->SetUniform<glm::vec4>("ClearColors"_uh, colors, layers);
 	_fullscreenQuad->Draw();
 
 	// Reset depth test function to default
@@ -377,10 +443,9 @@ void RenderLayer::OnWindowResize(const glm::ivec2& oldSize, const glm::ivec2& ne
 {
 	if (newSize.x * newSize.y == 0) return;
 
-	// Set viewport and resize our primary FBO and light accumulation FBO
-	_primaryFBO->Resize(newSize);
-	_lightingFBO->Resize(newSize);
-	_outputBuffer->Resize(newSize);
+	// Resize our primary FBO and output to the new render size, the lighting buffer comes from the pool
+	_outputSize = newSize;
+	_ResizeTargets();
 
 	// Update the main camera's projection
 	Application& app = Application::Get();
@@ -396,10 +461,32 @@ void RenderLayer::OnAppLoad(const nlohmann::json& config)
 	glEnable(GL_CULL_FACE);
 	glCullFace(GL_BACK);
 
-	// Create a new descriptor for our FBO
+	// Load our dynamic resolution settings, the scene will be rendered at a scale of the window size
+	if (config.contains(Name) && config[Name].contains("dynamic_resolution")) {
+		_dynamicResolution->FromJson(config[Name]["dynamic_resolution"]);
+	}
+	if (config.contains(Name) && config[Name].contains("temporal_aa")) {
+		_temporalAA->FromJson(config[Name]["temporal_aa"]);
+	}
+	if (config.contains(Name)) {
+		_targetGranularity = JsonGet(config[Name], "target_granularity", _targetGranularity);
+		_targetShrinkDelay = JsonGet(config[Name], "target_shrink_delay", _targetShrinkDelay);
+		_lodPixelError     = JsonGet(config[Name], "lod_pixel_error", _lodPixelError);
+		_lodHysteresis     = JsonGet(config[Name], "lod_hysteresis", _lodHysteresis);
+		_lodFadeTime       = JsonGet(config[Name], "lod_fade_time", _lodFadeTime);
+	}
+	_outputSize = app.GetWindowSize();
+	glm::ivec2 renderSize = _dynamicResolution->GetRenderSize(_outputSize);
+
+	_gpuTimer = std::make_shared<GpuTimer>();
+
+	// Create a new descriptor for our FBO. We allocate with some headroom, so that resizing the
+	// window or changing the dynamic resolution usually just shrinks or grows the viewport
 	FramebufferDescriptor fboDescriptor;
-	fboDescriptor.Width = app.GetWindowSize().x;
-	fboDescriptor.Height = app.GetWindowSize().y;
+	fboDescriptor.Width = renderSize.x;
+	fboDescriptor.Height = renderSize.y;
+	fboDescriptor.Granularity = _targetGranularity;
+	fboDescriptor.ShrinkDelay = _targetShrinkDelay;
 
 	// We want to use a 32 bit depth buffer, we'll ignore the stencil buffer for now
 	fboDescriptor.RenderTargets[RenderTargetAttachment::Depth] = RenderTargetDescriptor(RenderTargetType::Depth32);
@@ -411,15 +498,18 @@ void RenderLayer::OnAppLoad(const nlohmann::json& config)
 	fboDescriptor.RenderTargets[RenderTargetAttachment::Color2] = RenderTargetDescriptor(RenderTargetType::ColorRgba8);
 	// Color layer 3 (view space position)  
 	fboDescriptor.RenderTargets[RenderTargetAttachment::Color3] = RenderTargetDescriptor(RenderTargetType::ColorRgba16F);
+	// Color layer 4 (motion vectors, in UV units)
+	fboDescriptor.RenderTargets[RenderTargetAttachment::Color4] = RenderTargetDescriptor(RenderTargetType::ColorRG16F);
 	 
 	// Create the primary FBO
 	_primaryFBO = std::make_shared<Framebuffer>(fboDescriptor);
 
-	fboDescriptor.RenderTargets.clear();
-	fboDescriptor.RenderTargets[RenderTargetAttachment::Color0] = RenderTargetDescriptor(RenderTargetType::ColorRgba8); // Diffuse
-	fboDescriptor.RenderTargets[RenderTargetAttachment::Color1] = RenderTargetDescriptor(RenderTargetType::ColorRgba8); // Specular
-
-	_lightingFBO = std::make_shared<Framebuffer>(fboDescriptor);
+	// Intermediate targets are borrowed from the pool each frame. We grab the lighting buffer once
+	// up front so that it's never null for anything that wants to preview it
+	_targetPool = std::make_shared<RenderTargetPool>();
+	_targetPool->SetRenderSize(_primaryFBO->GetSize(), _primaryFBO->GetCapacity());
+	_AcquireLightingBuffer();
+	_targetPool->Release(_lightingFBO);
 
 	// Create an FBO to store final output
 	fboDescriptor.RenderTargets.clear();
@@ -427,6 +517,7 @@ void RenderLayer::OnAppLoad(const nlohmann::json& config)
 	fboDescriptor.RenderTargets[RenderTargetAttachment::Color0] = RenderTargetDescriptor(RenderTargetType::ColorRgba8);
 
 	_outputBuffer = std::make_shared<Framebuffer>(fboDescriptor);
+	_outputBuffer->Resize(_primaryFBO->GetSize(), _primaryFBO->GetCapacity());
 
 	// We'll use one shader for light accumulation for now
 	_lightAccumulationShader = ShaderProgram::Create();
@@ -449,6 +540,11 @@ void RenderLayer::OnAppLoad(const nlohmann::json& config)
 	_shadowShader->LoadShaderPartFromFile("shaders/fragment_shaders/shadow_composite.glsl", ShaderPartType::Fragment);
 	_shadowShader->Link();
 
+	_upscaleShader = ShaderProgram::Create();
+	_upscaleShader->LoadShaderPartFromFile("shaders/vertex_shaders/fullscreen_quad.glsl", ShaderPartType::Vertex);
+	_upscaleShader->LoadShaderPartFromFile("shaders/fragment_shaders/upscale.glsl", ShaderPartType::Fragment);
+	_upscaleShader->Link();
+
 	// We need a mesh for drawing fullscreen quads
 
 	glm::vec2 positions[6] = {
@@ -496,6 +592,8 @@ void RenderLayer::SetClearColor(const glm::vec4 & value) {
 
 void RenderLayer::SetRenderFlags(RenderFlags value) {
 	_renderFlags = value;
+	// Shaders select their color correction variant from this, instead of checking the frame flags per fragment
+	ShaderProgram::SetGlobalKeyword("ENABLE_COLOR_CORRECTION", *(value & RenderFlags::EnableColorCorrection));
 }
 
 RenderFlags RenderLayer::GetRenderFlags() const {
@@ -506,11 +604,111 @@ const Framebuffer::Sptr& RenderLayer::GetLightingBuffer() const {
 	return _lightingFBO;
 }
 
+const RenderTargetPool::Sptr& RenderLayer::GetRenderTargetPool() const {
+	return _targetPool;
+}
+
 const Framebuffer::Sptr& RenderLayer::GetGBuffer() const
 {
 	return _primaryFBO;
 }
 
+const DynamicResolution::Sptr& RenderLayer::GetDynamicResolution() const {
+	return _dynamicResolution;
+}
+
+const TemporalAntiAliasing::Sptr& RenderLayer::GetTemporalAntiAliasing() const {
+	return _temporalAA;
+}
+
+glm::ivec2 RenderLayer::GetRenderSize() const {
+	return _primaryFBO->GetSize();
+}
+
+glm::ivec2 RenderLayer::GetRenderCapacity() const {
+	return _primaryFBO->GetCapacity();
+}
+
+void RenderLayer::Present(const Framebuffer::Sptr& source)
+{
+	Application& app = Application::Get();
+	const glm::uvec4& viewport = app.GetPrimaryViewport();
+
+	// Resolve TAA, when upsampling this will already be at the size of the viewport
+	Framebuffer::Sptr image = source;
+	if (_temporalAA->Enabled) {
+		glm::mat4 clipToPrevClip = _prevViewProjection * glm::inverse(_viewProjection);
+		image = _temporalAA->Resolve(source, _primaryFBO, glm::ivec2(viewport.z, viewport.w), clipToPrevClip, _fullscreenQuad);
+	} else {
+		// Whatever is in the history will be stale by the time TAA is turned back on
+		_temporalAA->Invalidate();
+	}
+
+	// Gameplay and editor code expect the camera's matrices without the jitter
+	app.CurrentScene()->MainCamera->SetJitter(glm::vec2(0.0f));
+
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+	glViewport(viewport.x, viewport.y, viewport.z, viewport.w);
+
+	if (image->GetSize() == glm::ivec2(viewport.z, viewport.w)) {
+		// Nothing to scale, so we can skip the filtering and just copy the image over
+		image->Bind(FramebufferBinding::Read);
+		Framebuffer::Blit(
+			{ 0, 0, image->GetWidth(), image->GetHeight() },
+			{ viewport.x, viewport.y, viewport.x + viewport.z, viewport.y + viewport.w },
+			BufferFlags::Color,
+			MagFilter::Nearest
+		);
+		image->Unbind();
+	} else {
+		glDisable(GL_DEPTH_TEST);
+		glDisable(GL_BLEND);
+
+		bool sharpen = _dynamicResolution->Filter == UpscaleFilter::Sharpen;
+		ShaderProgram* shader = _upscaleShader->GetVariant(sharpen ? _upscaleShader->GetKeywordMask(std::vector<std::string>{ "SHARPEN" }) : 0);
+		shader->Bind();
+		if (sharpen) {
+			shader->SetUniform("u_Sharpness"_uh, _dynamicResolution->Sharpness);
+		}
+
+		// The image is either a render size target, or the TAA history which has it's own capacity
+		shader->SetUniform("u_ImageUvScale"_uh, image->GetUvScale());
+		image->BindAttachment(RenderTargetAttachment::Color0, 0);
+		_fullscreenQuad->Draw();
+	}
+
+	// Everything after this point is drawn at the window's resolution, so it doesn't count towards our budget
+	_gpuTimer->End();
+}
+
+void RenderLayer::_ResizeTargets()
+{
+	if (_outputSize.x * _outputSize.y == 0) {
+		return;
+	}
+
+	// The G-Buffer decides how much memory we hold onto, everything else at the render size follows it's
+	// capacity so that the UV scale in the frame uniforms works for all of them. None of these will
+	// re-create their attachments unless the capacity changes
+	glm::ivec2 size = _dynamicResolution->GetRenderSize(_outputSize);
+	_primaryFBO->Resize(size);
+	_outputBuffer->Resize(size, _primaryFBO->GetCapacity());
+	_targetPool->SetRenderSize(size, _primaryFBO->GetCapacity());
+}
+
+nlohmann::json RenderLayer::GetDefaultConfig()
+{
+	return {
+		{ "dynamic_resolution", _dynamicResolution->ToJson() },
+		{ "temporal_aa", _temporalAA->ToJson() },
+		{ "target_granularity", _targetGranularity },
+		{ "target_shrink_delay", _targetShrinkDelay },
+		{ "lod_pixel_error", _lodPixelError },
+		{ "lod_hysteresis", _lodHysteresis },
+		{ "lod_fade_time", _lodFadeTime }
+	};
+}
+
 void RenderLayer::_InitFrameUniforms()
 {
 	using namespace Gameplay;
@@ -537,6 +735,9 @@ void RenderLayer::_InitFrameUniforms()
 	frameData.u_ZNear = camera->GetNearPlane();
 	frameData.u_ZFar = camera->GetFarPlane();
 	frameData.u_Viewport = { 0.0f, 0.0f, _primaryFBO->GetWidth(), _primaryFBO->GetHeight() };
+	frameData.u_PrevViewProjection = _prevViewProjection;
+	frameData.u_Jitter = _jitter;
+	frameData.u_UvScale = _primaryFBO->GetUvScale();
 
 	frameData.u_Aperture   = camera->Aperture;
 	frameData.u_LensDepth  = camera->LensDepth;
@@ -554,7 +755,6 @@ void RenderLayer::_RenderScene(const glm::mat4& view, const glm::mat4& projectio
 
 	// The current material that is bound for rendering
 	Material::Sptr currentMat = nullptr;
-	ShaderProgram::Sptr shader = nullptr;
 
 	Material::Sptr defaultMat = app.CurrentScene()->DefaultMaterial;
 
@@ -566,6 +766,11 @@ void RenderLayer::_RenderScene(const glm::mat4& view, const glm::mat4& projectio
 	frameData.u_Viewport = { 0.0f, 0.0f, screenSize.x, screenSize.y };
 	_frameUniforms->Update();
 
+	// How far along their cross-fades objects that are changing LODs get this frame. Never 0, since that means not fading to the shaders
+	float lodFadeStep = _lodFadeTime > 0.0f ? glm::max(Timing::Current().DeltaTime() / _lodFadeTime, 1e-3f) : 1.0f;
+	// Orthographic projections don't shrink things with distance
+	bool perspective = projection[2][3] != 0.0f;
+
 	// Render all our objects
 	app.CurrentScene()->Components().Each<RenderComponent>([&](const RenderComponent::Sptr& renderable) {
 		// Early bail if mesh not set
@@ -588,9 +793,8 @@ void RenderLayer::_RenderScene(const glm::mat4& view, const glm::mat4& projectio
 		// Note: This is a good reason why we should be sorting the render components in ComponentManager
 		if (renderable->GetMaterial() != currentMat) {
 			currentMat = renderable->GetMaterial();
-			shader = currentMat->GetShader();
 
-			shader->Bind();
+			// Applying the material will bind the shader variant that matches the material's keywords
 			currentMat->Apply();
 		}
 
@@ -603,10 +807,36 @@ void RenderLayer::_RenderScene(const glm::mat4& view, const glm::mat4& projectio
 		instanceData.u_ModelViewProjection = viewProj * object->GetTransform();
 		instanceData.u_ModelView = view * object->GetTransform();
 		instanceData.u_NormalMatrix = glm::mat3(glm::transpose(glm::inverse(object->GetTransform())));
+		instanceData.u_PrevModelViewProjection = _prevViewProjection * renderable->SwapPreviousTransform(object->GetTransform(), _frameIndex);
+
+		// Pick the level of detail from how big the mesh's bounding sphere is on screen
+		const MeshResource::Sptr& mesh = renderable->GetMeshResource();
+		if (mesh->GetLodCount() > 1) {
+			const glm::mat4& transform = object->GetTransform();
+			glm::vec3 center = transform * glm::vec4(glm::vec3(mesh->BoundingSphere), 1.0f);
+			float scale = glm::max(glm::length(glm::vec3(transform[0])), glm::max(glm::length(glm::vec3(transform[1])), glm::length(glm::vec3(transform[2]))));
+			float radius = mesh->BoundingSphere.w * scale;
+
+			// The clip space w is the distance along the view direction, and we always want full detail if we're inside the sphere
+			float distance = perspective ? (viewProj * glm::vec4(center, 1.0f)).w : 1.0f;
+			float pixelRadius = (perspective && distance <= radius) ? FLT_MAX : radius * projection[1][1] * 0.5f * screenSize.y / distance;
+			renderable->UpdateLod(mesh->SelectLod(pixelRadius, renderable->GetLod(), _lodPixelError, _lodHysteresis), lodFadeStep);
+		}
+
+		// While cross-fading, both levels are drawn with complementary dither patterns (see fragments/lod_fade.glsl)
+		uint32_t lod = renderable->GetLod();
+		bool fading = renderable->GetLodFade() < 1.0f && renderable->GetPreviousLod() != lod;
+		instanceData.u_LodFade = fading ? renderable->GetLodFade() : 0.0f;
 		_instanceUniforms->Update();
 
 		// Draw the object
-		renderable->GetMesh()->Draw();
+		mesh->GetLod(lod)->Draw();
+
+		if (fading) {
+			instanceData.u_LodFade = -renderable->GetLodFade();
+			_instanceUniforms->Update();
+			mesh->GetLod(renderable->GetPreviousLod())->Draw();
+		}
 
 	});
 
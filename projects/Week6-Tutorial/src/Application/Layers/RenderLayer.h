@@ -1,6 +1,10 @@
 #pragma once
 #include "../ApplicationLayer.h"
 #include "Graphics/Framebuffer.h"
+#include "Graphics/RenderTargetPool.h"
+#include "Graphics/DynamicResolution.h"
+#include "Graphics/GpuTimer.h"
+#include "Graphics/TemporalAntiAliasing.h"
 #include "Graphics/Buffers/UniformBuffer.h"
 #include "Graphics/ShaderProgram.h"
 #include "Graphics/VertexArrayObject.h"
@@ -50,6 +54,12 @@ public:
 
 		glm::vec4 u_Viewport;
 
+		// The un-jittered view projection from the previous frame
+		glm::mat4 u_PrevViewProjection;
+		// The projection jitter for this frame (xy) and the previous frame (zw), in NDC
+		glm::vec4 u_Jitter;
+		// Takes UVs over the rendered image to UVs in render size targets, see Framebuffer::GetUvScale
+		glm::vec4 u_UvScale;
 
 	};
 
@@ -65,6 +75,13 @@ public:
 		glm::mat4 u_ModelView;
 		// Normal Matrix for transforming normals
 		glm::mat4 u_NormalMatrix;
+		// The un-jittered MVP from the previous frame, for motion vectors
+		glm::mat4 u_PrevModelViewProjection;
+		// The progress of a cross-fade between levels of detail, positive for the incoming level,
+		// negative for the outgoing level, and 0 when the object isn't fading
+		float     u_LodFade;
+		// Pads us out to the size of a vec4, which std140 rounds the block up to
+		float     _padding[3];
 	};
 
 	/// <summary>
@@ -110,12 +127,48 @@ public:
 	void SetRenderFlags(RenderFlags value);
 	RenderFlags GetRenderFlags() const;
 
+	/// <summary>
+	/// Gets the light accumulation buffer from the most recent frame. This is a transient
+	/// target from the render target pool, so it should only be read for debugging
+	/// </summary>
 	const Framebuffer::Sptr& GetLightingBuffer() const;
 	const Framebuffer::Sptr& GetRenderOutput() const;
 	const Framebuffer::Sptr& GetGBuffer() const;
 
 	const UniformBuffer<FrameLevelUniforms>::Sptr& GetFrameUniforms() const;
 
+	/// <summary>
+	/// Gets the pool of transient render targets that intermediate passes (including
+	/// post processing) can borrow framebuffers from
+	/// </summary>
+	const RenderTargetPool::Sptr& GetRenderTargetPool() const;
+
+	/// <summary>
+	/// Gets the controller that picks the resolution the scene is rendered at
+	/// </summary>
+	const DynamicResolution::Sptr& GetDynamicResolution() const;
+	/// <summary>
+	/// Gets the temporal anti-aliasing settings, TAA is resolved when the scene is presented
+	/// </summary>
+	const TemporalAntiAliasing::Sptr& GetTemporalAntiAliasing() const;
+	/// <summary>
+	/// Gets the size that the scene is currently being rendered at. The G-Buffer, lighting
+	/// and post processing targets are all this size, which may be smaller than the window
+	/// </summary>
+	glm::ivec2 GetRenderSize() const;
+	/// <summary>
+	/// Gets the size that render size targets are allocated at. This is rounded up from the render size
+	/// so that most changes to the render size only move the viewport, see Framebuffer::Resize
+	/// </summary>
+	glm::ivec2 GetRenderCapacity() const;
+	/// <summary>
+	/// Draws the final image of the scene into the game viewport of the window, scaling it up
+	/// from the render size if needed. This marks the end of the scene's GPU work for the frame,
+	/// anything drawn afterwards (ex: GUI) is at native resolution and is not timed
+	/// </summary>
+	/// <param name="source">The framebuffer to present, it's Color0 attachment will be used</param>
+	void Present(const Framebuffer::Sptr& source);
+
 	// Inherited from ApplicationLayer
 
 	virtual void OnAppLoad(const nlohmann::json& config) override;
@@ -123,16 +176,20 @@ public:
 	virtual void OnRender(const Framebuffer::Sptr& prevLayer) override;
 	virtual void OnPostRender() override;
 	virtual void OnWindowResize(const glm::ivec2& oldSize, const glm::ivec2& newSize) override;
+	virtual nlohmann::json GetDefaultConfig() override;
 
 protected:
 	Framebuffer::Sptr   _primaryFBO;
 	Framebuffer::Sptr   _lightingFBO;
 	Framebuffer::Sptr   _outputBuffer;
 
+	RenderTargetPool::Sptr _targetPool;
+
 	ShaderProgram::Sptr _clearShader;
 	ShaderProgram::Sptr _lightAccumulationShader;
 	ShaderProgram::Sptr _compositingShader;
 	ShaderProgram::Sptr _shadowShader;
+	ShaderProgram::Sptr _upscaleShader;
 
 	VertexArrayObject::Sptr _fullscreenQuad;
 
@@ -140,6 +197,32 @@ protected:
 	glm::vec4         _clearColor;
 	RenderFlags       _renderFlags;
 
+	DynamicResolution::Sptr _dynamicResolution;
+	// Measures the GPU time from the start of the frame until the scene is presented
+	GpuTimer::Sptr          _gpuTimer;
+	// The size of the window, which the render size is scaled from
+	glm::ivec2              _outputSize;
+	// Render size targets are allocated in multiples of this many pixels, and shrink once they have
+	// been larger than needed for this many frames
+	uint32_t                _targetGranularity;
+	uint32_t                _targetShrinkDelay;
+
+	// Objects use the least detailed LOD whose error covers less than this many pixels. To stop them from
+	// flickering at the thresholds, the error has to move this fraction past the threshold to change levels
+	float                   _lodPixelError;
+	float                   _lodHysteresis;
+	// The time in seconds that objects take to cross-fade between levels, 0 to switch instantly
+	float                   _lodFadeTime;
+
+	TemporalAntiAliasing::Sptr _temporalAA;
+	// The camera's un-jittered view projection for this frame and the last, for motion vectors
+	glm::mat4                  _viewProjection;
+	glm::mat4                  _prevViewProjection;
+	// The jitter for this frame (xy) and the last (zw)
+	glm::vec4                  _jitter;
+	// Incremented every frame, so render components can tell if they were drawn in the previous frame
+	uint64_t                   _frameIndex;
+
 	const int FRAME_UBO_BINDING = 0;
 	UniformBuffer<FrameLevelUniforms>::Sptr _frameUniforms;
 
@@ -155,4 +238,6 @@ protected:
 	void _AccumulateLighting();
 	void _Composite();
 	void _ClearFramebuffer(Framebuffer::Sptr& buffer, const glm::vec4* colors, int layers);
+	void _AcquireLightingBuffer();
+	void _ResizeTargets();
 };
\ No newline at end of file
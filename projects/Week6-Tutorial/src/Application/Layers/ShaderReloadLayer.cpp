@@ -0,0 +1,92 @@
+#include "ShaderReloadLayer.h"
+#include <unordered_set>
+#include "../Timing.h"
+#include "Graphics/ShaderProgram.h"
+#include "Utils/FileHelpers.h"
+#include "Utils/JsonGlmHelpers.h"
+
+ShaderReloadLayer::ShaderReloadLayer() :
+	ApplicationLayer(),
+	_pollInterval(0.5f),
+	_timeSinceLastPoll(0.0f),
+	_watchedFiles()
+{
+	Name = "Shader Reload";
+	Overrides = AppLayerFunctions::OnAppLoad | AppLayerFunctions::OnUpdate;
+}
+
+ShaderReloadLayer::~ShaderReloadLayer() = default;
+
+void ShaderReloadLayer::OnAppLoad(const nlohmann::json& config)
+{
+	if (config.contains(Name)) {
+		_pollInterval = JsonGet(config[Name], "poll_interval", _pollInterval);
+	}
+}
+
+void ShaderReloadLayer::OnUpdate()
+{
+	// We use unscaled time so that we still reload when the game is paused
+	_timeSinceLastPoll += Timing::Current().UnscaledDeltaTime();
+	if (_timeSinceLastPoll >= _pollInterval) {
+		_timeSinceLastPoll = 0.0f;
+		CheckForChanges();
+	}
+}
+
+nlohmann::json ShaderReloadLayer::GetDefaultConfig()
+{
+	return {
+		{ "poll_interval", _pollInterval }
+	};
+}
+
+int ShaderReloadLayer::CheckForChanges()
+{
+	_UpdateWatchedFiles();
+
+	// Figure out which files have been touched since we last looked
+	std::unordered_set<std::string> changedFiles;
+	for (auto& [path, lastWriteTime] : _watchedFiles) {
+		std::filesystem::file_time_type writeTime = FileHelpers::GetLastWriteTime(path);
+		if (writeTime != lastWriteTime) {
+			lastWriteTime = writeTime;
+			changedFiles.insert(path);
+			LOG_INFO("Detected change in \"{}\"", path);
+		}
+	}
+
+	if (changedFiles.empty()) {
+		return 0;
+	}
+
+	// Only rebuild the programs that actually depend on the changed files
+	int numReloaded = 0;
+	ShaderProgram::Each([&](ShaderProgram& program) {
+		for (const std::string& path : changedFiles) {
+			if (program.DependsOn(path)) {
+				numReloaded += program.Reload() ? 1 : 0;
+				break;
+			}
+		}
+	});
+
+	LOG_INFO("Reloaded {} shader program(s)", numReloaded);
+	return numReloaded;
+}
+
+void ShaderReloadLayer::_UpdateWatchedFiles()
+{
+	// Programs come and go, and reloading can add or remove includes, so we rebuild the list each time
+	std::unordered_map<std::string, std::filesystem::file_time_type> watched;
+	ShaderProgram::Each([&](ShaderProgram& program) {
+		for (const std::string& path : program.GetDependencies()) {
+			if (watched.find(path) != watched.end()) {
+				continue;
+			}
+			auto it = _watchedFiles.find(path);
+			watched[path] = it != _watchedFiles.end() ? it->second : FileHelpers::GetLastWriteTime(path);
+		}
+	});
+	_watchedFiles = std::move(watched);
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <unordered_map>
+#include <filesystem>
+#include "../ApplicationLayer.h"
+
+/**
+ * The shader reload layer watches all the files that our shader programs were built from
+ * (including #included fragments), and hot-reloads only the programs that depend on a file
+ * when it changes on disk. If a program fails to compile, the previous version is kept
+ */
+class ShaderReloadLayer final : public ApplicationLayer {
+public:
+	MAKE_PTRS(ShaderReloadLayer)
+
+	ShaderReloadLayer();
+	virtual ~ShaderReloadLayer();
+
+	/**
+	 * Immediately checks all watched files for changes, and reloads any affected programs
+	 * 
+	 * @returns The number of programs that were successfully rebuilt
+	 */
+	int CheckForChanges();
+
+	// Inherited from ApplicationLayer
+
+	virtual void OnAppLoad(const nlohmann::json& config) override;
+	virtual void OnUpdate() override;
+	virtual nlohmann::json GetDefaultConfig() override;
+
+protected:
+	// How often to check our files, in seconds
+	float _pollInterval;
+	float _timeSinceLastPoll;
+
+	// Maps normalized file paths to the last write time that we've seen for that file
+	std::unordered_map<std::string, std::filesystem::file_time_type> _watchedFiles;
+
+	/**
+	 * Rebuilds our list of watched files from the programs that are currently alive,
+	 * keeping the last seen write times for files that we already knew about
+	 */
+	void _UpdateWatchedFiles();
+};
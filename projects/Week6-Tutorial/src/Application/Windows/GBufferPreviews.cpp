@@ -28,6 +28,7 @@ void GBufferPreviews::Render()
 	Texture2D::Sptr& normals = framebuffer->GetTextureAttachment(RenderTargetAttachment::Color1);
 	Texture2D::Sptr& emissive = framebuffer->GetTextureAttachment(RenderTargetAttachment::Color2);
 	Texture2D::Sptr& viewspace = framebuffer->GetTextureAttachment(RenderTargetAttachment::Color3);
+	Texture2D::Sptr& motion = framebuffer->GetTextureAttachment(RenderTargetAttachment::Color4);
 
 	Texture2D::Sptr& diffuse = lightBuffer->GetTextureAttachment(RenderTargetAttachment::Color0);
 	Texture2D::Sptr& specular = lightBuffer->GetTextureAttachment(RenderTargetAttachment::Color1);
@@ -37,6 +38,9 @@ void GBufferPreviews::Render()
 	int height = width / aspect;
 	ImVec2 size = ImVec2(width, height);
 
+	// Only part of each target has been rendered to, the lighting buffer shares the G-Buffer's capacity
+	glm::vec2 uvScale = glm::vec2(framebuffer->GetUvScale());
+
 	ImGui::Columns(2);
 	ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, ImVec2(0, 0));
 	ImGui::BeginChildFrame(ImGui::GetID(depth.get()), ImVec2(size.x, size.y + ImGui::GetTextLineHeight() + 10));
@@ -46,28 +50,31 @@ void GBufferPreviews::Render()
 	ImGui::PopStyleVar();
 	ImGui::NextColumn();
 
-	_RenderTexture2D(color, size, "color");
+	_RenderTexture2D(color, size, "color", uvScale);
 	ImGui::NextColumn();
 
-	_RenderTexture2D(normals, size, "normals");
+	_RenderTexture2D(normals, size, "normals", uvScale);
 	ImGui::NextColumn();
 
-	_RenderTexture2D(emissive, size, "emissive"); 
+	_RenderTexture2D(emissive, size, "emissive", uvScale); 
 	ImGui::NextColumn();  
 
-	_RenderTexture2D(viewspace, size, "position (viewspace)");
+	_RenderTexture2D(viewspace, size, "position (viewspace)", uvScale);
+	ImGui::NextColumn();
+
+	_RenderTexture2D(motion, size, "motion vectors", uvScale);
 	ImGui::NextColumn();
 
-	_RenderTexture2D(diffuse, size, "Diffuse Lighting");
+	_RenderTexture2D(diffuse, size, "Diffuse Lighting", uvScale);
 	ImGui::NextColumn();
 
-	_RenderTexture2D(specular, size, "Specular Lighting");
+	_RenderTexture2D(specular, size, "Specular Lighting", uvScale);
 	ImGui::NextColumn(); 
 
 	ImGui::Columns(1);
 }
 
-void GBufferPreviews::_RenderTexture2D(const Texture2D::Sptr & value, const ImVec2& size, const char* name) {
+void GBufferPreviews::_RenderTexture2D(const Texture2D::Sptr & value, const ImVec2& size, const char* name, const glm::vec2& uvScale) {
 	ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, ImVec2(0, 0));
 	ImGui::BeginChildFrame(ImGui::GetID(value.get()), ImVec2(size.x, size.y + ImGui::GetTextLineHeight() + 10));
 	ImDrawList* drawList = ImGui::GetWindowDrawList();
@@ -75,7 +82,8 @@ void GBufferPreviews::_RenderTexture2D(const Texture2D::Sptr & value, const ImVe
 	drawList->AddCallback([](const ImDrawList* parent_list, const ImDrawCmd* cmd) {
 		glDisable(GL_BLEND);
 	}, nullptr);
-	ImGui::Image((ImTextureID)value->GetHandle(), size, ImVec2(0, 1), ImVec2(1, 0));
+	value->MakeResident();
+	ImGui::Image((ImTextureID)value->GetHandle(), size, ImVec2(0, uvScale.y), ImVec2(uvScale.x, 0));
 	drawList->AddCallback([](const ImDrawList* parent_list, const ImDrawCmd* cmd) {
 		glEnable(GL_BLEND);
 	}, nullptr);
@@ -20,5 +20,5 @@ public:
 	virtual void Render() override; 
 
 protected:
-	void _RenderTexture2D(const Texture2D::Sptr& value, const ImVec2& size, const char* name);
+	void _RenderTexture2D(const Texture2D::Sptr& value, const ImVec2& size, const char* name, const glm::vec2& uvScale = glm::vec2(1.0f));
 };
\ No newline at end of file
@@ -0,0 +1,122 @@
+#include "GpuMemoryWindow.h"
+#include <algorithm>
+
+#include "Graphics/GpuMemory.h"
+#include "Graphics/Textures/Texture2D.h"
+#include "Gameplay/MeshResource.h"
+#include "Utils/ResourceManager/ResourceManager.h"
+
+/// <summary>
+/// Converts a number of bytes to megabytes for display
+/// </summary>
+inline float __ToMegabytes(uint64_t bytes) {
+	return bytes / (1024.0f * 1024.0f);
+}
+
+GpuMemoryWindow::GpuMemoryWindow()
+	: IEditorWindow()
+{
+	Name = "GPU Memory";
+	SplitDirection = ImGuiDir_::ImGuiDir_None;
+	Requirements = EditorWindowRequirements::Window;
+	Open = false;
+}
+
+GpuMemoryWindow::~GpuMemoryWindow() = default;
+
+void GpuMemoryWindow::Render()
+{
+	uint64_t total  = GpuMemory::GetTotalUsage();
+	uint64_t budget = GpuMemory::GetBudget();
+
+	// Budget, 0 turns it off
+	int budgetMb = static_cast<int>(budget / (1024 * 1024));
+	if (ImGui::DragInt("Budget (MB)", &budgetMb, 16.0f, 0, 65536)) {
+		GpuMemory::SetBudget(static_cast<uint64_t>(std::max(budgetMb, 0)) * 1024ull * 1024ull);
+	}
+	int age = static_cast<int>(GpuMemory::GetEvictionAge());
+	if (ImGui::DragInt("Eviction Age (frames)", &age, 1.0f, 1, 10000)) {
+		GpuMemory::SetEvictionAge(static_cast<uint32_t>(std::max(age, 1)));
+	}
+
+	char overlay[64];
+	if (budget > 0) {
+		snprintf(overlay, sizeof(overlay), "%.1f / %.1f MB", __ToMegabytes(total), __ToMegabytes(budget));
+		ImGui::ProgressBar(std::min((float)total / (float)budget, 1.0f), ImVec2(-1.0f, 0.0f), overlay);
+	} else {
+		ImGui::Text("Using %.1f MB (no budget)", __ToMegabytes(total));
+	}
+
+	ImGui::Separator();
+
+	// Usage per category
+	ImGui::Columns(3);
+	ImGui::Text("Category"); ImGui::NextColumn();
+	ImGui::Text("Objects");  ImGui::NextColumn();
+	ImGui::Text("MB");       ImGui::NextColumn();
+	ImGui::Separator();
+	for (uint8_t ix = 0; ix < GpuMemory::CATEGORY_COUNT; ix++) {
+		GpuMemoryCategory category = (GpuMemoryCategory)ix;
+		ImGui::Text("%s", (~category).c_str()); ImGui::NextColumn();
+		ImGui::Text("%u", GpuMemory::GetObjectCount(category)); ImGui::NextColumn();
+		ImGui::Text("%.2f", __ToMegabytes(GpuMemory::GetUsage(category))); ImGui::NextColumn();
+	}
+	ImGui::Columns(1);
+
+	ImGui::Separator();
+
+	ImGui::Text("Evictable: %u (%u evicted)", GpuMemory::GetEvictableCount(), GpuMemory::GetEvictedCount());
+	ImGui::Text("Evictions: %llu, Reloads: %llu", (unsigned long long)GpuMemory::GetTotalEvictions(), (unsigned long long)GpuMemory::GetTotalReloads());
+	// The draw data for this frame may still reference the textures, so the eviction waits for the next frame
+	if (ImGui::Button("Evict Unused")) {
+		GpuMemory::RequestEvictAll();
+	}
+
+	if (ImGui::CollapsingHeader("Resources")) {
+		_RenderResources();
+	}
+}
+
+void GpuMemoryWindow::_RenderResources()
+{
+	struct Row {
+		std::string Name;
+		uint64_t    Size;
+		uint64_t    LastUsed;
+		bool        Evicted;
+	};
+
+	// Gather up all our evictable resources, and show the biggest ones first
+	std::vector<Row> rows;
+	ResourceManager::Each<Texture2D>([&](const Texture2D::Sptr& texture) {
+		if (!texture->GetDescription().Filename.empty()) {
+			rows.push_back({ texture->GetDescription().Filename, texture->GetEvictableSize(), texture->GetLastUsedFrame(), texture->IsEvicted() });
+		}
+	});
+	ResourceManager::Each<Gameplay::MeshResource>([&](const Gameplay::MeshResource::Sptr& mesh) {
+		if (!mesh->Filename.empty()) {
+			rows.push_back({ mesh->Filename, mesh->GetEvictableSize(), mesh->GetLastUsedFrame(), mesh->IsEvicted() });
+		}
+	});
+	std::sort(rows.begin(), rows.end(), [](const Row& a, const Row& b) {
+		return a.Size > b.Size;
+	});
+
+	uint64_t frame = GpuMemory::GetFrameIndex();
+	ImGui::Columns(3);
+	ImGui::Text("Resource");  ImGui::NextColumn();
+	ImGui::Text("MB");        ImGui::NextColumn();
+	ImGui::Text("Last Used"); ImGui::NextColumn();
+	ImGui::Separator();
+	for (const Row& row : rows) {
+		ImGui::TextUnformatted(row.Name.c_str()); ImGui::NextColumn();
+		if (row.Evicted) {
+			ImGui::TextDisabled("evicted");
+		} else {
+			ImGui::Text("%.2f", __ToMegabytes(row.Size));
+		}
+		ImGui::NextColumn();
+		ImGui::Text("%llu frames ago", (unsigned long long)(frame - std::min(frame, row.LastUsed))); ImGui::NextColumn();
+	}
+	ImGui::Columns(1);
+}
@@ -0,0 +1,20 @@
+#pragma once
+#include "../IEditorWindow.h"
+
+/**
+ * Shows how much GPU memory we're using, broken down by category, and lets us tweak the budget
+ */
+class GpuMemoryWindow : public IEditorWindow {
+public:
+	MAKE_PTRS(GpuMemoryWindow);
+
+	GpuMemoryWindow();
+	virtual ~GpuMemoryWindow();
+
+	// Inherited from IEditorWindow
+
+	virtual void Render() override;
+
+protected:
+	void _RenderResources();
+};
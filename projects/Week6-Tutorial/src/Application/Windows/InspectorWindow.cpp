@@ -31,7 +31,7 @@ void InspectorWindow::Render()
 		memcpy(nameBuff, selection->Name.c_str(), selection->Name.size());
 		nameBuff[selection->Name.size()] = '\0';
 		if (ImGui::InputText("##name", nameBuff, 256)) {
-			selection->Name = nameBuff;
+			selection->SetName(nameBuff);
 		}
 
 		ImGui::Separator();
@@ -71,6 +71,33 @@ void InspectorWindow::Render()
 
 		ImGui::Separator();
 
+		// Draw the layer and tags
+		int layer = selection->GetLayer();
+		if (LABEL_LEFT(ImGui::SliderInt, "Layer   ", &layer, 0, Gameplay::GameObject::MAX_LAYERS - 1)) {
+			selection->SetLayer(static_cast<uint8_t>(layer));
+		}
+		for (size_t ix = 0; ix < Gameplay::GameObject::MAX_TAGS; ix++) {
+			if (selection->GetTags().test(ix)) {
+				const std::string& tag = scene->GetTagName(static_cast<int>(ix));
+				ImGui::PushID(static_cast<int>(ix));
+				if (ImGui::SmallButton((tag + " x").c_str())) {
+					selection->RemoveTag(tag);
+				}
+				ImGui::PopID();
+				ImGui::SameLine();
+			}
+		}
+		static char tagBuff[64];
+		ImGui::SetNextItemWidth(120.0f);
+		if (ImGui::InputText("##tag", tagBuff, 64, ImGuiInputTextFlags_EnterReturnsTrue) && tagBuff[0] != '\0') {
+			selection->AddTag(tagBuff);
+			tagBuff[0] = '\0';
+		}
+		ImGui::SameLine();
+		ImGui::TextDisabled("Add Tag");
+
+		ImGui::Separator();
+
 		// Render each component under it's own header
 		for (int ix = 0; ix < selection->_components.size(); ix++) {
 			std::shared_ptr<Gameplay::IComponent> component = selection->_components[ix];
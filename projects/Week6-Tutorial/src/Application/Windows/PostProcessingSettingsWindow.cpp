@@ -1,5 +1,6 @@
 #include "PostProcessingSettingsWindow.h"
 #include "../Application.h"
+#include "../Layers/RenderLayer.h"
 #include "Utils/ImGuiHelper.h"
 #include "imgui_internal.h"
 #include <set>
@@ -22,6 +23,13 @@ void PostProcessingSettingsWindow::Render()
 
 	PostProcessingLayer::Sptr layer = app.GetLayer<PostProcessingLayer>();
 
+	ImGui::Checkbox("Fuse point-wise effects", &layer->EnableFusion);
+	ImGui::Checkbox("Use compute shaders", &layer->EnableCompute);
+	ImGui::Separator();
+
+	_RenderDynamicResolution();
+	_RenderTemporalAA();
+
 	std::set<PostProcessingLayer::Effect::Sptr> unique (layer->GetEffects().begin(), layer->GetEffects().end());
 
 	for (const auto& effect : unique) {
@@ -29,6 +37,69 @@ void PostProcessingSettingsWindow::Render()
 	}
 }
 
+void PostProcessingSettingsWindow::_RenderDynamicResolution()
+{
+	RenderLayer::Sptr renderer = Application::Get().GetLayer<RenderLayer>();
+	const DynamicResolution::Sptr& resolution = renderer->GetDynamicResolution();
+
+	ImGui::PushID(resolution.get());
+
+	ImGuiID id = ImGui::GetID("Dynamic Resolution");
+	bool isOpen = ImGui::CollapsingHeader("Dynamic Resolution", ImGuiTreeNodeFlags_AllowItemOverlap | ImGuiTreeNodeFlags_ClipLabelForTrailingButton);
+	ImGuiHelper::HeaderCheckbox(id, &resolution->Enabled);
+
+	if (isOpen) {
+		ImGui::Indent();
+
+		glm::ivec2 size = renderer->GetRenderSize();
+		ImGui::Text("Rendering at %dx%d (%.0f%%), GPU %.2fms", size.x, size.y, resolution->GetScale() * 100.0f, resolution->GetSmoothedFrameTime());
+		glm::ivec2 capacity = renderer->GetRenderCapacity();
+		ImGui::Text("Targets allocated at %dx%d", capacity.x, capacity.y);
+
+		LABEL_LEFT(ImGui::DragFloat, "Target (ms)", &resolution->TargetFrameTime, 0.1f, 1.0f, 100.0f);
+		LABEL_LEFT(ImGui::SliderFloat, "Min Scale  ", &resolution->MinScale, 0.25f, 1.0f);
+		LABEL_LEFT(ImGui::SliderFloat, "Max Scale  ", &resolution->MaxScale, 0.25f, 1.0f);
+		ENUM_COMBO("Upscale    ", &resolution->Filter, UpscaleFilter);
+		if (resolution->Filter == UpscaleFilter::Sharpen) {
+			LABEL_LEFT(ImGui::SliderFloat, "Sharpness  ", &resolution->Sharpness, 0.0f, 1.0f);
+		}
+
+		ImGui::Unindent();
+		ImGui::Separator();
+	}
+
+	ImGui::PopID();
+}
+
+void PostProcessingSettingsWindow::_RenderTemporalAA()
+{
+	RenderLayer::Sptr renderer = Application::Get().GetLayer<RenderLayer>();
+	const TemporalAntiAliasing::Sptr& taa = renderer->GetTemporalAntiAliasing();
+
+	ImGui::PushID(taa.get());
+
+	ImGuiID id = ImGui::GetID("Temporal Anti-Aliasing");
+	bool isOpen = ImGui::CollapsingHeader("Temporal Anti-Aliasing", ImGuiTreeNodeFlags_AllowItemOverlap | ImGuiTreeNodeFlags_ClipLabelForTrailingButton);
+	ImGuiHelper::HeaderCheckbox(id, &taa->Enabled);
+
+	if (isOpen) {
+		ImGui::Indent();
+
+		ImGui::Checkbox("Upsample to window", &taa->Upsample);
+		LABEL_LEFT(ImGui::SliderFloat, "Feedback (moving)", &taa->FeedbackMin, 0.0f, 0.99f);
+		LABEL_LEFT(ImGui::SliderFloat, "Feedback (still) ", &taa->FeedbackMax, 0.0f, 0.99f);
+		int samples = (int)taa->SampleCount;
+		if (LABEL_LEFT(ImGui::SliderInt, "Samples          ", &samples, 1, 32)) {
+			taa->SampleCount = (uint32_t)samples;
+		}
+
+		ImGui::Unindent();
+		ImGui::Separator();
+	}
+
+	ImGui::PopID();
+}
+
 void PostProcessingSettingsWindow::_RenderEffect(const PostProcessingLayer::Effect::Sptr& value)
 {
 	ImGui::PushID(value.get());
@@ -18,4 +18,6 @@ public:
 
 protected:
 	void _RenderEffect(const PostProcessingLayer::Effect::Sptr& value);
+	void _RenderDynamicResolution();
+	void _RenderTemporalAA();
 };
\ No newline at end of file
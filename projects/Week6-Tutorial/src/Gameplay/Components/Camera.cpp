@@ -62,8 +62,11 @@ namespace Gameplay {
 		_aspectRatio(1.0f),
 		_orthoVerticalScale(10.0f),
 		_isOrtho(false),
+		_isProjectionDirty(true),
 		_view(glm::mat4(1.0f)),
 		_projection(glm::mat4(1.0f)),
+		_unjitteredProjection(glm::mat4(1.0f)),
+		_jitter(0.0f),
 		_viewProjection(glm::mat4(1.0f)),
 		_isDirty(true)
 	{
@@ -105,6 +108,18 @@ namespace Gameplay {
 		return _projection;
 	}
 
+	const glm::mat4& Camera::GetUnjitteredProjection() const {
+		__CalculateProjection();
+		return _unjitteredProjection;
+	}
+
+	void Camera::SetJitter(const glm::vec2& offset) {
+		if (offset != _jitter) {
+			_jitter = offset;
+			_isProjectionDirty = true;
+		}
+	}
+
 	const glm::mat4& Camera::GetViewProjection() const {
 		_viewProjection = __CalculateProjection() * GetGameObject()->GetInverseTransform();
 		return _viewProjection;
@@ -147,10 +162,12 @@ namespace Gameplay {
 			if (_isOrtho) {
 				float w = (_orthoVerticalScale * _aspectRatio) / 2.0f;
 				float h = (_orthoVerticalScale / 2.0f);
-				_projection = glm::ortho(-w, w, -h, h, _nearPlane, _farPlane);
+				_unjitteredProjection = glm::ortho(-w, w, -h, h, _nearPlane, _farPlane);
 			} else {
-				_projection = glm::perspective(_fovRadians, _aspectRatio, _nearPlane, _farPlane);
+				_unjitteredProjection = glm::perspective(_fovRadians, _aspectRatio, _nearPlane, _farPlane);
 			}
+			// Translating after the projection shifts everything by the same amount in NDC, regardless of depth
+			_projection = glm::translate(glm::mat4(1.0f), glm::vec3(_jitter, 0.0f)) * _unjitteredProjection;
 			_isProjectionDirty = false;
 		}
 		return _projection;
@@ -72,6 +72,17 @@ namespace Gameplay {
 		/// </summary>
 		bool GetOrthoEnabled() const { return _isOrtho; }
 
+		/// <summary>
+		/// Sets a sub-pixel offset that is applied to the projection, used by temporal anti-aliasing to
+		/// sample a different position within each pixel every frame
+		/// </summary>
+		/// <param name="offset">The offset in normalized device coordinates (2 / render size per pixel)</param>
+		void SetJitter(const glm::vec2& offset);
+		/// <summary>
+		/// Gets the offset applied to the projection, in normalized device coordinates
+		/// </summary>
+		const glm::vec2& GetJitter() const { return _jitter; }
+
 		/// <summary>
 		/// Gets the view matrix for this camera
 		/// </summary>
@@ -81,6 +92,10 @@ namespace Gameplay {
 		/// </summary>
 		const glm::mat4& GetProjection() const;
 		/// <summary>
+		/// Gets the projection matrix for this camera without any jitter applied
+		/// </summary>
+		const glm::mat4& GetUnjitteredProjection() const;
+		/// <summary>
 		/// Gets the combined view-projection matrix for this camera, calculating if needed
 		/// </summary>
 		const glm::mat4& GetViewProjection() const;
@@ -105,6 +120,8 @@ namespace Gameplay {
 
 		glm::mat4 _view;
 		mutable glm::mat4 _projection;
+		mutable glm::mat4 _unjitteredProjection;
+		glm::vec2         _jitter;
 
 		// The view projection, it is mutable so we can re-calculate it during const methods
 		mutable glm::mat4 _viewProjection;
@@ -3,6 +3,8 @@
 #include "IComponent.h"
 #include <typeindex>
 #include <optional>
+#include <unordered_map>
+#include <unordered_set>
 #include <Logging.h>
 
 namespace Gameplay {
@@ -18,6 +20,8 @@ namespace Gameplay {
 
 		inline void Clear() {
 			_Components.clear();
+			_ComponentsByGuid.clear();
+			_DirtyPools.clear();
 		}
 
 		/// <summary>
@@ -46,7 +50,7 @@ namespace Gameplay {
 					result->_weakSelfPtr = result;
 
 					// Add the component to the global pools
-					_Components[result->_realType].push_back(result);
+					_AddToPools(result);
 					return result;
 				}
 			}
@@ -75,7 +79,7 @@ namespace Gameplay {
 					result->_realType = typeIndex.value();
 					result->_weakSelfPtr = result;
 					// Add the component to the global pools
-					_Components[result->_realType].push_back(result);
+					_AddToPools(result);
 					return result;
 				}
 			}
@@ -102,7 +106,7 @@ namespace Gameplay {
 				result->_realType = type;
 				result->_weakSelfPtr = result;
 				// Add the component to the global pools
-				_Components[result->_realType].push_back(result);
+				_AddToPools(result);
 				return result;
 			}
 			return nullptr;
@@ -144,7 +148,7 @@ namespace Gameplay {
 			component->_weakSelfPtr = component;
 
 			// Add to global component list for that type
-			_Components[type].push_back(component);
+			_AddToPools(component);
 
 			// Return the result
 			return component;
@@ -165,21 +169,15 @@ namespace Gameplay {
 			std::type_index type = std::type_index(typeid(ComponentType));
 			LOG_ASSERT(_TypeLoadRegistry[type] != nullptr, "You must register component types before creating them!");
 
-			// Clear any dead weak pointers
-			auto removeIt = std::remove_if(_Components[type].begin(), _Components[type].end(), [](const std::weak_ptr<IComponent>& ptr) {
-				return ptr.expired();
-			});
-			_Components[type].erase(removeIt, _Components[type].end());
-
-			// Search the component store for a component that matches that ID
-			auto& it = std::find_if(_Components[type].begin(), _Components[type].end(), [&](const std::weak_ptr<IComponent>& ptr) {
-				return (ptr.lock())->GetGUID() == id;
-			});
-
-			// If the component was found, return it. Otherwise return nullptr
-			if (it != _Components[type].end()) {
-				// We need to lock the weak pointer to convert it to a shared ptr
-				return std::dynamic_pointer_cast<ComponentType>((*it).lock());
+			// Look up the component, and make sure it's the type that was asked for
+			auto it = _ComponentsByGuid.find(id);
+			if (it == _ComponentsByGuid.end()) {
+				return nullptr;
+			}
+			// We need to lock the weak pointer to convert it to a shared ptr
+			IComponent::Sptr component = it->second.lock();
+			if (component != nullptr && component->_realType == type) {
+				return std::static_pointer_cast<ComponentType>(component);
 			} else {
 				return nullptr;
 			}
@@ -239,6 +237,24 @@ namespace Gameplay {
 		/// </summary>
 		inline void FlushAll() {
 			_Components = std::unordered_map<std::type_index, std::vector<std::weak_ptr<IComponent>>>();
+			_ComponentsByGuid = std::unordered_map<Guid, std::weak_ptr<IComponent>>();
+			_DirtyPools.clear();
+		}
+
+		/// <summary>
+		/// Removes the dead entries from all the pools that have had components destroyed since the last
+		/// call. Destroying a component only flags it's pool, so that destroying lots of components at
+		/// once only needs a single pass over each pool
+		/// </summary>
+		inline void CompactPools() {
+			for (const std::type_index& type : _DirtyPools) {
+				std::vector<std::weak_ptr<IComponent>>& componentStore = _Components[type];
+				auto it = std::remove_if(componentStore.begin(), componentStore.end(), [](const std::weak_ptr<IComponent>& ptr) {
+					return ptr.expired();
+				});
+				componentStore.erase(it, componentStore.end());
+			}
+			_DirtyPools.clear();
 		}
 
 	private:
@@ -258,6 +274,24 @@ namespace Gameplay {
 		// actually increasing the reference count. Thus components will be destroyed at the correct
 		// time (when the only reference is the one stored here).
 		std::unordered_map<std::type_index, std::vector<std::weak_ptr<IComponent>>> _Components;  
+		// Lets us look up components by their GUID without searching the pools, used for resolving
+		// references between components
+		std::unordered_map<Guid, std::weak_ptr<IComponent>> _ComponentsByGuid;
+		// The types that have had components destroyed since the last CompactPools
+		std::unordered_set<std::type_index> _DirtyPools;
+
+		/// <summary>
+		/// Adds a new component to the pool for it's type and the GUID lookup
+		/// </summary>
+		/// <param name="component">The component to add, it's type and GUID should already be set</param>
+		inline void _AddToPools(const IComponent::Sptr& component) {
+			_Components[component->_realType].push_back(component);
+			// If a live component already has this GUID, it keeps it's place in the lookup
+			std::weak_ptr<IComponent>& entry = _ComponentsByGuid[component->GetGUID()];
+			if (entry.expired()) {
+				entry = component;
+			}
+		}
 
 		template <typename T>
 		static IComponent::Sptr ParseTypeFromBlob(const nlohmann::json& blob) {
@@ -294,16 +328,13 @@ namespace Gameplay {
 			// Make sure the component's type was one that was registered
 			LOG_ASSERT(_TypeLoadRegistry[component->_realType] != nullptr, "You must register component types before creating them!");
 
-			
-			// Get a reference to the vector of components for easy access
-			std::vector<std::weak_ptr<IComponent>>& componentStore = _Components[component->_realType];
+			// The dead weak pointer gets cleared out of the pool in CompactPools, Each already skips it
+			_DirtyPools.insert(component->_realType);
 
-			// Clear any dead weak pointers
-			auto it = std::remove_if(componentStore.begin(), componentStore.end(), [](const std::weak_ptr<IComponent>& ptr) {
-				return ptr.expired();
-				});
-			if (it != componentStore.end()) {
-				componentStore.erase(it);
+			// Remove the GUID lookup, as long as it belongs to this component and not another one with the same GUID
+			auto guidIt = _ComponentsByGuid.find(component->GetGUID());
+			if (guidIt != _ComponentsByGuid.end() && !guidIt->second.owner_before(component->_weakSelfPtr) && !component->_weakSelfPtr.owner_before(guidIt->second)) {
+				_ComponentsByGuid.erase(guidIt);
 			}
 		}
 	};
@@ -141,8 +141,8 @@ void ParticleSystem::Update()
 
 	// Bind the update shader and send our relevant uniforms
 	_updateShader->Bind();
-	_updateShader->SetUniform("u_Gravity", _gravity); 
-	_updateShader->SetUniformMatrix("u_ModelMatrix", GetGameObject()->GetTransform()); 
+	_updateShader->SetUniform("u_Gravity"_uh, _gravity); 
+	_updateShader->SetUniformMatrix("u_ModelMatrix"_uh, GetGameObject()->GetTransform()); 
 
 	glBindVertexArray(_updateVaos[_currentVertexBuffer]);
 
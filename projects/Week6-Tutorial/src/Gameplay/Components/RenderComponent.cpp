@@ -7,17 +7,31 @@
 RenderComponent::RenderComponent(const Gameplay::MeshResource::Sptr& mesh, const Gameplay::Material::Sptr& material) :
 	_mesh(mesh), 
 	_material(material), 
-	_meshBuilderParams(std::vector<MeshBuilderParam>()) 
+	_meshBuilderParams(std::vector<MeshBuilderParam>()),
+	_previousTransform(1.0f),
+	_previousFrame(0),
+	_lod(0),
+	_previousLod(0),
+	_lodFade(1.0f)
 { }
 
 RenderComponent::RenderComponent() : 
 	_mesh(nullptr), 
 	_material(nullptr), 
-	_meshBuilderParams(std::vector<MeshBuilderParam>())
+	_meshBuilderParams(std::vector<MeshBuilderParam>()),
+	_previousTransform(1.0f),
+	_previousFrame(0),
+	_lod(0),
+	_previousLod(0),
+	_lodFade(1.0f)
 { }
 
 RenderComponent* RenderComponent::SetMesh(const Gameplay::MeshResource::Sptr& mesh) {
 	_mesh = mesh;
+	// The old mesh's levels don't mean anything for the new one
+	_lod = 0;
+	_previousLod = 0;
+	_lodFade = 1.0f;
 	return this;
 }
 
@@ -26,7 +40,7 @@ const Gameplay::MeshResource::Sptr& RenderComponent::GetMeshResource() const {
 }
 
 VertexArrayObject::Sptr RenderComponent::GetMesh() const {
-	return _mesh ? _mesh->Mesh : nullptr;
+	return _mesh ? _mesh->GetLod(0) : nullptr;
 }
 
 RenderComponent* RenderComponent::SetMaterial(const Gameplay::Material::Sptr& mat) {
@@ -38,6 +52,24 @@ const Gameplay::Material::Sptr& RenderComponent::GetMaterial() const {
 	return _material;
 }
 
+glm::mat4 RenderComponent::SwapPreviousTransform(const glm::mat4& transform, uint64_t frame) {
+	glm::mat4 result = (frame == _previousFrame + 1) ? _previousTransform : transform;
+	_previousTransform = transform;
+	_previousFrame = frame;
+	return result;
+}
+
+void RenderComponent::UpdateLod(uint32_t lod, float fadeStep) {
+	if (lod != _lod) {
+		// If we were already fading, the new fade starts from whatever level we were fading to
+		_previousLod = _lod;
+		_lod = lod;
+		_lodFade = glm::min(fadeStep, 1.0f);
+	} else {
+		_lodFade = glm::min(_lodFade + fadeStep, 1.0f);
+	}
+}
+
 nlohmann::json RenderComponent::ToJson() const {
 	nlohmann::json result;
 	result["mesh"] = _mesh ? _mesh->GetGUID().str() : "null";
@@ -57,6 +89,7 @@ void RenderComponent::RenderImGui() {
 	ImGui::Text("Indexed:   %s", GetMesh() != nullptr ? (_mesh->Mesh->GetIndexBuffer() != nullptr ? "true" : "false") : "N/A");
 	ImGui::Text("Triangles: %d", GetMesh() != nullptr ? (_mesh->Mesh->GetElementCount() / 3) : 0);
 	ImGui::Text("Source:    %s", (_mesh == nullptr || _mesh->Filename.empty()) ? "Generated" : _mesh->Filename.c_str());
+	ImGui::Text("LOD:       %d / %d", _lod, _mesh != nullptr ? _mesh->GetLodCount() : 0);
 	ImGui::Separator();
 	ImGui::Text("Material:  %s", _material != nullptr ? _material->Name.c_str() : "NULL");
 	ImGuiHelper::ResourceDragTarget<Gameplay::Material>(_material);
@@ -42,6 +42,33 @@ public:
 	/// <param name="mat">The material for this object</param>
 	RenderComponent* SetMaterial(const Gameplay::Material::Sptr& mat);
 
+	/// <summary>
+	/// Gets the transform this object was rendered with in the previous frame, and replaces it with the
+	/// transform for this frame. Used by the render layer to generate motion vectors. If the object was
+	/// not rendered in the previous frame, the current transform is returned so it won't appear to move
+	/// </summary>
+	/// <param name="transform">The transform the object is being rendered with this frame</param>
+	/// <param name="frame">The index of the frame being rendered</param>
+	glm::mat4 SwapPreviousTransform(const glm::mat4& transform, uint64_t frame);
+
+	/// <summary>
+	/// Moves this object to a new level of detail. If fadeStep is less than 1, the previous level keeps being
+	/// drawn alongside the new one until the fade is complete, see GetLodFade
+	/// </summary>
+	/// <param name="lod">The level of detail the object should be drawn with</param>
+	/// <param name="fadeStep">How much of the cross-fade to complete this frame, 1 to switch levels immediately</param>
+	void UpdateLod(uint32_t lod, float fadeStep);
+	/// <summary>
+	/// Gets the level of detail that the object is drawn with, and the level it is fading out from
+	/// </summary>
+	uint32_t GetLod() const { return _lod; }
+	uint32_t GetPreviousLod() const { return _previousLod; }
+	/// <summary>
+	/// Gets how far the object is through fading from the previous level of detail to the current one,
+	/// in the 0-1 range. Once this reaches 1, only the current level needs to be drawn
+	/// </summary>
+	float GetLodFade() const { return _lodFade; }
+
 	// Inherited from IComponent
 
 	virtual void RenderImGui() override;
@@ -57,4 +84,13 @@ protected:
 
 	// If we want to use MeshFactory, we can populate this list
 	std::vector<MeshBuilderParam> _meshBuilderParams;
+
+	// The transform and frame index from the last time this object was rendered
+	glm::mat4 _previousTransform;
+	uint64_t  _previousFrame;
+
+	// The level of detail we're drawn with, and the level we're fading out from
+	uint32_t  _lod;
+	uint32_t  _previousLod;
+	float     _lodFade;
 };
\ No newline at end of file
@@ -30,7 +30,12 @@ namespace Gameplay {
 		_inverseWorldTransform(MAT4_IDENTITY),
 		_isWorldTransformDirty(true),
 		_parent(WeakRef()),
-		_children(std::vector<WeakRef>())
+		_children(std::vector<WeakRef>()),
+		_tags(TagSet()),
+		_layer(0),
+		_indexedName(""),
+		_sceneIndex(SIZE_MAX),
+		_isPendingDelete(false)
 	{ }
 
 	void GameObject::_RecalcLocalTransform() const
@@ -81,6 +86,40 @@ namespace Gameplay {
 		_children.erase(it, _children.end());
 	}
 
+	void GameObject::SetName(const std::string& name) {
+		Name = name;
+		if (_scene != nullptr) {
+			_scene->_OnObjectRenamed(this);
+		}
+	}
+
+	bool GameObject::AddTag(const std::string& tag) {
+		int index = _scene->RegisterTag(tag);
+		if (index < 0) {
+			LOG_WARN("Cannot add tag \"{}\" to {}, the scene has run out of tags", tag, Name);
+			return false;
+		}
+		_tags.set(index);
+		return true;
+	}
+
+	void GameObject::RemoveTag(const std::string& tag) {
+		int index = _scene->GetTagIndex(tag);
+		if (index >= 0) {
+			_tags.reset(index);
+		}
+	}
+
+	bool GameObject::HasTag(const std::string& tag) const {
+		int index = _scene->GetTagIndex(tag);
+		return index >= 0 && _tags.test(index);
+	}
+
+	void GameObject::SetLayer(uint8_t layer) {
+		LOG_ASSERT(layer < MAX_LAYERS, "Layer must be less than {}", MAX_LAYERS);
+		_layer = layer;
+	}
+
 	void GameObject::LookAt(const glm::vec3& point) {
 		glm::mat4 rot = glm::lookAt(_position, point, glm::vec3(0.0f, 0.0f, 1.0f));
 		// Take the conjugate of the quaternion, as lookAt returns the *inverse* rotation
@@ -324,7 +363,7 @@ namespace Gameplay {
 			memcpy(nameBuff, Name.c_str(), Name.size());
 			nameBuff[Name.size()] = '\0';
 			if (ImGui::InputText("", nameBuff, 256)) {
-				Name = nameBuff;
+				SetName(nameBuff);
 			}
 			ImGui::SameLine();
 			if (ImGuiHelper::WarningButton("Delete")) {
@@ -463,6 +502,12 @@ namespace Gameplay {
 		result->_rotation = (data["rotation"]);
 		result->_scale    = (data["scale"]);
 		result->HideInHierarchy = JsonGet(data, "hide_in_inspector", false);
+		result->_layer = JsonGet(data, "layer", (uint8_t)0) % MAX_LAYERS;
+		if (data.contains("tags") && data["tags"].is_array()) {
+			for (const auto& tag : data["tags"]) {
+				result->AddTag(tag.get<std::string>());
+			}
+		}
 		result->_isLocalTransformDirty = true;
 		result->_isWorldTransformDirty = true;
 
@@ -493,8 +538,15 @@ namespace Gameplay {
 			{ "rotation", _rotation },
 			{ "scale",    _scale },
 			{ "parent",   parent == nullptr ? "null" : parent->_guid.str() },
-			{ "hide_in_inspector", HideInHierarchy }
+			{ "hide_in_inspector", HideInHierarchy },
+			{ "layer", _layer }
 		};
+		result["tags"] = std::vector<std::string>();
+		for (size_t ix = 0; ix < MAX_TAGS; ix++) {
+			if (_tags.test(ix)) {
+				result["tags"].push_back(_scene->GetTagName(static_cast<int>(ix)));
+			}
+		}
 		result["components"] = nlohmann::json();
 		for (auto& component : _components) {
 			result["components"][component->ComponentTypeName()] = component->ToJson();
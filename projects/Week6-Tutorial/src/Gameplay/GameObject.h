@@ -1,5 +1,6 @@
 #pragma once
 #include <string>
+#include <bitset>
 
 // Utils
 #include "Utils/GUID.hpp"
@@ -34,6 +35,16 @@ namespace Gameplay {
 		typedef std::shared_ptr<GameObject> Sptr;
 		typedef std::weak_ptr<GameObject> Wptr;
 
+		// The number of distinct tags that a scene can use
+		static constexpr size_t MAX_TAGS = 64;
+		// The number of layers that objects can be placed on, so that a layer mask fits in 32 bits
+		static constexpr uint8_t MAX_LAYERS = 32;
+
+		/// <summary>
+		/// A set of tags, where each bit is a tag index registered with the scene
+		/// </summary>
+		typedef std::bitset<MAX_TAGS> TagSet;
+
 		/// <summary>
 		/// Structure to assist in wrapping weak references to GameObjects
 		/// Can track the object's GUID before and after creation
@@ -133,12 +144,53 @@ namespace Gameplay {
 			void Reset();
 		};
 
-		// Human readable name for the object
+		// Human readable name for the object, use SetName to rename objects that are in a scene
+		// so that Scene::FindObjectByName can keep track of them
 		std::string             Name;
 
 		// Hack to hide instances from the hierarchy (like when adding lots of instances)
 		bool HideInHierarchy = false;
 
+		/// <summary>
+		/// Renames this object, and updates the scene's name lookup
+		/// </summary>
+		/// <param name="name">The new name for the object</param>
+		void SetName(const std::string& name);
+
+		/// <summary>
+		/// Adds a tag to this object, registering it with the scene if it does not exist yet
+		/// </summary>
+		/// <param name="tag">The name of the tag to add</param>
+		/// <returns>True if the tag was added, false if the scene has run out of tags</returns>
+		bool AddTag(const std::string& tag);
+		/// <summary>
+		/// Removes a tag from this object
+		/// </summary>
+		/// <param name="tag">The name of the tag to remove</param>
+		void RemoveTag(const std::string& tag);
+		/// <summary>
+		/// Checks whether this object has the given tag
+		/// </summary>
+		/// <param name="tag">The name of the tag to check</param>
+		bool HasTag(const std::string& tag) const;
+		/// <summary>
+		/// Gets the set of tags on this object, see Scene::GetTagIndex for mapping names to bits
+		/// </summary>
+		const TagSet& GetTags() const { return _tags; }
+
+		/// <summary>
+		/// Sets the layer that this object is on, between 0 and MAX_LAYERS - 1
+		/// </summary>
+		void SetLayer(uint8_t layer);
+		/// <summary>
+		/// Gets the layer that this object is on
+		/// </summary>
+		uint8_t GetLayer() const { return _layer; }
+		/// <summary>
+		/// Gets a mask with only this object's layer bit set, for testing against layer masks
+		/// </summary>
+		uint32_t GetLayerMask() const { return 1u << _layer; }
+
 		/// <summary>
 		/// Rotates this object to look at the given point in world coordinates
 		/// </summary>
@@ -363,6 +415,17 @@ namespace Gameplay {
 		std::vector<IComponent::Sptr> _components;
 		std::weak_ptr<GameObject> _selfRef;
 
+		// Tags and layer, for filtering objects in scene queries
+		TagSet  _tags;
+		uint8_t _layer;
+		// The name that the scene has this object stored under, so it can be removed after a rename
+		std::string _indexedName;
+
+		// Where this object is in the scene's object list, so it can be removed without searching
+		size_t _sceneIndex;
+		// True once this object has been queued for deletion, so we don't queue it twice
+		bool   _isPendingDelete;
+
 		// Pointer to the scene, we use raw pointers since 
 		// this will always be set by the scene on creation
 		// or load, we don't need to worry about ref counting
@@ -0,0 +1,520 @@
+#include "Gameplay/GltfImporter.h"
+
+#include <filesystem>
+#include <map>
+#include <tuple>
+
+#include <tiny_gltf.h>
+#include <stb_image.h>
+
+#include "Gameplay/Components/RenderComponent.h"
+#include "Graphics/Textures/Texture2D.h"
+#include "Utils/ResourceManager/ResourceManager.h"
+#include "Utils/StringUtils.h"
+#include "Utils/FileHelpers.h"
+#include "Utils/VirtualFileSystem.h"
+#include "Logging.h"
+
+namespace fs = std::filesystem;
+
+namespace Gameplay {
+	/// <summary>
+	/// Everything that has been created while importing a file, so that anything the file references more
+	/// than once is only created once
+	/// </summary>
+	struct __GltfImportContext {
+		const tinygltf::Model& Model;
+		ShaderProgram::Sptr    Shader;
+
+		// Keyed on buffer view, start of the range within the view, stride and vertex count
+		std::map<std::tuple<int, size_t, size_t, size_t>, VertexBuffer::Sptr> VertexBuffers;
+		// Keyed on accessor
+		std::map<int, IndexBuffer::Sptr>                                    IndexBuffers;
+		// Keyed on texture, and whether it holds sRGB colors
+		std::map<std::pair<int, bool>, Texture2D::Sptr>                     Textures;
+		// One entry per glTF material, created the first time they are used
+		std::vector<Material::Sptr>                                         Materials;
+		Material::Sptr                                                      DefaultMaterial;
+		// The mesh resource and material index for each primitive of each glTF mesh, created the first time they are used
+		std::vector<std::vector<std::pair<MeshResource::Sptr, int>>>        Meshes;
+		std::vector<bool>                                                   MeshLoaded;
+
+		// Stand-ins for materials that don't have a texture
+		Texture2D::Sptr White;
+		Texture2D::Sptr FlatNormal;
+
+		__GltfImportContext(const tinygltf::Model& model) : Model(model) { }
+	};
+
+	/// <summary>
+	/// Creates a 1x1 texture with a single color
+	/// </summary>
+	static inline Texture2D::Sptr __CreateSolidTexture(const glm::vec3& color) {
+		Texture2DDescription singlePixelDescriptor;
+		singlePixelDescriptor.Width = singlePixelDescriptor.Height = 1;
+		singlePixelDescriptor.Format = InternalFormat::RGB8;
+
+		Texture2D::Sptr result = ResourceManager::CreateAsset<Texture2D>(singlePixelDescriptor);
+		result->LoadData(1, 1, PixelFormat::RGB, PixelType::Float, const_cast<float*>(&color.x));
+		return result;
+	}
+
+	/// <summary>
+	/// Gets or creates the texture for a glTF texture index, returning the fallback if there isn't one
+	/// </summary>
+	static Texture2D::Sptr __GetTexture(__GltfImportContext& context, int textureIx, bool srgb, const Texture2D::Sptr& fallback) {
+		if (textureIx < 0 || textureIx >= (int)context.Model.textures.size()) {
+			return fallback;
+		}
+		auto it = context.Textures.find({ textureIx, srgb });
+		if (it != context.Textures.end()) {
+			return it->second;
+		}
+
+		const tinygltf::Texture& texture = context.Model.textures[textureIx];
+		if (texture.source < 0 || texture.source >= (int)context.Model.images.size() || context.Model.images[texture.source].image.empty()) {
+			LOG_WARN("Texture {} has no image data, using a solid color instead", textureIx);
+			context.Textures[{ textureIx, srgb }] = fallback;
+			return fallback;
+		}
+		const tinygltf::Image& image = context.Model.images[texture.source];
+
+		// tinygltf always expands images to 4 channels, but we'll handle anything it gives us
+		PixelFormat format = GetPixelFormatForChannels(image.component);
+		PixelType type = image.bits == 16 ? PixelType::UShort : PixelType::UByte;
+
+		Texture2DDescription description;
+		description.Width  = image.width;
+		description.Height = image.height;
+		description.Format = srgb ? (image.component == 4 ? InternalFormat::SRGBA : InternalFormat::SRGB) : GetInternalFormatForChannels8(image.component);
+		// glTF's sampler enums are the same as OpenGL's, which is what ours are built on
+		if (texture.sampler >= 0 && texture.sampler < (int)context.Model.samplers.size()) {
+			const tinygltf::Sampler& sampler = context.Model.samplers[texture.sampler];
+			description.HorizontalWrap = static_cast<WrapMode>(sampler.wrapS);
+			description.VerticalWrap   = static_cast<WrapMode>(sampler.wrapT);
+			if (sampler.minFilter > 0) {
+				description.MinificationFilter = static_cast<MinFilter>(sampler.minFilter);
+			}
+			if (sampler.magFilter > 0) {
+				description.MagnificationFilter = static_cast<MagFilter>(sampler.magFilter);
+			}
+		}
+
+		Texture2D::Sptr result = ResourceManager::CreateAsset<Texture2D>(description);
+		result->LoadData(image.width, image.height, format, type, const_cast<unsigned char*>(image.image.data()));
+		result->SetDebugName(image.name.empty() ? image.uri : image.name);
+
+		context.Textures[{ textureIx, srgb }] = result;
+		return result;
+	}
+
+	/// <summary>
+	/// Gets or creates the material for a glTF material index, returning a plain white material if there isn't one
+	/// </summary>
+	static Material::Sptr __GetMaterial(__GltfImportContext& context, int materialIx) {
+		bool isDefault = materialIx < 0 || materialIx >= (int)context.Model.materials.size();
+		Material::Sptr& slot = isDefault ? context.DefaultMaterial : context.Materials[materialIx];
+		if (slot != nullptr) {
+			return slot;
+		}
+
+		// The defaults here match the ones in the glTF spec, so missing values behave the same
+		tinygltf::Material defaults;
+		const tinygltf::Material& source = isDefault ? defaults : context.Model.materials[materialIx];
+		const tinygltf::PbrMetallicRoughness& pbr = source.pbrMetallicRoughness;
+
+		Material::Sptr result = ResourceManager::CreateAsset<Material>(context.Shader);
+		result->Name = source.name.empty() ? (isDefault ? "glTF Default" : "glTF Material " + std::to_string(materialIx)) : source.name;
+
+		glm::vec4 baseColor(1.0f);
+		for (size_t ix = 0; ix < 4 && ix < pbr.baseColorFactor.size(); ix++) {
+			baseColor[ix] = static_cast<float>(pbr.baseColorFactor[ix]);
+		}
+		glm::vec3 emissive(0.0f);
+		for (size_t ix = 0; ix < 3 && ix < source.emissiveFactor.size(); ix++) {
+			emissive[ix] = static_cast<float>(source.emissiveFactor[ix]);
+		}
+
+		result->Set("u_Material.BaseColorMap", __GetTexture(context, pbr.baseColorTexture.index, true, context.White));
+		result->Set("u_Material.MetallicRoughnessMap", __GetTexture(context, pbr.metallicRoughnessTexture.index, false, context.White));
+		result->Set("u_Material.NormalMap", __GetTexture(context, source.normalTexture.index, false, context.FlatNormal));
+		result->Set("u_Material.EmissiveMap", __GetTexture(context, source.emissiveTexture.index, true, context.White));
+		result->Set("u_Material.BaseColorFactor", baseColor);
+		result->Set("u_Material.MetallicFactor", static_cast<float>(pbr.metallicFactor));
+		result->Set("u_Material.RoughnessFactor", static_cast<float>(pbr.roughnessFactor));
+		result->Set("u_Material.NormalScale", static_cast<float>(source.normalTexture.scale));
+		result->Set("u_Material.EmissiveFactor", emissive);
+
+		// We don't have a forward pass for blending, so blended materials are cut out instead
+		float cutoff = 0.0f;
+		if (source.alphaMode == "MASK") {
+			cutoff = static_cast<float>(source.alphaCutoff);
+		} else if (source.alphaMode == "BLEND") {
+			LOG_WARN("Material \"{}\" uses alpha blending, which is not supported. It will be alpha tested instead", result->Name);
+			cutoff = 0.5f;
+		}
+		result->Set("u_Material.AlphaCutoff", cutoff);
+
+		// Maps that the file doesn't have behave like the white fallbacks, so the variant can skip sampling them
+		result->SetKeyword("HAS_BASE_COLOR_MAP", pbr.baseColorTexture.index >= 0);
+		result->SetKeyword("HAS_METALLIC_ROUGHNESS_MAP", pbr.metallicRoughnessTexture.index >= 0);
+		result->SetKeyword("HAS_NORMAL_MAP", source.normalTexture.index >= 0);
+		result->SetKeyword("HAS_EMISSIVE_MAP", source.emissiveTexture.index >= 0);
+		result->SetKeyword("ALPHA_TEST", cutoff > 0.0f);
+
+		slot = result;
+		return result;
+	}
+
+	/// <summary>
+	/// Gets or creates the vertex buffer for a group of accessors that share a buffer view. The buffer holds the
+	/// view's bytes for the accessors' vertices, uploaded straight from the file
+	/// </summary>
+	static VertexBuffer::Sptr __GetVertexBuffer(__GltfImportContext& context, int viewIx, size_t start, size_t stride, size_t count, size_t length) {
+		auto key = std::make_tuple(viewIx, start, stride, count);
+		auto it = context.VertexBuffers.find(key);
+		if (it != context.VertexBuffers.end()) {
+			return it->second;
+		}
+
+		const tinygltf::BufferView& view = context.Model.bufferViews[viewIx];
+		const tinygltf::Buffer& buffer = context.Model.buffers[view.buffer];
+		size_t offset = view.byteOffset + start;
+
+		VertexBuffer::Sptr result = VertexBuffer::Create(BufferUsage::StaticDraw);
+		// The last vertex doesn't have to fill it's whole stride, so the range may stop short of stride * count
+		if (offset + stride * count <= buffer.data.size()) {
+			result->LoadStorage(buffer.data.data() + offset, static_cast<uint32_t>(stride), static_cast<uint32_t>(count));
+		} else {
+			std::vector<uint8_t> padded(stride * count, 0);
+			memcpy(padded.data(), buffer.data.data() + offset, length);
+			result->LoadStorage(padded.data(), static_cast<uint32_t>(stride), static_cast<uint32_t>(count));
+		}
+
+		context.VertexBuffers[key] = result;
+		return result;
+	}
+
+	/// <summary>
+	/// Gets or creates the index buffer for an accessor. 8 bit indices are widened to 16 bits, everything
+	/// else is uploaded straight from the file
+	/// </summary>
+	static IndexBuffer::Sptr __GetIndexBuffer(__GltfImportContext& context, int accessorIx) {
+		auto it = context.IndexBuffers.find(accessorIx);
+		if (it != context.IndexBuffers.end()) {
+			return it->second;
+		}
+
+		const tinygltf::Accessor& accessor = context.Model.accessors[accessorIx];
+		const tinygltf::BufferView& view = context.Model.bufferViews[accessor.bufferView];
+		const uint8_t* data = context.Model.buffers[view.buffer].data.data() + view.byteOffset + accessor.byteOffset;
+		IndexType type = static_cast<IndexType>(accessor.componentType);
+
+		IndexBuffer::Sptr result = IndexBuffer::Create(BufferUsage::StaticDraw);
+		if (type == IndexType::UByte) {
+			std::vector<uint16_t> widened(data, data + accessor.count);
+			result->LoadStorage(widened.data(), sizeof(uint16_t), static_cast<uint32_t>(widened.size()), IndexType::UShort);
+		} else {
+			result->LoadStorage(data, static_cast<uint32_t>(GetIndexTypeSize(type)), static_cast<uint32_t>(accessor.count), type);
+		}
+
+		context.IndexBuffers[accessorIx] = result;
+		return result;
+	}
+
+	/// <summary>
+	/// Returns true if an accessor's data is all within it's buffer, and can be read directly
+	/// </summary>
+	static bool __ValidateAccessor(const tinygltf::Model& model, int accessorIx, const std::string& name) {
+		if (accessorIx < 0 || accessorIx >= (int)model.accessors.size()) {
+			return false;
+		}
+		const tinygltf::Accessor& accessor = model.accessors[accessorIx];
+		if (accessor.sparse.isSparse || accessor.bufferView < 0 || accessor.bufferView >= (int)model.bufferViews.size()) {
+			LOG_WARN("Accessor for {} is sparse or has no buffer view, which is not supported", name);
+			return false;
+		}
+		int componentSize = tinygltf::GetComponentSizeInBytes(accessor.componentType);
+		int componentCount = tinygltf::GetNumComponentsInType(accessor.type);
+		if (componentSize <= 0 || componentCount <= 0) {
+			LOG_WARN("Accessor for {} has an unknown type", name);
+			return false;
+		}
+		const tinygltf::BufferView& view = model.bufferViews[accessor.bufferView];
+		size_t elementSize = (size_t)componentSize * componentCount;
+		size_t stride = view.byteStride > 0 ? view.byteStride : elementSize;
+		size_t end = accessor.count == 0 ? 0 : accessor.byteOffset + stride * (accessor.count - 1) + elementSize;
+		if (view.buffer < 0 || view.buffer >= (int)model.buffers.size() || end > view.byteLength || view.byteOffset + view.byteLength > model.buffers[view.buffer].data.size()) {
+			LOG_WARN("Accessor for {} runs past the end of it's buffer", name);
+			return false;
+		}
+		return true;
+	}
+
+	/// <summary>
+	/// Creates the mesh resource for a single primitive
+	/// </summary>
+	static MeshResource::Sptr __LoadPrimitive(__GltfImportContext& context, const tinygltf::Primitive& primitive, const std::string& name) {
+		const tinygltf::Model& model = context.Model;
+
+		if (primitive.mode != -1 && primitive.mode != TINYGLTF_MODE_TRIANGLES) {
+			LOG_WARN("Primitive in \"{}\" is not a triangle list, skipping", name);
+			return nullptr;
+		}
+
+		// The vertex shader slots for each of the attributes we use. glTF colors would need a shader that can
+		// tell when they are missing, so we leave them out
+		static const std::pair<const char*, std::pair<uint32_t, AttribUsage>> attributeSlots[] = {
+			{ "POSITION",   { 0, AttribUsage::Position } },
+			{ "NORMAL",     { 2, AttribUsage::Normal } },
+			{ "TEXCOORD_0", { 3, AttribUsage::Texture } },
+			{ "TANGENT",    { 4, AttribUsage::Tangent } }
+		};
+
+		// Attributes that share a buffer view with a stride are interleaved, so they can share a vertex buffer
+		struct Stream {
+			int                          View;
+			size_t                       Stride;
+			size_t                       Start;
+			size_t                       End;
+			size_t                       Count;
+			std::vector<BufferAttribute> Attributes;
+			std::vector<size_t>          Offsets;
+		};
+		std::vector<Stream> streams;
+		int positionIx = -1;
+		for (const auto& [attribName, slot] : attributeSlots) {
+			auto it = primitive.attributes.find(attribName);
+			if (it == primitive.attributes.end() || !__ValidateAccessor(model, it->second, name + " " + attribName)) {
+				continue;
+			}
+			const tinygltf::Accessor& accessor = model.accessors[it->second];
+			const tinygltf::BufferView& view = model.bufferViews[accessor.bufferView];
+			size_t elementSize = tinygltf::GetComponentSizeInBytes(accessor.componentType) * tinygltf::GetNumComponentsInType(accessor.type);
+			size_t stride = view.byteStride > 0 ? view.byteStride : elementSize;
+			if (slot.second == AttribUsage::Position) {
+				positionIx = it->second;
+			}
+
+			BufferAttribute attribute(slot.first, tinygltf::GetNumComponentsInType(accessor.type), static_cast<AttributeType>(accessor.componentType), static_cast<GLsizei>(stride), 0, slot.second, accessor.normalized);
+
+			// Only views with an explicit stride can hold more than one attribute per vertex
+			Stream* stream = nullptr;
+			if (view.byteStride > 0) {
+				for (auto& existing : streams) {
+					if (existing.View == accessor.bufferView && existing.Count == accessor.count && existing.Stride == stride &&
+						accessor.byteOffset < existing.Start + stride && existing.Start < accessor.byteOffset + stride) {
+						stream = &existing;
+						break;
+					}
+				}
+			}
+			if (stream == nullptr) {
+				streams.push_back({ accessor.bufferView, stride, accessor.byteOffset, accessor.byteOffset, accessor.count });
+				stream = &streams.back();
+			}
+			stream->Start = std::min(stream->Start, accessor.byteOffset);
+			stream->End = std::max(stream->End, accessor.byteOffset + stride * (accessor.count - 1) + elementSize);
+			stream->Attributes.push_back(attribute);
+			stream->Offsets.push_back(accessor.byteOffset);
+		}
+		if (positionIx < 0 || model.accessors[positionIx].count == 0) {
+			LOG_WARN("Primitive in \"{}\" has no positions, skipping", name);
+			return nullptr;
+		}
+		if (primitive.attributes.count("NORMAL") == 0) {
+			LOG_WARN("Primitive in \"{}\" has no normals, lighting will be incorrect", name);
+		}
+
+		VertexArrayObject::Sptr vao = VertexArrayObject::Create();
+		VertexArrayObject::VertexDeclaration vertexDeclaration;
+
+		// Index buffer goes first, so the VAO draws by index count
+		if (primitive.indices >= 0) {
+			if (!__ValidateAccessor(model, primitive.indices, name + " indices")) {
+				return nullptr;
+			}
+			vao->SetIndexBuffer(__GetIndexBuffer(context, primitive.indices));
+		}
+
+		for (auto& stream : streams) {
+			// Offsets are relative to the start of the range we upload
+			for (size_t ix = 0; ix < stream.Attributes.size(); ix++) {
+				stream.Attributes[ix].Offset = static_cast<GLsizei>(stream.Offsets[ix] - stream.Start);
+			}
+			VertexBuffer::Sptr buffer = __GetVertexBuffer(context, stream.View, stream.Start, stream.Stride, stream.Count, stream.End - stream.Start);
+			vao->AddVertexBuffer(buffer, stream.Attributes);
+			vertexDeclaration.insert(vertexDeclaration.end(), stream.Attributes.begin(), stream.Attributes.end());
+		}
+		vao->SetVDecl(vertexDeclaration);
+
+		MeshResource::Sptr result = ResourceManager::CreateAsset<MeshResource>();
+		result->Mesh = vao;
+
+		// glTF requires positions to have their bounds, which saves us from reading them back
+		const tinygltf::Accessor& positions = model.accessors[positionIx];
+		if (positions.minValues.size() >= 3 && positions.maxValues.size() >= 3) {
+			result->BoundsMin = glm::vec3(positions.minValues[0], positions.minValues[1], positions.minValues[2]);
+			result->BoundsMax = glm::vec3(positions.maxValues[0], positions.maxValues[1], positions.maxValues[2]);
+			result->BoundingSphere = glm::vec4((result->BoundsMin + result->BoundsMax) * 0.5f, glm::length(result->BoundsMax - result->BoundsMin) * 0.5f);
+		}
+		return result;
+	}
+
+	/// <summary>
+	/// Gets or creates the mesh resources for each primitive of a glTF mesh
+	/// </summary>
+	static const std::vector<std::pair<MeshResource::Sptr, int>>& __GetMesh(__GltfImportContext& context, int meshIx) {
+		if (!context.MeshLoaded[meshIx]) {
+			const tinygltf::Mesh& mesh = context.Model.meshes[meshIx];
+			for (size_t ix = 0; ix < mesh.primitives.size(); ix++) {
+				std::string name = (mesh.name.empty() ? "mesh " + std::to_string(meshIx) : mesh.name) + "[" + std::to_string(ix) + "]";
+				MeshResource::Sptr primitive = __LoadPrimitive(context, mesh.primitives[ix], name);
+				if (primitive != nullptr) {
+					context.Meshes[meshIx].push_back({ primitive, mesh.primitives[ix].material });
+				}
+			}
+			context.MeshLoaded[meshIx] = true;
+		}
+		return context.Meshes[meshIx];
+	}
+
+	/// <summary>
+	/// Creates the game object for a node and all of it's children
+	/// </summary>
+	static GameObject::Sptr __ImportNode(__GltfImportContext& context, const Scene::Sptr& scene, int nodeIx, int depth) {
+		const tinygltf::Node& node = context.Model.nodes[nodeIx];
+		GameObject::Sptr result = scene->CreateGameObject(node.name.empty() ? "Node " + std::to_string(nodeIx) : node.name);
+
+		// Nodes either have a matrix or separate translation, rotation and scale
+		if (node.matrix.size() == 16) {
+			glm::mat4 transform;
+			for (int ix = 0; ix < 16; ix++) {
+				transform[ix / 4][ix % 4] = static_cast<float>(node.matrix[ix]);
+			}
+			glm::vec3 scale(glm::length(glm::vec3(transform[0])), glm::length(glm::vec3(transform[1])), glm::length(glm::vec3(transform[2])));
+			glm::mat3 rotation(glm::vec3(transform[0]) / scale.x, glm::vec3(transform[1]) / scale.y, glm::vec3(transform[2]) / scale.z);
+			result->SetPostion(glm::vec3(transform[3]));
+			result->SetRotation(glm::quat_cast(rotation));
+			result->SetScale(scale);
+		} else {
+			if (node.translation.size() == 3) {
+				result->SetPostion(glm::vec3(node.translation[0], node.translation[1], node.translation[2]));
+			}
+			if (node.rotation.size() == 4) {
+				// glTF stores quaternions as xyzw, GLM's constructor takes wxyz
+				result->SetRotation(glm::quat(static_cast<float>(node.rotation[3]), static_cast<float>(node.rotation[0]), static_cast<float>(node.rotation[1]), static_cast<float>(node.rotation[2])));
+			}
+			if (node.scale.size() == 3) {
+				result->SetScale(glm::vec3(node.scale[0], node.scale[1], node.scale[2]));
+			}
+		}
+
+		// A render component only holds one mesh, so meshes with multiple primitives get a child object for each
+		if (node.mesh >= 0 && node.mesh < (int)context.Model.meshes.size()) {
+			const auto& primitives = __GetMesh(context, node.mesh);
+			for (size_t ix = 0; ix < primitives.size(); ix++) {
+				GameObject::Sptr target = result;
+				if (primitives.size() > 1) {
+					target = scene->CreateGameObject(result->Name + " [" + std::to_string(ix) + "]");
+					result->AddChild(target);
+				}
+				RenderComponent::Sptr renderer = target->Add<RenderComponent>();
+				renderer->SetMesh(primitives[ix].first);
+				renderer->SetMaterial(__GetMaterial(context, primitives[ix].second));
+			}
+		}
+
+		// glTF doesn't allow cycles, but we guard against malformed files running us out of stack
+		if (depth < 256) {
+			for (int child : node.children) {
+				if (child >= 0 && child < (int)context.Model.nodes.size()) {
+					result->AddChild(__ImportNode(context, scene, child, depth + 1));
+				}
+			}
+		}
+
+		return result;
+	}
+
+	/// <summary>
+	/// tinygltf file system callback, so that glTF files and their buffers and images can be loaded from packs
+	/// </summary>
+	static bool __GltfFileExists(const std::string& filename, void*) {
+		return FileHelpers::Exists(filename);
+	}
+
+	/// <summary>
+	/// tinygltf file system callback, so that glTF files and their buffers and images can be loaded from packs
+	/// </summary>
+	static bool __GltfReadWholeFile(std::vector<unsigned char>* result, std::string* error, const std::string& filename, void*) {
+		VfsFile::Sptr file = VirtualFileSystem::Open(filename);
+		if (file == nullptr) {
+			if (error != nullptr) {
+				*error += "File open error : " + filename + "\n";
+			}
+			return false;
+		}
+		result->assign(file->GetData(), file->GetData() + file->GetSize());
+		return true;
+	}
+
+	GameObject::Sptr GltfImporter::ImportScene(const Scene::Sptr& scene, const std::string& filename, const GltfImportSettings& settings) {
+		std::string extension = fs::path(filename).extension().string();
+		StringTools::ToLower(extension);
+
+		// Texture2D flips images when loading from files, but glTF's UVs expect them as they are
+		stbi_set_flip_vertically_on_load(false);
+
+		tinygltf::Model model;
+		tinygltf::TinyGLTF loader;
+		tinygltf::FsCallbacks callbacks = { &__GltfFileExists, &tinygltf::ExpandFilePath, &__GltfReadWholeFile, &tinygltf::WriteWholeFile, nullptr };
+		loader.SetFsCallbacks(callbacks);
+		std::string error, warning;
+		bool loaded = extension == ".glb" ?
+			loader.LoadBinaryFromFile(&model, &error, &warning, filename) :
+			loader.LoadASCIIFromFile(&model, &error, &warning, filename);
+		if (!warning.empty()) {
+			LOG_WARN("glTF warnings in \"{}\": {}", filename, warning);
+		}
+		if (!loaded) {
+			LOG_ERROR("Failed to load glTF file \"{}\": {}", filename, error);
+			return nullptr;
+		}
+
+		__GltfImportContext context(model);
+		context.Shader = settings.Shader;
+		if (context.Shader == nullptr) {
+			context.Shader = ResourceManager::CreateAsset<ShaderProgram>(std::unordered_map<ShaderPartType, std::string>{
+				{ ShaderPartType::Vertex, "shaders/vertex_shaders/gltf.glsl" },
+				{ ShaderPartType::Fragment, "shaders/fragment_shaders/deferred_gltf.glsl" }
+			});
+			context.Shader->SetDebugName("glTF - GBuffer Generation");
+		}
+		context.White = __CreateSolidTexture(glm::vec3(1.0f));
+		context.FlatNormal = __CreateSolidTexture(glm::vec3(0.5f, 0.5f, 1.0f));
+		context.Materials.resize(model.materials.size());
+		context.Meshes.resize(model.meshes.size());
+		context.MeshLoaded.resize(model.meshes.size(), false);
+
+		GameObject::Sptr root = scene->CreateGameObject(fs::path(filename).stem().string());
+		if (settings.ConvertToZUp) {
+			root->SetRotation(glm::vec3(90.0f, 0.0f, 0.0f));
+		}
+
+		// Files without scenes are allowed, they're just a library of meshes and materials with nothing to place
+		int sceneIx = settings.SceneIndex >= 0 ? settings.SceneIndex : std::max(model.defaultScene, 0);
+		if (sceneIx < (int)model.scenes.size()) {
+			for (int nodeIx : model.scenes[sceneIx].nodes) {
+				if (nodeIx >= 0 && nodeIx < (int)model.nodes.size()) {
+					root->AddChild(__ImportNode(context, scene, nodeIx, 0));
+				}
+			}
+		} else if (!model.scenes.empty()) {
+			LOG_WARN("\"{}\" does not have a scene {}", filename, sceneIx);
+		}
+
+		LOG_INFO("Imported \"{}\" ({} nodes, {} meshes, {} materials, {} textures)", filename, model.nodes.size(), model.meshes.size(), model.materials.size(), context.Textures.size());
+		return root;
+	}
+}
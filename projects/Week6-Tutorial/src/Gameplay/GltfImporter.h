@@ -0,0 +1,47 @@
+#pragma once
+#include <string>
+
+#include "Gameplay/Scene.h"
+#include "Gameplay/MeshResource.h"
+#include "Gameplay/Material.h"
+#include "Graphics/ShaderProgram.h"
+
+namespace Gameplay {
+	/// <summary>
+	/// Controls how a glTF file is brought into a scene
+	/// </summary>
+	struct GltfImportSettings {
+		// The shader to create the materials with, or null to use the glTF shaders from res/shaders. The shader
+		// should take the u_Material uniforms declared in fragment_shaders/deferred_gltf.glsl
+		ShaderProgram::Sptr Shader        = nullptr;
+		// glTF scenes are Y-up, this rotates the root object so that they are Z-up like our scenes
+		bool                ConvertToZUp  = true;
+		// Which of the file's scenes to import, or -1 for the file's default scene
+		int                 SceneIndex    = -1;
+	};
+
+	/// <summary>
+	/// Imports glTF 2.0 scenes (both .gltf and .glb) into game objects, using tinygltf to parse the file
+	///
+	/// Each primitive becomes a MeshResource that keeps it's index buffer (as 16 or 32 bit indices), with
+	/// the vertex attributes uploaded straight from the file's buffer views. Meshes that are used by more
+	/// than one node, and buffer ranges that are used by more than one primitive, are only uploaded once.
+	/// Materials are made from the metallic-roughness parameters and textures, and the node tree becomes
+	/// a tree of game objects under a single root object
+	/// </summary>
+	class GltfImporter {
+	public:
+		/// <summary>
+		/// Imports a glTF file into a scene
+		/// </summary>
+		/// <param name="scene">The scene to create the game objects in</param>
+		/// <param name="filename">The path to the .gltf or .glb file to load</param>
+		/// <param name="settings">Controls how the file is imported</param>
+		/// <returns>The root object that all the file's nodes are parented to, or nullptr if the file failed to load</returns>
+		static GameObject::Sptr ImportScene(const Scene::Sptr& scene, const std::string& filename, const GltfImportSettings& settings = GltfImportSettings());
+
+	protected:
+		GltfImporter() = default;
+		~GltfImporter() = default;
+	};
+}
@@ -12,15 +12,26 @@ namespace Gameplay {
 	Material::Material(const ShaderProgram::Sptr& shader) :
 		IResource(),
 		_shader(shader),
-		_uniforms(std::unordered_map<std::string, UniformData>())
+		_uniforms(std::unordered_map<std::string, UniformData>()),
+		_keywords(),
+		_activeShader(nullptr),
+		_globalKeywordRevision(0),
+		_shaderRevision(shader != nullptr ? shader->GetRevision() : 0)
 	{
+		// Keywords usually enable features such as texture maps, so a new material has everything
+		// turned on until it's told otherwise
+		_EnableAllKeywords();
 		_PopulateUniforms();
 	}
 
 	Material::Material() :
 		IResource(),
 		_shader(nullptr),
-		_uniforms(std::unordered_map<std::string, UniformData>())
+		_uniforms(std::unordered_map<std::string, UniformData>()),
+		_keywords(),
+		_activeShader(nullptr),
+		_globalKeywordRevision(0),
+		_shaderRevision(0)
 	{ }
 
 	void Material::Set(const std::string& name, ShaderDataType type, const void* value, size_t arraySize)
@@ -60,8 +71,49 @@ namespace Gameplay {
 		return _shader;
 	}
 
+	void Material::SetKeyword(const std::string& keyword, bool enabled) {
+		if (enabled == HasKeyword(keyword)) {
+			return;
+		}
+		if (enabled) {
+			_keywords.insert(keyword);
+		} else {
+			_keywords.erase(keyword);
+		}
+		// We'll find the new variant the next time we need it
+		_activeShader = nullptr;
+	}
+
+	bool Material::HasKeyword(const std::string& keyword) const {
+		return _keywords.find(keyword) != _keywords.end();
+	}
+
+	const std::set<std::string>& Material::GetKeywords() const {
+		return _keywords;
+	}
+
+	ShaderProgram* Material::GetActiveShader() {
+		if (_shader != nullptr && (_activeShader == nullptr || _globalKeywordRevision != ShaderProgram::GetGlobalKeywordRevision())) {
+			_globalKeywordRevision = ShaderProgram::GetGlobalKeywordRevision();
+			ShaderProgram* variant = _shader->GetVariant(_shader->GetKeywordMask(_keywords) | _shader->GetGlobalKeywordMask());
+			if (variant != _activeShader) {
+				_activeShader = variant;
+				_RefreshUniformLocations();
+			}
+		}
+		return _activeShader;
+	}
+
 	void Material::Apply() {
-		if (_shader != nullptr) {
+		ShaderProgram* shader = GetActiveShader();
+		if (shader != nullptr) {
+			// If the shader has been hot-reloaded, our locations may be stale
+			if (shader->GetRevision() != _shaderRevision) {
+				_RefreshUniformLocations();
+			}
+
+			shader->Bind();
+
 			// Skip the reserved # of texture slots
 			int textureSlot = 0;
 			
@@ -85,13 +137,13 @@ namespace Gameplay {
 							ITexture::Unbind(textureSlot);
 						}
 						// Send the slot to the shader
-						_shader->SetUniform(data.Location, data.Type, &textureSlot);
+						shader->SetUniform(data.Location, data.Type, &textureSlot);
 						textureSlot++;
 					}
 				}
 				// The uniform is a plain ol' value type, send it in
 				else {
-					_shader->SetUniform(data.Location, data.Type, data.ArraySize > 1 ? data.ArrayBlock : data.Value, data.ArraySize);
+					shader->SetUniform(data.Location, data.Type, data.ArraySize > 1 ? data.ArrayBlock : data.Value, data.ArraySize);
 				}
 			}
 		}
@@ -106,6 +158,24 @@ namespace Gameplay {
 
 		if (open) {
 			ImGui::Text("Shader: %s", _shader != nullptr ? _shader->GetDebugName().c_str() : "null");
+
+			// Allow toggling any feature keywords the shader has
+			if (_shader != nullptr && !_shader->GetKeywords().empty()) {
+				ImGui::Text("Keywords (%d/%d variants):", _shader->GetVariantCount(), ShaderProgram::MaxVariants);
+				ImGui::Indent();
+				for (const std::string& keyword : _shader->GetKeywords()) {
+					// Global keywords are controlled by the render layer
+					if (_shader->IsGlobalKeyword(keyword)) {
+						continue;
+					}
+					bool enabled = HasKeyword(keyword);
+					if (ImGui::Checkbox(keyword.c_str(), &enabled)) {
+						SetKeyword(keyword, enabled);
+					}
+				}
+				ImGui::Unindent();
+			}
+
 			// Draw all of our valid uniforms
 			for (auto&[key, value] : _uniforms) {
 				if (value.Location != -2 && value.Location != -1) {
@@ -132,14 +202,24 @@ namespace Gameplay {
 		result->OverrideGUID(Guid(data["guid"]));
 		result->Name = data["name"].get<std::string>();
 		result->_shader = ResourceManager::Get<ShaderProgram>(Guid(data["shader"]));
-		result->_PopulateUniforms();
+		if (data.contains("keywords") && data["keywords"].is_array()) {
+			for (const auto& keyword : data["keywords"]) {
+				result->_keywords.insert(keyword.get<std::string>());
+			}
+		}
+		// Materials that were saved before the shader had keywords expect all of it's features
+		else {
+			result->_EnableAllKeywords();
+		}
+		// Resolving the active shader will also populate our uniforms
+		result->GetActiveShader();
 
 		// material specific parameters'
 		if (data.contains("parameters") && data["parameters"].is_object()) {
 			// Iterate over all objects
 			for (auto& [key, value] : data["parameters"].items()) {
 				// Try loading a uniform from the blob, if successful, store it
-				Material::UniformData uniform = Material::UniformData::FromJson(value, key, result->_shader);
+				Material::UniformData uniform = Material::UniformData::FromJson(value, key, result->_activeShader);
 				if (uniform.Location != -2) {
 					result->_uniforms[key] = uniform;
 				}
@@ -153,12 +233,13 @@ namespace Gameplay {
 			{ "guid", GetGUID().str() },
 			{ "name", Name },
 			{ "shader", _shader ? _shader->GetGUID().str() : "null" },
+			{ "keywords", _keywords },
 			{ "parameters", nlohmann::json() }
 		};
 
-		// Store all the uniforms
+		// Store all the uniforms, including ones that may not be in our current variant
 		for (auto& [key, value] : _uniforms) {
-			if (value.Location != -1) {
+			if (value.Type != ShaderDataType::None) {
 				result["parameters"][key] = value.ToJson();
 			}
 		}
@@ -169,15 +250,16 @@ namespace Gameplay {
 	Material::UniformData& Material::_GetUniform(const std::string& name)
 	{
 		UniformData& data = _uniforms[name];
-		if (data.Location == -2) {
+		ShaderProgram* shader = GetActiveShader();
+		if (data.Location == -2 && shader != nullptr) {
 			ShaderProgram::UniformInfo uniform;
-			if (_shader->FindUniform(name, &uniform)) {
+			if (shader->FindUniform(name, &uniform)) {
 				// Ignoring our reserved textures
 				if (GetShaderDataTypeCode(uniform.Type) == ShaderDataTypecode::Texture && uniform.Binding >= MAX_TEXTURE_SLOTS) {
 					data.Location = -1;
 				}
 				else {
-					data = UniformData(name, _shader);
+					data = UniformData(name, shader);
 				}
 			} else {
 				data.Location = -1;
@@ -188,12 +270,55 @@ namespace Gameplay {
 
 	void Material::_PopulateUniforms()
 	{
-		const auto& uniforms = _shader->GetUniforms();
+		ShaderProgram* shader = GetActiveShader();
+		if (shader == nullptr) {
+			return;
+		}
+		const auto& uniforms = shader->GetUniforms();
 		for (const auto& [key, value] : uniforms) {
 			_uniforms[key] = _GetUniform(key);
 		}
 	}
 
+	void Material::_EnableAllKeywords()
+	{
+		if (_shader == nullptr) {
+			return;
+		}
+		for (const std::string& keyword : _shader->GetKeywords()) {
+			if (!_shader->IsGlobalKeyword(keyword)) {
+				_keywords.insert(keyword);
+			}
+		}
+		_activeShader = nullptr;
+	}
+
+	void Material::_RefreshUniformLocations()
+	{
+		for (auto& [name, data] : _uniforms) {
+			// Uniforms that we've never resolved will be looked up as needed
+			if (data.Location == -2) {
+				continue;
+			}
+			// Uniforms that we never found may exist in the new shader, so we flag them to be looked up again
+			if (data.Type == ShaderDataType::None) {
+				data.Location = -2;
+				continue;
+			}
+
+			ShaderProgram::UniformInfo uniform;
+			if (_activeShader->FindUniform(name, &uniform) && uniform.Type == data.Type && (size_t)uniform.ArraySize == data.ArraySize) {
+				data.Location = uniform.Location;
+			} else {
+				data.Location = -1;
+			}
+		}
+
+		// Pick up any uniforms that were added to the shader
+		_PopulateUniforms();
+		_shaderRevision = _activeShader->GetRevision();
+	}
+
 	bool Material::UniformData::RenderImGui() {
 		ImGui::PushID(Name.c_str());
 
@@ -395,7 +520,7 @@ namespace Gameplay {
 		return *this;
 	}
 
-	Material::UniformData::UniformData(const std::string& uniformName, const ShaderProgram::Sptr& shader) :
+	Material::UniformData::UniformData(const std::string& uniformName, ShaderProgram* shader) :
 		TextureAsset(nullptr)
 	{
 		// We extract the uniform info from the shader to populate our info
@@ -634,7 +759,7 @@ namespace Gameplay {
 		return result;
 	}
 
-	Material::UniformData Material::UniformData::FromJson(const nlohmann::json& blob, const std::string& name, const ShaderProgram::Sptr& shader) {
+	Material::UniformData Material::UniformData::FromJson(const nlohmann::json& blob, const std::string& name, ShaderProgram* shader) {
 		ShaderDataType type = ParseShaderDataType(JsonGet<std::string>(blob, "type"), ShaderDataType::None);
 		if (type == ShaderDataType::None) {
 			return Material::UniformData();
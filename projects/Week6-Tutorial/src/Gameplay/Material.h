@@ -1,5 +1,6 @@
 #pragma once
 #include <memory>
+#include <set>
 #include "Graphics/ShaderProgram.h"
 #include "Graphics/Textures/ITexture.h"
 
@@ -60,6 +61,29 @@ namespace Gameplay {
 		/// </summary>
 		const ShaderProgram::Sptr& GetShader() const;
 
+		/// <summary>
+		/// Enables or disables a shader feature keyword for this material. The material will
+		/// render with the shader variant that has all of it's keywords #defined. New materials
+		/// start with all of the shader's keywords enabled
+		/// </summary>
+		/// <param name="keyword">The keyword to toggle, should be declared by the shader</param>
+		/// <param name="enabled">True to enable the keyword, false to disable it</param>
+		void SetKeyword(const std::string& keyword, bool enabled = true);
+		/// <summary>
+		/// Returns true if the given shader feature keyword is enabled for this material
+		/// </summary>
+		bool HasKeyword(const std::string& keyword) const;
+		/// <summary>
+		/// Gets all the shader feature keywords that this material has enabled
+		/// </summary>
+		const std::set<std::string>& GetKeywords() const;
+
+		/// <summary>
+		/// Gets the shader variant that matches this material's keywords and the enabled global
+		/// keywords, compiling it if this is the first time it has been requested
+		/// </summary>
+		ShaderProgram* GetActiveShader();
+
 		/// <summary>
 		/// Handles applying this material's state to the OpenGL pipeline
 		/// Will bind the shader, update material uniforms, and bind textures
@@ -124,7 +148,7 @@ namespace Gameplay {
 			UniformData(UniformData&& other);
 			UniformData& operator=(const UniformData& other);
 			UniformData& operator=(UniformData&& other) noexcept;
-			UniformData(const std::string& uniformName, const ShaderProgram::Sptr& shader);
+			UniformData(const std::string& uniformName, ShaderProgram* shader);
 			~UniformData();
 
 			/// <summary>
@@ -140,7 +164,7 @@ namespace Gameplay {
 			/// Parses a uniform information structure from a JSON blob
 			/// </summary>
 			/// <param name="blob">The JSON blob to parse</param>
-			static UniformData FromJson(const nlohmann::json& blob, const std::string& name, const ShaderProgram::Sptr& shader);
+			static UniformData FromJson(const nlohmann::json& blob, const std::string& name, ShaderProgram* shader);
 
 			template <typename T>
 			T& Get() {
@@ -174,8 +198,34 @@ namespace Gameplay {
 		/// The uniforms that the material will be modifying
 		/// </summary>
 		std::unordered_map<std::string, UniformData> _uniforms;
+		/// <summary>
+		/// The shader feature keywords that this material enables
+		/// </summary>
+		std::set<std::string> _keywords;
+		/// <summary>
+		/// The variant of _shader that matches our keywords, resolved when first needed
+		/// </summary>
+		ShaderProgram* _activeShader;
+		/// <summary>
+		/// The global keyword revision that _activeShader was selected with
+		/// </summary>
+		uint32_t _globalKeywordRevision;
+		/// <summary>
+		/// The revision of the shader that our uniform locations were looked up from
+		/// </summary>
+		uint32_t _shaderRevision;
 
 		UniformData& _GetUniform(const std::string& name);
 		void _PopulateUniforms();
+		/// <summary>
+		/// Enables all of the feature keywords that our shader declares, excluding global keywords
+		/// </summary>
+		void _EnableAllKeywords();
+		/// <summary>
+		/// Re-resolves our uniform locations after the shader has been reloaded or we have
+		/// switched to another variant, keeping
+		/// the values of all uniforms that still exist with the same type
+		/// </summary>
+		void _RefreshUniformLocations();
 	};
 }
\ No newline at end of file
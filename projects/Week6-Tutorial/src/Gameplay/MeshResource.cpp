@@ -1,25 +1,41 @@
 #include "MeshResource.h"
 #include <filesystem>
+#include <algorithm>
 
-#include "Utils/ObjLoader.h"
+#include "Utils/OptimizedObjLoader.h"
+#include "Utils/FileHelpers.h"
 
 namespace Gameplay {
 	MeshResource::MeshResource() :
 		IResource(),
+		IGpuEvictable(),
 		Filename(""),
 		MeshBuilderParams(std::vector<MeshBuilderParam>()),
 		Mesh(nullptr),
-		BulletTriMesh(nullptr)
+		Lods(),
+		BoundingSphere(0.0f),
+		BoundsMin(0.0f),
+		BoundsMax(0.0f),
+		Submeshes(),
+		BulletTriMesh(nullptr),
+		_isFileBacked(false)
 	{ }
 
 	MeshResource::MeshResource(const std::string& filename) :
 		IResource(),
+		IGpuEvictable(),
 		Filename(filename),
 		MeshBuilderParams(std::vector<MeshBuilderParam>()),
 		Mesh(nullptr),
-		BulletTriMesh(nullptr)
+		Lods(),
+		BoundingSphere(0.0f),
+		BoundsMin(0.0f),
+		BoundsMax(0.0f),
+		Submeshes(),
+		BulletTriMesh(nullptr),
+		_isFileBacked(false)
 	{
-		Mesh = ObjLoader::LoadFromFile(filename);
+		_LoadFromFile();
 	}
 
 	MeshResource::~MeshResource() = default;
@@ -54,13 +70,8 @@ namespace Gameplay {
 			result->Mesh = mesh.Bake();
 		} else {
 			result->Filename = JsonGet<std::string>(blob, "filename", "null");
-			if (result->Filename != "null" && std::filesystem::exists(result->Filename)) {
-				#ifdef OPTIMIZED_OBJ_LOADER
-				result->Mesh = OptimizedObjLoader::LoadFromFile(result->Filename);
-				#else
-				result->Mesh = ObjLoader::LoadFromFile(result->Filename);
-				#endif
-
+			if (result->Filename != "null" && FileHelpers::Exists(result->Filename)) {
+				result->_LoadFromFile();
 			}
 		}
 		return result;
@@ -73,9 +84,87 @@ namespace Gameplay {
 		}
 		MeshFactory::CalculateTBN(mesh);
 		Mesh = mesh.Bake();
+		Lods.clear();
+		Submeshes.clear();
+		_isFileBacked = false;
 	}
 
 	void MeshResource::AddParam(const MeshBuilderParam & param) {
 		MeshBuilderParams.push_back(param);
 	}
+
+	const VertexArrayObject::Sptr& MeshResource::GetLod(uint32_t level) const {
+		_MarkUsed();
+		return (level == 0 || level > Lods.size()) ? Mesh : Lods[level - 1].Mesh;
+	}
+
+	uint32_t MeshResource::SelectLod(float pixelRadius, uint32_t current, float pixelError, float hysteresis) const {
+		uint32_t result = 0;
+		for (uint32_t level = 1; level <= Lods.size(); level++) {
+			float tolerance = pixelError * (level <= current ? 1.0f + hysteresis : 1.0f - hysteresis);
+			// Errors only go up as we go down the chain, so the first level that's too coarse ends the search
+			if (Lods[level - 1].Error * pixelRadius > tolerance) {
+				break;
+			}
+			result = level;
+		}
+		return result;
+	}
+
+	void MeshResource::_LoadFromFile() {
+		MeshFileInfo info;
+		Mesh = OptimizedObjLoader::LoadFromFile(Filename, &info);
+		Lods = std::move(info.Lods);
+		Submeshes = std::move(info.Submeshes);
+		BoundingSphere = info.BoundingSphere;
+		BoundsMin = info.BoundsMin;
+		BoundsMax = info.BoundsMax;
+		_isFileBacked = Mesh != nullptr;
+	}
+
+	bool MeshResource::_CanEvict() const {
+		return _isFileBacked && Mesh != nullptr;
+	}
+
+	uint64_t MeshResource::_GetEvictableSize() const {
+		// LODs usually share their vertex buffers with the full detail mesh, so we make sure to only count each buffer once
+		std::vector<const IBuffer*> buffers;
+		auto addBuffers = [&](const VertexArrayObject::Sptr& vao) {
+			if (vao == nullptr) {
+				return;
+			}
+			if (vao->GetIndexBuffer() != nullptr) {
+				buffers.push_back(vao->GetIndexBuffer().get());
+			}
+			for (const auto* binding : vao->GetVertexBuffers()) {
+				buffers.push_back(binding->GetBuffer().get());
+			}
+		};
+		addBuffers(Mesh);
+		for (const MeshLod& lod : Lods) {
+			addBuffers(lod.Mesh);
+		}
+		std::sort(buffers.begin(), buffers.end());
+		buffers.erase(std::unique(buffers.begin(), buffers.end()), buffers.end());
+
+		uint64_t result = 0;
+		for (const IBuffer* buffer : buffers) {
+			result += buffer != nullptr ? buffer->GetGpuMemoryUsage() : 0;
+		}
+		return result;
+	}
+
+	void MeshResource::_OnEvict() {
+		// Dropping our VAOs releases their buffers, unless someone else is still holding on to them. We keep the
+		// LOD list around so that LOD selection still works, GetLod will bring the meshes back
+		Mesh = nullptr;
+		for (MeshLod& lod : Lods) {
+			lod.Mesh = nullptr;
+		}
+	}
+
+	void MeshResource::_OnReload() {
+		// The mesh will come out of the import cache, so this is just mapping the binary mesh back in
+		_LoadFromFile();
+	}
 }
\ No newline at end of file
@@ -1,7 +1,10 @@
 #pragma once
 #include "Utils/ResourceManager/IResource.h"
 #include "Graphics/VertexArrayObject.h"
+#include "Graphics/GpuMemory.h"
 #include "Utils/MeshFactory.h"
+#include "Utils/MeshSimplifier.h"
+#include "Utils/OptimizedObjLoader.h"
 
 // bullet triangle mesh pre-declaration
 class btTriangleMesh;
@@ -11,8 +14,11 @@ namespace Gameplay {
 	/// A mesh resource contains information on how to generate a VAO at runtime
 	/// It can either load a VAO from a file, or generate one using the mesh 
 	/// factory and MeshBuilderParams
+	/// 
+	/// Meshes loaded from files can be evicted when we are over our GPU memory budget, which releases
+	/// Mesh and the LODs until the next time GetLod is called
 	/// </summary>
-	class MeshResource : public IResource {
+	class MeshResource : public IResource, public IGpuEvictable {
 	public:
 		typedef std::shared_ptr<MeshResource> Sptr;
 
@@ -40,6 +46,25 @@ namespace Gameplay {
 		/// The VAO for rendering this mesh in OpenGL
 		/// </summary>
 		VertexArrayObject::Sptr         Mesh;
+		/// <summary>
+		/// Simplified versions of Mesh for drawing at a distance, from most to least detailed. Level 0 is
+		/// always Mesh itself, so this holds levels 1 and up. Only meshes loaded from files have LODs
+		/// </summary>
+		std::vector<MeshLod>            Lods;
+		/// <summary>
+		/// The sphere enclosing the mesh in model space, as center (xyz) and radius (w)
+		/// </summary>
+		glm::vec4                       BoundingSphere;
+		/// <summary>
+		/// The box enclosing the mesh in model space
+		/// </summary>
+		glm::vec3                       BoundsMin;
+		glm::vec3                       BoundsMax;
+		/// <summary>
+		/// The ranges of the mesh's triangles that share a material, with their index ranges in each level of
+		/// detail and their own bounds. Only meshes loaded from files have submeshes
+		/// </summary>
+		std::vector<Submesh>            Submeshes;
 
 
 		/// <summary>
@@ -61,9 +86,45 @@ namespace Gameplay {
 		/// <param name="param">The parameter to add</param>
 		void AddParam(const MeshBuilderParam& param);
 
+		/// <summary>
+		/// Gets the number of levels of detail this mesh has, including the full detail mesh
+		/// </summary>
+		uint32_t GetLodCount() const { return static_cast<uint32_t>(Lods.size()) + 1; }
+		/// <summary>
+		/// Gets the VAO for the given level of detail, where 0 is the full detail mesh. This will reload the
+		/// mesh if it has been evicted, so prefer this to using Mesh directly
+		/// </summary>
+		const VertexArrayObject::Sptr& GetLod(uint32_t level) const;
+		/// <summary>
+		/// Picks the least detailed level whose error would cover less than pixelError pixels on screen
+		/// 
+		/// To stop objects sitting right at a threshold from flickering between levels, levels coarser than
+		/// the current one have to be within pixelError * (1 - hysteresis), while the current level and finer
+		/// ones can stay up to pixelError * (1 + hysteresis)
+		/// </summary>
+		/// <param name="pixelRadius">The radius of the bounding sphere on screen, in pixels</param>
+		/// <param name="current">The level the object was drawn with last</param>
+		/// <param name="pixelError">How many pixels of error we can accept</param>
+		/// <param name="hysteresis">How far past the threshold we need to be before changing levels, in the 0-1 range</param>
+		uint32_t SelectLod(float pixelRadius, uint32_t current, float pixelError, float hysteresis) const;
+
 		// Inherited from IResource
 
 		virtual nlohmann::json ToJson() const override;
 		static MeshResource::Sptr FromJson(const nlohmann::json& blob);
+
+	protected:
+		// True if Mesh was loaded from Filename, and can be loaded again after being evicted
+		bool _isFileBacked;
+
+		// Loads the mesh and it's LODs from Filename
+		void _LoadFromFile();
+
+		// Inherited from IGpuEvictable
+
+		virtual bool _CanEvict() const override;
+		virtual uint64_t _GetEvictableSize() const override;
+		virtual void _OnEvict() override;
+		virtual void _OnReload() override;
 	};
 }
\ No newline at end of file
@@ -62,7 +62,7 @@ namespace Gameplay::Physics {
 		// We need to calculate the triangle mesh from the mesh data
 		else {
 			// Get the VAO from the mesh and make sure it exists
-			VertexArrayObject::Sptr vao = mesh->Mesh;
+			VertexArrayObject::Sptr vao = mesh->GetLod(0);
 			if (vao == nullptr) {
 				LOG_WARN("Mesh resource not fully configured!");
 				return;
@@ -3,6 +3,7 @@
 #include "Gameplay/Physics/ICollider.h"
 
 class btTransform;
+class btCollisionObject;
 
 namespace Gameplay {
 	class Scene;
@@ -87,6 +88,9 @@ namespace Gameplay {
 
 			virtual void Awake() = 0;
 		protected:
+			// The scene removes physics objects in bulk when deleting game objects
+			friend class Gameplay::Scene;
+
 			Scene*        _scene;
 
 			// Stores the bullet shape associated with the physics object
@@ -124,6 +128,8 @@ namespace Gameplay {
 
 			// Gets the bullet broadphase proxy that we can use for clearing collisions
 			virtual btBroadphaseProxy* _GetBroadphaseHandle() = 0;
+			// Gets the bullet object that we add to the world, so the scene can remove them in bulk
+			virtual btCollisionObject* _GetCollisionObject() = 0;
 
 			static int _editorSelectedColliderType;
 		};
@@ -0,0 +1,92 @@
+#include "Gameplay/Physics/PhysicsWorld.h"
+
+namespace Gameplay::Physics {
+	/// <summary>
+	/// Flags all pairs that contain one of the given proxies for removal
+	/// </summary>
+	struct __RemovePairsCallback : public btOverlapCallback {
+		const std::unordered_set<btBroadphaseProxy*>& Proxies;
+
+		__RemovePairsCallback(const std::unordered_set<btBroadphaseProxy*>& proxies) :
+			Proxies(proxies)
+		{ }
+
+		virtual bool processOverlap(btBroadphasePair& pair) override {
+			return Proxies.count(pair.m_pProxy0) > 0 || Proxies.count(pair.m_pProxy1) > 0;
+		}
+	};
+
+	BatchedPairCache::BatchedPairCache() :
+		btHashedOverlappingPairCache(),
+		_skipProxyCleanup(false)
+	{ }
+
+	void BatchedPairCache::RemovePairsContaining(const std::unordered_set<btBroadphaseProxy*>& proxies, btDispatcher* dispatcher) {
+		if (proxies.empty()) {
+			return;
+		}
+		// Removing through the cache also lets the ghost pair callback know, so trigger volumes stay up to date
+		__RemovePairsCallback callback(proxies);
+		processAllOverlappingPairs(&callback, dispatcher);
+	}
+
+	void BatchedPairCache::cleanProxyFromPairs(btBroadphaseProxy* proxy, btDispatcher* dispatcher) {
+		if (!_skipProxyCleanup) {
+			btHashedOverlappingPairCache::cleanProxyFromPairs(proxy, dispatcher);
+		}
+	}
+
+	void BatchedPairCache::removeOverlappingPairsContainingProxy(btBroadphaseProxy* proxy, btDispatcher* dispatcher) {
+		if (!_skipProxyCleanup) {
+			btHashedOverlappingPairCache::removeOverlappingPairsContainingProxy(proxy, dispatcher);
+		}
+	}
+
+	PhysicsWorld::PhysicsWorld(btDispatcher* dispatcher, btBroadphaseInterface* broadphase, BatchedPairCache* pairCache, btConstraintSolver* solver, btCollisionConfiguration* config) :
+		btDiscreteDynamicsWorld(dispatcher, broadphase, solver, config),
+		_pairCache(pairCache)
+	{ }
+
+	void PhysicsWorld::RemoveObjects(const std::vector<btCollisionObject*>& objects) {
+		// Gather everything that's actually in the world, objects always have a proxy while they are in the world
+		std::unordered_set<btBroadphaseProxy*> proxies;
+		std::unordered_set<btRigidBody*> bodies;
+		proxies.reserve(objects.size());
+		for (btCollisionObject* object : objects) {
+			if (object != nullptr && object->getBroadphaseHandle() != nullptr) {
+				proxies.insert(object->getBroadphaseHandle());
+				btRigidBody* body = btRigidBody::upcast(object);
+				if (body != nullptr) {
+					bodies.insert(body);
+				}
+			}
+		}
+		if (proxies.empty()) {
+			return;
+		}
+
+		// Strip all the pairs in one pass, so removing each proxy doesn't need to search the whole cache
+		_pairCache->RemovePairsContaining(proxies, m_dispatcher1);
+
+		// The collision world tracks each object's index in it's array, so these are constant time once
+		// the pair cleanup is skipped. We skip btDiscreteDynamicsWorld::removeRigidBody since it does a
+		// linear search of the non static bodies, and compact that list once at the end instead
+		_pairCache->SetSkipProxyCleanup(true);
+		for (btCollisionObject* object : objects) {
+			if (object != nullptr && object->getBroadphaseHandle() != nullptr) {
+				btCollisionWorld::removeCollisionObject(object);
+			}
+		}
+		_pairCache->SetSkipProxyCleanup(false);
+
+		if (!bodies.empty()) {
+			int count = 0;
+			for (int ix = 0; ix < m_nonStaticRigidBodies.size(); ix++) {
+				if (bodies.count(m_nonStaticRigidBodies[ix]) == 0) {
+					m_nonStaticRigidBodies[count++] = m_nonStaticRigidBodies[ix];
+				}
+			}
+			m_nonStaticRigidBodies.resize(count);
+		}
+	}
+}
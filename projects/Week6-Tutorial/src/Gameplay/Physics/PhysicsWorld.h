@@ -0,0 +1,64 @@
+#pragma once
+#include <vector>
+#include <unordered_set>
+#include <btBulletDynamicsCommon.h>
+
+namespace Gameplay::Physics {
+	/// <summary>
+	/// A hashed pair cache that can skip the per-proxy pair cleanup that Bullet does when removing
+	/// objects. Bullet searches every overlapping pair for each object it removes, which is what makes
+	/// removing lots of objects at once slow, so the world removes all the pairs for a batch in a single
+	/// pass first, and then removes the objects with cleanup disabled
+	/// </summary>
+	ATTRIBUTE_ALIGNED16(class) BatchedPairCache : public btHashedOverlappingPairCache {
+	public:
+		BT_DECLARE_ALIGNED_ALLOCATOR();
+
+		BatchedPairCache();
+		virtual ~BatchedPairCache() = default;
+
+		/// <summary>
+		/// Removes all pairs that contain any of the given proxies, in a single pass over the cache
+		/// </summary>
+		/// <param name="proxies">The proxies to remove the pairs for</param>
+		/// <param name="dispatcher">The dispatcher that owns the pairs' collision algorithms</param>
+		void RemovePairsContaining(const std::unordered_set<btBroadphaseProxy*>& proxies, btDispatcher* dispatcher);
+
+		/// <summary>
+		/// Enables or disables skipping the pair cleanup when proxies are removed, this should only be
+		/// enabled while removing proxies that have already had their pairs removed
+		/// </summary>
+		void SetSkipProxyCleanup(bool value) { _skipProxyCleanup = value; }
+
+		// Inherited from btHashedOverlappingPairCache
+
+		virtual void cleanProxyFromPairs(btBroadphaseProxy* proxy, btDispatcher* dispatcher) override;
+		virtual void removeOverlappingPairsContainingProxy(btBroadphaseProxy* proxy, btDispatcher* dispatcher) override;
+
+	protected:
+		bool _skipProxyCleanup;
+	};
+
+	/// <summary>
+	/// Extends the Bullet dynamics world with a way to remove many objects at once, in time that
+	/// scales with the number of objects removed instead of the number of objects times the size
+	/// of the world
+	/// </summary>
+	ATTRIBUTE_ALIGNED16(class) PhysicsWorld : public btDiscreteDynamicsWorld {
+	public:
+		BT_DECLARE_ALIGNED_ALLOCATOR();
+
+		PhysicsWorld(btDispatcher* dispatcher, btBroadphaseInterface* broadphase, BatchedPairCache* pairCache, btConstraintSolver* solver, btCollisionConfiguration* config);
+		virtual ~PhysicsWorld() = default;
+
+		/// <summary>
+		/// Removes a batch of collision objects and rigid bodies from the world. Objects that are not
+		/// in the world are ignored. The objects are not deleted
+		/// </summary>
+		/// <param name="objects">The objects to remove</param>
+		void RemoveObjects(const std::vector<btCollisionObject*>& objects);
+
+	protected:
+		BatchedPairCache* _pairCache;
+	};
+}
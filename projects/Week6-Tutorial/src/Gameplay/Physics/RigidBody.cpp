@@ -32,8 +32,10 @@ namespace Gameplay::Physics {
 
 	RigidBody::~RigidBody() {
 		if (_body != nullptr) {
-			// Remove from the physics world
-			_scene->GetPhysicsWorld()->removeRigidBody(_body);
+			// Remove from the physics world, unless the scene has already removed us
+			if (_body->getBroadphaseHandle() != nullptr) {
+				_scene->GetPhysicsWorld()->removeRigidBody(_body);
+			}
 
 			// Clean up all our memory
 			delete _motionState;
@@ -342,5 +344,9 @@ namespace Gameplay::Physics {
 		return _body != nullptr ? _body->getBroadphaseProxy() : nullptr;
 	}
 
+	btCollisionObject* RigidBody::_GetCollisionObject() {
+		return _body;
+	}
+
 }
 
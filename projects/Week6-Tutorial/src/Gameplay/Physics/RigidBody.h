@@ -202,5 +202,6 @@ namespace Gameplay::Physics {
 		void _HandleStateDirty();
 
 		virtual btBroadphaseProxy* _GetBroadphaseHandle() override;
+		virtual btCollisionObject* _GetCollisionObject() override;
 	};
 }
\ No newline at end of file
@@ -18,7 +18,10 @@ namespace Gameplay::Physics {
 
 	TriggerVolume::~TriggerVolume() {
 		if (_ghost != nullptr) {
-			_scene->GetPhysicsWorld()->removeCollisionObject(_ghost);
+			// Remove from the physics world, unless the scene has already removed us
+			if (_ghost->getBroadphaseHandle() != nullptr) {
+				_scene->GetPhysicsWorld()->removeCollisionObject(_ghost);
+			}
 			delete _ghost;
 		}
 	}
@@ -195,6 +198,10 @@ namespace Gameplay::Physics {
 		return _ghost != nullptr ? _ghost->getBroadphaseHandle() : nullptr;
 	}
 
+	btCollisionObject* TriggerVolume::_GetCollisionObject() {
+		return _ghost;
+	}
+
 	void TriggerVolume::SetFlags(TriggerTypeFlags flags) {
 		_typeFlags = flags;
 	}
@@ -9,6 +9,7 @@
 
 #include "Gameplay/Physics/RigidBody.h"
 #include "Gameplay/Physics/TriggerVolume.h"
+#include "Gameplay/Physics/PhysicsWorld.h"
 #include "Gameplay/MeshResource.h"
 #include "Gameplay/Material.h"
 
@@ -21,6 +22,10 @@ namespace Gameplay {
 	Scene::Scene() :
 		_objects(std::vector<GameObject::Sptr>()),
 		_deletionQueue(std::vector<std::weak_ptr<GameObject>>()),
+		_objectsByGuid(),
+		_objectsByName(),
+		_tagNames(),
+		_tagIndices(),
 		IsPlaying(false),
 		IsDestroyed(false),
 		MainCamera(nullptr),
@@ -47,7 +52,7 @@ namespace Gameplay {
 		_skyboxShader = nullptr;
 		_skyboxMesh = nullptr;
 		_skyboxTexture = nullptr;
-		_objects.clear();
+		_ClearObjects();
 		_components.Clear();
 		_CleanupPhysics();
 		IsDestroyed = true;
@@ -97,13 +102,15 @@ namespace Gameplay {
 	{
 		GameObject::Sptr result(new GameObject());
 		result->Name = name;
-		result->_scene = this;
-		result->_selfRef = result;
-		_objects.push_back(result);
+		_AddObject(result);
 		return result;
 	}
 
 	void Scene::RemoveGameObject(const GameObject::Sptr& object) {
+		if (object == nullptr || object->_isPendingDelete) {
+			return;
+		}
+		object->_isPendingDelete = true;
 		_deletionQueue.push_back(object);
 		for (const auto& child : object->_children) {
 			RemoveGameObject(child);
@@ -111,17 +118,88 @@ namespace Gameplay {
 	}
 
 	GameObject::Sptr Scene::FindObjectByName(const std::string name) const {
-		auto it = std::find_if(_objects.begin(), _objects.end(), [&](const GameObject::Sptr& obj) {
-			return obj->Name == name;
-		});
-		return it == _objects.end() ? nullptr : *it;
+		auto range = _objectsByName.equal_range(name);
+		for (auto it = range.first; it != range.second; it++) {
+			// Skip objects that had their name changed directly instead of through SetName
+			if (it->second->Name == name) {
+				return it->second->SelfRef();
+			}
+		}
+		return nullptr;
+	}
+
+	std::vector<GameObject::Sptr> Scene::FindObjectsByName(const std::string& name) const {
+		std::vector<GameObject::Sptr> result;
+		auto range = _objectsByName.equal_range(name);
+		for (auto it = range.first; it != range.second; it++) {
+			if (it->second->Name == name) {
+				result.push_back(it->second->SelfRef());
+			}
+		}
+		return result;
 	}
 
 	GameObject::Sptr Scene::FindObjectByGUID(Guid id) const {
-		auto it = std::find_if(_objects.begin(), _objects.end(), [&](const GameObject::Sptr& obj) {
-			return obj->_guid == id;
-		});
-		return it == _objects.end() ? nullptr : *it;
+		auto it = _objectsByGuid.find(id);
+		return it == _objectsByGuid.end() ? nullptr : it->second->SelfRef();
+	}
+
+	int Scene::RegisterTag(const std::string& tag) {
+		auto it = _tagIndices.find(tag);
+		if (it != _tagIndices.end()) {
+			return it->second;
+		}
+		if (_tagNames.size() >= GameObject::MAX_TAGS) {
+			return -1;
+		}
+		uint8_t index = static_cast<uint8_t>(_tagNames.size());
+		_tagNames.push_back(tag);
+		_tagIndices[tag] = index;
+		return index;
+	}
+
+	int Scene::GetTagIndex(const std::string& tag) const {
+		auto it = _tagIndices.find(tag);
+		return it == _tagIndices.end() ? -1 : it->second;
+	}
+
+	const std::string& Scene::GetTagName(int index) const {
+		return _tagNames[index];
+	}
+
+	GameObject::TagSet Scene::MakeTagSet(const std::vector<std::string>& tags) {
+		GameObject::TagSet result;
+		for (const std::string& tag : tags) {
+			int index = RegisterTag(tag);
+			if (index >= 0) {
+				result.set(index);
+			}
+		}
+		return result;
+	}
+
+	std::vector<GameObject::Sptr> Scene::FindObjectsWithTags(const GameObject::TagSet& tags, LayerMask layers) const {
+		std::vector<GameObject::Sptr> result;
+		for (const auto& obj : _objects) {
+			if ((obj->_tags & tags) == tags && (obj->GetLayerMask() & layers) != 0) {
+				result.push_back(obj);
+			}
+		}
+		return result;
+	}
+
+	std::vector<GameObject::Sptr> Scene::FindObjectsWithTag(const std::string& tag, LayerMask layers) const {
+		int index = GetTagIndex(tag);
+		if (index < 0) {
+			return std::vector<GameObject::Sptr>();
+		}
+		GameObject::TagSet tags;
+		tags.set(index);
+		return FindObjectsWithTags(tags, layers);
+	}
+
+	std::vector<GameObject::Sptr> Scene::FindObjectsOnLayers(LayerMask layers) const {
+		return FindObjectsWithTags(GameObject::TagSet(), layers);
 	}
 
 	void Scene::SetAmbientLight(const glm::vec3& value) {
@@ -213,7 +291,7 @@ namespace Gameplay {
 
 		Scene::Sptr result = std::make_shared<Scene>();
 		result->MainCamera = nullptr;
-		result->_objects.clear();
+		result->_ClearObjects();
 		result->DefaultMaterial = ResourceManager::Get<Material>(Guid(data["default_material"]));
 
 		if (data.contains("ambient")) {
@@ -232,10 +310,8 @@ namespace Gameplay {
 		LOG_ASSERT(data["objects"].is_array(), "Objects not present in scene!");
 		for (auto& object : data["objects"]) {
 			GameObject::Sptr obj = GameObject::FromJson(result.get(), object);
-			obj->_scene = result.get();
 			obj->_parent.SceneContext = result.get();
-			obj->_selfRef = obj;
-			result->_objects.push_back(obj);
+			result->_AddObject(obj);
 		}
 
 		// Re-build the parent hierarchy 
@@ -307,13 +383,15 @@ namespace Gameplay {
 	void Scene::_InitPhysics() {
 		_collisionConfig = new btDefaultCollisionConfiguration();
 		_collisionDispatcher = new btCollisionDispatcher(_collisionConfig);
-		_broadphaseInterface = new btDbvtBroadphase();
+		_pairCache = new Physics::BatchedPairCache();
+		_broadphaseInterface = new btDbvtBroadphase(_pairCache);
 		_ghostCallback = new btGhostPairCallback();
 		_broadphaseInterface->getOverlappingPairCache()->setInternalGhostPairCallback(_ghostCallback);
 		_constraintSolver = new btSequentialImpulseConstraintSolver();
-		_physicsWorld = new btDiscreteDynamicsWorld(
+		_physicsWorld = new Physics::PhysicsWorld(
 			_collisionDispatcher,
 			_broadphaseInterface,
+			_pairCache,
 			_constraintSolver,
 			_collisionConfig
 		);
@@ -328,6 +406,8 @@ namespace Gameplay {
 		delete _physicsWorld;
 		delete _constraintSolver;
 		delete _broadphaseInterface;
+		// The broadphase does not own the pair cache when we provide one
+		delete _pairCache;
 		delete _ghostCallback;
 		delete _collisionDispatcher;
 		delete _collisionConfig;
@@ -335,16 +415,106 @@ namespace Gameplay {
 
 
 	void Scene::_FlushDeleteQueue() {
+		// We hold on to the removed objects until the end, so that all their physics objects are removed
+		// from the world in one go before their components are destroyed
+		std::vector<GameObject::Sptr> removed;
+		std::vector<btCollisionObject*> physicsObjects;
+		removed.reserve(_deletionQueue.size());
+
 		for (auto& weakPtr : _deletionQueue) {
-			if (weakPtr.expired()) continue;
-			auto& it = std::find(_objects.begin(), _objects.end(), weakPtr.lock());
-			if (it != _objects.end()) {
-				_objects.erase(it);
+			GameObject::Sptr object = weakPtr.lock();
+			if (object == nullptr) continue;
+
+			// Make sure the object is still in this scene
+			size_t index = object->_sceneIndex;
+			if (index >= _objects.size() || _objects[index] != object) continue;
+
+			_RemoveObjectFromLookups(object.get());
+
+			// Swap and pop, the object that was at the back takes this object's slot
+			if (index != _objects.size() - 1) {
+				_objects[index] = std::move(_objects.back());
+				_objects[index]->_sceneIndex = index;
+			}
+			_objects.pop_back();
+			object->_sceneIndex = SIZE_MAX;
+
+			_CollectPhysicsObjects(object, physicsObjects);
+			removed.push_back(std::move(object));
+		}
+		_deletionQueue.clear();
+
+		_physicsWorld->RemoveObjects(physicsObjects);
+		removed.clear();
+
+		// Components destroyed above only flag their pools, so clean them all up at once
+		_components.CompactPools();
+	}
+
+	void Scene::_CollectPhysicsObjects(const GameObject::Sptr& object, std::vector<btCollisionObject*>& result) {
+		for (const auto& component : object->_components) {
+			Physics::PhysicsBase* physics = dynamic_cast<Physics::PhysicsBase*>(component.get());
+			if (physics != nullptr && physics->_GetCollisionObject() != nullptr) {
+				result.push_back(physics->_GetCollisionObject());
+			}
+		}
+	}
+
+	void Scene::_AddObject(const GameObject::Sptr& object) {
+		object->_scene = this;
+		object->_selfRef = object;
+		object->_sceneIndex = _objects.size();
+		_objects.push_back(object);
+
+		// If another object already has this GUID, it keeps it's place in the lookup
+		_objectsByGuid.emplace(object->_guid, object.get());
+		object->_indexedName = object->Name;
+		_objectsByName.emplace(object->Name, object.get());
+	}
+
+	void Scene::_RemoveObjectFromLookups(GameObject* object) {
+		// Make sure we don't remove a different object that has the same GUID
+		auto guidIt = _objectsByGuid.find(object->_guid);
+		if (guidIt != _objectsByGuid.end() && guidIt->second == object) {
+			_objectsByGuid.erase(guidIt);
+		}
+
+		auto range = _objectsByName.equal_range(object->_indexedName);
+		for (auto it = range.first; it != range.second; it++) {
+			if (it->second == object) {
+				_objectsByName.erase(it);
+				break;
 			}
 		}
+	}
+
+	void Scene::_ClearObjects() {
+		// Pull all the physics objects out of the world at once, rather than one at a time as each is destroyed
+		std::vector<btCollisionObject*> physicsObjects;
+		for (const auto& object : _objects) {
+			_CollectPhysicsObjects(object, physicsObjects);
+		}
+		_physicsWorld->RemoveObjects(physicsObjects);
+
+		_objectsByGuid.clear();
+		_objectsByName.clear();
+		_objects.clear();
 		_deletionQueue.clear();
 	}
 
+	void Scene::_OnObjectRenamed(GameObject* object) {
+		// Find the entry under the old name, objects that haven't been added to the scene yet won't have one
+		auto range = _objectsByName.equal_range(object->_indexedName);
+		for (auto it = range.first; it != range.second; it++) {
+			if (it->second == object) {
+				_objectsByName.erase(it);
+				object->_indexedName = object->Name;
+				_objectsByName.emplace(object->Name, object);
+				return;
+			}
+		}
+	}
+
 	void Scene::DrawAllGameObjectGUIs()
 	{
 		for (auto& object : _objects) {
@@ -373,8 +543,8 @@ namespace Gameplay {
 			glDepthFunc(GL_LEQUAL); 
 
 			_skyboxShader->Bind();
-			_skyboxShader->SetUniformMatrix("u_ClippedView", MainCamera->GetProjection());
-			_skyboxShader->SetUniformMatrix("u_EnvironmentRotation", _skyboxRotation * glm::inverse(glm::mat3(MainCamera->GetView())));
+			_skyboxShader->SetUniformMatrix("u_ClippedView"_uh, MainCamera->GetProjection());
+			_skyboxShader->SetUniformMatrix("u_EnvironmentRotation"_uh, _skyboxRotation * glm::inverse(glm::mat3(MainCamera->GetView())));
 			_skyboxTexture->Bind(0);
 			_skyboxMesh->Mesh->Draw();
 
@@ -1,4 +1,5 @@
 #pragma once
+#include <unordered_map>
 #include <btBulletDynamicsCommon.h>
 #include "BulletCollision/CollisionDispatch/btGhostObject.h"
 
@@ -21,6 +22,8 @@ class HierarchyWindow;
 namespace Gameplay {
 	namespace Physics {
 		class RigidBody;
+		class PhysicsWorld;
+		class BatchedPairCache;
 	}
 
 	class MeshResource;
@@ -34,6 +37,10 @@ namespace Gameplay {
 	class Scene {
 	public:
 		typedef std::shared_ptr<Scene> Sptr;
+
+		// A mask of layers, where each bit corresponds to a GameObject layer
+		typedef uint32_t LayerMask;
+		static constexpr LayerMask ALL_LAYERS = 0xFFFFFFFF;
 		
 		// The camera for our scene
 		Camera::Sptr               MainCamera;
@@ -78,26 +85,71 @@ namespace Gameplay {
 		GameObject::Sptr CreateGameObject(const std::string& name);
 
 		/// <summary>
-		/// Queues a game object for deletion at the call of the next Update function
+		/// Queues a game object and all of it's children for deletion at the call of the next Update
+		/// function. Deleted objects are removed in a batch, so the order of the remaining objects
+		/// may change
 		/// </summary>
 		/// <param name="object">The gameobject to delete</param>
 		void RemoveGameObject(const GameObject::Sptr& object);
 
 		/// <summary>
-		/// Searches all objects in the scene and returns the first
-		/// one who's name matches the one given, or nullptr if no object
-		/// is found
+		/// Returns an object who's name matches the one given, or nullptr if no object
+		/// is found. If multiple objects share a name, which one is returned is not defined
 		/// </summary>
 		/// <param name="name">The name of the object to find</param>
 		GameObject::Sptr FindObjectByName(const std::string name) const;
 		/// <summary>
-		/// Searches all render objects in the scene and returns the first
-		/// one who's guid matches the one given, or nullptr if no object
+		/// Returns all the objects who's name matches the one given
+		/// </summary>
+		/// <param name="name">The name of the objects to find</param>
+		std::vector<GameObject::Sptr> FindObjectsByName(const std::string& name) const;
+		/// <summary>
+		/// Returns the object who's guid matches the one given, or nullptr if no object
 		/// is found
 		/// </summary>
 		/// <param name="id">The guid of the object to find</param>
 		GameObject::Sptr FindObjectByGUID(Guid id) const;
 
+		/// <summary>
+		/// Gets the bit index of a tag, registering the tag if it does not exist yet
+		/// </summary>
+		/// <param name="tag">The name of the tag</param>
+		/// <returns>The index of the tag, or -1 if we've run out of tags</returns>
+		int RegisterTag(const std::string& tag);
+		/// <summary>
+		/// Gets the bit index of a tag, or -1 if no object in the scene has used the tag
+		/// </summary>
+		/// <param name="tag">The name of the tag</param>
+		int GetTagIndex(const std::string& tag) const;
+		/// <summary>
+		/// Gets the name of the tag with the given index
+		/// </summary>
+		const std::string& GetTagName(int index) const;
+		/// <summary>
+		/// Gets a tag set with the given tags, for use with FindObjectsWithTags. Tags that
+		/// have not been registered yet will be registered
+		/// </summary>
+		/// <param name="tags">The names of the tags to include</param>
+		GameObject::TagSet MakeTagSet(const std::vector<std::string>& tags);
+
+		/// <summary>
+		/// Returns all objects that have all of the given tags, and are on one of the given layers
+		/// </summary>
+		/// <param name="tags">The tags that objects must have, an empty set matches all objects</param>
+		/// <param name="layers">The layers that objects must be on</param>
+		std::vector<GameObject::Sptr> FindObjectsWithTags(const GameObject::TagSet& tags, LayerMask layers = ALL_LAYERS) const;
+		/// <summary>
+		/// Returns all objects that have the given tag, and are on one of the given layers
+		/// </summary>
+		/// <param name="tag">The name of the tag that objects must have</param>
+		/// <param name="layers">The layers that objects must be on</param>
+		std::vector<GameObject::Sptr> FindObjectsWithTag(const std::string& tag, LayerMask layers = ALL_LAYERS) const;
+		/// <summary>
+		/// Returns all objects that are on one of the given layers
+		/// </summary>
+		/// <param name="layers">The layers that objects must be on</param>
+		std::vector<GameObject::Sptr> FindObjectsOnLayers(LayerMask layers) const;
+
 		/// <summary>
 		/// Sets the ambient light color for this scene
 		/// </summary>
@@ -195,7 +247,9 @@ namespace Gameplay {
 		ComponentManager _components;
 
 		// Bullet physics stuff world
-		btDynamicsWorld*          _physicsWorld;
+		Physics::PhysicsWorld*    _physicsWorld;
+		// Stores overlapping pairs for the broadphase, lets us remove pairs in bulk
+		Physics::BatchedPairCache* _pairCache;
 		// Our bullet physics configuration
 		btCollisionConfiguration* _collisionConfig; 
 		// Handles dispatching collisions between objects
@@ -219,6 +273,15 @@ namespace Gameplay {
 		std::vector<GameObject::Sptr>  _objects;
 		std::vector<std::weak_ptr<GameObject>>  _deletionQueue;
 
+		// Lookups for finding objects without searching through the whole scene, these are
+		// updated whenever objects are added, removed or renamed
+		std::unordered_map<Guid, GameObject*>             _objectsByGuid;
+		std::unordered_multimap<std::string, GameObject*> _objectsByName;
+
+		// The names of all the tags used in the scene, and the bit index for each of them
+		std::vector<std::string>                 _tagNames;
+		std::unordered_map<std::string, uint8_t> _tagIndices;
+
 		// Info for rendering our skybox will be stored in the scene itself
 		std::shared_ptr<ShaderProgram>       _skyboxShader;
 		std::shared_ptr<MeshResource> _skyboxMesh;
@@ -241,6 +304,31 @@ namespace Gameplay {
 		/// </summary>
 		void _CleanupPhysics();
 
+		/// <summary>
+		/// Removes all the objects that have been queued for deletion, along with their
+		/// physics objects and components
+		/// </summary>
 		void _FlushDeleteQueue();
+		/// <summary>
+		/// Gets the bullet objects from an object's physics components, so they can be removed in bulk
+		/// </summary>
+		void _CollectPhysicsObjects(const GameObject::Sptr& object, std::vector<btCollisionObject*>& result);
+
+		/// <summary>
+		/// Adds an object to the scene, and to the lookups
+		/// </summary>
+		void _AddObject(const GameObject::Sptr& object);
+		/// <summary>
+		/// Removes an object from the GUID and name lookups, without removing it from the scene
+		/// </summary>
+		void _RemoveObjectFromLookups(GameObject* object);
+		/// <summary>
+		/// Removes all objects from the scene and the lookups
+		/// </summary>
+		void _ClearObjects();
+		/// <summary>
+		/// Updates the name lookup after an object has been renamed
+		/// </summary>
+		void _OnObjectRenamed(GameObject* object);
 	};
 }
\ No newline at end of file
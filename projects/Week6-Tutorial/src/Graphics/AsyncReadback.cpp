@@ -0,0 +1,263 @@
+#include "Graphics/AsyncReadback.h"
+
+#include <filesystem>
+#include <cstring>
+
+#include <stb_image_write.h>
+#include <Logging.h>
+
+#include "Utils/BlobStore.h"
+
+uint32_t                  AsyncReadback::RingSize = 8;
+std::vector<AsyncReadback::Slot> AsyncReadback::_slots;
+std::deque<size_t>        AsyncReadback::_inFlight;
+std::thread               AsyncReadback::_worker;
+std::mutex                AsyncReadback::_jobMutex;
+std::condition_variable   AsyncReadback::_jobAdded;
+std::condition_variable   AsyncReadback::_jobsDone;
+std::deque<AsyncReadback::Job> AsyncReadback::_jobs;
+size_t                    AsyncReadback::_activeJobs = 0;
+bool                      AsyncReadback::_stopWorker = false;
+
+AsyncReadback::Slot& AsyncReadback::_AcquireSlot(size_t dataSize, size_t& index) {
+	if (_slots.empty()) {
+		_slots.resize(glm::max(RingSize, 1u));
+	}
+
+	// If every slot is busy, we have no choice but to wait for the oldest request
+	if (_inFlight.size() == _slots.size()) {
+		LOG_WARN("Readback ring is full, waiting on the oldest request (consider increasing AsyncReadback::RingSize)");
+		size_t oldest = _inFlight.front();
+		glClientWaitSync(_slots[oldest].Fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+		_Retire(oldest);
+		_inFlight.pop_front();
+	}
+
+	// Find a slot that's not in use
+	for (index = 0; index < _slots.size(); index++) {
+		if (_slots[index].Fence == nullptr) {
+			break;
+		}
+	}
+	Slot& slot = _slots[index];
+
+	// Grow the buffer if needed. We re-allocate rather than using immutable storage since requests vary in size
+	if (slot.Buffer == 0) {
+		glCreateBuffers(1, &slot.Buffer);
+	}
+	if (slot.Capacity < dataSize) {
+		glNamedBufferData(slot.Buffer, dataSize, nullptr, GL_STREAM_READ);
+		slot.Capacity = dataSize;
+	}
+	slot.DataSize = dataSize;
+	return slot;
+}
+
+void AsyncReadback::ReadTexture(GLuint texture, const glm::uvec3& size, PixelFormat format, PixelType type, Callback callback, int level) {
+	size_t dataSize = GetTexelSize(format, type) * size.x * size.y * size.z;
+	LOG_ASSERT(dataSize > 0, "Cannot read back an empty texture or an unknown format");
+
+	size_t index = 0;
+	Slot& slot = _AcquireSlot(dataSize, index);
+	slot.Result.Size   = size;
+	slot.Result.Format = format;
+	slot.Result.Type   = type;
+	slot.OnComplete    = callback;
+
+	// With a pack buffer bound, the pointer is an offset into the buffer and the call returns right away
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.Buffer);
+	glGetTextureImage(texture, level, *format, *type, (GLsizei)dataSize, nullptr);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	slot.Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	_inFlight.push_back(index);
+}
+
+void AsyncReadback::ReadFramebuffer(const Framebuffer::Sptr& framebuffer, RenderTargetAttachment attachment, const glm::uvec4& region, PixelFormat format, PixelType type, Callback callback) {
+	size_t dataSize = GetTexelSize(format, type) * region.z * region.w;
+	LOG_ASSERT(dataSize > 0, "Cannot read back an empty region or an unknown format");
+
+	size_t index = 0;
+	Slot& slot = _AcquireSlot(dataSize, index);
+	slot.Result.Size   = glm::uvec3(region.z, region.w, 1);
+	slot.Result.Format = format;
+	slot.Result.Type   = type;
+	slot.OnComplete    = callback;
+
+	if (framebuffer != nullptr) {
+		framebuffer->Bind(FramebufferBinding::Read);
+		glReadBuffer(*attachment);
+	} else {
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+		glReadBuffer(GL_BACK);
+	}
+
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.Buffer);
+	glReadPixels(region.x, region.y, region.z, region.w, *format, *type, nullptr);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	if (framebuffer != nullptr) {
+		framebuffer->Unbind();
+	}
+
+	slot.Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	_inFlight.push_back(index);
+}
+
+void AsyncReadback::_Retire(size_t index) {
+	Slot& slot = _slots[index];
+
+	// Copy the data out so the buffer can be re-used right away
+	Job job;
+	job.Result = std::move(slot.Result);
+	job.Result.Data.resize(slot.DataSize);
+	job.OnComplete = std::move(slot.OnComplete);
+
+	void* mapped = glMapNamedBufferRange(slot.Buffer, 0, slot.DataSize, GL_MAP_READ_BIT);
+	if (mapped != nullptr) {
+		memcpy(job.Result.Data.data(), mapped, slot.DataSize);
+		glUnmapNamedBuffer(slot.Buffer);
+	} else {
+		LOG_ERROR("Failed to map readback buffer, the request will be dropped");
+	}
+
+	glDeleteSync(slot.Fence);
+	slot.Fence = nullptr;
+	slot.Result = ReadbackResult();
+	slot.OnComplete = nullptr;
+
+	if (mapped == nullptr || job.OnComplete == nullptr) {
+		return;
+	}
+
+	// Hand the data off to the worker, starting it if this is the first job
+	std::unique_lock<std::mutex> lock(_jobMutex);
+	if (!_worker.joinable()) {
+		_stopWorker = false;
+		_worker = std::thread(&AsyncReadback::_WorkerMain);
+	}
+	_jobs.push_back(std::move(job));
+	_jobAdded.notify_one();
+}
+
+void AsyncReadback::Poll() {
+	// Requests complete in order, so we can stop at the first one that isn't done
+	while (!_inFlight.empty()) {
+		size_t index = _inFlight.front();
+		GLenum status = glClientWaitSync(_slots[index].Fence, 0, 0);
+		if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+			break;
+		}
+		_Retire(index);
+		_inFlight.pop_front();
+	}
+}
+
+void AsyncReadback::Flush() {
+	while (!_inFlight.empty()) {
+		size_t index = _inFlight.front();
+		glClientWaitSync(_slots[index].Fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+		_Retire(index);
+		_inFlight.pop_front();
+	}
+
+	std::unique_lock<std::mutex> lock(_jobMutex);
+	_jobsDone.wait(lock, [] { return _jobs.empty() && _activeJobs == 0; });
+}
+
+void AsyncReadback::Shutdown() {
+	Flush();
+
+	{
+		std::unique_lock<std::mutex> lock(_jobMutex);
+		_stopWorker = true;
+		_jobAdded.notify_all();
+	}
+	if (_worker.joinable()) {
+		_worker.join();
+	}
+
+	for (Slot& slot : _slots) {
+		if (slot.Buffer != 0) {
+			glDeleteBuffers(1, &slot.Buffer);
+		}
+	}
+	_slots.clear();
+}
+
+size_t AsyncReadback::GetPendingCount() {
+	std::unique_lock<std::mutex> lock(_jobMutex);
+	return _inFlight.size() + _jobs.size() + _activeJobs;
+}
+
+void AsyncReadback::_WorkerMain() {
+	std::unique_lock<std::mutex> lock(_jobMutex);
+	while (true) {
+		_jobAdded.wait(lock, [] { return _stopWorker || !_jobs.empty(); });
+		if (_jobs.empty()) {
+			// Only get here if we've been told to stop and there's no work left
+			return;
+		}
+
+		Job job = std::move(_jobs.front());
+		_jobs.pop_front();
+		_activeJobs++;
+
+		// Run the callback without holding the lock, so the render thread can keep queueing work
+		lock.unlock();
+		job.OnComplete(job.Result);
+		lock.lock();
+
+		_activeJobs--;
+		if (_jobs.empty() && _activeJobs == 0) {
+			_jobsDone.notify_all();
+		}
+	}
+}
+
+AsyncReadback::Callback AsyncReadback::PngWriter(const std::string& path) {
+	return [path](ReadbackResult& result) {
+		int channels = 0;
+		switch (result.Format) {
+			case PixelFormat::Red:  channels = 1; break;
+			case PixelFormat::RG:   channels = 2; break;
+			case PixelFormat::RGB:  channels = 3; break;
+			case PixelFormat::RGBA: channels = 4; break;
+			default: break;
+		}
+		if (channels == 0 || result.Type != PixelType::UByte || result.Size.z != 1) {
+			LOG_WARN("Cannot write \"{}\", PNGs must be 2D images with 8 bits per channel", path);
+			return;
+		}
+
+		// GL gives us the bottom row first, but PNGs start at the top
+		size_t stride = (size_t)result.Size.x * channels;
+		std::vector<uint8_t> row(stride);
+		for (uint32_t iy = 0; iy < result.Size.y / 2; iy++) {
+			uint8_t* top    = result.Data.data() + iy * stride;
+			uint8_t* bottom = result.Data.data() + (result.Size.y - 1 - iy) * stride;
+			memcpy(row.data(), top, stride);
+			memcpy(top, bottom, stride);
+			memcpy(bottom, row.data(), stride);
+		}
+
+		std::error_code error;
+		std::filesystem::path parent = std::filesystem::path(path).parent_path();
+		if (!parent.empty()) {
+			std::filesystem::create_directories(parent, error);
+		}
+		if (!stbi_write_png(path.c_str(), result.Size.x, result.Size.y, channels, result.Data.data(), (int)stride)) {
+			LOG_WARN("Failed to write \"{}\"", path);
+		}
+	};
+}
+
+AsyncReadback::Callback AsyncReadback::BlobWriter(const std::string& id) {
+	return [id](ReadbackResult& result) {
+		if (!BlobStore::WriteAs(id, result.Data.data(), result.Data.size())) {
+			LOG_WARN("Failed to write readback to blob \"{}\"", id);
+		}
+	};
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include <glad/glad.h>
+#include <GLM/glm.hpp>
+
+#include "Graphics/GlEnums.h"
+#include "Graphics/Framebuffer.h"
+
+/// <summary>
+/// The pixels that were read back from the GPU by an AsyncReadback request
+/// </summary>
+struct ReadbackResult {
+	// The pixel data, tightly packed (pack alignment of 1), with the first row being the bottom of the image
+	std::vector<uint8_t> Data;
+	// The size of the region that was read, in pixels (Z is 1 for 2D reads)
+	glm::uvec3           Size;
+	PixelFormat          Format;
+	PixelType            Type;
+};
+
+/// <summary>
+/// Reads textures and framebuffers back from the GPU without stalling the pipeline. Each request copies
+/// into one of a ring of pixel pack buffers and inserts a fence. Poll is called once a frame, and once a
+/// request's fence has signalled, it's data is copied out and handed to a worker thread, where the request's
+/// callback is invoked. Callbacks should do their heavy lifting there (ex: encoding PNGs, compressing blobs)
+///
+/// All functions other than the callbacks must be called from the thread that owns the GL context
+/// </summary>
+class AsyncReadback {
+public:
+	AsyncReadback() = delete;
+
+	/// <summary>
+	/// Invoked on the worker thread once a request's data is available. The result may be modified
+	/// </summary>
+	typedef std::function<void(ReadbackResult&)> Callback;
+
+	/// <summary>
+	/// The number of pixel pack buffers in the ring, if all of them are in flight when a new request
+	/// is made, the oldest request will be waited on. Must be set before the first request
+	/// </summary>
+	static uint32_t RingSize;
+
+	/// <summary>
+	/// Queues a readback of a mip level of a texture
+	/// </summary>
+	/// <param name="texture">The GL handle of the texture to read</param>
+	/// <param name="size">The size of the mip level being read, in pixels (use 1 for unused dimensions)</param>
+	/// <param name="format">The format to read the pixels as</param>
+	/// <param name="type">The data type to read the pixels as</param>
+	/// <param name="callback">The callback to invoke on the worker thread once the data is available</param>
+	/// <param name="level">The mip level to read</param>
+	static void ReadTexture(GLuint texture, const glm::uvec3& size, PixelFormat format, PixelType type, Callback callback, int level = 0);
+	/// <summary>
+	/// Queues a readback of a region of a framebuffer attachment
+	/// </summary>
+	/// <param name="framebuffer">The framebuffer to read from, or nullptr to read the back buffer of the window</param>
+	/// <param name="attachment">The color attachment to read from (ignored for the back buffer)</param>
+	/// <param name="region">The region to read, as x, y, width, height</param>
+	/// <param name="format">The format to read the pixels as</param>
+	/// <param name="type">The data type to read the pixels as</param>
+	/// <param name="callback">The callback to invoke on the worker thread once the data is available</param>
+	static void ReadFramebuffer(const Framebuffer::Sptr& framebuffer, RenderTargetAttachment attachment, const glm::uvec4& region, PixelFormat format, PixelType type, Callback callback);
+
+	/// <summary>
+	/// Checks the fences of all in-flight requests, and hands the ones that have completed to the worker thread.
+	/// Should be called once per frame
+	/// </summary>
+	static void Poll();
+	/// <summary>
+	/// Blocks until all requests have completed and their callbacks have finished running
+	/// </summary>
+	static void Flush();
+	/// <summary>
+	/// Flushes all requests, then stops the worker thread and frees the pixel pack buffers
+	/// </summary>
+	static void Shutdown();
+
+	/// <summary>
+	/// Gets the number of requests that are waiting on the GPU or the worker thread
+	/// </summary>
+	static size_t GetPendingCount();
+
+	/// <summary>
+	/// Creates a callback that writes an 8 bit per channel result to a PNG file, creating any missing directories
+	/// </summary>
+	/// <param name="path">The path of the file to write</param>
+	static Callback PngWriter(const std::string& path);
+	/// <summary>
+	/// Creates a callback that writes a result to the blob store under the given ID
+	/// </summary>
+	/// <param name="id">The ID to store the blob as, see BlobStore::WriteAs</param>
+	static Callback BlobWriter(const std::string& id);
+
+private:
+	// A pixel pack buffer in the ring, and the request that is currently using it
+	struct Slot {
+		GLuint         Buffer   = 0;
+		size_t         Capacity = 0;
+		GLsync         Fence    = nullptr;
+		size_t         DataSize = 0;
+		ReadbackResult Result;
+		Callback       OnComplete;
+	};
+
+	// A completed readback that is waiting for the worker thread
+	struct Job {
+		ReadbackResult Result;
+		Callback       OnComplete;
+	};
+
+	static std::vector<Slot> _slots;
+	// Indices of slots that are in flight, oldest first
+	static std::deque<size_t> _inFlight;
+
+	static std::thread             _worker;
+	static std::mutex              _jobMutex;
+	static std::condition_variable _jobAdded;
+	static std::condition_variable _jobsDone;
+	static std::deque<Job>         _jobs;
+	static size_t                  _activeJobs;
+	static bool                    _stopWorker;
+
+	/// <summary>
+	/// Gets a free slot with at least the given capacity, waiting on the oldest request if the ring is full
+	/// </summary>
+	static Slot& _AcquireSlot(size_t dataSize, size_t& index);
+	/// <summary>
+	/// Copies a completed slot's data out, and hands it to the worker thread
+	/// </summary>
+	static void _Retire(size_t index);
+	static void _WorkerMain();
+};
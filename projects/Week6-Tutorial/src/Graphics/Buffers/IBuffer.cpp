@@ -5,11 +5,18 @@ IBuffer::IBuffer(BufferType type, BufferUsage usage) :
 	IGraphicsResource(),
 	_elementCount(0),
 	_elementSize(0),
-	_size(0)
+	_size(0),
+	_immutable(false)
 {
 	_type = type;
 	_usage = usage;
 	glCreateBuffers(1, &_rendererId);
+
+	switch (type) {
+		case BufferType::Index:   _gpuMemoryCategory = GpuMemoryCategory::IndexBuffer; break;
+		case BufferType::Uniform: _gpuMemoryCategory = GpuMemoryCategory::UniformBuffer; break;
+		default:                  _gpuMemoryCategory = GpuMemoryCategory::VertexBuffer; break;
+	}
 }
 
 GlResourceType IBuffer::GetResourceClass() const {
@@ -30,12 +37,24 @@ void IBuffer::LoadData(const void* data, uint32_t elementSize, uint32_t elementC
 	_elementCount = elementCount;
 	_elementSize = elementSize;
 	_size = elementCount * elementSize;
+	_SetGpuMemoryUsage(_size);
+}
+
+void IBuffer::LoadStorage(const void* data, uint32_t elementSize, uint32_t elementCount, GLbitfield flags) {
+	LOG_ASSERT(!_immutable, "Buffer storage has already been allocated!");
+	glNamedBufferStorage(_rendererId, (GLsizeiptr)elementSize * elementCount, data, flags);
+
+	_elementCount = elementCount;
+	_elementSize = elementSize;
+	_size = elementCount * elementSize;
+	_immutable = true;
+	_SetGpuMemoryUsage(_size);
 }
 
 void IBuffer::UpdateData(const void* data, uint32_t elementSize, uint32_t elementCount, bool allowResize /*= true*/)
 {
 	if (elementSize * elementCount > _size) {
-		if (allowResize) {
+		if (allowResize && !_immutable) {
 			glNamedBufferData(_rendererId, (GLsizeiptr)elementSize * elementCount, data, (GLenum)_usage);
 
 			LOG_INFO("Expanding buffer from {} bytes to {} bytes", _size, elementCount * elementSize);
@@ -43,6 +62,7 @@ void IBuffer::UpdateData(const void* data, uint32_t elementSize, uint32_t elemen
 			_elementCount = elementCount;
 			_elementSize = elementSize;
 			_size = elementCount * elementSize;
+			_SetGpuMemoryUsage(_size);
 		} else {
 			LOG_ASSERT(false, "Attempting to write beyond the end of the buffer!");
 		}
@@ -50,6 +70,7 @@ void IBuffer::UpdateData(const void* data, uint32_t elementSize, uint32_t elemen
 		if (_size == 0) {
 			glNamedBufferData(_rendererId, (GLsizeiptr)elementSize * elementCount, data, (GLenum)_usage);
 			_size = elementCount * elementSize;
+			_SetGpuMemoryUsage(_size);
 		} else {
 			glNamedBufferSubData(_rendererId, 0, (GLsizeiptr)elementSize * elementCount, data);
 		}
@@ -43,6 +43,17 @@ public:
 	/// <param name="elementCount">The number of elements to upload</param>
 	virtual void LoadData(const void* data, uint32_t elementSize, uint32_t elementCount);
 
+	/// <summary>
+	/// Loads data into this buffer as immutable storage, using glNamedBufferStorage. The buffer can't be
+	/// resized or reloaded afterwards, which lets the driver place it wherever suits it best. This is meant
+	/// for static data that is uploaded once (ex: meshes loaded from disk)
+	/// </summary>
+	/// <param name="data">The data that you want to load into the buffer</param>
+	/// <param name="elementSize">The size of a single element, in bytes</param>
+	/// <param name="elementCount">The number of elements to upload</param>
+	/// <param name="flags">The GL_*_BIT storage flags, 0 if the contents will never be written or mapped by the CPU</param>
+	virtual void LoadStorage(const void* data, uint32_t elementSize, uint32_t elementCount, GLbitfield flags = 0);
+
 	/// <summary>
 	/// Updates data within the buffer, optionally resizing the buffer
 	/// </summary>
@@ -83,6 +94,10 @@ public:
 	/// Returns the usage hint for this buffer (ex GL_STATIC_DRAW, GL_DYNAMIC_DRAW)
 	/// </summary>
 	BufferUsage GetUsage() const { return _usage; }
+	/// <summary>
+	/// Returns true if the buffer's storage was allocated with LoadStorage, and can't be resized
+	/// </summary>
+	bool IsImmutable() const { return _immutable; }
 
 	/// <summary>
 	/// Maps the buffer's data to a pointer that the CPU can access. Note that unmap should be called
@@ -134,4 +149,5 @@ protected:
 	uint32_t _size; // The size of the buffer in bytes
 	BufferUsage _usage; // The buffer usage mode (GL_STATIC_DRAW, GL_DYNAMIC_DRAW)
 	BufferType _type; // The buffer type (ex GL_ARRAY_BUFFER, GL_ARRAY_ELEMENT_BUFFER)
+	bool _immutable; // True if the buffer's storage was allocated with glNamedBufferStorage
 };
@@ -43,6 +43,19 @@ public:
 		_elementType = elementType;
 	}
 
+	/// <summary>
+	/// Loads indices into immutable storage, specifying the type of indices we are using via the elementType parameter
+	/// </summary>
+	/// <param name="data">The pointer to the data to load in</param>
+	/// <param name="elementSize">The size of a single element, in bytes</param>
+	/// <param name="elementCount">The number of elements to upload</param>
+	/// <param name="elementType">The type of elements you are storing (GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT, GL_UNSIGNED_INT)</param>
+	/// <param name="flags">The GL_*_BIT storage flags, 0 if the contents will never be written or mapped by the CPU</param>
+	inline void LoadStorage(const void* data, uint32_t elementSize, uint32_t elementCount, IndexType elementType, GLbitfield flags = 0) {
+		IBuffer::LoadStorage(data, elementSize, elementCount, flags);
+		_elementType = elementType;
+	}
+
 	/// <summary>
 	/// Loads data of a known type into this index buffer
 	/// </summary>
@@ -0,0 +1,114 @@
+#include "Graphics/DynamicResolution.h"
+
+#include "Utils/JsonGlmHelpers.h"
+
+DynamicResolution::DynamicResolution() :
+	Enabled(true),
+	TargetFrameTime(1000.0f / 60.0f),
+	MinScale(0.5f),
+	MaxScale(1.0f),
+	ScaleStep(0.05f),
+	Smoothing(0.1f),
+	UpperBound(1.0f),
+	LowerBound(0.8f),
+	Cooldown(15),
+	Filter(UpscaleFilter::Sharpen),
+	Sharpness(0.5f),
+	_scale(1.0f),
+	_smoothedTime(0.0f),
+	_sampleCount(0),
+	_framesSinceChange(0)
+{ }
+
+DynamicResolution::~DynamicResolution() = default;
+
+bool DynamicResolution::Update(float milliseconds) {
+	if (!Enabled) {
+		// Start the average over if we get turned back on, these timings would be from full resolution
+		_sampleCount = 0;
+		return false;
+	}
+
+	// Seed the average with the first sample so we don't spend the first few frames ramping up from 0
+	_smoothedTime = _sampleCount == 0 ? milliseconds : glm::mix(_smoothedTime, milliseconds, Smoothing);
+	_sampleCount++;
+	_framesSinceChange++;
+
+	// Give the timings a chance to settle after a change, otherwise we'd still be seeing frames from the old scale
+	if (_framesSinceChange < Cooldown) {
+		return false;
+	}
+
+	float scale = _scale;
+	if (_smoothedTime > TargetFrameTime * UpperBound) {
+		// Aim a bit under the budget, so we don't end up right on the edge of it
+		float target = TargetFrameTime * glm::mix(LowerBound, UpperBound, 0.5f);
+		scale = _ClampScale(_scale * glm::sqrt(target / _smoothedTime));
+		// Always drop at least one step, otherwise rounding can leave us stuck over budget
+		if (scale >= _scale) {
+			scale = _ClampScale(_scale - ScaleStep);
+		}
+	} else if (_smoothedTime < TargetFrameTime * LowerBound) {
+		// Only go up one step at a time, since getting it wrong in this direction costs us frames
+		scale = _ClampScale(_scale + ScaleStep);
+	}
+
+	if (scale == _scale) {
+		return false;
+	}
+
+	// Assume the new scale costs what we predicted, so the next decision isn't based entirely on stale samples
+	_smoothedTime *= (scale * scale) / (_scale * _scale);
+	_scale = scale;
+	_framesSinceChange = 0;
+	return true;
+}
+
+void DynamicResolution::Reset() {
+	_scale = _ClampScale(MaxScale);
+	_smoothedTime = 0.0f;
+	_sampleCount = 0;
+	_framesSinceChange = 0;
+}
+
+glm::ivec2 DynamicResolution::GetRenderSize(const glm::ivec2& outputSize) const {
+	return glm::max(glm::ivec2(glm::round(glm::vec2(outputSize) * GetScale())), glm::ivec2(1));
+}
+
+float DynamicResolution::_ClampScale(float scale) const {
+	if (ScaleStep > 0.0f) {
+		scale = glm::floor(scale / ScaleStep + 0.5f) * ScaleStep;
+	}
+	return glm::clamp(scale, glm::min(MinScale, MaxScale), MaxScale);
+}
+
+nlohmann::json DynamicResolution::ToJson() const {
+	return {
+		{ "enabled", Enabled },
+		{ "target_frame_time", TargetFrameTime },
+		{ "min_scale", MinScale },
+		{ "max_scale", MaxScale },
+		{ "scale_step", ScaleStep },
+		{ "smoothing", Smoothing },
+		{ "upper_bound", UpperBound },
+		{ "lower_bound", LowerBound },
+		{ "cooldown", Cooldown },
+		{ "filter", ~Filter },
+		{ "sharpness", Sharpness }
+	};
+}
+
+void DynamicResolution::FromJson(const nlohmann::json& blob) {
+	Enabled         = JsonGet(blob, "enabled", Enabled);
+	TargetFrameTime = JsonGet(blob, "target_frame_time", TargetFrameTime);
+	MinScale        = JsonGet(blob, "min_scale", MinScale);
+	MaxScale        = JsonGet(blob, "max_scale", MaxScale);
+	ScaleStep       = JsonGet(blob, "scale_step", ScaleStep);
+	Smoothing       = JsonGet(blob, "smoothing", Smoothing);
+	UpperBound      = JsonGet(blob, "upper_bound", UpperBound);
+	LowerBound      = JsonGet(blob, "lower_bound", LowerBound);
+	Cooldown        = JsonGet(blob, "cooldown", Cooldown);
+	Filter          = JsonParseEnum(UpscaleFilter, blob, "filter", Filter);
+	Sharpness       = JsonGet(blob, "sharpness", Sharpness);
+	Reset();
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstdint>
+
+#include <GLM/glm.hpp>
+#include <EnumToString.h>
+#include <json.hpp>
+
+#include "Utils/Macros.h"
+
+/// <summary>
+/// The filter used to scale the image rendered at the dynamic resolution up to the window
+/// </summary>
+ENUM(UpscaleFilter, uint32_t,
+	Bilinear = 0,
+	Sharpen  = 1  // Bilinear, followed by a contrast adaptive sharpen
+)
+
+/// <summary>
+/// Picks the scale that the scene should be rendered at, based on how long the GPU has been taking
+/// to render frames. Frame times are smoothed with an exponential moving average, and the scale is
+/// only changed when the smoothed time leaves a band around the target, after which we wait a number
+/// of frames for the new scale to show up in the timings. This keeps the resolution from oscillating
+/// when the frame time is hovering around the budget
+///
+/// The GPU cost of the scene scales roughly with the number of pixels, so we estimate the scale that
+/// would hit the target from the square root of the ratio between the target and the current time
+/// </summary>
+class DynamicResolution final {
+public:
+	MAKE_PTRS(DynamicResolution);
+
+	/// <summary>
+	/// True if the scale should be adjusted automatically, when false the scene renders at full resolution
+	/// </summary>
+	bool          Enabled;
+	/// <summary>
+	/// The GPU time that we are trying to keep the scene under, in milliseconds
+	/// </summary>
+	float         TargetFrameTime;
+	/// <summary>
+	/// The smallest and largest scales that can be picked, relative to the window size
+	/// </summary>
+	float         MinScale;
+	float         MaxScale;
+	/// <summary>
+	/// Scales are rounded to multiples of this, so that small changes in timing do not resize our targets
+	/// </summary>
+	float         ScaleStep;
+	/// <summary>
+	/// How much of each new sample goes into the smoothed frame time, in the 0-1 range
+	/// </summary>
+	float         Smoothing;
+	/// <summary>
+	/// The scale will go down when the smoothed time is above TargetFrameTime * UpperBound, and
+	/// up when it is below TargetFrameTime * LowerBound
+	/// </summary>
+	float         UpperBound;
+	float         LowerBound;
+	/// <summary>
+	/// The number of samples to wait after changing the scale before changing it again
+	/// </summary>
+	uint32_t      Cooldown;
+	/// <summary>
+	/// The filter used to scale the result up to the window, and the strength of the sharpen filter (0-1)
+	/// </summary>
+	UpscaleFilter Filter;
+	float         Sharpness;
+
+	DynamicResolution();
+	~DynamicResolution();
+
+	/// <summary>
+	/// Feeds a new GPU frame time to the controller
+	/// </summary>
+	/// <param name="milliseconds">The time the GPU took to render the scene in the last measured frame</param>
+	/// <returns>True if the scale has changed, false if otherwise</returns>
+	bool Update(float milliseconds);
+	/// <summary>
+	/// Discards the smoothed frame time and goes back to MaxScale
+	/// </summary>
+	void Reset();
+
+	/// <summary>
+	/// Gets the scale the scene should be rendered at, relative to the window size. This is
+	/// always 1 while the controller is disabled
+	/// </summary>
+	float GetScale() const { return Enabled ? _scale : 1.0f; }
+	/// <summary>
+	/// Gets the smoothed GPU frame time, in milliseconds
+	/// </summary>
+	float GetSmoothedFrameTime() const { return _smoothedTime; }
+	/// <summary>
+	/// Gets the size that the scene should be rendered at for a given output size
+	/// </summary>
+	glm::ivec2 GetRenderSize(const glm::ivec2& outputSize) const;
+
+	nlohmann::json ToJson() const;
+	void FromJson(const nlohmann::json& blob);
+
+private:
+	float    _scale;
+	float    _smoothedTime;
+	uint32_t _sampleCount;
+	uint32_t _framesSinceChange;
+
+	float _ClampScale(float scale) const;
+};
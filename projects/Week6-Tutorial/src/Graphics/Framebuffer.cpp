@@ -1,5 +1,7 @@
 #include "Graphics/Framebuffer.h"
 
+#include <algorithm>
+
 #include "Graphics/RenderBuffer.h"
 #include "Utils/JsonGlmHelpers.h"
 
@@ -7,12 +9,15 @@
 Framebuffer::Framebuffer(const FramebufferDescriptor& description) :
 	IGraphicsResource(),
 	_description(FramebufferDescriptor()),
+	_capacity(0),
+	_framesOversized(0),
 	_isValid(false),
 	_targets(__TargetMap()),
 	_drawBuffers(std::vector<RenderTargetAttachment>())
 {
 	_description = description;
 	LOG_ASSERT(_description.Width * _description.Height > 0, "Width and height must both be > 0");
+	_capacity = __RoundUpToGranularity(GetSize(), _description.Granularity);
 
 	// Generate the framebuffer
 	glCreateFramebuffers(1, &_rendererId);
@@ -40,6 +45,15 @@ glm::ivec2 Framebuffer::GetSize() const {
 	return glm::ivec2(_description.Width, _description.Height);
 }
 
+glm::ivec2 Framebuffer::GetCapacity() const {
+	return _capacity;
+}
+
+glm::vec4 Framebuffer::GetUvScale() const {
+	glm::vec2 capacity = glm::vec2(_capacity);
+	return glm::vec4(glm::vec2(GetSize()) / capacity, (glm::vec2(GetSize()) - 0.5f) / capacity);
+}
+
 Texture2D::Sptr Framebuffer::GetTextureAttachment(RenderTargetAttachment attachment) const {
 	// Find the attachment
 	const auto& it = _targets.find(attachment);
@@ -57,11 +71,34 @@ Texture2D::Sptr Framebuffer::GetTextureAttachment(RenderTargetAttachment attachm
 void Framebuffer::Resize(uint32_t width, uint32_t height) {
 	LOG_ASSERT(width * height > 0, "Width and height must be > 0");
 
-	// We'll only do the heavy lifting if the dimensions have changed
-	if (width != _description.Width || height != _description.Height) {
-		// Update the description
-		_description.Width  = width;
-		_description.Height = height;
+	glm::ivec2 size = glm::ivec2(width, height);
+	glm::ivec2 required = __RoundUpToGranularity(size, _description.Granularity);
+
+	// We have to grow right away, but if we're larger than we need to be we hang onto the memory
+	// for a while, in case we get resized back up (see NextFrame)
+	glm::ivec2 capacity = _capacity;
+	if (required.x > _capacity.x || required.y > _capacity.y || _description.ShrinkDelay == 0) {
+		capacity = required;
+	}
+	Resize(size, capacity);
+}
+
+void Framebuffer::Resize(const glm::ivec2& size) {
+	Resize(size.x, size.y);
+}
+
+void Framebuffer::Resize(const glm::ivec2& size, const glm::ivec2& capacity) {
+	LOG_ASSERT(size.x * size.y > 0, "Width and height must be > 0");
+	LOG_ASSERT(capacity.x >= size.x && capacity.y >= size.y, "Capacity must be at least as large as the size");
+
+	// Changing the rendered area is free, the owner just needs to update it's viewport
+	_description.Width  = size.x;
+	_description.Height = size.y;
+
+	// We'll only do the heavy lifting if the allocation has changed
+	if (capacity != _capacity) {
+		_capacity = capacity;
+		_framesOversized = 0;
 
 		// Re-attach all our rendertargets (releasing our references and re-creating them)
 		for (const auto& kvp : _targets) {
@@ -73,8 +110,20 @@ void Framebuffer::Resize(uint32_t width, uint32_t height) {
 	}
 }
 
-void Framebuffer::Resize(const glm::ivec2& size) {
-	Resize(size.x, size.y);
+bool Framebuffer::NextFrame() {
+	glm::ivec2 required = __RoundUpToGranularity(GetSize(), _description.Granularity);
+	if (required == _capacity) {
+		_framesOversized = 0;
+		return false;
+	}
+
+	// Only give the memory back once we've been too big for a while
+	_framesOversized++;
+	if (_framesOversized < _description.ShrinkDelay) {
+		return false;
+	}
+	Resize(GetSize(), required);
+	return true;
 }
 
 // meat and potatoes
@@ -86,7 +135,10 @@ void Framebuffer::_AddAttachment(RenderTargetAttachment attachment, const Render
 	}
 	// If this is a new attachment and is a color, add it to the draw buffers so OpenGL knows to render to it
 	else if (IsColorAttachment(attachment)) {
+		// Keep the draw buffers in attachment order, so fragment output N goes to ColorN no matter what
+		// order the descriptor's (unordered) targets are created in
 		_drawBuffers.push_back(attachment);
+		std::sort(_drawBuffers.begin(), _drawBuffers.end());
 		glNamedFramebufferDrawBuffers(_rendererId, _drawBuffers.size(), reinterpret_cast<GLenum*>(_drawBuffers.data()));
 	}
 
@@ -100,8 +152,8 @@ void Framebuffer::_AddAttachment(RenderTargetAttachment attachment, const Render
 	if (buffer.IsRenderBuffer) {
 		RenderbufferDescription descriptor = RenderbufferDescription();
 		// Per-framebuffer parameters
-		descriptor.Width            = _description.Width;
-		descriptor.Height           = _description.Height;
+		descriptor.Width            = _capacity.x;
+		descriptor.Height           = _capacity.y;
 
 		// Per-attachment parameters
 		descriptor.Format = target.Format;
@@ -114,8 +166,8 @@ void Framebuffer::_AddAttachment(RenderTargetAttachment attachment, const Render
 	else {
 		Texture2DDescription descriptor = Texture2DDescription();
 		// Per-framebuffer parameters
-		descriptor.Width            = _description.Width;
-		descriptor.Height           = _description.Height;
+		descriptor.Width            = _capacity.x;
+		descriptor.Height           = _capacity.y;
 
 		// Per-attachment parameters
 		descriptor.Format = (InternalFormat)target.Format;
@@ -130,6 +182,7 @@ void Framebuffer::_AddAttachment(RenderTargetAttachment attachment, const Render
 
 		// Create image and store in the buffer
 		Texture2D::Sptr image = std::make_shared<Texture2D>(descriptor);
+		image->SetGpuMemoryCategory(GpuMemoryCategory::RenderTarget);
 		buffer.Resource = image;
 
 		// Attach texture to the framebuffer
@@ -266,6 +319,8 @@ nlohmann::json Framebuffer::ToJson() const {
 	nlohmann::json result ={
 		{ "width", _description.Width },
 		{ "height", _description.Height },
+		{ "granularity", _description.Granularity },
+		{ "shrink-delay", _description.ShrinkDelay },
 		{ "attachments", nlohmann::json() }
 	};
 
@@ -287,6 +342,8 @@ Framebuffer::Sptr Framebuffer::FromJson(const nlohmann::json& blob) {
 	FramebufferDescriptor result = FramebufferDescriptor();
 	result.Width  = JsonGet(blob, "width", 0);
 	result.Height = JsonGet(blob, "height", 0);
+	result.Granularity = JsonGet(blob, "granularity", 0u);
+	result.ShrinkDelay = JsonGet(blob, "shrink-delay", 0u);
 
 	if (blob.contains("attachments") && blob["attachments"].is_object()) {
 		// Iterate over all objects
@@ -312,6 +369,13 @@ Framebuffer::Sptr Framebuffer::FromJson(const nlohmann::json& blob) {
 	return std::make_shared<Framebuffer>(result);
 }
 
+glm::ivec2 Framebuffer::__RoundUpToGranularity(const glm::ivec2& size, uint32_t granularity) {
+	if (granularity == 0) {
+		return size;
+	}
+	return ((size + (int)granularity - 1) / (int)granularity) * (int)granularity;
+}
+
 Framebuffer::RenderTarget::RenderTarget() :
 	Resource(nullptr),
 	IsRenderBuffer(false),
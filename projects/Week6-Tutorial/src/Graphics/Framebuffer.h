@@ -43,11 +43,23 @@ struct RenderTargetDescriptor {
 struct FramebufferDescriptor {
 	uint32_t Width;
 	uint32_t Height;
+	/**
+	 * When non-zero, attachments are allocated with their dimensions rounded up to a multiple of this
+	 * many pixels, so that resizing within that capacity only changes the area that is rendered to
+	 */
+	uint32_t Granularity;
+	/**
+	 * The number of frames (see Framebuffer::NextFrame) that the attachments must be larger than
+	 * needed before they are shrunk, 0 to shrink as soon as the framebuffer is resized
+	 */
+	uint32_t ShrinkDelay;
 	std::unordered_map<RenderTargetAttachment, RenderTargetDescriptor> RenderTargets;
 
 	FramebufferDescriptor() :
 		Width(0),
 		Height(0),
+		Granularity(0),
+		ShrinkDelay(0),
 		RenderTargets(std::unordered_map<RenderTargetAttachment, RenderTargetDescriptor>())
 	{ }
 };
@@ -63,17 +75,29 @@ public:
 	~Framebuffer();
 
 	/**
-	 * Gets the width of the framebuffer and its attachments in pixels
+	 * Gets the width of the area of the framebuffer that is rendered to in pixels
 	 */
 	uint32_t GetWidth() const;
 	/**
-	 * Gets the height of the framebuffer and its attachments in pixels
+	 * Gets the height of the area of the framebuffer that is rendered to in pixels
 	 */
 	uint32_t GetHeight() const;
 	/**
-	 * Gets the dimensions of the framebuffer and its attachments in pixels
+	 * Gets the dimensions of the area of the framebuffer that is rendered to in pixels. This is the
+	 * bottom left corner of the attachments, see GetCapacity
 	 */
 	glm::ivec2 GetSize() const;
+	/**
+	 * Gets the dimensions that the attachments have been allocated at in pixels, this is never
+	 * smaller than GetSize
+	 */
+	glm::ivec2 GetCapacity() const;
+	/**
+	 * Gets the scale that takes UVs over the rendered area to UVs in the attachments (size / capacity) in
+	 * xy, and the largest UV that can be sampled without bilinear filtering reading outside of the rendered
+	 * area in zw. This matches ScaleUV in shaders/fragments/deferred_post_common.glsl
+	 */
+	glm::vec4 GetUvScale() const;
 
 	/**
 	 * Gets the texture attached to the given render target attachment, or nullptr
@@ -85,20 +109,37 @@ public:
 	Texture2D::Sptr GetTextureAttachment(RenderTargetAttachment attachment) const;
 
 	/**
-	 * Resizes this Framebuffer and all attachments to the given dimensions in pixels. Destroys all data
-	 * in the rendertargets
+	 * Resizes this Framebuffer to the given dimensions in pixels. If the framebuffer has a granularity
+	 * and the new size fits within its capacity, only the rendered area changes. Otherwise the attachments
+	 * are re-created, which destroys all data in the rendertargets. Attachments that are larger than
+	 * needed are kept until they have been oversized for ShrinkDelay frames
 	 * 
 	 * @param width The new width for the framebuffer in pixels
 	 * @param height The new height for the framebuffer in pixels
 	 */
 	void Resize(uint32_t width, uint32_t height);
 	/**
-	 * Resizes this Framebuffer and all attachments to the given dimensions in pixels. Destroys all data
-	 * in the rendertargets
+	 * Resizes this Framebuffer to the given dimensions in pixels, see Resize(uint32_t, uint32_t)
 	 * 
 	 * @param size The new size of the framebuffer in pixels
 	 */
 	void Resize(const glm::ivec2& size);
+	/**
+	 * Resizes this Framebuffer, with the attachments allocated at exactly the given capacity. This lets
+	 * several framebuffers share the same UV scale. Attachments are only re-created if the capacity changes
+	 * 
+	 * @param size     The new size of the rendered area in pixels
+	 * @param capacity The size to allocate the attachments at in pixels, must be at least as large as size
+	 */
+	void Resize(const glm::ivec2& size, const glm::ivec2& capacity);
+
+	/**
+	 * Should be called once per frame for framebuffers with a ShrinkDelay. Shrinks the attachments
+	 * once they have been larger than needed for ShrinkDelay frames
+	 *
+	 * @returns True if the attachments were re-created
+	 */
+	bool NextFrame();
 
 	/**
 	 * Validates the framebuffer and returns true if it is ready for use in rendering
@@ -165,8 +206,12 @@ public:
 	static Framebuffer::Sptr FromJson(const nlohmann::json& blob);
 
 protected:
-	// The descriptor for this framebuffer
+	// The descriptor for this framebuffer, it's size is the area that gets rendered to
 	FramebufferDescriptor _description;
+	// The size that the attachments are allocated at
+	glm::ivec2            _capacity;
+	// The number of frames the attachments have been larger than they need to be
+	uint32_t              _framesOversized;
 	// True if the Framebuffer has been validated
 	bool                  _isValid;
 
@@ -191,5 +236,8 @@ protected:
 	std::vector<RenderTargetAttachment> _drawBuffers;
 
 	void _AddAttachment(RenderTargetAttachment attachment, const RenderTargetDescriptor& target);
+
+	// Rounds a size up to a multiple of the granularity
+	static glm::ivec2 __RoundUpToGranularity(const glm::ivec2& size, uint32_t granularity);
 };
 
@@ -17,6 +17,7 @@ ENUM(ShaderPartType, GLint,
 	 TessControl  = GL_TESS_CONTROL_SHADER,
 	 TessEval     = GL_TESS_EVALUATION_SHADER,
 	 Geometry     = GL_GEOMETRY_SHADER,
+	 Compute      = GL_COMPUTE_SHADER,
 	 Unknown      = GL_NONE // Usually good practice to have an "unknown" or "none" state for enums
 )
 
@@ -33,6 +34,14 @@ ENUM(TextureType, GLenum,
 	_2DArray = GL_TEXTURE_2D_ARRAY
 )
 
+// S3TC is an extension that our GLAD loader does not expose, but it is available on all desktop hardware
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT 0x83F1
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
 // https://www.khronos.org/registry/OpenGL-Refpages/gl4/html/glTexImage2D.xhtml
 // These are some of our more common available internal formats
 ENUM(InternalFormat, GLint,
@@ -52,10 +61,53 @@ ENUM(InternalFormat, GLint,
 	RGBA8        = GL_RGBA8,
 	SRGBA        = GL_SRGB8_ALPHA8,
 	RGBA16       = GL_RGBA16,
-	RGB32AF      = GL_RGBA32F
+	RGB32AF      = GL_RGBA32F,
+	// Block compressed formats, see TextureCompression.h
+	BC1          = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT,
+	BC3          = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT,
+	BC4          = GL_COMPRESSED_RED_RGTC1,
+	BC5          = GL_COMPRESSED_RG_RGTC2,
+	BC7          = GL_COMPRESSED_RGBA_BPTC_UNORM
 	// Note: There are sized internal formats but there is a LOT of them
 )
 
+/*
+ * Checks whether the given internal format is one of our block compressed formats
+ * @param format The format to check
+ * @returns True if the format stores 4x4 texel blocks
+ */
+constexpr bool IsCompressedFormat(InternalFormat format) {
+	switch (format) {
+		case InternalFormat::BC1:
+		case InternalFormat::BC3:
+		case InternalFormat::BC4:
+		case InternalFormat::BC5:
+		case InternalFormat::BC7:
+			return true;
+		default:
+			return false;
+	}
+}
+
+/*
+ * Gets the number of bytes that a single 4x4 block takes up in a compressed format
+ * @param format The compressed format to check
+ * @returns The size of a single block in bytes, or 0 if the format is not compressed
+ */
+constexpr size_t GetCompressedBlockSize(InternalFormat format) {
+	switch (format) {
+		case InternalFormat::BC1:
+		case InternalFormat::BC4:
+			return 8;
+		case InternalFormat::BC3:
+		case InternalFormat::BC5:
+		case InternalFormat::BC7:
+			return 16;
+		default:
+			return 0;
+	}
+}
+
 // The layout of the input pixel data
 ENUM(PixelFormat, GLint,
     Unknown      = GL_NONE,
@@ -815,6 +867,11 @@ ENUM(AttributeType, GLenum,
 	 UInt    = GL_UNSIGNED_INT,
 	 Float   = GL_FLOAT,
 	 Double  = GL_DOUBLE,
+	 // 16 bit floats, half the size of Float for data that doesn't need the precision (ex: UVs)
+	 HalfFloat   = GL_HALF_FLOAT,
+	 // 3 10 bit components and a 2 bit component packed into 32 bits, these must have a size of 4
+	 Int2101010  = GL_INT_2_10_10_10_REV,
+	 UInt2101010 = GL_UNSIGNED_INT_2_10_10_10_REV,
 	 Unknown = GL_NONE
 )
 
@@ -866,6 +923,7 @@ ENUM(RenderTargetType, uint32_t,
 	 ColorRgb10   = GL_RGB10,
 	 ColorRgb8    = GL_RGB8,
 	 ColorRG8     = GL_RG8,
+	 ColorRG16F   = GL_RG16F,
 	 ColorRed8    = GL_R8,
 	 ColorRgb16F  = GL_RGB16F,
 	 ColorRgba16F = GL_RGBA16F,
@@ -0,0 +1,202 @@
+#include "Graphics/GpuMemory.h"
+
+#include <algorithm>
+#include <Logging.h>
+
+#include "Graphics/GlEnums.h"
+
+uint64_t GpuMemory::_usage[GpuMemory::CATEGORY_COUNT]       = { 0 };
+uint32_t GpuMemory::_objectCount[GpuMemory::CATEGORY_COUNT] = { 0 };
+uint64_t GpuMemory::_totalUsage          = 0;
+uint64_t GpuMemory::_budget              = 0;
+uint32_t GpuMemory::_evictionAge         = 120;
+uint64_t GpuMemory::_frameIndex          = 0;
+uint64_t GpuMemory::_totalEvictions      = 0;
+uint64_t GpuMemory::_totalReloads        = 0;
+bool     GpuMemory::_isOverBudget        = false;
+bool     GpuMemory::_isEvictAllRequested = false;
+
+std::vector<IGpuEvictable*> GpuMemory::_evictables;
+
+/// <summary>
+/// Gets the number of bytes a single texel takes up for a sized internal format. Drivers usually
+/// pad 3 component formats out to 4 components, so we count them as such
+/// </summary>
+/// <returns>The size of a texel in bytes, or 0 for block compressed formats</returns>
+inline uint64_t __GetTexelSize(GLenum format) {
+	if (IsCompressedFormat((InternalFormat)format)) {
+		return 0;
+	}
+	switch (format) {
+		case GL_R8:
+		case GL_STENCIL_INDEX4:
+		case GL_STENCIL_INDEX8:
+			return 1;
+		case GL_R16:
+		case GL_R16F:
+		case GL_RG8:
+		case GL_DEPTH_COMPONENT16:
+		case GL_STENCIL_INDEX16:
+			return 2;
+		case GL_RGB16:
+		case GL_RGB16F:
+		case GL_RGBA16:
+		case GL_RGBA16F:
+		case GL_RG32F:
+			return 8;
+		case GL_RGB32F:
+		case GL_RGBA32F:
+			return 16;
+		// RGB8, RGBA8, RGB10, RG16, R32F, and all the packed depth formats
+		default:
+			return 4;
+	}
+}
+
+void GpuMemory::SetBudget(uint64_t bytes) {
+	_budget = bytes;
+	_isOverBudget = false;
+}
+
+uint64_t GpuMemory::GetBudget() {
+	return _budget;
+}
+
+void GpuMemory::SetEvictionAge(uint32_t frames) {
+	_evictionAge = frames;
+}
+
+uint32_t GpuMemory::GetEvictionAge() {
+	return _evictionAge;
+}
+
+void GpuMemory::Update() {
+	// Handle evict requests before advancing the frame, so that anything used last frame is kept
+	if (_isEvictAllRequested) {
+		_isEvictAllRequested = false;
+		uint64_t before = _totalUsage;
+		uint32_t evicted = EvictAll();
+		LOG_INFO("Evicted {} unused resources ({} bytes)", evicted, before - _totalUsage);
+	}
+
+	_frameIndex++;
+
+	if (_budget == 0 || _totalUsage <= _budget) {
+		_isOverBudget = false;
+		return;
+	}
+
+	uint64_t before = _totalUsage;
+	uint32_t evicted = _Evict(_budget, _evictionAge);
+	if (evicted > 0) {
+		LOG_INFO("Evicted {} resources ({} bytes) to stay under the GPU memory budget", evicted, before - _totalUsage);
+	}
+
+	// Everything that's left is either in use or can't be reloaded, so there's nothing more we can do
+	if (_totalUsage > _budget && !_isOverBudget) {
+		LOG_WARN("GPU memory usage ({} MB) is over budget ({} MB), and nothing else can be evicted", _totalUsage / (1024 * 1024), _budget / (1024 * 1024));
+		_isOverBudget = true;
+	}
+}
+
+uint32_t GpuMemory::EvictAll() {
+	return _Evict(0, 1);
+}
+
+uint32_t GpuMemory::GetEvictedCount() {
+	return static_cast<uint32_t>(std::count_if(_evictables.begin(), _evictables.end(), [](const IGpuEvictable* item) {
+		return item->IsEvicted();
+	}));
+}
+
+uint64_t GpuMemory::CalculateTextureSize(GLenum format, uint32_t width, uint32_t height, uint32_t depth, uint32_t levels, uint32_t layers, uint32_t samples) {
+	const uint64_t texelSize = __GetTexelSize(format);
+	const uint64_t blockSize = GetCompressedBlockSize((InternalFormat)format);
+
+	uint64_t result = 0;
+	for (uint32_t level = 0; level < std::max(levels, 1u); level++) {
+		uint64_t levelWidth  = std::max(width  >> level, 1u);
+		uint64_t levelHeight = std::max(height >> level, 1u);
+		uint64_t levelDepth  = std::max(depth  >> level, 1u);
+		if (blockSize > 0) {
+			result += ((levelWidth + 3) / 4) * ((levelHeight + 3) / 4) * levelDepth * blockSize;
+		} else {
+			result += levelWidth * levelHeight * levelDepth * texelSize;
+		}
+	}
+	return result * std::max(layers, 1u) * std::max(samples, 1u);
+}
+
+void GpuMemory::Track(GpuMemoryCategory category, uint64_t oldSize, uint64_t newSize) {
+	uint8_t ix = *category;
+	_usage[ix] = _usage[ix] - std::min(_usage[ix], oldSize) + newSize;
+	_totalUsage = _totalUsage - std::min(_totalUsage, oldSize) + newSize;
+	if (oldSize == 0 && newSize > 0) {
+		_objectCount[ix]++;
+	} else if (oldSize > 0 && newSize == 0 && _objectCount[ix] > 0) {
+		_objectCount[ix]--;
+	}
+}
+
+uint32_t GpuMemory::_Evict(uint64_t target, uint64_t minAge) {
+	// Only resources that haven't been used in a while are candidates, so that we don't evict something
+	// that we're going to need again in a couple frames
+	std::vector<IGpuEvictable*> candidates;
+	for (IGpuEvictable* item : _evictables) {
+		if (!item->_isEvicted && item->_lastUsedFrame + minAge <= _frameIndex && item->_CanEvict()) {
+			candidates.push_back(item);
+		}
+	}
+	std::sort(candidates.begin(), candidates.end(), [](const IGpuEvictable* a, const IGpuEvictable* b) {
+		return a->_lastUsedFrame < b->_lastUsedFrame;
+	});
+
+	uint32_t result = 0;
+	for (IGpuEvictable* item : candidates) {
+		if (_totalUsage <= target) {
+			break;
+		}
+		if (item->Evict()) {
+			result++;
+		}
+	}
+	return result;
+}
+
+IGpuEvictable::IGpuEvictable() :
+	_lastUsedFrame(GpuMemory::GetFrameIndex()),
+	_isEvicted(false),
+	_evictableIndex(GpuMemory::_evictables.size())
+{
+	GpuMemory::_evictables.push_back(this);
+}
+
+IGpuEvictable::~IGpuEvictable() {
+	// Swap and pop, so we don't need to search or shift the list
+	IGpuEvictable* last = GpuMemory::_evictables.back();
+	GpuMemory::_evictables[_evictableIndex] = last;
+	last->_evictableIndex = _evictableIndex;
+	GpuMemory::_evictables.pop_back();
+}
+
+bool IGpuEvictable::Evict() {
+	if (_isEvicted || !_CanEvict()) {
+		return false;
+	}
+	LOG_TRACE("Evicting resource ({} bytes) last used in frame {}", _GetEvictableSize(), _lastUsedFrame);
+	_OnEvict();
+	_isEvicted = true;
+	GpuMemory::_totalEvictions++;
+	return true;
+}
+
+void IGpuEvictable::MakeResident() const {
+	_MarkUsed();
+}
+
+void IGpuEvictable::_Reload() {
+	// Clear the flag first, in case reloading ends up using the resource
+	_isEvicted = false;
+	_OnReload();
+	GpuMemory::_totalReloads++;
+}
@@ -0,0 +1,213 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <glad/glad.h>
+#include <EnumToString.h>
+
+#include "Utils/Macros.h"
+
+/**
+ * The categories that we break GPU memory usage down into
+ */
+ENUM(GpuMemoryCategory, uint8_t,
+	VertexBuffer  = 0,
+	IndexBuffer   = 1,
+	UniformBuffer = 2,
+	Texture       = 3,
+	RenderTarget  = 4
+)
+
+class IGpuEvictable;
+
+/**
+ * Keeps track of how much GPU memory our graphics resources are using, and keeps us under a budget
+ * by evicting resources that have not been used in a while
+ *
+ * OpenGL has no portable way to ask how much memory a resource actually takes up, so the sizes
+ * reported by resources are estimates based on their dimensions and formats. Drivers may pad or
+ * compress resources, so treat these as a lower bound
+ */
+class GpuMemory {
+public:
+	GpuMemory() = delete;
+
+	static constexpr size_t CATEGORY_COUNT = 5;
+
+	/**
+	 * Sets the number of bytes that we try to keep GPU memory usage under, or 0 for no limit
+	 */
+	static void SetBudget(uint64_t bytes);
+	static uint64_t GetBudget();
+	/**
+	 * Sets how many frames a resource needs to go unused before it can be evicted, this stops us
+	 * from evicting resources that are only used every few frames and immediately reloading them
+	 */
+	static void SetEvictionAge(uint32_t frames);
+	static uint32_t GetEvictionAge();
+
+	/**
+	 * Should be called once at the start of every frame. Advances the frame counter that resources
+	 * use to track when they were last used, and evicts the least recently used resources if we
+	 * are over budget
+	 */
+	static void Update();
+	/**
+	 * Gets the index of the current frame, as counted by Update
+	 */
+	static uint64_t GetFrameIndex() { return _frameIndex; }
+
+	/**
+	 * Evicts every resource that can be evicted and has not been used this frame, regardless of the budget
+	 * @returns The number of resources that were evicted
+	 */
+	static uint32_t EvictAll();
+	/**
+	 * Requests an EvictAll at the start of the next Update. Use this from inside a frame (ex: the editor),
+	 * where draw commands that have been recorded but not submitted may still reference the resources
+	 */
+	static void RequestEvictAll() { _isEvictAllRequested = true; }
+
+	/**
+	 * Gets the total number of bytes in use across all categories
+	 */
+	static uint64_t GetTotalUsage() { return _totalUsage; }
+	/**
+	 * Gets the number of bytes in use by resources in the given category
+	 */
+	static uint64_t GetUsage(GpuMemoryCategory category) { return _usage[*category]; }
+	/**
+	 * Gets the number of resources in the given category that are using memory
+	 */
+	static uint32_t GetObjectCount(GpuMemoryCategory category) { return _objectCount[*category]; }
+	/**
+	 * Gets the number of resources that can be evicted, and how many of those are currently evicted
+	 */
+	static uint32_t GetEvictableCount() { return static_cast<uint32_t>(_evictables.size()); }
+	static uint32_t GetEvictedCount();
+	/**
+	 * Gets the total number of resources evicted and reloaded since the app started
+	 */
+	static uint64_t GetTotalEvictions() { return _totalEvictions; }
+	static uint64_t GetTotalReloads() { return _totalReloads; }
+
+	/**
+	 * Calculates how many bytes a texture will take up, including all of it's mip levels
+	 * @param format The GL internal format of the texture
+	 * @param width The width of the base level, in texels
+	 * @param height The height of the base level, in texels
+	 * @param depth The depth of the base level, in texels (1 for 1D and 2D textures)
+	 * @param levels The number of mip levels allocated
+	 * @param layers The number of array layers or cube faces, these are not reduced by mips
+	 * @param samples The number of samples per texel for multisampled textures
+	 */
+	static uint64_t CalculateTextureSize(GLenum format, uint32_t width, uint32_t height, uint32_t depth, uint32_t levels, uint32_t layers = 1, uint32_t samples = 1);
+
+	/**
+	 * Adjusts the tracked usage for a category, this is called by IGraphicsResource when resources
+	 * allocate or release memory and should not need to be called anywhere else
+	 * @param category The category the memory belongs to
+	 * @param oldSize The number of bytes the resource was using
+	 * @param newSize The number of bytes the resource is now using
+	 */
+	static void Track(GpuMemoryCategory category, uint64_t oldSize, uint64_t newSize);
+
+protected:
+	friend class IGpuEvictable;
+
+	static uint64_t _usage[CATEGORY_COUNT];
+	static uint32_t _objectCount[CATEGORY_COUNT];
+	static uint64_t _totalUsage;
+	static uint64_t _budget;
+	static uint32_t _evictionAge;
+	static uint64_t _frameIndex;
+	static uint64_t _totalEvictions;
+	static uint64_t _totalReloads;
+	// True once we've warned about being over budget with nothing left to evict, so we don't spam the log
+	static bool     _isOverBudget;
+	// Set by RequestEvictAll, handled at the start of the next Update
+	static bool     _isEvictAllRequested;
+
+	// All the resources that are able to release their memory, evictables store their index in here
+	// so that they can remove themselves without a search
+	static std::vector<IGpuEvictable*> _evictables;
+
+	// Evicts resources that have not been used recently, oldest first, until we are at or below the target
+	static uint32_t _Evict(uint64_t target, uint64_t minAge);
+};
+
+/**
+ * Interface for resources that can release their GPU memory when we're over budget, and load it back
+ * the next time they are used. Evicted resources stay alive and keep their GUIDs, so anything holding
+ * on to them does not need to know that they were ever evicted
+ *
+ * Implementations should call _MarkUsed whenever the resource is about to be used for rendering
+ */
+class IGpuEvictable {
+public:
+	NO_COPY(IGpuEvictable);
+	NO_MOVE(IGpuEvictable);
+
+	virtual ~IGpuEvictable();
+
+	/**
+	 * Returns true if this resource's GPU memory has been released
+	 */
+	bool IsEvicted() const { return _isEvicted; }
+	/**
+	 * Gets the frame that this resource was last used in
+	 */
+	uint64_t GetLastUsedFrame() const { return _lastUsedFrame; }
+	/**
+	 * Gets the number of bytes that evicting this resource would release, or 0 if it is already evicted
+	 */
+	uint64_t GetEvictableSize() const { return _isEvicted ? 0 : _GetEvictableSize(); }
+
+	/**
+	 * Releases this resource's GPU memory if it can be reloaded later
+	 * @returns True if the resource was evicted
+	 */
+	bool Evict();
+	/**
+	 * Makes sure this resource is loaded, and marks it as used this frame
+	 */
+	void MakeResident() const;
+
+protected:
+	IGpuEvictable();
+
+	/**
+	 * Marks this resource as used in the current frame, reloading it first if it was evicted
+	 */
+	inline void _MarkUsed() const {
+		_lastUsedFrame = GpuMemory::GetFrameIndex();
+		if (_isEvicted) {
+			const_cast<IGpuEvictable*>(this)->_Reload();
+		}
+	}
+
+	/**
+	 * Should return true if the resource knows how to reload itself (ex: it was loaded from a file)
+	 */
+	virtual bool _CanEvict() const = 0;
+	/**
+	 * Gets the number of bytes that evicting this resource will release
+	 */
+	virtual uint64_t _GetEvictableSize() const = 0;
+	/**
+	 * Releases the resource's GPU memory
+	 */
+	virtual void _OnEvict() = 0;
+	/**
+	 * Reloads the resource from it's source
+	 */
+	virtual void _OnReload() = 0;
+
+private:
+	friend class GpuMemory;
+
+	mutable uint64_t _lastUsedFrame;
+	bool             _isEvicted;
+	size_t           _evictableIndex;
+
+	void _Reload();
+};
@@ -0,0 +1,62 @@
+#include "Graphics/GpuTimer.h"
+
+#include <GLM/glm.hpp>
+
+GpuTimer::GpuTimer(uint32_t latency) :
+	_queries(glm::max(latency, 1u), 0),
+	_pending(glm::max(latency, 1u), false),
+	_next(0),
+	_oldest(0),
+	_running(false)
+{
+	glCreateQueries(GL_TIME_ELAPSED, (GLsizei)_queries.size(), _queries.data());
+}
+
+GpuTimer::~GpuTimer() {
+	glDeleteQueries((GLsizei)_queries.size(), _queries.data());
+}
+
+void GpuTimer::Begin() {
+	// If we're still waiting on this query, the GPU is more than a ring behind us. We skip this span
+	// rather than stalling to get the old result back
+	if (_running || _pending[_next]) {
+		return;
+	}
+
+	glBeginQuery(GL_TIME_ELAPSED, _queries[_next]);
+	_running = true;
+}
+
+void GpuTimer::End() {
+	if (!_running) {
+		return;
+	}
+
+	glEndQuery(GL_TIME_ELAPSED);
+	_pending[_next] = true;
+	_next = (_next + 1) % _queries.size();
+	_running = false;
+}
+
+bool GpuTimer::Poll(float& milliseconds) {
+	bool result = false;
+
+	// Queries complete in order, so we can stop at the first one that isn't ready
+	while (_pending[_oldest]) {
+		GLint available = GL_FALSE;
+		glGetQueryObjectiv(_queries[_oldest], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available) {
+			break;
+		}
+
+		GLuint64 nanoseconds = 0;
+		glGetQueryObjectui64v(_queries[_oldest], GL_QUERY_RESULT, &nanoseconds);
+		milliseconds = (float)(nanoseconds / 1.0e6);
+		result = true;
+
+		_pending[_oldest] = false;
+		_oldest = (_oldest + 1) % _queries.size();
+	}
+
+	return result;
+}
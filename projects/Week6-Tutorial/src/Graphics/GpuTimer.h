@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "Utils/Macros.h"
+
+/// <summary>
+/// Measures how long a span of GPU work takes using GL_TIME_ELAPSED queries. Results take a few
+/// frames to become available, so the timer cycles through a small ring of queries and never
+/// waits on the GPU. Poll returns the most recent result that has come back
+///
+/// Only one timer (or any other GL_TIME_ELAPSED query) can be running at a time
+/// </summary>
+class GpuTimer final {
+public:
+	MAKE_PTRS(GpuTimer);
+	NO_COPY(GpuTimer);
+	NO_MOVE(GpuTimer);
+
+	/// <summary>
+	/// Creates a new timer
+	/// </summary>
+	/// <param name="latency">The number of queries in the ring, this is how many frames a result can be in flight for</param>
+	GpuTimer(uint32_t latency = 4);
+	~GpuTimer();
+
+	/// <summary>
+	/// Starts timing. If the query we would use is still waiting on a result, this span will not be timed
+	/// </summary>
+	void Begin();
+	/// <summary>
+	/// Stops timing, does nothing if the timer is not running
+	/// </summary>
+	void End();
+	/// <summary>
+	/// Returns true if Begin has been called without a matching call to End
+	/// </summary>
+	bool IsRunning() const { return _running; }
+
+	/// <summary>
+	/// Collects the results of any queries that have completed, without blocking
+	/// </summary>
+	/// <param name="milliseconds">Will be set to the most recent result, if one was available</param>
+	/// <returns>True if a new result was available, false if otherwise</returns>
+	bool Poll(float& milliseconds);
+
+private:
+	std::vector<GLuint> _queries;
+	// True for queries that have been issued but not yet read back
+	std::vector<bool>   _pending;
+	// The next query in the ring to issue, and the oldest one that is still pending
+	uint32_t _next;
+	uint32_t _oldest;
+	bool     _running;
+};
@@ -2,9 +2,15 @@
 
 IGraphicsResource::IGraphicsResource() :
 	_debugName(""),
-	_rendererId(0)
+	_rendererId(0),
+	_gpuMemoryUsage(0),
+	_gpuMemoryCategory(GpuMemoryCategory::VertexBuffer)
 { }
 
+IGraphicsResource::~IGraphicsResource() {
+	_SetGpuMemoryUsage(0);
+}
+
 void IGraphicsResource::SetDebugName(const std::string& name)
 {
 	_debugName = name;
@@ -31,3 +37,16 @@ void IGraphicsResource::_SetRenderId(uint32_t renderId)
 		glObjectLabel(*type, _rendererId, _debugName.size(), _debugName.c_str());
 	}
 }
+
+void IGraphicsResource::SetGpuMemoryCategory(GpuMemoryCategory category) {
+	if (category != _gpuMemoryCategory) {
+		GpuMemory::Track(_gpuMemoryCategory, _gpuMemoryUsage, 0);
+		GpuMemory::Track(category, 0, _gpuMemoryUsage);
+		_gpuMemoryCategory = category;
+	}
+}
+
+void IGraphicsResource::_SetGpuMemoryUsage(uint64_t bytes) {
+	GpuMemory::Track(_gpuMemoryCategory, _gpuMemoryUsage, bytes);
+	_gpuMemoryUsage = bytes;
+}
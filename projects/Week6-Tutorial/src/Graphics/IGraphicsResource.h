@@ -7,6 +7,7 @@
 
 #include "Utils/ResourceManager/IResource.h"
 #include "Utils/Macros.h"
+#include "Graphics/GpuMemory.h"
 
 /**
  * Enumerates all OpenGL resource types, as can be passed into glObjectLabel and other 
@@ -35,7 +36,7 @@ public:
 	// For pointers and deletion of move and copy
 	DEFINE_RESOURCE(IGraphicsResource)
 
-	virtual ~IGraphicsResource() = default;
+	virtual ~IGraphicsResource();
 
 	/**
 	 * Should be overridden in derived classes to return a resource type identifier
@@ -58,6 +59,20 @@ public:
 	 */
 	virtual uint32_t GetHandle() const;
 
+	/**
+	 * Gets the estimated number of bytes of GPU memory that this resource is using
+	 */
+	uint64_t GetGpuMemoryUsage() const { return _gpuMemoryUsage; }
+	/**
+	 * Gets the category that this resource's memory is counted under
+	 */
+	GpuMemoryCategory GetGpuMemoryCategory() const { return _gpuMemoryCategory; }
+	/**
+	 * Changes the category that this resource's memory is counted under (ex: for textures that are
+	 * used as render targets)
+	 */
+	void SetGpuMemoryCategory(GpuMemoryCategory category);
+
 protected:
 	IGraphicsResource();
 	
@@ -66,7 +81,15 @@ protected:
 	 * is accurate. Should be used instead of setting _rendererId directly
 	 */
 	void _SetRenderId(uint32_t renderId);
+	/**
+	 * Updates the amount of GPU memory this resource is using, should be called whenever
+	 * the resource allocates or releases storage
+	 * @param bytes The estimated number of bytes the resource's storage takes up
+	 */
+	void _SetGpuMemoryUsage(uint64_t bytes);
 
-	std::string _debugName;
-	uint32_t    _rendererId;
+	std::string       _debugName;
+	uint32_t          _rendererId;
+	uint64_t          _gpuMemoryUsage;
+	GpuMemoryCategory _gpuMemoryCategory;
 };
\ No newline at end of file
@@ -0,0 +1,173 @@
+#include "Graphics/RenderTargetPool.h"
+
+#include <algorithm>
+
+RenderTargetPool::RenderTargetPool() :
+	MaxIdleFrames(30),
+	_buckets(),
+	_owners(),
+	_frameIndex(0),
+	_activeCount(0),
+	_renderSize(0),
+	_renderCapacity(0)
+{ }
+
+RenderTargetPool::~RenderTargetPool() = default;
+
+Framebuffer::Sptr RenderTargetPool::Acquire(const FramebufferDescriptor& description) {
+	LOG_ASSERT(description.Width * description.Height > 0, "Width and height must both be > 0");
+
+	// Targets at the render size are allocated at the G-Buffer's capacity, everything else is allocated exactly.
+	// Pooled targets never resize themselves, so we clear out the resize policy
+	glm::ivec2 size = glm::ivec2(description.Width, description.Height);
+	glm::ivec2 capacity = size == _renderSize ? _renderCapacity : size;
+	FramebufferDescriptor allocation = description;
+	allocation.Width       = capacity.x;
+	allocation.Height      = capacity.y;
+	allocation.Granularity = 0;
+	allocation.ShrinkDelay = 0;
+
+	uint64_t key = __HashDescriptor(allocation);
+	std::vector<Entry>& bucket = _buckets[key];
+
+	// Try and find a free target that matches our description
+	for (Entry& entry : bucket) {
+		if (!entry.InUse && __DescriptorsMatch(entry.Description, allocation)) {
+			entry.InUse = true;
+			entry.LastUsedFrame = _frameIndex;
+			entry.Buffer->Resize(size, capacity);
+			_activeCount++;
+			return entry.Buffer;
+		}
+	}
+
+	// Nothing available, we need to make a new one
+	Entry entry;
+	entry.Buffer        = std::make_shared<Framebuffer>(allocation);
+	entry.Description   = allocation;
+	entry.InUse         = true;
+	entry.LastUsedFrame = _frameIndex;
+	entry.Buffer->Resize(size, capacity);
+	entry.Buffer->Validate();
+	entry.Buffer->SetDebugName("Pooled Target " + std::to_string(allocation.Width) + "x" + std::to_string(allocation.Height));
+
+	_owners[entry.Buffer->GetHandle()] = key;
+	bucket.push_back(entry);
+	_activeCount++;
+
+	return entry.Buffer;
+}
+
+Framebuffer::Sptr RenderTargetPool::Acquire(uint32_t width, uint32_t height, RenderTargetType format) {
+	FramebufferDescriptor description = FramebufferDescriptor();
+	description.Width  = width;
+	description.Height = height;
+	description.RenderTargets[RenderTargetAttachment::Color0] = RenderTargetDescriptor(format);
+	return Acquire(description);
+}
+
+void RenderTargetPool::SetRenderSize(const glm::ivec2& size, const glm::ivec2& capacity) {
+	LOG_ASSERT(capacity.x >= size.x && capacity.y >= size.y, "Capacity must be at least as large as the size");
+	_renderSize     = size;
+	_renderCapacity = capacity;
+}
+
+void RenderTargetPool::Release(const Framebuffer::Sptr& buffer) {
+	if (buffer == nullptr) {
+		return;
+	}
+
+	auto it = _owners.find(buffer->GetHandle());
+	if (it == _owners.end()) {
+		return;
+	}
+
+	for (Entry& entry : _buckets[it->second]) {
+		if (entry.Buffer == buffer) {
+			if (entry.InUse) {
+				entry.InUse = false;
+				entry.LastUsedFrame = _frameIndex;
+				_activeCount--;
+			}
+			return;
+		}
+	}
+}
+
+void RenderTargetPool::NextFrame() {
+	_frameIndex++;
+
+	for (auto bucketIt = _buckets.begin(); bucketIt != _buckets.end(); ) {
+		std::vector<Entry>& bucket = bucketIt->second;
+
+		// Move any targets that have been idle for too long to the end of the bucket and destroy them
+		auto removed = std::remove_if(bucket.begin(), bucket.end(), [&](const Entry& entry) {
+			return !entry.InUse && (_frameIndex - entry.LastUsedFrame) > MaxIdleFrames;
+		});
+		for (auto it = removed; it != bucket.end(); it++) {
+			_owners.erase(it->Buffer->GetHandle());
+		}
+		bucket.erase(removed, bucket.end());
+
+		if (bucket.empty()) {
+			bucketIt = _buckets.erase(bucketIt);
+		} else {
+			bucketIt++;
+		}
+	}
+}
+
+void RenderTargetPool::Clear() {
+	for (auto& [key, bucket] : _buckets) {
+		auto removed = std::remove_if(bucket.begin(), bucket.end(), [](const Entry& entry) { return !entry.InUse; });
+		for (auto it = removed; it != bucket.end(); it++) {
+			_owners.erase(it->Buffer->GetHandle());
+		}
+		bucket.erase(removed, bucket.end());
+	}
+}
+
+size_t RenderTargetPool::GetTargetCount() const {
+	return _owners.size();
+}
+
+size_t RenderTargetPool::GetActiveCount() const {
+	return _activeCount;
+}
+
+uint64_t RenderTargetPool::__HashDescriptor(const FramebufferDescriptor& description) {
+	// FNV-1a over the size and attachments. The attachments are stored in an unordered map, so we
+	// sort them by attachment point first so that equal descriptors will always hash the same
+	std::vector<std::pair<RenderTargetAttachment, RenderTargetDescriptor>> targets(description.RenderTargets.begin(), description.RenderTargets.end());
+	std::sort(targets.begin(), targets.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+	uint64_t hash = 0xcbf29ce484222325ull;
+	auto combine = [&](uint64_t value) {
+		hash ^= value;
+		hash *= 0x100000001b3ull;
+	};
+	combine(description.Width);
+	combine(description.Height);
+	for (const auto& [attachment, target] : targets) {
+		combine(*attachment);
+		combine(*target.Format);
+		combine((target.UseTexture ? 1 : 0) | (target.IsShadow ? 2 : 0));
+	}
+	return hash;
+}
+
+bool RenderTargetPool::__DescriptorsMatch(const FramebufferDescriptor& a, const FramebufferDescriptor& b) {
+	if (a.Width != b.Width || a.Height != b.Height || a.RenderTargets.size() != b.RenderTargets.size()) {
+		return false;
+	}
+	for (const auto& [attachment, target] : a.RenderTargets) {
+		auto it = b.RenderTargets.find(attachment);
+		if (it == b.RenderTargets.end() ||
+			it->second.Format != target.Format ||
+			it->second.UseTexture != target.UseTexture ||
+			it->second.IsShadow != target.IsShadow) {
+			return false;
+		}
+	}
+	return true;
+}
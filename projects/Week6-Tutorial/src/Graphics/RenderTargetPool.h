@@ -0,0 +1,110 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include "Graphics/Framebuffer.h"
+#include "Utils/Macros.h"
+
+/**
+ * Stores a pool of framebuffers that can be handed out for transient use within a frame,
+ * such as for post processing or intermediate render passes. Framebuffers are keyed on their
+ * size, attachment points and formats, so once a pass releases a target, the next pass that
+ * asks for the same configuration will re-use the same memory
+ *
+ * Targets that have not been requested for a number of frames (ex: after the window is
+ * resized) will be destroyed when NextFrame is called
+ *
+ * Targets that are requested at the render size (see SetRenderSize) are allocated at the
+ * render capacity instead, so that they share a UV scale with the G-Buffer, and so that changing
+ * the render size within that capacity can keep re-using the same targets
+ */
+class RenderTargetPool final {
+public:
+	MAKE_PTRS(RenderTargetPool);
+	NO_COPY(RenderTargetPool);
+	NO_MOVE(RenderTargetPool);
+
+	/**
+	 * The number of frames a free target can go unused before it is destroyed
+	 */
+	uint32_t MaxIdleFrames;
+
+	RenderTargetPool();
+	~RenderTargetPool();
+
+	/**
+	 * Gets a framebuffer matching the given description, re-using a free one from the pool if possible.
+	 * The contents of the framebuffer are undefined, and it must be returned with Release once the caller
+	 * is done with it
+	 *
+	 * @param description The size and attachments of the framebuffer to get
+	 * @returns A framebuffer matching the description
+	 */
+	Framebuffer::Sptr Acquire(const FramebufferDescriptor& description);
+	/**
+	 * Shorthand for acquiring a framebuffer with a single color attachment
+	 *
+	 * @param width  The width of the framebuffer, in pixels
+	 * @param height The height of the framebuffer, in pixels
+	 * @param format The format of the Color0 attachment
+	 */
+	Framebuffer::Sptr Acquire(uint32_t width, uint32_t height, RenderTargetType format = RenderTargetType::ColorRgba8);
+	/**
+	 * Sets the size that the scene is being rendered at, and the size that targets of that size should
+	 * be allocated at. Targets handed out after this will have GetSize() == size and GetCapacity() == capacity
+	 *
+	 * @param size     The size the scene is rendered at, in pixels
+	 * @param capacity The size the G-Buffer's attachments are allocated at, in pixels
+	 */
+	void SetRenderSize(const glm::ivec2& size, const glm::ivec2& capacity);
+
+	/**
+	 * Returns a framebuffer to the pool so that it can be handed out again. Framebuffers that did not
+	 * come from this pool are ignored
+	 *
+	 * @param buffer The framebuffer to release
+	 */
+	void Release(const Framebuffer::Sptr& buffer);
+
+	/**
+	 * Advances the pool's frame counter and destroys any free targets that have been idle
+	 * for more than MaxIdleFrames
+	 */
+	void NextFrame();
+	/**
+	 * Destroys all framebuffers that are not currently in use
+	 */
+	void Clear();
+
+	/**
+	 * Gets the total number of framebuffers that are owned by this pool
+	 */
+	size_t GetTargetCount() const;
+	/**
+	 * Gets the number of framebuffers that are currently handed out
+	 */
+	size_t GetActiveCount() const;
+
+private:
+	struct Entry {
+		Framebuffer::Sptr     Buffer;
+		FramebufferDescriptor Description;
+		bool                  InUse;
+		uint64_t              LastUsedFrame;
+	};
+
+	// Maps the hash of a descriptor to all the buffers that were created with a matching descriptor,
+	// descriptors are stored with the size that the buffer was allocated at
+	std::unordered_map<uint64_t, std::vector<Entry>> _buckets;
+	// Maps framebuffer handles to the bucket they were created in, so we can release them quickly
+	std::unordered_map<GLuint, uint64_t> _owners;
+	uint64_t _frameIndex;
+	size_t   _activeCount;
+	// Requests for the render size are allocated at the render capacity
+	glm::ivec2 _renderSize;
+	glm::ivec2 _renderCapacity;
+
+	static uint64_t __HashDescriptor(const FramebufferDescriptor& description);
+	static bool __DescriptorsMatch(const FramebufferDescriptor& a, const FramebufferDescriptor& b);
+};
@@ -12,6 +12,9 @@ Renderbuffer::Renderbuffer(const RenderbufferDescription& description) :
 	else {
 		glNamedRenderbufferStorage(_rendererId, *_description.Format, _description.Width, _description.Height);
 	}
+
+	_gpuMemoryCategory = GpuMemoryCategory::RenderTarget;
+	_SetGpuMemoryUsage(GpuMemory::CalculateTextureSize(*_description.Format, _description.Width, _description.Height, 1, 1, 1, _description.MultisampleCount));
 }
 
 Renderbuffer::~Renderbuffer() {
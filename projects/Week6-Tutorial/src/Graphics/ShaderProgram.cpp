@@ -3,22 +3,41 @@
 #include <fstream>
 #include <sstream>
 #include <filesystem>
+#include <algorithm>
+#include <cstring>
 
 #include "Utils/FileHelpers.h"
+#include "Utils/StringUtils.h"
 #include "Utils/JsonGlmHelpers.h"
+#include "Utils/ImportCache.h"
+
+std::unordered_set<ShaderProgram*> ShaderProgram::__programs;
+std::unordered_set<std::string> ShaderProgram::__enabledGlobalKeywords;
+uint32_t ShaderProgram::__globalKeywordRevision = 0;
+int ShaderProgram::MaxVariants = 64;
 
 ShaderProgram::ShaderProgram() : 
 	IGraphicsResource(),
-	IResource()
+	IResource(),
+	_revision(0),
+	_globalKeywords(0),
+	_variantLimitReported(false),
+	_interleavedVaryings(true)
 {
 	_rendererId = glCreateProgram();
+	__programs.insert(this);
 }
 
 ShaderProgram::ShaderProgram(const std::unordered_map<ShaderPartType, std::string>& filePaths) :
 	IGraphicsResource(),
-	IResource()
+	IResource(),
+	_revision(0),
+	_globalKeywords(0),
+	_variantLimitReported(false),
+	_interleavedVaryings(true)
 {
 	_rendererId = glCreateProgram();
+	__programs.insert(this);
 	for (auto& [type, path] : filePaths) {
 		LoadShaderPartFromFile(path.c_str(), type);
 	}
@@ -26,13 +45,14 @@ ShaderProgram::ShaderProgram(const std::unordered_map<ShaderPartType, std::strin
 }
 
 ShaderProgram::~ShaderProgram() {
+	__programs.erase(this);
 	if (_rendererId != 0) {
 		glDeleteProgram(_rendererId);
 		_rendererId = 0;
 	}
 }
 
-bool ShaderProgram::LoadShaderPart(const char* source, ShaderPartType type) {
+GLuint ShaderProgram::__CompileShaderPart(const char* source, ShaderPartType type) {
 	// Creates a new shader part (VS, FS, GS, etc...)
 	GLuint handle = glCreateShader((GLenum)type);
 
@@ -64,38 +84,187 @@ bool ShaderProgram::LoadShaderPart(const char* source, ShaderPartType type) {
 		// Delete the broken shader result
 		glDeleteShader(handle);
 		handle = 0;
+	}
+
+	return handle;
+}
+
+bool ShaderProgram::__LinkProgram(GLuint program, const std::unordered_map<ShaderPartType, int>& handles) {
+	// Attach all our shaders
+	for (auto& [type, id] : handles) {
+		if (id != 0) {
+			glAttachShader(program, id);
+		}
+	}
+
+	// Perform linking
+	glLinkProgram(program);
+
+	// Remove shader parts to save space (we can do this since we only needed the shader parts to compile an actual shader program)
+	for (auto& [type, id] : handles) { 
+		if (id != 0) {
+			glDetachShader(program, id);
+			glDeleteShader(id);
+		}
+	}
+
+	GLint status = 0;
+	glGetProgramiv(program, GL_LINK_STATUS, &status);
+
+	// If linking failed, figure out why
+	if (status == GL_FALSE)
+	{
+		// Get the length of the log
+		GLint length = 0;
+		glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length);
+
+		if (length > 0) {
+			// Read the log from openGL
+			char* log = new char[length];
+			glGetProgramInfoLog(program, length, &length, log);
+			LOG_ERROR("Shader failed to link:\n{}", log);
+			delete[] log; 
+		} else {
+			LOG_ERROR("Shader failed to link for an unknown reason!");
+		}
+	}
+
+	return status != GL_FALSE;
+}
+
+// Will be put at the start of each program binary file, followed by the driver's binary blob
+struct ProgramBinaryHeader {
+	char     HeaderBytes[4] = { 'G', 'L', 'P', 'B' };
+	uint32_t Format         = 0;
+	uint32_t Length         = 0;
+	uint32_t Reserved       = 0;
+};
+
+// Bump this whenever the way we build programs changes in a way that isn't captured by the source (ex: a new
+// glProgramParameteri before linking), so that binaries in the ImportCache are linked again
+const uint32_t PROGRAM_BINARY_VERSION = 1;
+
+/// <summary>
+/// Returns true if the driver can give us program binaries (some drivers report no formats at all)
+/// </summary>
+static bool __ProgramBinariesSupported() {
+	static int formatCount = -1;
+	if (formatCount < 0) {
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+	}
+	return formatCount > 0;
+}
+
+bool ShaderProgram::__LoadProgramBinary(GLuint program, const std::string& filename) {
+	std::ifstream file(filename, std::ios::binary);
+	if (!file) {
+		return false;
+	}
+
+	ProgramBinaryHeader header = ProgramBinaryHeader();
+	file.read(reinterpret_cast<char*>(&header), sizeof(ProgramBinaryHeader));
+	if (!file || memcmp(header.HeaderBytes, "GLPB", 4) != 0 || header.Length == 0) {
+		return false;
+	}
+	std::vector<char> binary(header.Length);
+	file.read(binary.data(), header.Length);
+	if (!file) {
+		return false;
+	}
+
+	// The driver may reject the binary even if it's the same driver (ex: after a settings change), in
+	// which case the link status is false and we just compile the program as normal
+	glProgramBinary(program, header.Format, binary.data(), header.Length);
+	GLint status = 0;
+	glGetProgramiv(program, GL_LINK_STATUS, &status);
+	return status != GL_FALSE;
+}
+
+bool ShaderProgram::__SaveProgramBinary(GLuint program, const std::string& filename) {
+	GLint length = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0) {
+		return false;
+	}
+
+	ProgramBinaryHeader header = ProgramBinaryHeader();
+	std::vector<char> binary(length);
+	GLenum format = 0;
+	glGetProgramBinary(program, length, &length, &format, binary.data());
+	header.Format = format;
+	header.Length = static_cast<uint32_t>(length);
+
+	std::ofstream file(filename, std::ios::binary);
+	if (!file) {
+		return false;
+	}
+	file.write(reinterpret_cast<const char*>(&header), sizeof(ProgramBinaryHeader));
+	file.write(binary.data(), header.Length);
+	return file.good();
+}
+
+std::string ShaderProgram::_GetBinaryKey() const {
+	// Hash the parts in a fixed order, since the map's order isn't stable
+	std::vector<ShaderPartType> types;
+	for (const auto& [type, source] : _pendingSources) {
+		types.push_back(type);
+	}
+	std::sort(types.begin(), types.end(), [](ShaderPartType a, ShaderPartType b) { return *a < *b; });
 
+	uint64_t hash = ImportCache::HashBytes(nullptr, 0);
+	for (ShaderPartType type : types) {
+		const std::string& source = _pendingSources.at(type);
+		hash = ImportCache::HashBytes(&type, sizeof(ShaderPartType), hash);
+		hash = ImportCache::HashBytes(source.data(), source.size(), hash);
+	}
+
+	// Binaries are only valid for the driver that made them, and varyings are baked in at link time
+	std::string settings;
+	settings += reinterpret_cast<const char*>(glGetString(GL_VENDOR));
+	settings += reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+	settings += reinterpret_cast<const char*>(glGetString(GL_VERSION));
+	for (const std::string& varying : _varyings) {
+		settings += " " + varying;
+	}
+	settings += _interleavedVaryings ? " interleaved" : " separate";
+
+	return ImportCache::MakeKey("shader", PROGRAM_BINARY_VERSION, hash, settings);
+}
+
+bool ShaderProgram::LoadShaderPart(const char* source, ShaderPartType type) {
+	if (source == nullptr) {
 		return false;
 	}
 
-	// If we're overwriting, warn and clean up the old program before we store
-	if (_handles[type] != 0) {
+	// Look for any feature keywords, and inject our defines if we're a variant
+	_ParseKeywords(source);
+
+	// If we're overwriting, warn before we store
+	if (_pendingSources.find(type) != _pendingSources.end()) {
 		LOG_WARN("Another shader has been attached to this slot, overwriting");
-		glDeleteShader(_handles[type]);
 	}
-	_handles[type] = handle;
+	_pendingSources[type] = _defines.empty() ? source : _InjectDefines(source);
 
 	// Store info about where we got this data from
 	_fileSourceMap[type].IsFilePath = false;
 	_fileSourceMap[type].Source = source;
+	_fileSourceMap[type].Dependencies.clear();
 
-	return status != GL_FALSE;
+	return true;
 }
 
 bool ShaderProgram::LoadShaderPartFromFile(const char* path, ShaderPartType type) {
 	// Make sure that the file exists before we try reading
-	if (std::filesystem::exists(path)) {
+	if (FileHelpers::Exists(path)) {
 		// Load the source from the file, using our helper that will
-		// resolve #include directives
-		std::string source = FileHelpers::ReadResolveIncludes(path);
+		// resolve #include directives, and tell us what files we depend on
+		std::unordered_set<std::string> dependencies;
+		std::string source = FileHelpers::ReadResolveIncludes(path, &dependencies);
 		// Pass off to LoadShaderPart
 		bool result =  LoadShaderPart(source.c_str(), type);
 		_fileSourceMap[type].IsFilePath = true;
 		_fileSourceMap[type].Source = path;
-		if (result == false) {
-			LOG_ERROR("Source File: {}", path);
-		}
-		glObjectLabel(GL_SHADER, _handles[type], -1, path);
+		_fileSourceMap[type].Dependencies = std::move(dependencies);
 		return result; 
 	} else {
 		LOG_WARN("Could not open file at \"{}\"", path);
@@ -106,59 +275,440 @@ bool ShaderProgram::LoadShaderPartFromFile(const char* path, ShaderPartType type
 bool ShaderProgram::Link() {
 
 	LOG_TRACE("Starting shader link:");
-	GLenum err = glGetError();
-	
-	// Attach all our shaders
-	for (auto& [type, id] : _handles) {
-		if (id != 0) {
-			glAttachShader(_rendererId, id);
-			LOG_TRACE("\t{} - {}", ~type, _fileSourceMap[type].IsFilePath ? _fileSourceMap[type].Source : "<from source>");
+	for (auto& [type, source] : _pendingSources) {
+		LOG_TRACE("\t{} - {}", ~type, _fileSourceMap[type].IsFilePath ? _fileSourceMap[type].Source : "<from source>");
+	}
+
+	// If we've linked this exact program before, we can skip compiling and linking entirely
+	bool result = false;
+	std::string key;
+	if (__ProgramBinariesSupported()) {
+		key = _GetBinaryKey();
+		std::string binaryPath;
+		if (ImportCache::TryGet(key, binaryPath)) {
+			result = __LoadProgramBinary(_rendererId, binaryPath);
+			if (result) {
+				LOG_TRACE("Loaded program binary \"{}\"", binaryPath);
+			} else {
+				ImportCache::Remove(key);
+			}
 		}
 	}
 
-	// Perform linking
-	glLinkProgram(_rendererId);
-	err = glGetError();
+	if (!result) {
+		// Compile all of our parts
+		std::unordered_map<ShaderPartType, int> handles;
+		bool compiled = true;
+		for (auto& [type, source] : _pendingSources) {
+			GLuint handle = __CompileShaderPart(source.c_str(), type);
+			if (handle == 0) {
+				LOG_ERROR("Source File: {}", _fileSourceMap[type].IsFilePath ? _fileSourceMap[type].Source : "<from source>");
+				compiled = false;
+				continue;
+			}
+			if (_fileSourceMap[type].IsFilePath) {
+				glObjectLabel(GL_SHADER, handle, -1, _fileSourceMap[type].Source.c_str());
+			}
+			handles[type] = handle;
+		}
 
-	// Remove shader parts to save space (we can do this since we only needed the shader parts to compile an actual shader program)
-	for (auto& [type, id] : _handles) { 
-		if (id != 0) {
-			glDetachShader(_rendererId, id);
-			glDeleteShader(id);
+		if (compiled) {
+			// Attach, link, and clean up our shader parts
+			glProgramParameteri(_rendererId, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+			result = __LinkProgram(_rendererId, handles);
+
+			// Store the linked program so that we can skip all this next time
+			if (result && !key.empty()) {
+				if (__SaveProgramBinary(_rendererId, ImportCache::GetPath(key))) {
+					ImportCache::Commit(key, _debugName);
+				} else {
+					ImportCache::Remove(key);
+				}
+			}
+		} else {
+			for (auto& [type, id] : handles) {
+				glDeleteShader(id);
+			}
 		}
 	}
-	// Remove all the handles so we don't accidentally use them
-	_handles.clear();
 
-	err = glGetError();
+	// Remove all the sources so we don't accidentally link them again
+	_pendingSources.clear();
 
-	GLint status = 0;
-	glGetProgramiv(_rendererId, GL_LINK_STATUS, &status);
+	if (result) {
+		LOG_TRACE("Linking complete, starting introspection");
+	}
 
-	// If linking failed, figure out why
-	if (status == GL_FALSE)
-	{
-		// Get the length of the log
-		GLint length = 0;
-		glGetProgramiv(_rendererId, GL_INFO_LOG_LENGTH, &length);
+	// Perform our uniform introspection to see what uniforms are in the shader
+	_Introspect();
 
-		if (length > 0) {
-			// Read the log from openGL
-			char* log = new char[length];
-			glGetProgramInfoLog(_rendererId, length, &length, log);
-			LOG_ERROR("Shader failed to link:\n{}", log);
-			delete[] log; 
+	// Update our list of files we depend on
+	_UpdateDependencies();
+
+	// Any handles that were requested before linking need to be resolved again
+	_RefreshUniformHandles();
+
+	return result;
+}
+
+void ShaderProgram::_CopyUniformValues(GLuint from, const std::unordered_map<std::string, UniformInfo>& fromUniforms) {
+	// Large enough to fit a dmat4
+	union {
+		float    Floats[16];
+		int      Ints[16];
+		uint32_t Uints[16];
+		double   Doubles[16];
+	} buffer;
+	bool bools[4];
+
+	for (const auto& [name, uniform] : fromUniforms) {
+		// Only copy if the uniform still exists and has not changed type
+		auto it = _uniforms.find(name);
+		if (it == _uniforms.end() || it->second.Type != uniform.Type || uniform.Location == -1) {
+			continue;
+		}
+
+		int count = std::min(uniform.ArraySize, it->second.ArraySize);
+		for (int ix = 0; ix < count; ix++) {
+			// Array elements are not guaranteed to have sequential locations, so we look up each one
+			std::string elementName = uniform.ArraySize > 1 ? name + "[" + std::to_string(ix) + "]" : name;
+			int srcLocation = glGetUniformLocation(from, elementName.c_str());
+			int dstLocation = glGetUniformLocation(_rendererId, elementName.c_str());
+			if (srcLocation == -1 || dstLocation == -1) {
+				continue;
+			}
+
+			ShaderDataTypecode typeCode = GetShaderDataTypeCode(uniform.Type);
+			switch (typeCode) {
+				case ShaderDataTypecode::Float:
+				case ShaderDataTypecode::Matrix:
+					glGetUniformfv(from, srcLocation, buffer.Floats);
+					break;
+				case ShaderDataTypecode::Int:
+				case ShaderDataTypecode::Bool:
+				case ShaderDataTypecode::Texture:
+					glGetUniformiv(from, srcLocation, buffer.Ints);
+					break;
+				case ShaderDataTypecode::Uint:
+					glGetUniformuiv(from, srcLocation, buffer.Uints);
+					break;
+				case ShaderDataTypecode::Double:
+				case ShaderDataTypecode::MatrixD:
+					glGetUniformdv(from, srcLocation, buffer.Doubles);
+					break;
+				default:
+					continue;
+			}
+
+			// The SetUniform helper expects bools to be tightly packed
+			if (typeCode == ShaderDataTypecode::Bool) {
+				for (int c = 0; c < 4; c++) {
+					bools[c] = buffer.Ints[c] != 0;
+				}
+				SetUniform(dstLocation, uniform.Type, bools);
+			} else {
+				SetUniform(dstLocation, uniform.Type, &buffer);
+			}
+		}
+	}
+}
+
+bool ShaderProgram::Reload() {
+	if (!IsReloadable()) {
+		return false;
+	}
+
+	LOG_INFO("Reloading shader \"{}\"", _debugName);
+
+	// Compile all the parts into new handles, so that the current program remains untouched
+	std::unordered_map<ShaderPartType, ShaderSource> sources = _fileSourceMap;
+	std::unordered_map<ShaderPartType, int> handles;
+	bool success = true;
+	for (auto& [type, part] : sources) {
+		std::string source;
+		if (part.IsFilePath) {
+			part.Dependencies.clear();
+			source = FileHelpers::ReadResolveIncludes(part.Source, &part.Dependencies);
 		} else {
-			LOG_ERROR("Shader failed to link for an unknown reason!");
+			source = part.Source;
 		}
-	} else {
-		LOG_TRACE("Linking complete, starting introspection");
+		_ParseKeywords(source);
+		if (!_defines.empty()) {
+			source = _InjectDefines(source);
+		}
+
+		GLuint handle = __CompileShaderPart(source.c_str(), type);
+		if (handle == 0) {
+			LOG_ERROR("Source File: {}", part.IsFilePath ? part.Source : "<from source>");
+			success = false;
+			break;
+		}
+		handles[type] = handle;
 	}
 
-	// Perform our uniform introspection to see what uniforms are in the shader
+	// Even if we fail, we want to track any new includes so that fixing them triggers a reload
+	for (auto& [type, part] : sources) {
+		_fileSourceMap[type].Dependencies = part.Dependencies;
+	}
+	_UpdateDependencies();
+
+	if (!success) {
+		for (auto& [type, id] : handles) {
+			glDeleteShader(id);
+		}
+		LOG_WARN("Failed to reload shader \"{}\", keeping the previous version", _debugName);
+		return false;
+	}
+
+	// Link into a brand new program, re-registering any transform feedback varyings
+	GLuint program = glCreateProgram();
+	if (!_varyings.empty()) {
+		std::vector<const char*> names;
+		names.reserve(_varyings.size());
+		for (const std::string& name : _varyings) {
+			names.push_back(name.c_str());
+		}
+		glTransformFeedbackVaryings(program, (GLsizei)names.size(), names.data(), _interleavedVaryings ? GL_INTERLEAVED_ATTRIBS : GL_SEPARATE_ATTRIBS);
+	}
+	if (!__LinkProgram(program, handles)) {
+		glDeleteProgram(program);
+		LOG_WARN("Failed to reload shader \"{}\", keeping the previous version", _debugName);
+		return false;
+	}
+
+	// Swap in the new program, and re-introspect
+	GLuint oldProgram = _rendererId;
+	std::unordered_map<std::string, UniformInfo> oldUniforms = std::move(_uniforms);
+	std::unordered_map<std::string, UniformBlockInfo> oldBlocks = std::move(_uniformBlocks);
+	_uniforms.clear();
+	_uniformBlocks.clear();
+	_SetRenderId(program);
 	_Introspect();
 
-	return status != GL_FALSE;
+	// Carry over state from the old program
+	_CopyUniformValues(oldProgram, oldUniforms);
+	for (const auto& [name, block] : oldBlocks) {
+		if (block.CurrentBinding != block.DefaultBinding) {
+			BindUniformBlockToSlot(name, block.CurrentBinding);
+		}
+	}
+
+	glDeleteProgram(oldProgram);
+	_revision++;
+
+	// Uniform locations may have moved, update our cached handles
+	_RefreshUniformHandles();
+
+	return true;
+}
+
+bool ShaderProgram::IsReloadable() const {
+	for (const auto& [type, part] : _fileSourceMap) {
+		if (part.IsFilePath) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool ShaderProgram::DependsOn(const std::string& normalizedPath) const {
+	return _dependencies.find(normalizedPath) != _dependencies.end();
+}
+
+void ShaderProgram::Each(const std::function<void(ShaderProgram&)>& callback) {
+	// Copy so that callbacks are free to create or destroy programs
+	std::vector<ShaderProgram*> programs(__programs.begin(), __programs.end());
+	for (ShaderProgram* program : programs) {
+		if (__programs.count(program)) {
+			callback(*program);
+		}
+	}
+}
+
+void ShaderProgram::DeclareKeyword(const std::string& keyword, bool global) {
+	auto it = std::find(_keywords.begin(), _keywords.end(), keyword);
+	if (it != _keywords.end()) {
+		if (global) {
+			_globalKeywords |= 1u << (it - _keywords.begin());
+		}
+		return;
+	}
+	if (_keywords.size() >= MAX_KEYWORDS) {
+		LOG_WARN("Shader \"{}\" has too many keywords, ignoring \"{}\"", _debugName, keyword);
+		return;
+	}
+	// Note that keywords are only ever appended, so that masks stay valid when the shader is reloaded
+	if (global) {
+		_globalKeywords |= 1u << _keywords.size();
+	}
+	_keywords.push_back(keyword);
+}
+
+bool ShaderProgram::IsGlobalKeyword(const std::string& keyword) const {
+	return (_globalKeywords & __GetKeywordBit(keyword)) != 0;
+}
+
+uint32_t ShaderProgram::GetGlobalKeywordMask() const {
+	uint32_t result = 0;
+	for (size_t ix = 0; ix < _keywords.size(); ix++) {
+		if ((_globalKeywords & (1u << ix)) && __enabledGlobalKeywords.count(_keywords[ix])) {
+			result |= 1u << ix;
+		}
+	}
+	return result;
+}
+
+void ShaderProgram::SetGlobalKeyword(const std::string& keyword, bool enabled) {
+	if (enabled == IsGlobalKeywordEnabled(keyword)) {
+		return;
+	}
+	if (enabled) {
+		__enabledGlobalKeywords.insert(keyword);
+	} else {
+		__enabledGlobalKeywords.erase(keyword);
+	}
+	__globalKeywordRevision++;
+}
+
+bool ShaderProgram::IsGlobalKeywordEnabled(const std::string& keyword) {
+	return __enabledGlobalKeywords.find(keyword) != __enabledGlobalKeywords.end();
+}
+
+uint32_t ShaderProgram::__GetKeywordBit(const std::string& keyword) const {
+	for (size_t ix = 0; ix < _keywords.size(); ix++) {
+		if (_keywords[ix] == keyword) {
+			return 1u << ix;
+		}
+	}
+	return 0;
+}
+
+ShaderProgram* ShaderProgram::GetVariant(uint32_t keywordMask) {
+	// Drop any bits for keywords we don't have
+	keywordMask &= _keywords.size() >= 32 ? 0xFFFFFFFFu : (1u << _keywords.size()) - 1;
+	if (keywordMask == 0) {
+		return this;
+	}
+
+	// If we've already tried to make this variant, return it (or ourselves if it failed)
+	auto it = _variants.find(keywordMask);
+	if (it != _variants.end()) {
+		return it->second != nullptr ? it->second.get() : this;
+	}
+
+	// Enforce our variant limit
+	if (GetVariantCount() >= MaxVariants) {
+		if (!_variantLimitReported) {
+			LOG_WARN("Shader \"{}\" has reached the limit of {} variants, new keyword combinations will use the base shader", _debugName, MaxVariants);
+			_variantLimitReported = true;
+		}
+		return this;
+	}
+
+	// Create our variant with the same source as this program
+	ShaderProgram::Sptr variant = std::make_shared<ShaderProgram>();
+	variant->_keywords = _keywords;
+	variant->_globalKeywords = _globalKeywords;
+	std::string variantName = _debugName + " [";
+	for (size_t ix = 0; ix < _keywords.size(); ix++) {
+		if (keywordMask & (1u << ix)) {
+			variantName += (variant->_defines.empty() ? "" : " ") + _keywords[ix];
+			variant->_defines.push_back(_keywords[ix]);
+		}
+	}
+	variantName += "]";
+	variant->SetDebugName(variantName);
+
+	if (!_varyings.empty()) {
+		std::vector<const char*> names;
+		for (const std::string& name : _varyings) {
+			names.push_back(name.c_str());
+		}
+		variant->RegisterVaryings(names.data(), (int)names.size(), _interleavedVaryings);
+	}
+
+	bool success = true;
+	for (const auto& [type, part] : _fileSourceMap) {
+		success &= part.IsFilePath ?
+			variant->LoadShaderPartFromFile(part.Source.c_str(), type) :
+			variant->LoadShaderPart(part.Source.c_str(), type);
+	}
+	success = success && variant->Link();
+
+	if (!success) {
+		LOG_ERROR("Failed to compile variant \"{}\", falling back to base shader", variantName);
+		_variants[keywordMask] = nullptr;
+		return this;
+	}
+
+	_variants[keywordMask] = variant;
+	LOG_INFO("Compiled shader variant \"{}\" ({}/{} variants)", variantName, GetVariantCount(), MaxVariants);
+	return variant.get();
+}
+
+int ShaderProgram::GetVariantCount() const {
+	int result = 0;
+	for (const auto& [mask, variant] : _variants) {
+		result += variant != nullptr ? 1 : 0;
+	}
+	return result;
+}
+
+void ShaderProgram::_ParseKeywords(const std::string& source) {
+	// Neither token appears inside the other, so a line will only ever match one of them
+	const std::pair<const char*, bool> pragmaTokens[] = {
+		{ "#pragma feature", false },
+		{ "#pragma global_feature", true }
+	};
+
+	for (const auto& [pragmaToken, global] : pragmaTokens) {
+		const size_t pragmaTokenLen = strlen(pragmaToken);
+
+		size_t seek = source.find(pragmaToken);
+		while (seek != std::string::npos) {
+			size_t eol = source.find_first_of("\r\n", seek);
+			if (eol == std::string::npos) {
+				eol = source.size();
+			}
+
+			// Split the rest of the line on whitespace
+			std::istringstream stream(source.substr(seek + pragmaTokenLen, eol - seek - pragmaTokenLen));
+			std::string keyword;
+			while (stream >> keyword) {
+				DeclareKeyword(keyword, global);
+			}
+
+			seek = source.find(pragmaToken, eol);
+		}
+	}
+}
+
+std::string ShaderProgram::_InjectDefines(const std::string& source) const {
+	std::string defines;
+	for (const std::string& define : _defines) {
+		defines += "#define " + define + " 1\n";
+	}
+
+	// #version must be the first statement in the shader, so we insert after it's line
+	size_t version = source.find("#version");
+	if (version == std::string::npos) {
+		return defines + source;
+	}
+	size_t eol = source.find('\n', version);
+	if (eol == std::string::npos) {
+		return source + "\n" + defines;
+	}
+
+	std::string result = source;
+	result.insert(eol + 1, defines);
+	return result;
+}
+
+void ShaderProgram::_UpdateDependencies() {
+	_dependencies.clear();
+	for (const auto& [type, part] : _fileSourceMap) {
+		_dependencies.insert(part.Dependencies.begin(), part.Dependencies.end());
+	}
 }
 
 void ShaderProgram::Bind() {
@@ -325,10 +875,87 @@ void ShaderProgram::SetUniform(int location, ShaderDataType type, void* data, in
 }
 
 int ShaderProgram::__GetUniformLocation(const std::string& name) {
-	// Since the default constructor for UniformInfo sets location to -1,
-	// we can simply index the map and if it doesn't exist, the default
-	// will be used
-	return _uniforms[name].Location;
+	// Note that we don't index the map directly, since that would insert empty
+	// uniforms for every name that we look up that does not exist
+	auto it = _uniforms.find(name);
+	return it != _uniforms.end() ? it->second.Location : -1;
+}
+
+UniformHandle ShaderProgram::GetUniformHandle(const UniformName& name) {
+	return __GetCachedHandle(name.Hash, name.Name);
+}
+
+UniformHandle ShaderProgram::GetUniformHandle(const std::string& name) {
+	return __GetCachedHandle(HashUniformName(name.c_str(), name.size()), name.c_str());
+}
+
+const UniformHandle& ShaderProgram::__GetCachedHandle(uint32_t hash, const char* name) {
+	auto it = _handleCache.find(hash);
+	if (it != _handleCache.end()) {
+		#ifdef _DEBUG
+		if (it->second.Name != name) {
+			LOG_ERROR("Uniform name hash collision between \"{}\" and \"{}\" in shader \"{}\"", it->second.Name, name, _debugName);
+		}
+		#endif
+		return it->second.Handle;
+	}
+
+	HandleCacheEntry& entry = _handleCache[hash];
+	entry.Name = name;
+	entry.Handle.NameHash = hash;
+	_ResolveHandle(entry);
+	return entry.Handle;
+}
+
+const UniformHandle& ShaderProgram::__FindCachedHandle(uint32_t hash) const {
+	static const UniformHandle invalid = UniformHandle();
+	auto it = _handleCache.find(hash);
+	return it != _handleCache.end() ? it->second.Handle : invalid;
+}
+
+bool ShaderProgram::__ValidateHandle(const UniformHandle& handle, ShaderDataType valueType, int& count) const {
+	// Missing uniforms are reported when the handle is resolved, so we can just skip these
+	if (handle.Location == -1) {
+		return false;
+	}
+
+	// Samplers get set with ints, and None indicates a type we can't check (ex: raw bools)
+	bool typeMatches = 
+		handle.Type == valueType || 
+		valueType == ShaderDataType::None ||
+		(valueType == ShaderDataType::Int && GetShaderDataTypeCode(handle.Type) == ShaderDataTypecode::Texture);
+	if (!typeMatches) {
+		LOG_WARN("Type mismatch for uniform \"{}\" in shader \"{}\", uniform is {}, passed {}", _handleCache.at(handle.NameHash).Name, _debugName, ~handle.Type, ~valueType);
+		return false;
+	}
+
+	if (count > handle.ArraySize) {
+		count = handle.ArraySize;
+	}
+	return true;
+}
+
+void ShaderProgram::_ResolveHandle(HandleCacheEntry& entry) {
+	entry.Handle.Owner    = this;
+	entry.Handle.Revision = _revision;
+
+	auto it = _uniforms.find(entry.Name);
+	if (it != _uniforms.end()) {
+		entry.Handle.Location  = it->second.Location;
+		entry.Handle.Type      = it->second.Type;
+		entry.Handle.ArraySize = it->second.ArraySize;
+	} else {
+		entry.Handle.Location  = -1;
+		entry.Handle.Type      = ShaderDataType::None;
+		entry.Handle.ArraySize = 0;
+		LOG_WARN("Uniform \"{}\" does not exist in shader \"{}\"", entry.Name, _debugName);
+	}
+}
+
+void ShaderProgram::_RefreshUniformHandles() {
+	for (auto& [hash, entry] : _handleCache) {
+		_ResolveHandle(entry);
+	}
 }
 
 nlohmann::json ShaderProgram::ToJson() const {
@@ -537,5 +1164,7 @@ GlResourceType ShaderProgram::GetResourceClass() const {
 
 void ShaderProgram::RegisterVaryings(const char* const* names, int numVaryings, bool interleaved /*= true*/)
 {
+	_varyings.assign(names, names + numVaryings);
+	_interleavedVaryings = interleaved;
 	glTransformFeedbackVaryings(_rendererId, numVaryings, names, interleaved ? GL_INTERLEAVED_ATTRIBS : GL_SEPARATE_ATTRIBS);
 }
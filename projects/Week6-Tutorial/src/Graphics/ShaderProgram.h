@@ -3,6 +3,8 @@
 #include <memory>
 #include <string>               // for std::string
 #include <unordered_map>        // for std::unordered_map
+#include <unordered_set>        // for std::unordered_set
+#include <functional>           // for std::function
 #include <GLM/glm.hpp>          // for our GLM types
 #include <GLM/gtc/type_ptr.hpp> // for glm::value_ptr
 #include <Logging.h>            // for the logging functions
@@ -11,6 +13,7 @@
 #include "Utils/ResourceManager/IResource.h"
 #include "Graphics/GlEnums.h"
 #include "Graphics/IGraphicsResource.h"
+#include "Graphics/UniformHandle.h"
 
 /// <summary>
 /// This class will wrap around an OpenGL shader program
@@ -71,13 +74,17 @@ public:
 
 	/// <summary>
 	/// Loads a single shader stage into this shader object (ex: Vertex Shader or Fragment Shader)
+	///
+	/// Compilation is deferred until Link, so that a program binary from the ImportCache can be used instead
+	/// when nothing has changed. Compilation errors will be reported by Link
 	/// </summary>
 	/// <param name="source">The source code of the shader to load</param>
 	/// <param name="type">The stage to load (GL_VERTEX_SHADER or GL_FRAGMENT_SHADER)</param>
 	/// <returns>True if the shader is loaded, false if there was an issue</returns>
 	bool LoadShaderPart(const char* source, ShaderPartType type);
 	/// <summary>
-	/// Loads a single shader stage into this shader object (ex: Vertex Shader or Fragment Shader) from an external file (in res)
+	/// Loads a single shader stage into this shader object (ex: Vertex Shader or Fragment Shader) from an external file (in res).
+	/// As with LoadShaderPart, compilation is deferred until Link
 	/// </summary>
 	/// <param name="path">The relative path to the file containing the source</param>
 	/// <param name="type">The stage to load (GL_VERTEX_SHADER or GL_FRAGMENT_SHADER)</param>
@@ -93,11 +100,126 @@ public:
 	void RegisterVaryings(const char* const* names, int numVaryings, bool interleaved = true);
 
 	/// <summary>
-	/// Links the vertex and fragment shader, and allows this shader program to be used
+	/// Compiles and links the shader parts, and allows this shader program to be used. The linked program
+	/// is stored in the ImportCache, keyed by the final source of every part and the driver, so the next
+	/// time the same program is linked it can be loaded with glProgramBinary instead
 	/// </summary>
 	/// <returns>True if the linking was successful, false if otherwise</returns>
 	bool Link();
 
+	/// <summary>
+	/// Re-reads and recompiles all file based shader parts into a brand new program, and swaps it
+	/// in place of the current one only if compilation and linking succeed. If anything fails, the
+	/// current program is kept as-is. Uniform values and uniform block bindings are carried over
+	/// to the new program
+	/// </summary>
+	/// <returns>True if the program was rebuilt, false if the old program was kept</returns>
+	bool Reload();
+	/// <summary>
+	/// Returns true if this shader has at least one part loaded from a file, and can be reloaded
+	/// </summary>
+	bool IsReloadable() const;
+
+	/// <summary>
+	/// Gets the normalized paths of all files (including #included files) that this program was built from
+	/// </summary>
+	const std::unordered_set<std::string>& GetDependencies() const { return _dependencies; }
+	/// <summary>
+	/// Returns true if the given file (see FileHelpers::NormalizePath) was used to build this program
+	/// </summary>
+	/// <param name="normalizedPath">The normalized path of the file to check</param>
+	bool DependsOn(const std::string& normalizedPath) const;
+
+	/// <summary>
+	/// Gets the number of times this program has been rebuilt. Anything that caches uniform locations
+	/// should compare this against the revision the locations were looked up with
+	/// </summary>
+	uint32_t GetRevision() const { return _revision; }
+
+	/// <summary>
+	/// The maximum number of feature keywords that a shader can declare
+	/// </summary>
+	static const int MAX_KEYWORDS = 32;
+	/// <summary>
+	/// The maximum number of variants that will be compiled for a single shader, once
+	/// this is reached any new keyword combinations will use the base program
+	/// </summary>
+	static int MaxVariants;
+
+	/// <summary>
+	/// Declares a feature keyword for this shader. Keywords can also be declared in the shader
+	/// source using a line in the form of #pragma feature KEYWORD_A KEYWORD_B, or
+	/// #pragma global_feature KEYWORD_A for global keywords
+	/// </summary>
+	/// <param name="keyword">The name of the keyword, which will be #defined in variants that enable it</param>
+	/// <param name="global">True if the keyword is toggled for all shaders with SetGlobalKeyword, rather than per material</param>
+	void DeclareKeyword(const std::string& keyword, bool global = false);
+	/// <summary>
+	/// Returns true if the given keyword was declared as a global keyword by this shader
+	/// </summary>
+	bool IsGlobalKeyword(const std::string& keyword) const;
+	/// <summary>
+	/// Gets the variant mask for the global keywords this shader declares that are currently enabled,
+	/// this should be combined with any other keywords when selecting a variant
+	/// </summary>
+	uint32_t GetGlobalKeywordMask() const;
+	/// <summary>
+	/// Gets all the feature keywords that this shader has declared, in bit order
+	/// </summary>
+	const std::vector<std::string>& GetKeywords() const { return _keywords; }
+	/// <summary>
+	/// Gets the keywords that are #defined in this program (empty for base programs)
+	/// </summary>
+	const std::vector<std::string>& GetDefines() const { return _defines; }
+	/// <summary>
+	/// Converts a set of keywords into a bitmask for selecting variants, keywords that the
+	/// shader does not declare are ignored
+	/// </summary>
+	/// <param name="keywords">The keywords to enable</param>
+	template <typename Container>
+	uint32_t GetKeywordMask(const Container& keywords) const {
+		uint32_t result = 0;
+		for (const std::string& keyword : keywords) {
+			result |= __GetKeywordBit(keyword);
+		}
+		return result;
+	}
+	/// <summary>
+	/// Gets the variant of this shader with the given keywords enabled, compiling it if this is
+	/// the first time the variant has been requested. If the variant fails to compile, or the
+	/// variant limit has been reached, this program is returned instead. Variants are owned by
+	/// this program, and will be hot-reloaded along with it
+	/// </summary>
+	/// <param name="keywordMask">The keywords to enable, see GetKeywordMask</param>
+	ShaderProgram* GetVariant(uint32_t keywordMask);
+	/// <summary>
+	/// Gets the number of variants that have been compiled for this shader
+	/// </summary>
+	int GetVariantCount() const;
+
+	/// <summary>
+	/// Enables or disables a global keyword, such as ones driven by the render flags. Shaders that declare
+	/// the keyword with #pragma global_feature will select variants with it #defined while it is enabled
+	/// </summary>
+	/// <param name="keyword">The keyword to toggle</param>
+	/// <param name="enabled">True to enable the keyword, false to disable it</param>
+	static void SetGlobalKeyword(const std::string& keyword, bool enabled);
+	/// <summary>
+	/// Returns true if the given global keyword is currently enabled
+	/// </summary>
+	static bool IsGlobalKeywordEnabled(const std::string& keyword);
+	/// <summary>
+	/// Gets a counter that is incremented whenever a global keyword is toggled. Anything that caches
+	/// a variant should select it again when this changes
+	/// </summary>
+	static uint32_t GetGlobalKeywordRevision() { return __globalKeywordRevision; }
+
+	/// <summary>
+	/// Invokes a callback for all shader programs that are currently alive
+	/// </summary>
+	/// <param name="callback">The callback to invoke for each program</param>
+	static void Each(const std::function<void(ShaderProgram&)>& callback);
+
 	/// <summary>
 	/// Binds this shader for use
 	/// </summary>
@@ -150,6 +272,52 @@ public:
 	/// <param name="transposed"True if matrices should be transposed</param>
 	void SetUniform(int location, ShaderDataType type, void* data, int count = 1, bool transposed = false);
 
+	/// <summary>
+	/// Resolves a uniform name to a handle that can be used to set the uniform without any string
+	/// lookups. Handles are cached per program, and remain usable after the program is reloaded
+	/// </summary>
+	/// <param name="name">The name of the uniform, ex: "u_Strength"_uh</param>
+	/// <returns>A handle to the uniform, check IsValid() to see if the uniform exists</returns>
+	UniformHandle GetUniformHandle(const UniformName& name);
+	/// <summary>
+	/// Resolves a uniform name to a handle, computing the name hash at runtime
+	/// </summary>
+	/// <param name="name">The name of the uniform</param>
+	UniformHandle GetUniformHandle(const std::string& name);
+
+	template <typename T>
+	void SetUniform(const UniformHandle& handle, const T& value) {
+		SetUniform(handle, &value, 1);
+	}
+	template <typename T>
+	void SetUniform(const UniformHandle& handle, const T* values, int count = 1) {
+		const UniformHandle& resolved = __ResolveHandle(handle);
+		if (__ValidateHandle(resolved, GetShaderDataType<T>(), count)) {
+			SetUniform(resolved.Location, values, count);
+		}
+	}
+	template <typename T>
+	void SetUniformMatrix(const UniformHandle& handle, const T& value, bool transposed = false) {
+		const UniformHandle& resolved = __ResolveHandle(handle);
+		int count = 1;
+		if (__ValidateHandle(resolved, GetShaderDataType<T>(), count)) {
+			SetUniformMatrix(resolved.Location, &value, 1, transposed);
+		}
+	}
+
+	template <typename T>
+	void SetUniform(const UniformName& name, const T& value) {
+		SetUniform(__GetCachedHandle(name.Hash, name.Name), &value, 1);
+	}
+	template <typename T>
+	void SetUniform(const UniformName& name, const T* values, int count = 1) {
+		SetUniform(__GetCachedHandle(name.Hash, name.Name), values, count);
+	}
+	template <typename T>
+	void SetUniformMatrix(const UniformName& name, const T& value, bool transposed = false) {
+		SetUniformMatrix(__GetCachedHandle(name.Hash, name.Name), value, transposed);
+	}
+
 	template <typename T>
 	void SetUniform(const std::string& name, const T& value) {
 		int location = __GetUniformLocation(name);
@@ -181,9 +349,9 @@ public:
 	void BindUniformBlockToSlot(const std::string& name, int uboSlot);
 
 protected:
-	// Stores all the handles to our shaders until we
-	// are ready to compile them into a program
-	std::unordered_map<ShaderPartType, int> _handles;
+	// Stores the final source of our shader parts (with includes
+	// resolved and defines injected) until we are ready to link
+	std::unordered_map<ShaderPartType, std::string> _pendingSources;
 	
 	// Map access to look up uniform locations and blocks
 	std::unordered_map<std::string, UniformInfo> _uniforms;
@@ -195,9 +363,77 @@ protected:
 	struct ShaderSource {
 		std::string Source;
 		bool        IsFilePath;
+		// All files that were read to produce this part, including #includes
+		std::unordered_set<std::string> Dependencies;
 	};
 	std::unordered_map<ShaderPartType, ShaderSource> _fileSourceMap;
 
+	// The union of all the part dependencies, rebuilt when we link
+	std::unordered_set<std::string> _dependencies;
+	// Incremented whenever the underlying program is swapped out
+	uint32_t _revision;
+
+	// Feature keywords that this shader declares, and the ones that are #defined in this program
+	std::vector<std::string> _keywords;
+	std::vector<std::string> _defines;
+	// The bits in _keywords that were declared as global keywords
+	uint32_t _globalKeywords;
+	// Variants that have been requested, keyed by keyword mask. Failed variants are stored as nullptr
+	std::unordered_map<uint32_t, ShaderProgram::Sptr> _variants;
+	bool _variantLimitReported;
+
+	// Transform feedback varyings, so that we can re-register them on reload
+	std::vector<std::string> _varyings;
+	bool                     _interleavedVaryings;
+
+	// All live shader programs, so that we can find programs affected by a file change
+	static std::unordered_set<ShaderProgram*> __programs;
+	// The global keywords that are currently enabled, and the number of times they've changed
+	static std::unordered_set<std::string> __enabledGlobalKeywords;
+	static uint32_t __globalKeywordRevision;
+
+	/// <summary>
+	/// Compiles a single shader part, returning the handle, or 0 if compilation failed
+	/// </summary>
+	static GLuint __CompileShaderPart(const char* source, ShaderPartType type);
+	/// <summary>
+	/// Links the given shader parts into a program, returning true if linking succeeded
+	/// </summary>
+	static bool __LinkProgram(GLuint program, const std::unordered_map<ShaderPartType, int>& handles);
+	/// <summary>
+	/// Loads a program binary that was written by __SaveProgramBinary, returning true if the program is now linked
+	/// </summary>
+	static bool __LoadProgramBinary(GLuint program, const std::string& filename);
+	/// <summary>
+	/// Writes a linked program's binary to a file, returning true on success
+	/// </summary>
+	static bool __SaveProgramBinary(GLuint program, const std::string& filename);
+	/// <summary>
+	/// Gets the import cache key for the program that will be linked from our pending sources
+	/// </summary>
+	std::string _GetBinaryKey() const;
+	/// <summary>
+	/// Returns the bit for the given keyword, or 0 if the keyword is not declared
+	/// </summary>
+	uint32_t __GetKeywordBit(const std::string& keyword) const;
+	/// <summary>
+	/// Finds any #pragma feature or #pragma global_feature lines in a shader source and declares their keywords
+	/// </summary>
+	void _ParseKeywords(const std::string& source);
+	/// <summary>
+	/// Injects this program's #defines into a shader source, directly after the #version line
+	/// </summary>
+	std::string _InjectDefines(const std::string& source) const;
+	/// <summary>
+	/// Rebuilds the combined dependency list from all our shader parts
+	/// </summary>
+	void _UpdateDependencies();
+	/// <summary>
+	/// Copies the current values of all plain uniforms in another program to the uniforms in this
+	/// program with the same name and type, used to carry state over when reloading
+	/// </summary>
+	void _CopyUniformValues(GLuint from, const std::unordered_map<std::string, UniformInfo>& fromUniforms);
+
 	/// <summary>
 	/// Performs program introspection, where we examine the uniforms that
 	/// the program contains
@@ -214,4 +450,46 @@ protected:
 	void _IntrospectUnifromBlocks();
 
 	int __GetUniformLocation(const std::string& name);
+
+	// Uniform handles that have been requested from this program, keyed on the name hash. Since
+	// the keys are already hashes, we can skip hashing them again
+	struct __IdentityHash {
+		size_t operator()(uint32_t value) const { return value; }
+	};
+	struct HandleCacheEntry {
+		std::string   Name;
+		UniformHandle Handle;
+	};
+	std::unordered_map<uint32_t, HandleCacheEntry, __IdentityHash> _handleCache;
+
+	/// <summary>
+	/// Gets a handle from the cache, resolving it and adding it to the cache if required
+	/// </summary>
+	const UniformHandle& __GetCachedHandle(uint32_t hash, const char* name);
+	/// <summary>
+	/// Returns the handle if it is up to date for this program, otherwise the matching handle from the cache
+	/// </summary>
+	inline const UniformHandle& __ResolveHandle(const UniformHandle& handle) {
+		if (handle.Owner == this && handle.Revision == _revision) {
+			return handle;
+		}
+		return __FindCachedHandle(handle.NameHash);
+	}
+	/// <summary>
+	/// Finds a handle in the cache, returning an invalid handle if it has never been resolved
+	/// </summary>
+	const UniformHandle& __FindCachedHandle(uint32_t hash) const;
+	/// <summary>
+	/// Checks that a handle is valid and matches the type we are setting, clamping count to the
+	/// size of the uniform. Returns false if the uniform should not be set
+	/// </summary>
+	bool __ValidateHandle(const UniformHandle& handle, ShaderDataType valueType, int& count) const;
+	/// <summary>
+	/// Updates a handle cache entry from our introspection data
+	/// </summary>
+	void _ResolveHandle(HandleCacheEntry& entry);
+	/// <summary>
+	/// Re-resolves all cached handles, should be invoked whenever introspection data changes
+	/// </summary>
+	void _RefreshUniformHandles();
 };
\ No newline at end of file
@@ -0,0 +1,129 @@
+#include "Graphics/TemporalAntiAliasing.h"
+
+#include "Utils/JsonGlmHelpers.h"
+
+TemporalAntiAliasing::TemporalAntiAliasing() :
+	Enabled(true),
+	Upsample(true),
+	FeedbackMin(0.85f),
+	FeedbackMax(0.95f),
+	SampleCount(8),
+	_shader(nullptr),
+	_history{ nullptr, nullptr },
+	_current(0),
+	_historyValid(false),
+	_sampleIndex(0),
+	_jitter(0.0f),
+	_previousJitter(0.0f)
+{ }
+
+TemporalAntiAliasing::~TemporalAntiAliasing() = default;
+
+glm::vec2 TemporalAntiAliasing::NextJitter(const glm::ivec2& renderSize, const glm::ivec2& outputSize) {
+	// Each render pixel covers several output pixels when upsampling, so we need more positions to hit them all
+	uint32_t sampleCount = glm::max(SampleCount, 1u);
+	if (Upsample) {
+		glm::vec2 ratio = glm::vec2(outputSize) / glm::vec2(glm::max(renderSize, glm::ivec2(1)));
+		sampleCount = glm::clamp((uint32_t)glm::ceil(sampleCount * ratio.x * ratio.y), sampleCount, 64u);
+	}
+	_sampleIndex = (_sampleIndex + 1) % sampleCount;
+
+	// Halton(2, 3) gives us a nicely stratified set of points in [0, 1), we skip index 0 since it's always 0, 0
+	glm::vec2 offset = glm::vec2(__Halton(_sampleIndex + 1, 2), __Halton(_sampleIndex + 1, 3)) - 0.5f;
+
+	_previousJitter = _jitter;
+	_jitter = offset * 2.0f / glm::vec2(glm::max(renderSize, glm::ivec2(1)));
+	return _jitter;
+}
+
+const Framebuffer::Sptr& TemporalAntiAliasing::Resolve(const Framebuffer::Sptr& source, const Framebuffer::Sptr& gBuffer, const glm::ivec2& outputSize, const glm::mat4& clipToPrevClip, const VertexArrayObject::Sptr& quad) {
+	if (_shader == nullptr) {
+		_shader = ShaderProgram::Create();
+		_shader->LoadShaderPartFromFile("shaders/vertex_shaders/fullscreen_quad.glsl", ShaderPartType::Vertex);
+		_shader->LoadShaderPartFromFile("shaders/fragment_shaders/taa_resolve.glsl", ShaderPartType::Fragment);
+		_shader->Link();
+		_shader->SetDebugName("TAA Resolve");
+	}
+
+	// Make sure our history matches the size we're resolving to, if it doesn't the old contents are useless anyways
+	glm::ivec2 size = Upsample ? outputSize : source->GetSize();
+	for (int ix = 0; ix < 2; ix++) {
+		if (_history[ix] == nullptr) {
+			FramebufferDescriptor descriptor;
+			descriptor.Width  = size.x;
+			descriptor.Height = size.y;
+			descriptor.RenderTargets[RenderTargetAttachment::Color0] = RenderTargetDescriptor(RenderTargetType::ColorRgba16F);
+			_history[ix] = std::make_shared<Framebuffer>(descriptor);
+			_history[ix]->SetDebugName("TAA History " + std::to_string(ix));
+			_historyValid = false;
+		} else if (_history[ix]->GetSize() != size) {
+			_history[ix]->Resize(size);
+			_historyValid = false;
+		}
+	}
+
+	const Framebuffer::Sptr& previous = _history[_current];
+	_current = 1 - _current;
+	const Framebuffer::Sptr& target = _history[_current];
+
+	glDisable(GL_DEPTH_TEST);
+	glDisable(GL_BLEND);
+
+	target->Bind();
+	glViewport(0, 0, size.x, size.y);
+
+	source->BindAttachment(RenderTargetAttachment::Color0, 0);
+	gBuffer->BindAttachment(RenderTargetAttachment::Depth, 1);
+	gBuffer->BindAttachment(RenderTargetAttachment::Color4, 2);
+	previous->BindAttachment(RenderTargetAttachment::Color0, 3);
+
+	bool upsample = size != source->GetSize();
+	ShaderProgram* shader = _shader->GetVariant(upsample ? _shader->GetKeywordMask(std::vector<std::string>{ "UPSAMPLE" }) : 0);
+	shader->Bind();
+	shader->SetUniform("u_RenderSize"_uh, source->GetSize());
+	shader->SetUniform("u_Jitter"_uh, _jitter);
+	shader->SetUniformMatrix("u_ClipToPrevClip"_uh, clipToPrevClip);
+	shader->SetUniform("u_FeedbackMin"_uh, FeedbackMin);
+	shader->SetUniform("u_FeedbackMax"_uh, FeedbackMax);
+	shader->SetUniform("u_HistoryValid"_uh, _historyValid);
+
+	quad->Draw();
+	target->Unbind();
+
+	_historyValid = true;
+	return target;
+}
+
+void TemporalAntiAliasing::Invalidate() {
+	_historyValid = false;
+}
+
+nlohmann::json TemporalAntiAliasing::ToJson() const {
+	return {
+		{ "enabled", Enabled },
+		{ "upsample", Upsample },
+		{ "feedback_min", FeedbackMin },
+		{ "feedback_max", FeedbackMax },
+		{ "sample_count", SampleCount }
+	};
+}
+
+void TemporalAntiAliasing::FromJson(const nlohmann::json& blob) {
+	Enabled     = JsonGet(blob, "enabled", Enabled);
+	Upsample    = JsonGet(blob, "upsample", Upsample);
+	FeedbackMin = JsonGet(blob, "feedback_min", FeedbackMin);
+	FeedbackMax = JsonGet(blob, "feedback_max", FeedbackMax);
+	SampleCount = JsonGet(blob, "sample_count", SampleCount);
+	Invalidate();
+}
+
+float TemporalAntiAliasing::__Halton(uint32_t index, uint32_t base) {
+	float result = 0.0f;
+	float fraction = 1.0f;
+	while (index > 0) {
+		fraction /= base;
+		result += fraction * (index % base);
+		index /= base;
+	}
+	return result;
+}
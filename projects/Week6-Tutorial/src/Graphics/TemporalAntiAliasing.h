@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstdint>
+
+#include <GLM/glm.hpp>
+#include <json.hpp>
+
+#include "Graphics/Framebuffer.h"
+#include "Graphics/ShaderProgram.h"
+#include "Graphics/VertexArrayObject.h"
+#include "Utils/Macros.h"
+
+/// <summary>
+/// Handles temporal anti-aliasing for the render layer. Each frame the camera's projection is jittered
+/// by a sub-pixel offset from a Halton sequence, and Resolve blends the new frame into a history buffer
+/// that is reprojected using the motion vectors from the G-Buffer (see shaders/fragment_shaders/taa_resolve.glsl)
+///
+/// In upsampling mode, the history is kept at the output size rather than the render size, so when the
+/// scene is rendered at a lower resolution (see DynamicResolution), the jittered samples from several
+/// frames are accumulated into a full resolution image
+/// </summary>
+class TemporalAntiAliasing final {
+public:
+	MAKE_PTRS(TemporalAntiAliasing);
+	NO_COPY(TemporalAntiAliasing);
+	NO_MOVE(TemporalAntiAliasing);
+
+	/// <summary>
+	/// True if the camera should be jittered and the frame resolved
+	/// </summary>
+	bool     Enabled;
+	/// <summary>
+	/// True to reconstruct the image at the output size, false to resolve at the render size and leave
+	/// upscaling to the spatial filter
+	/// </summary>
+	bool     Upsample;
+	/// <summary>
+	/// The amount of history that is kept for pixels that are moving quickly, and that are stationary
+	/// </summary>
+	float    FeedbackMin;
+	float    FeedbackMax;
+	/// <summary>
+	/// The number of jitter positions we cycle through at full resolution. When upsampling, this is scaled
+	/// up by the ratio of output to render pixels, so that every output pixel still gets covered
+	/// </summary>
+	uint32_t SampleCount;
+
+	TemporalAntiAliasing();
+	~TemporalAntiAliasing();
+
+	/// <summary>
+	/// Advances to the next position in the jitter sequence
+	/// </summary>
+	/// <param name="renderSize">The size the scene is being rendered at</param>
+	/// <param name="outputSize">The size the scene will be presented at</param>
+	/// <returns>The offset to apply to the camera's projection, in NDC</returns>
+	glm::vec2 NextJitter(const glm::ivec2& renderSize, const glm::ivec2& outputSize);
+	/// <summary>
+	/// Gets the jitter for the current frame, in NDC
+	/// </summary>
+	const glm::vec2& GetJitter() const { return _jitter; }
+	/// <summary>
+	/// Gets the jitter that was used in the previous frame, in NDC
+	/// </summary>
+	const glm::vec2& GetPreviousJitter() const { return _previousJitter; }
+
+	/// <summary>
+	/// Blends a newly rendered frame into the history, and returns the result
+	/// </summary>
+	/// <param name="source">The frame that was rendered with the current jitter, it's Color0 attachment is used</param>
+	/// <param name="gBuffer">The G-Buffer for the frame, we need it's depth and motion vectors (Color4)</param>
+	/// <param name="outputSize">The size the scene will be presented at</param>
+	/// <param name="clipToPrevClip">Takes un-jittered clip space positions from this frame to the previous frame</param>
+	/// <param name="quad">A VAO for drawing a fullscreen quad</param>
+	/// <returns>The resolved frame, this remains valid until the next call to Resolve</returns>
+	const Framebuffer::Sptr& Resolve(const Framebuffer::Sptr& source, const Framebuffer::Sptr& gBuffer, const glm::ivec2& outputSize, const glm::mat4& clipToPrevClip, const VertexArrayObject::Sptr& quad);
+	/// <summary>
+	/// Discards the history, so the next resolve only uses the new frame (ex: after a camera cut)
+	/// </summary>
+	void Invalidate();
+
+	nlohmann::json ToJson() const;
+	void FromJson(const nlohmann::json& blob);
+
+private:
+	ShaderProgram::Sptr _shader;
+	// We ping-pong between two history buffers, reading the previous frame while writing this one
+	Framebuffer::Sptr   _history[2];
+	uint32_t            _current;
+	bool                _historyValid;
+
+	uint32_t  _sampleIndex;
+	glm::vec2 _jitter;
+	glm::vec2 _previousJitter;
+
+	static float __Halton(uint32_t index, uint32_t base);
+};
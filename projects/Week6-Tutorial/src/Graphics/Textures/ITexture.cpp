@@ -7,14 +7,16 @@ ITexture::ITexture(TextureType type) :
 	IGraphicsResource(),
 	_type(type)
 {
+	_gpuMemoryCategory = GpuMemoryCategory::Texture;
 	__StaticInit();
 	_Recreate();
 }
 
 void ITexture::_Recreate()
 {
-	if (_rendererId == 0) {
+	if (_rendererId != 0) {
 		glDeleteTextures(1, &_rendererId);
+		_SetGpuMemoryUsage(0);
 	}
 	glCreateTextures((GLenum)_type, 1, &_rendererId);
 }
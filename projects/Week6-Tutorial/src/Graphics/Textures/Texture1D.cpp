@@ -1,7 +1,9 @@
 #include "Texture1D.h"
 #include "Utils/Base64.h"
+#include "Utils/BlobStore.h"
 #include "Utils/JsonGlmHelpers.h"
 #include <stb_image.h>
+#include "Utils/VirtualFileSystem.h"
 
 inline int CalcRequiredMipLevels(int size) {
 	return (1 + floor(log2(size)));
@@ -78,14 +80,17 @@ nlohmann::json Texture1D::ToJson() const
 	}
 	else if (_pixelType != PixelType::Unknown) {
 		result["size"] = _description.Size;
+		result["internal_format"] = ~_description.Format;
 		result["format"] = ~_description.FormatHint;
 		result["pixel_type"] = ~_pixelType;
 
 		if (_description.Size > 0 && _description.FormatHint != PixelFormat::Unknown) {
 			size_t dataSize = GetTexelSize(_description.FormatHint, _pixelType) * _description.Size;
-			uint8_t* dataStore = new uint8_t[dataSize];
-			glGetTextureImage(_rendererId, 0, *_description.Format, *_pixelType, dataSize, dataStore);
-			result["data"] = Base64::Encode(dataStore, dataSize);
+			std::vector<uint8_t> dataStore(dataSize);
+			glPixelStorei(GL_PACK_ALIGNMENT, 1);
+			glGetTextureImage(_rendererId, 0, *_description.FormatHint, *_pixelType, (GLsizei)dataSize, dataStore.data());
+			// The texels go in a sidecar file, we only store a reference to it in the JSON
+			result["blob"] = BlobStore::Write(dataStore.data(), dataSize);
 		}
 	}
 	return result;
@@ -101,18 +106,37 @@ Texture1D::Sptr Texture1D::FromJson(const nlohmann::json& data)
 	description.MagnificationFilter = JsonParseEnum(MagFilter, data, "filter_mag", MagFilter::Linear);
 	description.GenerateMipMaps = JsonGet(data, "generate_mipmaps", false);
 	description.FormatHint = JsonParseEnum(PixelFormat, data, "format", PixelFormat::Unknown);
+	description.Format = JsonParseEnum(InternalFormat, data, "internal_format", description.Format);
+
+	// Older manifests did not store the internal format, so we guess it from the pixel layout
+	if (description.Filename.empty() && description.Format == InternalFormat::Unknown && description.FormatHint != PixelFormat::Unknown) {
+		description.Format = GetInternalFormatForChannels8(GetTexelComponentCount(description.FormatHint));
+	}
 
 	Texture1D::Sptr result = std::make_shared<Texture1D>(description);
 
-	// If we embedded data into the JSON, load it now
-	if (description.Filename.empty() && data.contains("data") && data["data"].is_string()) {
+	if (description.Filename.empty()) {
 		PixelType type = JsonParseEnum(PixelType, data, "pixel_type", PixelType::Unknown);
-		try {
-			std::string rawData = Base64::Decode(data['data'].get<std::string>());
-			result->LoadData(description.Size, description.FormatHint, type, rawData.data());
+
+		// Texel data lives in a sidecar blob, which we read straight into the buffer we upload from
+		if (data.contains("blob") && data["blob"].is_string() && type != PixelType::Unknown && description.FormatHint != PixelFormat::Unknown) {
+			std::vector<uint8_t> texels;
+			size_t expectedSize = GetTexelSize(description.FormatHint, type) * description.Size;
+			if (BlobStore::Read(data["blob"].get<std::string>(), texels) && texels.size() >= expectedSize) {
+				result->LoadData(description.Size, description.FormatHint, type, texels.data());
+			} else {
+				LOG_WARN("Failed to load texel data for texture from blob \"{}\"", data["blob"].get<std::string>());
+			}
 		}
-		catch (std::runtime_error()) {
-			LOG_WARN("JSON blob had data, but failed to load to texture");
+		// Older manifests embedded the texels as Base64 in the JSON
+		else if (data.contains("data") && data["data"].is_string()) {
+			try {
+				std::string rawData = Base64::Decode(data["data"].get<std::string>());
+				result->LoadData(description.Size, description.FormatHint, type, rawData.data());
+			}
+			catch (std::runtime_error()) {
+				LOG_WARN("JSON blob had data, but failed to load to texture");
+			}
 		}
 	}
 
@@ -128,9 +152,10 @@ void Texture1D::_LoadDataFromFile()
 		int width, height, numChannels;
 		const int targetChannels = GetTexelComponentCount(_description.FormatHint);
 
-		// Use STBI to load the image
+		// Use STBI to load the image, reading it through the VFS in case it's packed
 		stbi_set_flip_vertically_on_load(true);
-		uint8_t* data = stbi_load(_description.Filename.c_str(), &width, &height, &numChannels, targetChannels);
+		VfsFile::Sptr file = VirtualFileSystem::Open(_description.Filename);
+		uint8_t* data = file == nullptr ? nullptr : stbi_load_from_memory(file->GetData(), (int)file->GetSize(), &width, &height, &numChannels, targetChannels);
 
 		// If we could not load any data, warn and return null
 		if (data == nullptr) {
@@ -179,6 +204,7 @@ void Texture1D::_SetTextureParams()
 		int layers = _description.GenerateMipMaps ? CalcRequiredMipLevels(_description.Size) : 1;
 		// Allocates the memory for our texture
 		glTextureStorage1D(_rendererId, layers, (GLenum)_description.Format, _description.Size);
+		_SetGpuMemoryUsage(GpuMemory::CalculateTextureSize((GLenum)_description.Format, _description.Size, 1, 1, layers));
 	}
 
 	glTextureParameteri(_rendererId, GL_TEXTURE_MIN_FILTER, (GLenum)_description.MinificationFilter);
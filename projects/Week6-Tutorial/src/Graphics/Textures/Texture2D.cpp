@@ -1,9 +1,16 @@
 #include "Texture2D.h"
 #include <stb_image.h>
+#include "Utils/VirtualFileSystem.h"
 #include <Logging.h>
 #include "GLM/glm.hpp"
 #include "Utils/JsonGlmHelpers.h"
 #include "Utils/Base64.h"
+#include "Utils/BlobStore.h"
+#include "Graphics/AsyncReadback.h"
+#include "Utils/StringUtils.h"
+#include "Graphics/Textures/TextureCompression.h"
+#include "Utils/ImportCache.h"
+#include <filesystem>
 
 /// <summary>
 /// Get the number of mipmap levels required for a texture of the given size
@@ -25,20 +32,29 @@ nlohmann::json Texture2D::ToJson() const {
 		{ "generate_mipmaps",  _description.GenerateMipMaps },
 	};
 
+	if (_description.Compression != InternalFormat::Unknown) {
+		result["compression"] = ~_description.Compression;
+	}
+
 	if (!_description.Filename.empty()) {
 		result["filename"] = _description.Filename;
 	}
 	else if (_pixelType != PixelType::Unknown) {
 		result["size_x"] = _description.Width;
-		result["size_y"] = _description.Width;
+		result["size_y"] = _description.Height;
 
+		result["internal_format"] = ~_description.Format;
 		result["format"] = ~_description.FormatHint;
 		result["pixel_type"] = ~_pixelType;
 		if (_description.Width * _description.Height > 0 && _description.FormatHint != PixelFormat::Unknown) {
-			size_t dataSize = GetTexelSize(_description.FormatHint, _pixelType) * _description.Width * _description.Height;
-			uint8_t* dataStore = new uint8_t[dataSize];
-			glGetTextureImage(_rendererId, 0, *_description.FormatHint, *_pixelType, dataSize, dataStore);
-			result["data"] = Base64::Encode(dataStore, dataSize);
+			// The pixels go in a sidecar file, we only store a reference to it in the JSON. Reading them back is done
+			// asynchronously, so the blob is written a few frames later on a worker thread. If our pixels haven't
+			// changed since the last snapshot, we can just re-use that one
+			if (_blobId.empty()) {
+				_blobId = Guid::New().str();
+				AsyncReadback::ReadTexture(_rendererId, glm::uvec3(_description.Width, _description.Height, 1), _description.FormatHint, _pixelType, AsyncReadback::BlobWriter(_blobId));
+			}
+			result["blob"] = _blobId;
 		}
 	}
 
@@ -48,25 +64,50 @@ nlohmann::json Texture2D::ToJson() const {
 Texture2D::Sptr Texture2D::FromJson(const nlohmann::json& data)
 {
 	Texture2DDescription descr = Texture2DDescription();
-	descr.Filename = data["filename"];
+	descr.Filename = JsonGet<std::string>(data, "filename", "");
+	descr.Width    = JsonGet(data, "size_x", descr.Width);
+	descr.Height   = JsonGet(data, "size_y", descr.Height);
 	descr.HorizontalWrap = JsonParseEnum(WrapMode, data, "wrap_s", WrapMode::ClampToEdge);
 	descr.VerticalWrap   = JsonParseEnum(WrapMode, data, "wrap_t", WrapMode::ClampToEdge);
 	descr.MinificationFilter  = JsonParseEnum(MinFilter, data, "filter_min", MinFilter::NearestMipNearest);
 	descr.MagnificationFilter = JsonParseEnum(MagFilter, data, "filter_mag", MagFilter::Linear);
 	descr.MaxAnisotropic      = JsonGet(data, "anisotropic", 0.0f);
 	descr.GenerateMipMaps     = JsonGet(data, "generate_mipmaps", false);
+	descr.Compression         = JsonParseEnum(InternalFormat, data, "compression", InternalFormat::Unknown);
+	descr.FormatHint          = JsonParseEnum(PixelFormat, data, "format", descr.FormatHint);
+	descr.Format              = JsonParseEnum(InternalFormat, data, "internal_format", InternalFormat::Unknown);
+
+	// Older manifests did not store the internal format, so we guess it from the pixel layout
+	if (descr.Filename.empty() && descr.Format == InternalFormat::Unknown && descr.Width * descr.Height > 0) {
+		descr.Format = GetInternalFormatForChannels8(GetTexelComponentCount(descr.FormatHint));
+	}
 
 	Texture2D::Sptr result = std::make_shared<Texture2D>(descr);
 
-	// If we embedded data into the JSON, load it now
-	if (descr.Filename.empty() && data.contains("data") && data["data"].is_string()) {
+	if (descr.Filename.empty()) {
 		PixelType type = JsonParseEnum(PixelType, data, "pixel_type", PixelType::Unknown);
-		try {
-			std::string rawData = Base64::Decode(data['data'].get<std::string>());
-			result->LoadData(descr.Width, descr.Height, descr.FormatHint, type, rawData.data());
+
+		// Pixel data lives in a sidecar blob, which we read straight into the buffer we upload from
+		if (data.contains("blob") && data["blob"].is_string() && type != PixelType::Unknown) {
+			std::vector<uint8_t> pixels;
+			size_t expectedSize = GetTexelSize(descr.FormatHint, type) * descr.Width * descr.Height;
+			if (BlobStore::Read(data["blob"].get<std::string>(), pixels) && pixels.size() >= expectedSize) {
+				result->LoadData(descr.Width, descr.Height, descr.FormatHint, type, pixels.data());
+				// Our pixels match the blob, so we can save without reading them back
+				result->_blobId = data["blob"].get<std::string>();
+			} else {
+				LOG_WARN("Failed to load pixel data for texture from blob \"{}\"", data["blob"].get<std::string>());
+			}
 		}
-		catch (std::runtime_error()) {
-			LOG_WARN("JSON blob had data, but failed to load to texture");
+		// Older manifests embedded the pixels as Base64 in the JSON
+		else if (data.contains("data") && data["data"].is_string()) {
+			try {
+				std::string rawData = Base64::Decode(data["data"].get<std::string>());
+				result->LoadData(descr.Width, descr.Height, descr.FormatHint, type, rawData.data());
+			}
+			catch (std::runtime_error()) {
+				LOG_WARN("JSON blob had data, but failed to load to texture");
+			}
 		}
 	}
 
@@ -75,8 +116,10 @@ Texture2D::Sptr Texture2D::FromJson(const nlohmann::json& data)
 
 Texture2D::Texture2D(const Texture2DDescription& description) : 
 	ITexture(TextureType::_2D),
+	IGpuEvictable(),
 	_description(description),
-	_pixelType(PixelType::Unknown)
+	_pixelType(PixelType::Unknown),
+	_isFileBacked(false)
 {
 	_SetTextureParams();
 	if (!description.Filename.empty()) {
@@ -86,8 +129,10 @@ Texture2D::Texture2D(const Texture2DDescription& description) :
 
 Texture2D::Texture2D(const std::string& filePath) : 
 	ITexture(TextureType::_2D),
+	IGpuEvictable(),
 	_description(Texture2DDescription()),
-	_pixelType(PixelType::Unknown)
+	_pixelType(PixelType::Unknown),
+	_isFileBacked(false)
 {
 	_description.Filename = filePath;
 	_SetTextureParams();
@@ -118,7 +163,7 @@ void Texture2D::SetAnisoLevel(float value) {
 		_description.MaxAnisotropic = glm::clamp(value, 1.0f, ITexture::GetLimits().MAX_ANISOTROPY);
 		glTextureParameterf(_rendererId, GL_TEXTURE_MAX_ANISOTROPY, _description.MaxAnisotropic);
 
-		if (_description.GenerateMipMaps) {
+		if (_description.GenerateMipMaps && !IsCompressedFormat(_description.Format)) {
 			glGenerateTextureMipmap(_rendererId);
 		}
 	}
@@ -128,9 +173,12 @@ void Texture2D::LoadData(uint32_t width, uint32_t height, PixelFormat format, Pi
 	// Ensure the rectangle we're setting is within the bounds of the image
 	LOG_ASSERT((width + offsetX) <= _description.Width, "Pixel bounds are outside of the X extents of the image!");
 	LOG_ASSERT((height + offsetY) <= _description.Height, "Pixel bounds are outside of the Y extents of the image!");
+	LOG_ASSERT(!IsCompressedFormat(_description.Format), "Cannot load uncompressed data into a compressed texture!");
 
 	_description.FormatHint = format;
 	_pixelType = type;
+	_blobId.clear();
+	_isFileBacked = false;
 
 	// Align the data store to the size of a single component to ensure we don't get weirdness with images that aren't RGBA
 	// See https://www.khronos.org/registry/OpenGL-Refpages/gl4/html/glPixelStore.xhtml
@@ -149,14 +197,15 @@ void Texture2D::LoadData(uint32_t width, uint32_t height, PixelFormat format, Pi
 void Texture2D::_LoadDataFromFile() {
 	LOG_ASSERT(_description.Width + _description.Height == 0, "This texture has already been configured with a size! Cannot re-allocate memory!");
 
-	if (!_description.Filename.empty()) {
+	if (!_description.Filename.empty() && !_LoadCompressedFromFile()) {
 		// Variables that will store properties about our image
 		int width, height, numChannels;
 		const int targetChannels = GetTexelComponentCount(_description.FormatHint);
 
-		// Use STBI to load the image
+		// Use STBI to load the image, reading it through the VFS in case it's packed
 		stbi_set_flip_vertically_on_load(true);
-		uint8_t* data = stbi_load(_description.Filename.c_str(), &width, &height, &numChannels, targetChannels);
+		VfsFile::Sptr file = VirtualFileSystem::Open(_description.Filename);
+		uint8_t* data = file == nullptr ? nullptr : stbi_load_from_memory(file->GetData(), (int)file->GetSize(), &width, &height, &numChannels, targetChannels);
 
 		// If we could not load any data, warn and return null
 		if (data == nullptr) {
@@ -196,10 +245,80 @@ void Texture2D::_LoadDataFromFile() {
 		stbi_image_free(data);
 	}
 	
+	_isFileBacked = !_description.Filename.empty();
 	SetDebugName(_description.Filename);
 }
 
-void Texture2D::_SetTextureParams() {
+bool Texture2D::_LoadCompressedFromFile() {
+	std::filesystem::path sourcePath = std::filesystem::path(_description.Filename);
+	std::string extension = sourcePath.extension().string();
+	StringTools::ToLower(extension);
+
+	CompressedImage image;
+
+	// DDS files can be loaded directly, regardless of the requested compression
+	if (extension == ".dds") {
+		if (!TextureCompression::LoadDDS(_description.Filename, image)) {
+			return false;
+		}
+		if (!TextureCompression::IsFormatSupported(image.Format)) {
+			LOG_WARN("\"{}\" uses {} which is not supported on this GPU", _description.Filename, ~image.Format);
+			return false;
+		}
+	}
+	// Otherwise we only compress if the description asks for it
+	else if (IsCompressedFormat(_description.Compression)) {
+		if (!TextureCompression::IsFormatSupported(_description.Compression)) {
+			LOG_WARN("{} is not supported on this GPU, \"{}\" will be uncompressed", ~_description.Compression, _description.Filename);
+			return false;
+		}
+
+		// The compressed mips live in the import cache, keyed by the source image and everything that changes the output
+		bool wrap = _description.HorizontalWrap == WrapMode::Repeat && _description.VerticalWrap == WrapMode::Repeat;
+		std::string settings = ~_description.Compression + (_description.GenerateMipMaps ? " mips" : "") + (wrap ? " wrap" : "");
+		std::string key = ImportCache::MakeKey("texture", TextureCompression::IMPORTER_VERSION, ImportCache::HashFile(_description.Filename), settings, ".dds");
+
+		std::string compressedPath;
+		bool loaded = ImportCache::TryGet(key, compressedPath) && TextureCompression::LoadDDS(compressedPath, image);
+		if (!loaded) {
+			if (!TextureCompression::ImportFile(_description.Filename, ImportCache::GetPath(key), _description.Compression, _description.GenerateMipMaps, wrap, image)) {
+				ImportCache::Remove(key);
+				return false;
+			}
+			ImportCache::Commit(key, _description.Filename);
+		}
+	}
+	else {
+		return false;
+	}
+
+	_UploadCompressed(image);
+	SetDebugName(_description.Filename);
+	return true;
+}
+
+void Texture2D::_UploadCompressed(const CompressedImage& image) {
+	// Update our description to match what we loaded
+	_description.Format = image.Format;
+	_description.Width  = image.Width;
+	_description.Height = image.Height;
+
+	// Mips are baked into the file, so we can't generate any that are missing
+	_description.GenerateMipMaps = image.Levels.size() > 1;
+
+	// Allocates our memory
+	_SetTextureParams((int)image.Levels.size());
+	if (image.Levels.size() == 1) {
+		glTextureParameteri(_rendererId, GL_TEXTURE_MAX_LEVEL, 0);
+	}
+
+	for (size_t ix = 0; ix < image.Levels.size(); ix++) {
+		const CompressedMipLevel& level = image.Levels[ix];
+		glCompressedTextureSubImage2D(_rendererId, (GLint)ix, 0, 0, level.Width, level.Height, *image.Format, (GLsizei)level.Data.size(), level.Data.data());
+	}
+}
+
+void Texture2D::_SetTextureParams(int mipLevels) {
 	// If we have a multisampled texture, and the current type is 2D, change it to 2D multisampled
 	if (_description.MultisampleCount > 1 && _type == TextureType::_2D) {
 		glDeleteTextures(1, &_rendererId);
@@ -217,9 +336,10 @@ void Texture2D::_SetTextureParams() {
 		// If the texture is NOT multisampled, we proceed as normal
 		if (_description.MultisampleCount == 1) {
 			// Calculate how many layers of storage to allocate based on whether mipmaps are enabled or not
-			int layers = _description.GenerateMipMaps ? CalcRequiredMipLevels(_description.Width, _description.Height) : 1;
+			int layers = mipLevels > 0 ? mipLevels : (_description.GenerateMipMaps ? CalcRequiredMipLevels(_description.Width, _description.Height) : 1);
 			// Allocates the memory for our texture
 			glTextureStorage2D(_rendererId, layers, (GLenum)_description.Format, _description.Width, _description.Height);
+			_SetGpuMemoryUsage(GpuMemory::CalculateTextureSize((GLenum)_description.Format, _description.Width, _description.Height, 1, layers));
 
 			glTextureParameteri(_rendererId, GL_TEXTURE_MIN_FILTER, (GLenum)_description.MinificationFilter);
 			glTextureParameteri(_rendererId, GL_TEXTURE_MAG_FILTER, (GLenum)_description.MagnificationFilter);
@@ -228,6 +348,7 @@ void Texture2D::_SetTextureParams() {
 		// Texture is multisampled, we need to allocate memory differently
 		else {
 			glTextureStorage2DMultisample(_rendererId, _description.MultisampleCount, *_description.Format, _description.Width, _description.Height, true);
+			_SetGpuMemoryUsage(GpuMemory::CalculateTextureSize((GLenum)_description.Format, _description.Width, _description.Height, 1, 1, 1, _description.MultisampleCount));
 		}
 
 		glTextureParameteri(_rendererId, GL_TEXTURE_WRAP_S, (GLenum)_description.HorizontalWrap);
@@ -244,6 +365,34 @@ void Texture2D::_SetTextureParams() {
 	}
 }
 
+void Texture2D::Bind(int slot) {
+	_MarkUsed();
+	ITexture::Bind(slot);
+}
+
+bool Texture2D::_CanEvict() const {
+	return _isFileBacked && _description.MultisampleCount == 1 && _rendererId != 0;
+}
+
+uint64_t Texture2D::_GetEvictableSize() const {
+	return GetGpuMemoryUsage();
+}
+
+void Texture2D::_OnEvict() {
+	// We keep our description, so that the texture still reports it's size while it's evicted
+	glDeleteTextures(1, &_rendererId);
+	_rendererId = 0;
+	_SetGpuMemoryUsage(0);
+}
+
+void Texture2D::_OnReload() {
+	// Our size gets filled back in by the load, compressed textures will come out of the import cache
+	_description.Width  = 0;
+	_description.Height = 0;
+	_Recreate();
+	_LoadDataFromFile();
+}
+
 Texture2D::Sptr Texture2D::LoadFromFile(const std::string& path, const Texture2DDescription& description, bool forceRgba) {
 	// Create a copy of the description and change filename to the path
 	Texture2DDescription desc = description;
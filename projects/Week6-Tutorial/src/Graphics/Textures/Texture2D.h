@@ -1,5 +1,8 @@
 #pragma once
 #include "ITexture.h"
+#include "Graphics/GpuMemory.h"
+
+struct CompressedImage;
 
 /// <summary>
 /// Describes all parameters we can manipulate with our 2D Textures
@@ -62,6 +65,14 @@ struct Texture2DDescription {
 	/// </summary>
 	PixelFormat    FormatHint;
 
+	/// <summary>
+	/// The block compressed format to import the source file to (BC1, BC3, BC4, BC5 or BC7),
+	/// or Unknown to upload the image uncompressed. The compressed image is cached next to
+	/// the source file as a DDS file, see TextureCompression.h. Will fall back to an
+	/// uncompressed upload if the format is not supported
+	/// </summary>
+	InternalFormat Compression;
+
 	Texture2DDescription() :
 		Width(0), Height(0),
 		Format(InternalFormat::Unknown),
@@ -74,11 +85,17 @@ struct Texture2DDescription {
 		MultisampleCount(1),
 		Filename(""),
 		FormatHint(PixelFormat::RGBA),
-		EnableShadowSampling(false)
+		EnableShadowSampling(false),
+		Compression(InternalFormat::Unknown)
 	{ }
 };
 
-class Texture2D : public ITexture {
+/// <summary>
+/// A 2D image on the GPU. Textures that were loaded from a file can be evicted when we are over our
+/// GPU memory budget, and will be loaded again from the file (or the import cache) the next time they
+/// are bound
+/// </summary>
+class Texture2D : public ITexture, public IGpuEvictable {
 public:
 	DEFINE_RESOURCE(Texture2D)
 
@@ -144,12 +161,22 @@ public:
 	/// </summary>
 	const Texture2DDescription& GetDescription() const { return _description; }
 
+	/// <summary>
+	/// Binds this texture to the given texture slot, reloading it first if it has been evicted
+	/// </summary>
+	/// <param name="slot">The slot to bind, 0 &lt;= slot &lt; MAX_TEXTURE_UNITS</param>
+	virtual void Bind(int slot) override;
+
 	virtual nlohmann::json ToJson() const override;
 	static Texture2D::Sptr FromJson(const nlohmann::json& data);
 
 protected:
 	Texture2DDescription _description;
 	PixelType _pixelType;
+	// The blob that holds a snapshot of our pixels, empty if the pixels have changed since the last snapshot
+	mutable std::string _blobId;
+	// True if our pixels match the file in our description, so we can be evicted and reloaded
+	bool _isFileBacked;
 
 	/// <summary>
 	/// Loads this texture from the file specified in the description
@@ -157,9 +184,28 @@ protected:
 	/// </summary>
 	void _LoadDataFromFile();
 	/// <summary>
+	/// Attempts to load this texture from a compressed DDS file, importing the source
+	/// file first if the compressed version is missing or out of date
+	/// </summary>
+	/// <returns>True if the compressed texture was loaded, false if we should fall back to stb_image</returns>
+	bool _LoadCompressedFromFile();
+	/// <summary>
+	/// Allocates storage for a compressed image and uploads all of it's mip levels
+	/// </summary>
+	/// <param name="image">The image to upload</param>
+	void _UploadCompressed(const CompressedImage& image);
+	/// <summary>
 	/// Allocates our texture's memory and sets sampling / filtering parameters
 	/// </summary>
-	void _SetTextureParams();
+	/// <param name="mipLevels">The number of mip levels to allocate, or 0 to calculate it from the description</param>
+	void _SetTextureParams(int mipLevels = 0);
+
+	// Inherited from IGpuEvictable
+
+	virtual bool _CanEvict() const override;
+	virtual uint64_t _GetEvictableSize() const override;
+	virtual void _OnEvict() override;
+	virtual void _OnReload() override;
 
 public:
 	static Texture2D::Sptr LoadFromFile(const std::string& path, const Texture2DDescription& description = Texture2DDescription(), bool forceRgba = true);
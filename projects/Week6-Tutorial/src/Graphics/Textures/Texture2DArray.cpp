@@ -1,5 +1,6 @@
 #include "Texture2DArray.h"
 #include <stb_image.h>
+#include "Utils/VirtualFileSystem.h"
 #include <Logging.h>
 #include "GLM/glm.hpp"
 #include "Utils/JsonGlmHelpers.h"
@@ -157,9 +158,10 @@ void Texture2DArray::_LoadDataFromFile() {
 		int width, height, numChannels;
 		const int targetChannels = GetTexelComponentCount(_description.FormatHint);
 
-		// Use STBI to load the image
+		// Use STBI to load the image, reading it through the VFS in case it's packed
 		stbi_set_flip_vertically_on_load(true);
-		uint8_t* data = stbi_load(_description.Filename.c_str(), &width, &height, &numChannels, targetChannels);
+		VfsFile::Sptr file = VirtualFileSystem::Open(_description.Filename);
+		uint8_t* data = file == nullptr ? nullptr : stbi_load_from_memory(file->GetData(), (int)file->GetSize(), &width, &height, &numChannels, targetChannels);
 
 		// If we could not load any data, warn and return null
 		if (data == nullptr) {
@@ -266,6 +268,7 @@ void Texture2DArray::_SetTextureParams() {
 		int layers = _description.GenerateMipMaps ? CalcRequiredMipLevels(sliceWidth, sliceHeight) : 1;
 		// Allocates the memory for our texture
 		glTextureStorage3D(_rendererId, layers, (GLenum)_description.Format, sliceWidth, sliceHeight, _description.XDivisions * _description.YDivisions);
+		_SetGpuMemoryUsage(GpuMemory::CalculateTextureSize((GLenum)_description.Format, sliceWidth, sliceHeight, 1, layers, _description.XDivisions * _description.YDivisions));
 
 		glTextureParameteri(_rendererId, GL_TEXTURE_MIN_FILTER, (GLenum)_description.MinificationFilter);
 		glTextureParameteri(_rendererId, GL_TEXTURE_MAG_FILTER, (GLenum)_description.MagnificationFilter);
@@ -1,12 +1,18 @@
 #include "Texture3D.h"
 #include "Utils/Base64.h"
+#include "Utils/BlobStore.h"
+#include "Graphics/AsyncReadback.h"
 #include "Utils/JsonGlmHelpers.h"
 #include "Utils/StringUtils.h"
+#include "Utils/ImportCache.h"
+#include "Utils/VirtualFileSystem.h"
 #include <Logging.h>
 #include <stb_image.h>
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <filesystem>
+#include <cstring>
 
 inline int CalcRequiredMipLevels(int width, int height, int depth) {
 	return (1 + floor(log2(std::max(width, std::max(height, depth)))));
@@ -50,6 +56,7 @@ void Texture3D::LoadData(uint32_t width, uint32_t height, uint32_t depth, PixelF
 
 	_description.FormatHint = format;
 	_pixelType = type;
+	_blobId.clear();
 
 	// Align the data store to the size of a single component to ensure we don't get weirdness with images that aren't RGBA
 	// See https://www.khronos.org/registry/OpenGL-Refpages/gl4/html/glPixelStore.xhtml
@@ -84,14 +91,19 @@ nlohmann::json Texture3D::ToJson() const
 		result["size_y"] = _description.Height;
 		result["size_z"] = _description.Depth;
 
+		result["internal_format"] = ~_description.Format;
 		result["format"] = ~_description.FormatHint;
 		result["pixel_type"] = ~_pixelType;
 
 		if ((_description.Width * _description.Height * _description.Depth) > 0 && _description.FormatHint != PixelFormat::Unknown) {
-			size_t dataSize = GetTexelSize(_description.FormatHint, _pixelType) * _description.Width * _description.Height * _description.Depth;
-			uint8_t* dataStore = new uint8_t[dataSize];
-			glGetTextureImage(_rendererId, 0, *_description.Format, *_pixelType, dataSize, dataStore);
-			result["data"] = Base64::Encode(dataStore, dataSize);
+			// The texels go in a sidecar file, we only store a reference to it in the JSON. Reading them back is done
+			// asynchronously, so the blob is written a few frames later on a worker thread. If our texels haven't
+			// changed since the last snapshot, we can just re-use that one
+			if (_blobId.empty()) {
+				_blobId = Guid::New().str();
+				AsyncReadback::ReadTexture(_rendererId, glm::uvec3(_description.Width, _description.Height, _description.Depth), _description.FormatHint, _pixelType, AsyncReadback::BlobWriter(_blobId));
+			}
+			result["blob"] = _blobId;
 		}
 	}
 	return result;
@@ -114,18 +126,39 @@ Texture3D::Sptr Texture3D::FromJson(const nlohmann::json& data)
 	description.MagnificationFilter = JsonParseEnum(MagFilter, data, "filter_mag", MagFilter::Linear);
 	description.GenerateMipMaps = JsonGet(data, "generate_mipmaps", false);
 	description.FormatHint = JsonParseEnum(PixelFormat, data, "format", PixelFormat::Unknown);
+	description.Format = JsonParseEnum(InternalFormat, data, "internal_format", description.Format);
+
+	// Older manifests did not store the internal format, so we guess it from the pixel layout
+	if (description.Filename.empty() && description.Format == InternalFormat::Unknown && description.FormatHint != PixelFormat::Unknown) {
+		description.Format = GetInternalFormatForChannels8(GetTexelComponentCount(description.FormatHint));
+	}
 
 	Texture3D::Sptr result = std::make_shared<Texture3D>(description);
 
-	// If we embedded data into the JSON, load it now
-	if (description.Filename.empty() && data.contains("data") && data["data"].is_string()) {
+	if (description.Filename.empty()) {
 		PixelType type = JsonParseEnum(PixelType, data, "pixel_type", PixelType::Unknown);
-		try {
-			std::string rawData = Base64::Decode(data['data'].get<std::string>());
-			result->LoadData(description.Width, description.Height, description.Depth, description.FormatHint, type, rawData.data());
+
+		// Texel data lives in a sidecar blob, which we read straight into the buffer we upload from
+		if (data.contains("blob") && data["blob"].is_string() && type != PixelType::Unknown && description.FormatHint != PixelFormat::Unknown) {
+			std::vector<uint8_t> texels;
+			size_t expectedSize = GetTexelSize(description.FormatHint, type) * description.Width * description.Height * description.Depth;
+			if (BlobStore::Read(data["blob"].get<std::string>(), texels) && texels.size() >= expectedSize) {
+				result->LoadData(description.Width, description.Height, description.Depth, description.FormatHint, type, texels.data());
+				// Our texels match the blob, so we can save without reading them back
+				result->_blobId = data["blob"].get<std::string>();
+			} else {
+				LOG_WARN("Failed to load texel data for texture from blob \"{}\"", data["blob"].get<std::string>());
+			}
 		}
-		catch (std::runtime_error()) {
-			LOG_WARN("JSON blob had data, but failed to load to texture");
+		// Older manifests embedded the texels as Base64 in the JSON
+		else if (data.contains("data") && data["data"].is_string()) {
+			try {
+				std::string rawData = Base64::Decode(data["data"].get<std::string>());
+				result->LoadData(description.Width, description.Height, description.Depth, description.FormatHint, type, rawData.data());
+			}
+			catch (std::runtime_error()) {
+				LOG_WARN("JSON blob had data, but failed to load to texture");
+			}
 		}
 	}
 
@@ -147,19 +180,33 @@ void Texture3D::_LoadDataFromFile()
 	}
 }
 
-void Texture3D::_LoadCubeFile()
-{
-	std::ifstream inFile(_description.Filename);
-
-	if (!inFile.is_open()) {
-		LOG_WARN("Failed to open file .cube file: {}", _description.Filename);
-		return;
+// Bump this whenever the parser or the binary layout below changes, so that LUTs in the ImportCache are parsed again
+const uint32_t LUT_IMPORTER_VERSION = 1;
+
+// Will be put at the start of each binary LUT file, followed by the title and then the RGB8 texels
+struct BinaryLutHeader {
+	char     HeaderBytes[4] = { 'L', 'U', 'T', '3' };
+	uint32_t Size           = 0;
+	uint32_t TitleLength    = 0;
+	uint32_t Reserved       = 0;
+};
+
+/// <summary>
+/// Parses the text of a .cube file into RGB8 texels
+/// </summary>
+static bool __ParseCubeFile(const std::string& filename, uint32_t& lutSize, std::vector<glm::u8vec3>& textureData, std::string& title) {
+	// The file may be coming from a pack, so we read it through the VFS
+	std::string contents;
+	if (!VirtualFileSystem::ReadFile(filename, contents)) {
+		LOG_WARN("Failed to open file .cube file: {}", filename);
+		return false;
 	}
+	std::istringstream inFile(contents);
 
-	glm::u8vec3* textureData = nullptr;
-	uint32_t lutSize{ 0 };
 	uint32_t ix{ 0 };
 	glm::vec3 rgb { 0, 0, 0 };
+	lutSize = 0;
+	textureData.clear();
 
 	std::string line;
 	// Iterate as long as we have lines from the file
@@ -185,33 +232,19 @@ void Texture3D::_LoadCubeFile()
 			std::stringstream lReader(line.substr(12));
 			lReader >> lutSize;
 
-			// Update the description's size
-			_description.Width = _description.Height = _description.Depth = lutSize;
-
-			// If the size we read is non-zero, allocate our data!
-			if (lutSize > 0) {
-				// If we had data already, delete it
-				if (textureData != nullptr) {
-					delete[] textureData;
-				} 
-
-				// Allocate data to store texels in
-				textureData = new glm::u8vec3[(size_t)lutSize * lutSize * lutSize];
-				ix = 0;
-			}
+			// Allocate data to store texels in, replacing anything we had already
+			textureData.assign((size_t)lutSize * lutSize * lutSize, glm::u8vec3(0));
+			ix = 0;
 		}
 
 		// We'll grab the title for our debug name, nice lil use of it
 		else if (line.find("TITLE") != std::string::npos) {
 
 			// Skip over the TITLE token and the space after it
-			std::string name = line.substr(6);
+			title = line.substr(6);
 
 			// Trim any excess whitespace
-			StringTools::Trim(name);
-
-			// We'll store this in the debug name
-			SetDebugName(name);
+			StringTools::Trim(title);
 		}
 
 		else if (line.find("DOMAIN_MIN") != std::string::npos)
@@ -224,11 +257,12 @@ void Texture3D::_LoadCubeFile()
 		{ /* ignore for now */ }
 
 		// Reading data lines
-		else if (!line.empty() && textureData != nullptr) {
+		else if (!textureData.empty()) {
 
 			// Make sure we don't case a write access violation
-			if (ix >= (lutSize * lutSize * lutSize) && lutSize > 0) {
+			if (ix >= textureData.size()) {
 				LOG_ASSERT(false, "Attempting to write outside the bounds of the LUT");
+				break;
 			}
 
 			// Read RGB from the line
@@ -245,9 +279,81 @@ void Texture3D::_LoadCubeFile()
 			// Move to the next texel
 			ix++;
 		}
-	} 
+	}
+
+	return !textureData.empty();
+}
+
+/// <summary>
+/// Writes parsed LUT texels to a binary file, so we don't need to parse the text again
+/// </summary>
+static bool __WriteBinaryLut(const std::string& filename, uint32_t lutSize, const std::vector<glm::u8vec3>& textureData, const std::string& title) {
+	std::ofstream file(filename, std::ios::binary);
+	if (!file) {
+		return false;
+	}
+
+	BinaryLutHeader header = BinaryLutHeader();
+	header.Size        = lutSize;
+	header.TitleLength = static_cast<uint32_t>(title.size());
+	file.write(reinterpret_cast<const char*>(&header), sizeof(BinaryLutHeader));
+	file.write(title.data(), title.size());
+	file.write(reinterpret_cast<const char*>(textureData.data()), textureData.size() * sizeof(glm::u8vec3));
+	return file.good();
+}
+
+/// <summary>
+/// Reads a LUT that was written by __WriteBinaryLut
+/// </summary>
+static bool __ReadBinaryLut(const std::string& filename, uint32_t& lutSize, std::vector<glm::u8vec3>& textureData, std::string& title) {
+	std::ifstream file(filename, std::ios::binary);
+	if (!file) {
+		return false;
+	}
+
+	BinaryLutHeader header = BinaryLutHeader();
+	file.read(reinterpret_cast<char*>(&header), sizeof(BinaryLutHeader));
+	// LUTs are tiny, anything this large means the file is garbage
+	if (!file || memcmp(header.HeaderBytes, "LUT3", 4) != 0 || header.Size == 0 || header.Size > 256 || header.TitleLength > 1024) {
+		return false;
+	}
+
+	lutSize = header.Size;
+	title.resize(header.TitleLength);
+	file.read(title.data(), header.TitleLength);
+	textureData.resize((size_t)lutSize * lutSize * lutSize);
+	file.read(reinterpret_cast<char*>(textureData.data()), textureData.size() * sizeof(glm::u8vec3));
+	return file.good();
+}
+
+void Texture3D::_LoadCubeFile()
+{
+	uint32_t lutSize{ 0 };
+	std::vector<glm::u8vec3> textureData;
+	std::string title;
+
+	// Parsing the text is slow, so we keep the parsed texels in the import cache
+	std::string key = ImportCache::MakeKey("lut", LUT_IMPORTER_VERSION, ImportCache::HashFile(_description.Filename));
+	std::string binaryPath;
+	bool loaded = ImportCache::TryGet(key, binaryPath) && __ReadBinaryLut(binaryPath, lutSize, textureData, title);
+	if (!loaded) {
+		if (__ParseCubeFile(_description.Filename, lutSize, textureData, title)) {
+			if (__WriteBinaryLut(ImportCache::GetPath(key), lutSize, textureData, title)) {
+				ImportCache::Commit(key, _description.Filename);
+			} else {
+				ImportCache::Remove(key);
+			}
+		}
+	}
+
+	if (!textureData.empty()) {
+		// We'll store the title in the debug name
+		if (!title.empty()) {
+			SetDebugName(title);
+		}
 
-	if (textureData != nullptr) {
+		// Update the description's size
+		_description.Width = _description.Height = _description.Depth = lutSize;
 		// Set the pixel format
 		_description.Format = InternalFormat::RGB8;
 		// We need to clamp to edge for LUTS
@@ -256,10 +362,7 @@ void Texture3D::_LoadCubeFile()
 		// Allocate data and configure params
 		_SetTextureParams();
 		// Load data
-		LoadData(lutSize, lutSize, lutSize, PixelFormat::RGB, PixelType::UByte, textureData);
-
-		// Clean up after ourselves
-		delete[] textureData;
+		LoadData(lutSize, lutSize, lutSize, PixelFormat::RGB, PixelType::UByte, textureData.data());
 	}
 	else {
 		LOG_WARN("Failed to load cube file: \"{}\"", _description.Filename);
@@ -272,6 +375,7 @@ void Texture3D::_SetTextureParams()
 	int layers = _description.GenerateMipMaps ? CalcRequiredMipLevels(_description.Width, _description.Height, _description.Depth) : 1;
 	// Allocates the memory for our texture
 	glTextureStorage3D(_rendererId, layers, (GLenum)_description.Format, _description.Width, _description.Height, _description.Depth);
+	_SetGpuMemoryUsage(GpuMemory::CalculateTextureSize((GLenum)_description.Format, _description.Width, _description.Height, _description.Depth, layers));
 
 	glTextureParameteri(_rendererId, GL_TEXTURE_MIN_FILTER, (GLenum)_description.MinificationFilter);
 	glTextureParameteri(_rendererId, GL_TEXTURE_MAG_FILTER, (GLenum)_description.MagnificationFilter);
@@ -149,6 +149,8 @@ public:
 protected:
 	Texture3DDescription _description;
 	PixelType _pixelType;
+	// The blob that holds a snapshot of our texels, empty if the texels have changed since the last snapshot
+	mutable std::string _blobId;
 
 	/// <summary>
 	/// Loads this texture from the file specified in the description
@@ -0,0 +1,904 @@
+#include "TextureCompression.h"
+
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include <cstring>
+#include <cfloat>
+#include <climits>
+#include <cmath>
+
+#include <stb_image.h>
+#include <GLFW/glfw3.h>
+#include <Logging.h>
+#include <GLM/gtc/constants.hpp>
+
+#include "Utils/StringUtils.h"
+#include "Utils/VirtualFileSystem.h"
+
+namespace fs = std::filesystem;
+
+#pragma region DDS Layout
+
+constexpr uint32_t MakeFourCC(char a, char b, char c, char d) {
+	return (uint32_t)(uint8_t)a | ((uint32_t)(uint8_t)b << 8) | ((uint32_t)(uint8_t)c << 16) | ((uint32_t)(uint8_t)d << 24);
+}
+
+// See https://docs.microsoft.com/en-us/windows/win32/direct3ddds/dds-header
+struct DDSPixelFormat {
+	uint32_t Size;
+	uint32_t Flags;
+	uint32_t FourCC;
+	uint32_t RGBBitCount;
+	uint32_t RBitMask;
+	uint32_t GBitMask;
+	uint32_t BBitMask;
+	uint32_t ABitMask;
+};
+
+struct DDSHeader {
+	uint32_t       Size;
+	uint32_t       Flags;
+	uint32_t       Height;
+	uint32_t       Width;
+	uint32_t       PitchOrLinearSize;
+	uint32_t       Depth;
+	uint32_t       MipMapCount;
+	uint32_t       Reserved1[11];
+	DDSPixelFormat PixelFormat;
+	uint32_t       Caps;
+	uint32_t       Caps2;
+	uint32_t       Caps3;
+	uint32_t       Caps4;
+	uint32_t       Reserved2;
+};
+
+// See https://docs.microsoft.com/en-us/windows/win32/direct3ddds/dds-header-dxt10
+struct DDSHeaderDX10 {
+	uint32_t DxgiFormat;
+	uint32_t ResourceDimension;
+	uint32_t MiscFlag;
+	uint32_t ArraySize;
+	uint32_t MiscFlags2;
+};
+
+static_assert(sizeof(DDSHeader) == 124, "DDS header must be 124 bytes");
+static_assert(sizeof(DDSHeaderDX10) == 20, "DDS DX10 header must be 20 bytes");
+
+const uint32_t DDS_MAGIC          = MakeFourCC('D', 'D', 'S', ' ');
+const uint32_t DDSD_CAPS          = 0x1;
+const uint32_t DDSD_HEIGHT        = 0x2;
+const uint32_t DDSD_WIDTH         = 0x4;
+const uint32_t DDSD_PIXELFORMAT   = 0x1000;
+const uint32_t DDSD_MIPMAPCOUNT   = 0x20000;
+const uint32_t DDSD_LINEARSIZE    = 0x80000;
+const uint32_t DDPF_FOURCC        = 0x4;
+const uint32_t DDSCAPS_COMPLEX    = 0x8;
+const uint32_t DDSCAPS_TEXTURE    = 0x1000;
+const uint32_t DDSCAPS_MIPMAP     = 0x400000;
+const uint32_t DDS_DIMENSION_TEXTURE2D = 3;
+
+// Readers ignore the reserved fields, so we use one to mark files that we wrote with rows stored
+// bottom to top (OpenGL's convention), rather than top to bottom like other tools will write them
+const uint32_t DDS_RESERVED_TAG_INDEX = 9;
+const uint32_t DDS_GL_ORIGIN_TAG      = MakeFourCC('G', 'L', 'B', 'L');
+
+// See https://docs.microsoft.com/en-us/windows/win32/api/dxgiformat/ne-dxgiformat-dxgi_format
+enum DxgiFormat : uint32_t {
+	DXGI_FORMAT_BC1_UNORM = 71,
+	DXGI_FORMAT_BC3_UNORM = 77,
+	DXGI_FORMAT_BC4_UNORM = 80,
+	DXGI_FORMAT_BC5_UNORM = 83,
+	DXGI_FORMAT_BC7_UNORM = 98
+};
+
+static uint32_t __GetDxgiFormat(InternalFormat format) {
+	switch (format) {
+		case InternalFormat::BC1: return DXGI_FORMAT_BC1_UNORM;
+		case InternalFormat::BC3: return DXGI_FORMAT_BC3_UNORM;
+		case InternalFormat::BC4: return DXGI_FORMAT_BC4_UNORM;
+		case InternalFormat::BC5: return DXGI_FORMAT_BC5_UNORM;
+		case InternalFormat::BC7: return DXGI_FORMAT_BC7_UNORM;
+		default: return 0;
+	}
+}
+
+static InternalFormat __FromDxgiFormat(uint32_t format) {
+	switch (format) {
+		case DXGI_FORMAT_BC1_UNORM: return InternalFormat::BC1;
+		case DXGI_FORMAT_BC3_UNORM: return InternalFormat::BC3;
+		case DXGI_FORMAT_BC4_UNORM: return InternalFormat::BC4;
+		case DXGI_FORMAT_BC5_UNORM: return InternalFormat::BC5;
+		case DXGI_FORMAT_BC7_UNORM: return InternalFormat::BC7;
+		default: return InternalFormat::Unknown;
+	}
+}
+
+static InternalFormat __FromFourCC(uint32_t fourCC) {
+	if (fourCC == MakeFourCC('D', 'X', 'T', '1')) return InternalFormat::BC1;
+	if (fourCC == MakeFourCC('D', 'X', 'T', '5')) return InternalFormat::BC3;
+	if (fourCC == MakeFourCC('A', 'T', 'I', '1') || fourCC == MakeFourCC('B', 'C', '4', 'U')) return InternalFormat::BC4;
+	if (fourCC == MakeFourCC('A', 'T', 'I', '2') || fourCC == MakeFourCC('B', 'C', '5', 'U')) return InternalFormat::BC5;
+	return InternalFormat::Unknown;
+}
+
+#pragma endregion
+
+#pragma region Block Encoders
+
+// Stores 16 RGBA texels for a single 4x4 block
+typedef uint8_t Block[16][4];
+
+/// <summary>
+/// Writes values into a little endian bit stream, used for BC7 blocks
+/// </summary>
+struct BitWriter {
+	uint8_t* Data;
+	uint32_t Bit = 0;
+
+	BitWriter(uint8_t* data) : Data(data) { }
+
+	void Write(uint32_t value, uint32_t count) {
+		for (uint32_t ix = 0; ix < count; ix++, Bit++) {
+			if ((value >> ix) & 1) {
+				Data[Bit >> 3] |= (uint8_t)(1 << (Bit & 7));
+			}
+		}
+	}
+};
+
+static void __FetchBlock(const uint8_t* rgba, uint32_t width, uint32_t height, uint32_t blockX, uint32_t blockY, Block& result) {
+	// Blocks that hang off the edge of the image repeat the last row/column, so they don't skew the endpoints
+	for (uint32_t y = 0; y < 4; y++) {
+		uint32_t py = std::min(blockY * 4 + y, height - 1);
+		for (uint32_t x = 0; x < 4; x++) {
+			uint32_t px = std::min(blockX * 4 + x, width - 1);
+			memcpy(result[y * 4 + x], rgba + ((size_t)py * width + px) * 4, 4);
+		}
+	}
+}
+
+/// <summary>
+/// Finds the endpoints of the line that best fits a set of points, by projecting the points
+/// onto their principal axis (found via power iteration on the covariance matrix)
+/// </summary>
+static void __FitLine(const float points[][4], int count, int channels, float outMin[4], float outMax[4]) {
+	float mean[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	float lo[4] = { 255.0f, 255.0f, 255.0f, 255.0f };
+	float hi[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	for (int ix = 0; ix < count; ix++) {
+		for (int c = 0; c < channels; c++) {
+			mean[c] += points[ix][c];
+			lo[c] = std::min(lo[c], points[ix][c]);
+			hi[c] = std::max(hi[c], points[ix][c]);
+		}
+	}
+	for (int c = 0; c < channels; c++) {
+		mean[c] /= (float)count;
+	}
+
+	float cov[4][4] = { };
+	for (int ix = 0; ix < count; ix++) {
+		for (int a = 0; a < channels; a++) {
+			for (int b = 0; b < channels; b++) {
+				cov[a][b] += (points[ix][a] - mean[a]) * (points[ix][b] - mean[b]);
+			}
+		}
+	}
+
+	// Start from the bounding box diagonal, then refine with a few power iterations
+	float axis[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	for (int c = 0; c < channels; c++) {
+		axis[c] = hi[c] - lo[c];
+	}
+	for (int iter = 0; iter < 8; iter++) {
+		float next[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		float length = 0.0f;
+		for (int a = 0; a < channels; a++) {
+			for (int b = 0; b < channels; b++) {
+				next[a] += cov[a][b] * axis[b];
+			}
+			length = std::max(length, std::abs(next[a]));
+		}
+		if (length < 1e-6f) {
+			break;
+		}
+		for (int c = 0; c < channels; c++) {
+			axis[c] = next[c] / length;
+		}
+	}
+
+	float lengthSq = 0.0f;
+	for (int c = 0; c < channels; c++) {
+		lengthSq += axis[c] * axis[c];
+	}
+
+	// All the points are the same (or the axis collapsed), just use the box corners
+	if (lengthSq < 1e-6f) {
+		for (int c = 0; c < channels; c++) {
+			outMin[c] = lo[c];
+			outMax[c] = hi[c];
+		}
+		return;
+	}
+
+	float tMin = FLT_MAX, tMax = -FLT_MAX;
+	for (int ix = 0; ix < count; ix++) {
+		float t = 0.0f;
+		for (int c = 0; c < channels; c++) {
+			t += (points[ix][c] - mean[c]) * axis[c];
+		}
+		tMin = std::min(tMin, t);
+		tMax = std::max(tMax, t);
+	}
+	for (int c = 0; c < channels; c++) {
+		outMin[c] = std::clamp(mean[c] + axis[c] * tMin / lengthSq, 0.0f, 255.0f);
+		outMax[c] = std::clamp(mean[c] + axis[c] * tMax / lengthSq, 0.0f, 255.0f);
+	}
+}
+
+static uint16_t __PackRgb565(const float color[4]) {
+	uint32_t r = (uint32_t)std::lround(color[0] * 31.0f / 255.0f);
+	uint32_t g = (uint32_t)std::lround(color[1] * 63.0f / 255.0f);
+	uint32_t b = (uint32_t)std::lround(color[2] * 31.0f / 255.0f);
+	return (uint16_t)((r << 11) | (g << 5) | b);
+}
+
+static void __UnpackRgb565(uint16_t value, int result[3]) {
+	int r = (value >> 11) & 31, g = (value >> 5) & 63, b = value & 31;
+	result[0] = (r << 3) | (r >> 2);
+	result[1] = (g << 2) | (g >> 4);
+	result[2] = (b << 3) | (b >> 2);
+}
+
+/// <summary>
+/// Encodes the color part of a BC1/BC3 block
+/// </summary>
+/// <param name="allowPunchThrough">True to use the 3 color + transparent mode for blocks with alpha (BC1 only)</param>
+static void __EncodeBC1(const Block& block, bool allowPunchThrough, uint8_t* output) {
+	float points[16][4];
+	int   count = 0;
+	bool  transparent[16];
+	bool  anyTransparent = false;
+	for (int ix = 0; ix < 16; ix++) {
+		transparent[ix] = allowPunchThrough && block[ix][3] < 128;
+		anyTransparent |= transparent[ix];
+		if (!transparent[ix]) {
+			for (int c = 0; c < 4; c++) {
+				points[count][c] = block[ix][c];
+			}
+			count++;
+		}
+	}
+
+	uint16_t c0 = 0, c1 = 0;
+	if (count > 0) {
+		float lo[4], hi[4];
+		__FitLine(points, count, 3, lo, hi);
+		c0 = __PackRgb565(hi);
+		c1 = __PackRgb565(lo);
+	}
+
+	// The order of the endpoints selects the mode, c0 > c1 is 4 color, otherwise 3 color + transparent
+	if (anyTransparent ? (c0 > c1) : (c0 < c1)) {
+		std::swap(c0, c1);
+	}
+
+	int palette[4][3];
+	__UnpackRgb565(c0, palette[0]);
+	__UnpackRgb565(c1, palette[1]);
+	int numColors = 4;
+	for (int c = 0; c < 3; c++) {
+		if (anyTransparent) {
+			palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+			palette[3][c] = 0;
+			numColors = 3;
+		} else {
+			palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+			palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+		}
+	}
+
+	uint32_t indices = 0;
+	// If both endpoints are equal we are in 3 color mode with a solid color, index 0 is fine
+	if (c0 != c1 || anyTransparent) {
+		for (int ix = 0; ix < 16; ix++) {
+			uint32_t best = 3;
+			if (!transparent[ix]) {
+				int bestError = INT_MAX;
+				for (int p = 0; p < numColors; p++) {
+					int dr = block[ix][0] - palette[p][0], dg = block[ix][1] - palette[p][1], db = block[ix][2] - palette[p][2];
+					int error = dr * dr + dg * dg + db * db;
+					if (error < bestError) {
+						bestError = error;
+						best = p;
+					}
+				}
+			}
+			indices |= best << (ix * 2);
+		}
+	}
+
+	output[0] = (uint8_t)(c0 & 0xFF); output[1] = (uint8_t)(c0 >> 8);
+	output[2] = (uint8_t)(c1 & 0xFF); output[3] = (uint8_t)(c1 >> 8);
+	for (int ix = 0; ix < 4; ix++) {
+		output[4 + ix] = (uint8_t)((indices >> (ix * 8)) & 0xFF);
+	}
+}
+
+/// <summary>
+/// Encodes a single channel BC4 block (also used for BC3 alpha and both channels of BC5)
+/// </summary>
+static void __EncodeBC4(const Block& block, int channel, uint8_t* output) {
+	int lo = 255, hi = 0;
+	for (int ix = 0; ix < 16; ix++) {
+		lo = std::min(lo, (int)block[ix][channel]);
+		hi = std::max(hi, (int)block[ix][channel]);
+	}
+
+	// a0 > a1 selects the 8 value mode
+	int palette[8];
+	palette[0] = hi;
+	palette[1] = lo;
+	for (int ix = 2; ix < 8; ix++) {
+		palette[ix] = ((8 - ix) * hi + (ix - 1) * lo) / 7;
+	}
+
+	uint64_t indices = 0;
+	if (hi != lo) {
+		for (int ix = 0; ix < 16; ix++) {
+			uint64_t best = 0;
+			int bestError = INT_MAX;
+			for (int p = 0; p < 8; p++) {
+				int error = std::abs(block[ix][channel] - palette[p]);
+				if (error < bestError) {
+					bestError = error;
+					best = p;
+				}
+			}
+			indices |= best << (ix * 3);
+		}
+	}
+
+	output[0] = (uint8_t)hi;
+	output[1] = (uint8_t)lo;
+	for (int ix = 0; ix < 6; ix++) {
+		output[2 + ix] = (uint8_t)((indices >> (ix * 8)) & 0xFF);
+	}
+}
+
+/// <summary>
+/// Encodes a BC7 block using mode 6 (one subset, 7 bit RGBA endpoints with a shared p-bit each, 4 bit indices)
+/// </summary>
+static void __EncodeBC7(const Block& block, uint8_t* output) {
+	static const int weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	float points[16][4];
+	for (int ix = 0; ix < 16; ix++) {
+		for (int c = 0; c < 4; c++) {
+			points[ix][c] = block[ix][c];
+		}
+	}
+	float endpoints[2][4];
+	__FitLine(points, 16, 4, endpoints[0], endpoints[1]);
+
+	// Quantize the endpoints to 7 bits, picking whichever p-bit gets us closer
+	uint32_t quantized[2][4];
+	uint32_t pBits[2];
+	int      expanded[2][4];
+	for (int e = 0; e < 2; e++) {
+		float bestError = FLT_MAX;
+		for (uint32_t p = 0; p < 2; p++) {
+			uint32_t q[4];
+			float error = 0.0f;
+			for (int c = 0; c < 4; c++) {
+				q[c] = (uint32_t)std::clamp((int)std::lround((endpoints[e][c] - p) / 2.0f), 0, 127);
+				float diff = (float)((q[c] << 1) | p) - endpoints[e][c];
+				error += diff * diff;
+			}
+			if (error < bestError) {
+				bestError = error;
+				pBits[e] = p;
+				memcpy(quantized[e], q, sizeof(q));
+			}
+		}
+		for (int c = 0; c < 4; c++) {
+			expanded[e][c] = (int)((quantized[e][c] << 1) | pBits[e]);
+		}
+	}
+
+	int palette[16][4];
+	for (int ix = 0; ix < 16; ix++) {
+		for (int c = 0; c < 4; c++) {
+			palette[ix][c] = ((64 - weights[ix]) * expanded[0][c] + weights[ix] * expanded[1][c] + 32) >> 6;
+		}
+	}
+
+	uint32_t indices[16];
+	for (int ix = 0; ix < 16; ix++) {
+		int bestError = INT_MAX;
+		for (uint32_t p = 0; p < 16; p++) {
+			int error = 0;
+			for (int c = 0; c < 4; c++) {
+				int diff = block[ix][c] - palette[p][c];
+				error += diff * diff;
+			}
+			if (error < bestError) {
+				bestError = error;
+				indices[ix] = p;
+			}
+		}
+	}
+
+	// The anchor texel's index has an implicit high bit of 0, swap the endpoints if that's not the case
+	if (indices[0] & 8) {
+		std::swap(quantized[0], quantized[1]);
+		std::swap(pBits[0], pBits[1]);
+		for (int ix = 0; ix < 16; ix++) {
+			indices[ix] = 15 - indices[ix];
+		}
+	}
+
+	memset(output, 0, 16);
+	BitWriter writer(output);
+	writer.Write(1 << 6, 7); // Mode 6
+	for (int c = 0; c < 4; c++) {
+		writer.Write(quantized[0][c], 7);
+		writer.Write(quantized[1][c], 7);
+	}
+	writer.Write(pBits[0], 1);
+	writer.Write(pBits[1], 1);
+	writer.Write(indices[0], 3);
+	for (int ix = 1; ix < 16; ix++) {
+		writer.Write(indices[ix], 4);
+	}
+}
+
+#pragma endregion
+
+#pragma region Block Flipping
+
+// Reverses the first numRows rows of the 2 bit index table in a BC1 block
+static void __FlipBC1Block(uint8_t* block, uint32_t numRows) {
+	uint8_t rows[4];
+	memcpy(rows, block + 4, 4);
+	for (uint32_t ix = 0; ix < numRows; ix++) {
+		block[4 + ix] = rows[numRows - 1 - ix];
+	}
+}
+
+// Reverses the first numRows rows of the 3 bit index table in a BC4 block
+static void __FlipBC4Block(uint8_t* block, uint32_t numRows) {
+	uint64_t bits = 0;
+	for (int ix = 0; ix < 6; ix++) {
+		bits |= (uint64_t)block[2 + ix] << (ix * 8);
+	}
+	uint64_t result = bits;
+	for (uint32_t ix = 0; ix < numRows; ix++) {
+		uint64_t row = (bits >> ((numRows - 1 - ix) * 12)) & 0xFFF;
+		result &= ~(0xFFFull << (ix * 12));
+		result |= row << (ix * 12);
+	}
+	for (int ix = 0; ix < 6; ix++) {
+		block[2 + ix] = (uint8_t)((result >> (ix * 8)) & 0xFF);
+	}
+}
+
+#pragma endregion
+
+#pragma region Mip Filtering
+
+// Zeroth order modified bessel function of the first kind, used by the kaiser window
+static float __Bessel0(float x) {
+	float sum = 1.0f, term = 1.0f;
+	for (int k = 1; k < 32; k++) {
+		float f = x / (2.0f * k);
+		term *= f * f;
+		sum += term;
+		if (term < sum * 1e-8f) break;
+	}
+	return sum;
+}
+
+static float __KaiserSinc(float x) {
+	const float width = 3.0f;
+	const float alpha = 4.0f;
+	if (std::abs(x) >= width) {
+		return 0.0f;
+	}
+	float t = x / width;
+	float window = __Bessel0(alpha * std::sqrt(1.0f - t * t)) / __Bessel0(alpha);
+	float sinc = x == 0.0f ? 1.0f : std::sin(glm::pi<float>() * x) / (glm::pi<float>() * x);
+	return sinc * window;
+}
+
+// The contribution of a range of source texels to a single output texel
+struct FilterTap {
+	int                Start;
+	std::vector<float> Weights;
+};
+
+static void __BuildFilter(uint32_t srcSize, uint32_t dstSize, std::vector<FilterTap>& result) {
+	const float scale   = (float)srcSize / (float)dstSize;
+	const float support = 3.0f * scale;
+	result.resize(dstSize);
+	for (uint32_t ix = 0; ix < dstSize; ix++) {
+		float center = (ix + 0.5f) * scale;
+		int start = (int)std::floor(center - support);
+		int end   = (int)std::ceil(center + support);
+		FilterTap& tap = result[ix];
+		tap.Start = start;
+		tap.Weights.resize(end - start);
+		float total = 0.0f;
+		for (int s = start; s < end; s++) {
+			float weight = __KaiserSinc((s + 0.5f - center) / scale);
+			tap.Weights[s - start] = weight;
+			total += weight;
+		}
+		for (float& weight : tap.Weights) {
+			weight /= total;
+		}
+	}
+}
+
+static inline int __ResolveTexel(int ix, int size, bool wrap) {
+	if (wrap) {
+		return ((ix % size) + size) % size;
+	}
+	return std::clamp(ix, 0, size - 1);
+}
+
+#pragma endregion
+
+std::string TextureCompression::GetCompressedPath(const std::string& sourceFile, InternalFormat format) {
+	std::string suffix = ~format;
+	StringTools::ToLower(suffix);
+	fs::path path = fs::path(sourceFile);
+	path.replace_extension("." + suffix + ".dds");
+	return path.string();
+}
+
+bool TextureCompression::IsFormatSupported(InternalFormat format) {
+	switch (format) {
+		// RGTC and BPTC are core as of GL 4.2
+		case InternalFormat::BC4:
+		case InternalFormat::BC5:
+		case InternalFormat::BC7:
+			return true;
+		case InternalFormat::BC1:
+		case InternalFormat::BC3:
+		{
+			static int supported = -1;
+			if (supported == -1) {
+				supported = 0;
+				GLint numExtensions = 0;
+				glGetIntegerv(GL_NUM_EXTENSIONS, &numExtensions);
+				for (GLint ix = 0; ix < numExtensions; ix++) {
+					const char* name = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, ix));
+					if (name != nullptr && strcmp(name, "GL_EXT_texture_compression_s3tc") == 0) {
+						supported = 1;
+						break;
+					}
+				}
+			}
+			return supported == 1;
+		}
+		default:
+			return false;
+	}
+}
+
+size_t TextureCompression::GetLevelSize(InternalFormat format, uint32_t width, uint32_t height) {
+	size_t blocksX = (std::max(width, 1u) + 3) / 4;
+	size_t blocksY = (std::max(height, 1u) + 3) / 4;
+	return blocksX * blocksY * GetCompressedBlockSize(format);
+}
+
+void TextureCompression::Downsample(const uint8_t* src, uint32_t srcWidth, uint32_t srcHeight, uint32_t dstWidth, uint32_t dstHeight, bool wrap, std::vector<uint8_t>& dst) {
+	std::vector<FilterTap> horizontal, vertical;
+	__BuildFilter(srcWidth, dstWidth, horizontal);
+	__BuildFilter(srcHeight, dstHeight, vertical);
+
+	// Colors are weighted by alpha while filtering, so that fully transparent texels
+	// (which often have garbage colors) don't bleed into the visible ones
+	std::vector<float> temp((size_t)dstWidth * srcHeight * 4, 0.0f);
+	for (uint32_t y = 0; y < srcHeight; y++) {
+		const uint8_t* row = src + (size_t)y * srcWidth * 4;
+		for (uint32_t x = 0; x < dstWidth; x++) {
+			const FilterTap& tap = horizontal[x];
+			float* out = &temp[((size_t)y * dstWidth + x) * 4];
+			for (size_t t = 0; t < tap.Weights.size(); t++) {
+				const uint8_t* texel = row + __ResolveTexel(tap.Start + (int)t, srcWidth, wrap) * 4;
+				float alpha = texel[3] / 255.0f;
+				float weight = tap.Weights[t];
+				out[0] += texel[0] * alpha * weight;
+				out[1] += texel[1] * alpha * weight;
+				out[2] += texel[2] * alpha * weight;
+				out[3] += texel[3] * weight;
+			}
+		}
+	}
+
+	dst.resize((size_t)dstWidth * dstHeight * 4);
+	for (uint32_t y = 0; y < dstHeight; y++) {
+		const FilterTap& tap = vertical[y];
+		for (uint32_t x = 0; x < dstWidth; x++) {
+			float sum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+			for (size_t t = 0; t < tap.Weights.size(); t++) {
+				const float* texel = &temp[((size_t)__ResolveTexel(tap.Start + (int)t, srcHeight, wrap) * dstWidth + x) * 4];
+				for (int c = 0; c < 4; c++) {
+					sum[c] += texel[c] * tap.Weights[t];
+				}
+			}
+			float alpha = std::clamp(sum[3], 0.0f, 255.0f);
+			float unpremultiply = alpha > 0.0f ? 255.0f / alpha : 0.0f;
+			uint8_t* out = &dst[((size_t)y * dstWidth + x) * 4];
+			for (int c = 0; c < 3; c++) {
+				out[c] = (uint8_t)std::clamp(std::lround(sum[c] * unpremultiply), 0l, 255l);
+			}
+			out[3] = (uint8_t)std::lround(alpha);
+		}
+	}
+}
+
+void TextureCompression::_CompressLevel(const uint8_t* rgba, uint32_t width, uint32_t height, InternalFormat format, std::vector<uint8_t>& result) {
+	const uint32_t blocksX = (width + 3) / 4;
+	const uint32_t blocksY = (height + 3) / 4;
+	const size_t blockSize = GetCompressedBlockSize(format);
+	result.resize(GetLevelSize(format, width, height));
+
+	Block block;
+	for (uint32_t by = 0; by < blocksY; by++) {
+		for (uint32_t bx = 0; bx < blocksX; bx++) {
+			__FetchBlock(rgba, width, height, bx, by, block);
+			uint8_t* output = &result[((size_t)by * blocksX + bx) * blockSize];
+			switch (format) {
+				case InternalFormat::BC1:
+					__EncodeBC1(block, true, output);
+					break;
+				case InternalFormat::BC3:
+					__EncodeBC4(block, 3, output);
+					__EncodeBC1(block, false, output + 8);
+					break;
+				case InternalFormat::BC4:
+					__EncodeBC4(block, 0, output);
+					break;
+				case InternalFormat::BC5:
+					__EncodeBC4(block, 0, output);
+					__EncodeBC4(block, 1, output + 8);
+					break;
+				case InternalFormat::BC7:
+					__EncodeBC7(block, output);
+					break;
+				default:
+					break;
+			}
+		}
+	}
+}
+
+bool TextureCompression::Compress(const uint8_t* rgba, uint32_t width, uint32_t height, InternalFormat format, bool generateMips, bool wrap, CompressedImage& result) {
+	if (!IsCompressedFormat(format) || width == 0 || height == 0) {
+		LOG_WARN("Cannot compress a {}x{} image to {}", width, height, ~format);
+		return false;
+	}
+
+	result.Format = format;
+	result.Width  = width;
+	result.Height = height;
+	result.Levels.clear();
+
+	// Each level is filtered from the one above it
+	std::vector<uint8_t> current(rgba, rgba + (size_t)width * height * 4);
+	std::vector<uint8_t> next;
+	uint32_t levelWidth = width, levelHeight = height;
+	while (true) {
+		CompressedMipLevel level;
+		level.Width  = levelWidth;
+		level.Height = levelHeight;
+		_CompressLevel(current.data(), levelWidth, levelHeight, format, level.Data);
+		result.Levels.push_back(std::move(level));
+
+		if (!generateMips || (levelWidth == 1 && levelHeight == 1)) {
+			break;
+		}
+
+		uint32_t nextWidth  = std::max(levelWidth / 2, 1u);
+		uint32_t nextHeight = std::max(levelHeight / 2, 1u);
+		Downsample(current.data(), levelWidth, levelHeight, nextWidth, nextHeight, wrap, next);
+		current.swap(next);
+		levelWidth  = nextWidth;
+		levelHeight = nextHeight;
+	}
+
+	return true;
+}
+
+bool TextureCompression::ImportFile(const std::string& sourceFile, const std::string& outFile, InternalFormat format, bool generateMips, bool wrap, CompressedImage& result) {
+	float startTime = static_cast<float>(glfwGetTime());
+
+	int width, height, numChannels;
+	stbi_set_flip_vertically_on_load(true);
+	VfsFile::Sptr file = VirtualFileSystem::Open(sourceFile);
+	uint8_t* data = file == nullptr ? nullptr : stbi_load_from_memory(file->GetData(), (int)file->GetSize(), &width, &height, &numChannels, 4);
+	if (data == nullptr) {
+		LOG_WARN("STBI Failed to load image from \"{}\"", sourceFile);
+		return false;
+	}
+
+	bool success = Compress(data, width, height, format, generateMips, wrap, result);
+	stbi_image_free(data);
+
+	if (success) {
+		if (!SaveDDS(outFile, result)) {
+			LOG_WARN("Failed to write compressed texture \"{}\", it will be re-imported next time", outFile);
+		}
+
+		float endTime = static_cast<float>(glfwGetTime());
+		LOG_TRACE("Compressed \"{}\" to {} in {} seconds ({} mip levels)", sourceFile, ~format, endTime - startTime, result.Levels.size());
+	}
+
+	return success;
+}
+
+bool TextureCompression::SaveDDS(const std::string& filename, const CompressedImage& image) {
+	if (!IsCompressedFormat(image.Format) || image.Levels.empty()) {
+		return false;
+	}
+
+	std::ofstream file(filename, std::ios::binary);
+	if (!file) {
+		return false;
+	}
+
+	DDSHeader header;
+	memset(&header, 0, sizeof(DDSHeader));
+	header.Size              = sizeof(DDSHeader);
+	header.Flags             = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_MIPMAPCOUNT | DDSD_LINEARSIZE;
+	header.Height            = image.Height;
+	header.Width             = image.Width;
+	header.PitchOrLinearSize = (uint32_t)image.Levels[0].Data.size();
+	header.MipMapCount       = (uint32_t)image.Levels.size();
+	header.Reserved1[DDS_RESERVED_TAG_INDEX] = DDS_GL_ORIGIN_TAG;
+	header.PixelFormat.Size   = sizeof(DDSPixelFormat);
+	header.PixelFormat.Flags  = DDPF_FOURCC;
+	header.PixelFormat.FourCC = MakeFourCC('D', 'X', '1', '0');
+	header.Caps              = DDSCAPS_TEXTURE | (image.Levels.size() > 1 ? DDSCAPS_COMPLEX | DDSCAPS_MIPMAP : 0);
+
+	DDSHeaderDX10 dx10;
+	memset(&dx10, 0, sizeof(DDSHeaderDX10));
+	dx10.DxgiFormat        = __GetDxgiFormat(image.Format);
+	dx10.ResourceDimension = DDS_DIMENSION_TEXTURE2D;
+	dx10.ArraySize         = 1;
+
+	file.write(reinterpret_cast<const char*>(&DDS_MAGIC), sizeof(uint32_t));
+	file.write(reinterpret_cast<const char*>(&header), sizeof(DDSHeader));
+	file.write(reinterpret_cast<const char*>(&dx10), sizeof(DDSHeaderDX10));
+	for (const CompressedMipLevel& level : image.Levels) {
+		file.write(reinterpret_cast<const char*>(level.Data.data()), level.Data.size());
+	}
+
+	return file.good();
+}
+
+bool TextureCompression::LoadDDS(const std::string& filename, CompressedImage& result) {
+	// DDS files may be coming from a pack, so we read them through the VFS
+	VfsFile::Sptr file = VirtualFileSystem::Open(filename);
+	if (file == nullptr) {
+		LOG_WARN("Failed to open DDS file \"{}\"", filename);
+		return false;
+	}
+
+	// Copies the next chunk of the file into dest, returning false if we've run past the end
+	size_t seek = 0;
+	auto read = [&](void* dest, size_t size) {
+		if (seek + size > file->GetSize()) {
+			return false;
+		}
+		memcpy(dest, file->GetData() + seek, size);
+		seek += size;
+		return true;
+	};
+
+	uint32_t magic = 0;
+	DDSHeader header;
+	if (!read(&magic, sizeof(uint32_t)) || !read(&header, sizeof(DDSHeader)) || magic != DDS_MAGIC || header.Size != sizeof(DDSHeader)) {
+		LOG_WARN("\"{}\" is not a valid DDS file", filename);
+		return false;
+	}
+
+	InternalFormat format = InternalFormat::Unknown;
+	if ((header.PixelFormat.Flags & DDPF_FOURCC) && header.PixelFormat.FourCC == MakeFourCC('D', 'X', '1', '0')) {
+		DDSHeaderDX10 dx10;
+		if (!read(&dx10, sizeof(DDSHeaderDX10)) || dx10.ResourceDimension != DDS_DIMENSION_TEXTURE2D || dx10.ArraySize > 1) {
+			LOG_WARN("DDS file \"{}\" is not a single 2D texture", filename);
+			return false;
+		}
+		format = __FromDxgiFormat(dx10.DxgiFormat);
+	} else if (header.PixelFormat.Flags & DDPF_FOURCC) {
+		format = __FromFourCC(header.PixelFormat.FourCC);
+	}
+
+	if (format == InternalFormat::Unknown) {
+		LOG_WARN("DDS file \"{}\" uses an unsupported format, only BC1/BC3/BC4/BC5/BC7 are supported", filename);
+		return false;
+	}
+
+	result.Format = format;
+	result.Width  = header.Width;
+	result.Height = header.Height;
+	result.Levels.clear();
+
+	uint32_t numLevels = (header.Flags & DDSD_MIPMAPCOUNT) ? std::max(header.MipMapCount, 1u) : 1;
+	uint32_t width = header.Width, height = header.Height;
+	for (uint32_t ix = 0; ix < numLevels; ix++) {
+		CompressedMipLevel level;
+		level.Width  = width;
+		level.Height = height;
+		level.Data.resize(GetLevelSize(format, width, height));
+		if (!read(level.Data.data(), level.Data.size())) {
+			LOG_WARN("DDS file \"{}\" is truncated, expected {} mip levels", filename, numLevels);
+			return false;
+		}
+		result.Levels.push_back(std::move(level));
+
+		width  = std::max(width / 2, 1u);
+		height = std::max(height / 2, 1u);
+	}
+
+	// Files from other tools are stored top to bottom, so we need to flip them to match OpenGL
+	if (header.Reserved1[DDS_RESERVED_TAG_INDEX] != DDS_GL_ORIGIN_TAG) {
+		if (format == InternalFormat::BC7) {
+			LOG_WARN("DDS file \"{}\" was not written by our importer, BC7 blocks cannot be flipped so it will appear upside down", filename);
+		} else {
+			for (CompressedMipLevel& level : result.Levels) {
+				_FlipLevel(format, level);
+			}
+		}
+	}
+
+	return true;
+}
+
+void TextureCompression::_FlipLevel(InternalFormat format, CompressedMipLevel& level) {
+	const uint32_t blocksX = (level.Width + 3) / 4;
+	const uint32_t blocksY = (level.Height + 3) / 4;
+	const size_t blockSize = GetCompressedBlockSize(format);
+	const size_t rowSize   = blocksX * blockSize;
+
+	// Rows can only move between blocks in whole blocks, so a partially filled last row of blocks will be off slightly
+	if (blocksY > 1 && level.Height % 4 != 0) {
+		LOG_WARN("Flipping a compressed mip level with a height of {}, rows will be misaligned", level.Height);
+	}
+	const uint32_t numRows = blocksY == 1 ? std::min(level.Height, 4u) : 4u;
+
+	for (uint32_t y = 0; y < blocksY / 2; y++) {
+		std::swap_ranges(
+			level.Data.begin() + y * rowSize,
+			level.Data.begin() + (y + 1) * rowSize,
+			level.Data.begin() + (blocksY - 1 - y) * rowSize
+		);
+	}
+
+	for (size_t offset = 0; offset < level.Data.size(); offset += blockSize) {
+		uint8_t* block = &level.Data[offset];
+		switch (format) {
+			case InternalFormat::BC1:
+				__FlipBC1Block(block, numRows);
+				break;
+			case InternalFormat::BC3:
+				__FlipBC4Block(block, numRows);
+				__FlipBC1Block(block + 8, numRows);
+				break;
+			case InternalFormat::BC4:
+				__FlipBC4Block(block, numRows);
+				break;
+			case InternalFormat::BC5:
+				__FlipBC4Block(block, numRows);
+				__FlipBC4Block(block + 8, numRows);
+				break;
+			default:
+				break;
+		}
+	}
+}
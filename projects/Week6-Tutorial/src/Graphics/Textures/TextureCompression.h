@@ -0,0 +1,121 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "Graphics/GlEnums.h"
+
+/// <summary>
+/// Represents a single mip level of a block compressed image
+/// </summary>
+struct CompressedMipLevel {
+	uint32_t             Width;
+	uint32_t             Height;
+	std::vector<uint8_t> Data;
+};
+
+/// <summary>
+/// Represents a block compressed image with it's full mip chain, as it would be stored in a DDS file
+/// Rows are stored bottom to top, so that the data can be handed straight to OpenGL
+/// </summary>
+struct CompressedImage {
+	InternalFormat                  Format = InternalFormat::Unknown;
+	uint32_t                        Width  = 0;
+	uint32_t                        Height = 0;
+	std::vector<CompressedMipLevel> Levels;
+};
+
+/// <summary>
+/// Handles the offline import of textures into BC1/BC3/BC4/BC5/BC7 compressed DDS files,
+/// as well as loading those files back in
+///
+/// The encoders here favor speed over absolute quality, they use a principal axis fit
+/// for the endpoints of each block. BC7 only uses mode 6 (a single RGBA line with 4 bit indices)
+/// </summary>
+class TextureCompression {
+public:
+	/// <summary>
+	/// Bump this whenever the encoders or the DDS layout change, so that textures in the ImportCache are compressed again
+	/// </summary>
+	static constexpr uint32_t IMPORTER_VERSION = 1;
+
+	/// <summary>
+	/// Gets the path of the compressed file that will be generated for the given source image and format
+	/// ex: textures/box.png with BC7 will map to textures/box.bc7.dds
+	/// </summary>
+	/// <param name="sourceFile">The path to the source image</param>
+	/// <param name="format">The compressed format that we are targeting</param>
+	static std::string GetCompressedPath(const std::string& sourceFile, InternalFormat format);
+
+	/// <summary>
+	/// Returns true if the current OpenGL context can sample the given compressed format
+	/// </summary>
+	/// <param name="format">The format to check</param>
+	static bool IsFormatSupported(InternalFormat format);
+
+	/// <summary>
+	/// Compresses an image into the given block compressed format, optionally generating the
+	/// full mip chain before compression
+	/// </summary>
+	/// <param name="rgba">The RGBA8 source pixels, bottom row first</param>
+	/// <param name="width">The width of the source image in pixels</param>
+	/// <param name="height">The height of the source image in pixels</param>
+	/// <param name="format">The compressed format to encode to</param>
+	/// <param name="generateMips">True if mip levels should be generated down to 1x1</param>
+	/// <param name="wrap">True if the image tiles, used by the mip filter when sampling past the edges</param>
+	/// <param name="result">The image to store the result in</param>
+	/// <returns>True if the image was compressed, false if the format is not supported</returns>
+	static bool Compress(const uint8_t* rgba, uint32_t width, uint32_t height, InternalFormat format, bool generateMips, bool wrap, CompressedImage& result);
+
+	/// <summary>
+	/// Loads a source image from disk, compresses it and saves the result as a DDS file
+	/// </summary>
+	/// <param name="sourceFile">The path to the image to load (any format supported by stb_image)</param>
+	/// <param name="outFile">The path to the DDS file to write</param>
+	/// <param name="format">The compressed format to encode to</param>
+	/// <param name="generateMips">True if mip levels should be generated down to 1x1</param>
+	/// <param name="wrap">True if the image tiles, used by the mip filter when sampling past the edges</param>
+	/// <param name="result">The image to store the compressed result in, so it can be uploaded without re-reading the file</param>
+	/// <returns>True on success, false if the image could not be loaded or compressed</returns>
+	static bool ImportFile(const std::string& sourceFile, const std::string& outFile, InternalFormat format, bool generateMips, bool wrap, CompressedImage& result);
+
+	/// <summary>
+	/// Saves a compressed image to a DDS file with a DX10 header
+	/// </summary>
+	/// <param name="filename">The path to the file to write</param>
+	/// <param name="image">The image to save</param>
+	/// <returns>True if the file was written</returns>
+	static bool SaveDDS(const std::string& filename, const CompressedImage& image);
+	/// <summary>
+	/// Loads a DDS file containing BC1/BC3/BC4/BC5/BC7 data. Files that were not written by
+	/// SaveDDS are stored top to bottom, and will be flipped to match OpenGL's convention
+	/// </summary>
+	/// <param name="filename">The path to the file to load</param>
+	/// <param name="result">The image to store the result in</param>
+	/// <returns>True if the file was loaded</returns>
+	static bool LoadDDS(const std::string& filename, CompressedImage& result);
+
+	/// <summary>
+	/// Downsamples an RGBA8 image to the given size using a Kaiser windowed sinc filter
+	/// </summary>
+	/// <param name="src">The source pixels</param>
+	/// <param name="srcWidth">The width of the source image in pixels</param>
+	/// <param name="srcHeight">The height of the source image in pixels</param>
+	/// <param name="dstWidth">The width of the output image, should be less than or equal to srcWidth</param>
+	/// <param name="dstHeight">The height of the output image, should be less than or equal to srcHeight</param>
+	/// <param name="wrap">True if samples past the edges should wrap around, false to clamp</param>
+	/// <param name="dst">The vector to store the output pixels in</param>
+	static void Downsample(const uint8_t* src, uint32_t srcWidth, uint32_t srcHeight, uint32_t dstWidth, uint32_t dstHeight, bool wrap, std::vector<uint8_t>& dst);
+
+	/// <summary>
+	/// Gets the number of bytes required to store a mip level of the given size in a compressed format
+	/// </summary>
+	static size_t GetLevelSize(InternalFormat format, uint32_t width, uint32_t height);
+
+protected:
+	TextureCompression() = default;
+	~TextureCompression() = default;
+
+	static void _CompressLevel(const uint8_t* rgba, uint32_t width, uint32_t height, InternalFormat format, std::vector<uint8_t>& result);
+	static void _FlipLevel(InternalFormat format, CompressedMipLevel& level);
+};
@@ -1,6 +1,8 @@
 #include "TextureCube.h"
 #include <filesystem>
 #include "stb_image.h"
+#include "Utils/FileHelpers.h"
+#include "Utils/VirtualFileSystem.h"
 #include "Utils/JsonGlmHelpers.h"
 
 TextureCube::TextureCube(const std::string& baseFilename) :
@@ -82,7 +84,7 @@ void TextureCube::_LoadFromDescription()
 			targetPath += baseName.extension();
 
 			// If the file exists, store it in the description
-			if (std::filesystem::exists(targetPath)) {
+			if (FileHelpers::Exists(targetPath.string())) {
 				_description.FaceFileNames[face] = targetPath.string();
 			}
 		}
@@ -115,9 +117,10 @@ void TextureCube::_LoadImages(const std::unordered_map<CubeMapFace, std::string>
 		const std::string& filename = _description.FaceFileNames[face];
 		int fileWidth, fileHeight, fileNumChannels;
 
-		// Use STBI to load the image
+		// Use STBI to load the image, reading it through the VFS in case it's packed
 		stbi_set_flip_vertically_on_load(true);
-		uint8_t* data = stbi_load(filename.c_str(), &fileWidth, &fileHeight, &fileNumChannels, 0);
+		VfsFile::Sptr file = VirtualFileSystem::Open(filename);
+		uint8_t* data = file == nullptr ? nullptr : stbi_load_from_memory(file->GetData(), (int)file->GetSize(), &fileWidth, &fileHeight, &fileNumChannels, 0);
 
 		// If we could not load any data, warn and return null
 		if (data == nullptr) {
@@ -182,6 +185,7 @@ void TextureCube::_SetTextureParams(){
 	if (_description.Size > 0 && _description.Format != InternalFormat::Unknown) {
 		// Allocates the memory for our texture
 		glTextureStorage2D(_rendererId, 1, (GLenum)_description.Format, _description.Size, _description.Size);
+		_SetGpuMemoryUsage(GpuMemory::CalculateTextureSize((GLenum)_description.Format, _description.Size, _description.Size, 1, 1, 6));
 
 		// Set up our texture parameters
 		glTextureParameteri(_rendererId, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
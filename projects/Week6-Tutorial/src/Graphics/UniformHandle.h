@@ -0,0 +1,72 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+#include "Graphics/GlEnums.h"
+
+class ShaderProgram;
+
+/// <summary>
+/// Hashes a uniform name using 32 bit FNV-1a, can be evaluated at compile time
+/// </summary>
+/// <param name="name">The name of the uniform</param>
+/// <param name="length">The length of name, in characters</param>
+constexpr uint32_t HashUniformName(const char* name, size_t length) {
+	uint32_t hash = 2166136261u;
+	for (size_t ix = 0; ix < length; ix++) {
+		hash = (hash ^ static_cast<uint8_t>(name[ix])) * 16777619u;
+	}
+	return hash;
+}
+
+/// <summary>
+/// A uniform name paired with it's pre-computed hash. Usually created using the
+/// _uh literal, ex: "u_Strength"_uh, so that the hash is computed at compile time
+/// </summary>
+struct UniformName {
+	uint32_t    Hash;
+	const char* Name;
+
+	constexpr UniformName(uint32_t hash, const char* name) :
+		Hash(hash), Name(name) { }
+};
+
+/// <summary>
+/// Creates a uniform name with a compile time hash, ex: "u_Strength"_uh
+/// </summary>
+constexpr UniformName operator""_uh(const char* name, size_t length) {
+	return UniformName(HashUniformName(name, length), name);
+}
+
+/// <summary>
+/// A uniform that has been looked up in a shader program ahead of time, so that it
+/// can be set without any string handling. Handles are resolved against the shader's
+/// introspection data, and are re-resolved automatically if the shader is reloaded
+/// </summary>
+struct UniformHandle {
+	// The hash of the uniform's name, used to re-resolve the handle
+	uint32_t             NameHash;
+	// The location of the uniform, or -1 if the uniform does not exist
+	int                  Location;
+	// The type of the uniform, as reported by the shader
+	ShaderDataType       Type;
+	// The number of elements in the uniform, for arrays
+	int                  ArraySize;
+	// The program and program revision that this handle was resolved against
+	const ShaderProgram* Owner;
+	uint32_t             Revision;
+
+	UniformHandle() :
+		NameHash(0),
+		Location(-1),
+		Type(ShaderDataType::None),
+		ArraySize(0),
+		Owner(nullptr),
+		Revision(0) { }
+
+	/// <summary>
+	/// Returns true if the handle points to a uniform that exists in the shader
+	/// </summary>
+	bool IsValid() const { return Location != -1; }
+};
@@ -119,6 +119,10 @@ public:
 	/// <param name="usage">The attribute usage hint to search for</param>
 	/// <returns>A const pointer to the binding, or nullptr if none is found</returns>
 	VertexBufferBinding* GetBufferBinding(AttribUsage usage);
+	/// <summary>
+	/// Gets all the vertex buffers that are bound to this VAO
+	/// </summary>
+	const std::vector<VertexBufferBinding*>& GetVertexBuffers() const { return _vertexBuffers; }
 
 	/// <summary>
 	/// Renders this VAO, using the specified draw mode
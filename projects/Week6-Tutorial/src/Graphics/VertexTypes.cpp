@@ -1,4 +1,6 @@
 #include "VertexTypes.h"
+
+#include <GLM/gtc/packing.hpp>
 #pragma warning( push )
 
 VertexPosCol* VPC = nullptr;
@@ -7,6 +9,7 @@ VertexPosNormCol* VPNC = nullptr;
 VertexPosNormTex* VPNT = nullptr;
 VertexPosNormTexCol* VPNTC = nullptr;
 VertexPosNormTexColTangents* VPNTCT = nullptr;
+VertexPosNormTexColTangentsPacked* VPNTCTP = nullptr;
 
 const std::vector<BufferAttribute> VertexPosCol::V_DECL = {
 	BufferAttribute(0, 3, AttributeType::Float, sizeof(VertexPosCol), (size_t)&VPC->Position, AttribUsage::Position),
@@ -41,4 +44,27 @@ const std::vector<BufferAttribute> VertexPosNormTexColTangents::V_DECL ={
 	BufferAttribute(4, 3, AttributeType::Float, sizeof(VertexPosNormTexColTangents), (size_t)&VPNTCT->Tangent, AttribUsage::Tangent),
 	BufferAttribute(5, 3, AttributeType::Float, sizeof(VertexPosNormTexColTangents), (size_t)&VPNTCT->BiTangent, AttribUsage::BiTangent)
 };
-#pragma warning(pop)
\ No newline at end of file
+const std::vector<BufferAttribute> VertexPosNormTexColTangentsPacked::V_DECL ={
+	BufferAttribute(0, 3, AttributeType::Float, sizeof(VertexPosNormTexColTangentsPacked), (size_t)&VPNTCTP->Position, AttribUsage::Position),
+	BufferAttribute(1, 4, AttributeType::UByte, sizeof(VertexPosNormTexColTangentsPacked), (size_t)&VPNTCTP->Color, AttribUsage::Color, true),
+	BufferAttribute(2, 4, AttributeType::Int2101010, sizeof(VertexPosNormTexColTangentsPacked), (size_t)&VPNTCTP->Normal, AttribUsage::Normal, true),
+	BufferAttribute(3, 2, AttributeType::HalfFloat, sizeof(VertexPosNormTexColTangentsPacked), (size_t)&VPNTCTP->UV, AttribUsage::Texture),
+	BufferAttribute(4, 4, AttributeType::Int2101010, sizeof(VertexPosNormTexColTangentsPacked), (size_t)&VPNTCTP->Tangent, AttribUsage::Tangent, true),
+	BufferAttribute(5, 4, AttributeType::Int2101010, sizeof(VertexPosNormTexColTangentsPacked), (size_t)&VPNTCTP->BiTangent, AttribUsage::BiTangent, true)
+};
+#pragma warning(pop)
+
+// Zero length directions are left as zero rather than normalized into NaNs
+static glm::vec3 __SafeNormalize(const glm::vec3& value) {
+	float length = glm::length(value);
+	return length > 0.0f ? value / length : glm::vec3(0.0f);
+}
+
+VertexPosNormTexColTangentsPacked::VertexPosNormTexColTangentsPacked(const VertexPosNormTexColTangents& vertex) :
+	Position(vertex.Position),
+	Normal(glm::packSnorm3x10_1x2(glm::vec4(__SafeNormalize(vertex.Normal), 0.0f))),
+	UV(glm::packHalf2x16(vertex.UV)),
+	Color(glm::packUnorm4x8(vertex.Color)),
+	Tangent(glm::packSnorm3x10_1x2(glm::vec4(__SafeNormalize(vertex.Tangent), 0.0f))),
+	BiTangent(glm::packSnorm3x10_1x2(glm::vec4(__SafeNormalize(vertex.BiTangent), 0.0f)))
+{ }
@@ -115,5 +115,33 @@ struct VertexPosNormTexColTangents {
 		BiTangent(glm::vec3(0.0f)) 
 	{}
 
+	static const std::vector<BufferAttribute> V_DECL;
+};
+
+/// <summary>
+/// A compact version of VertexPosNormTexColTangents for meshes that have been through the import pipeline
+/// (see MeshOptimizer), at 32 bytes instead of 72. Positions are kept as full floats, since the physics
+/// system reads them back from the vertex buffer. The directions are packed as signed normalized 10:10:10:2,
+/// UVs as half floats and the color as 8 bit normalized, so the GPU unpacks all of them on fetch and shaders
+/// see the same inputs as they would with the full vertex
+/// </summary>
+struct VertexPosNormTexColTangentsPacked {
+	glm::vec3 Position;
+	uint32_t  Normal;
+	uint32_t  UV;
+	uint32_t  Color;
+	uint32_t  Tangent;
+	uint32_t  BiTangent;
+
+	VertexPosNormTexColTangentsPacked() :
+		Position(glm::vec3(0.0f)),
+		Normal(0),
+		UV(0),
+		Color(0),
+		Tangent(0),
+		BiTangent(0)
+	{}
+	explicit VertexPosNormTexColTangentsPacked(const VertexPosNormTexColTangents& vertex);
+
 	static const std::vector<BufferAttribute> V_DECL;
 };
\ No newline at end of file
@@ -0,0 +1,169 @@
+#include "Utils/BlobStore.h"
+
+#include <fstream>
+#include <filesystem>
+#include <cstring>
+
+#include <zlib.h>
+#include <Logging.h>
+
+namespace fs = std::filesystem;
+
+std::string BlobStore::_directory = "blobs";
+
+/// <summary>
+/// 64 bit FNV-1a hash, used to generate the content addressed ID of a blob
+/// </summary>
+inline uint64_t HashBlob(const uint8_t* data, size_t size) {
+	uint64_t hash = 0xcbf29ce484222325ull;
+	for (size_t ix = 0; ix < size; ix++) {
+		hash ^= data[ix];
+		hash *= 0x100000001b3ull;
+	}
+	return hash;
+}
+
+void BlobStore::SetDirectory(const std::string& directory) {
+	_directory = directory;
+}
+
+const std::string& BlobStore::GetDirectory() {
+	return _directory;
+}
+
+std::string BlobStore::GetPath(const std::string& id) {
+	return (fs::path(_directory) / (id + ".blob")).string();
+}
+
+std::string BlobStore::Write(const void* data, size_t size, BlobCompression compression) {
+	const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+
+	// The size is part of the ID to make collisions between different sized payloads impossible
+	char id[40];
+	snprintf(id, sizeof(id), "%016llx-%llx", (unsigned long long)HashBlob(bytes, size), (unsigned long long)size);
+	std::string result = id;
+
+	// We've already stored this data, nothing to do
+	std::string path = GetPath(result);
+	if (fs::exists(path)) {
+		return result;
+	}
+
+	return _WriteFile(path, data, size, compression) ? result : "";
+}
+
+bool BlobStore::WriteAs(const std::string& id, const void* data, size_t size, BlobCompression compression) {
+	return _WriteFile(GetPath(id), data, size, compression);
+}
+
+bool BlobStore::_WriteFile(const std::string& path, const void* data, size_t size, BlobCompression compression) {
+	const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+
+	BlobHeader header = BlobHeader();
+	header.Size = size;
+
+	std::vector<uint8_t> compressed;
+	const uint8_t* payload = bytes;
+	header.StoredSize = size;
+
+	if (compression == BlobCompression::Zlib && size > 0) {
+		uLongf compressedSize = compressBound((uLong)size);
+		compressed.resize(compressedSize);
+		if (compress2(compressed.data(), &compressedSize, bytes, (uLong)size, Z_BEST_SPEED) == Z_OK && compressedSize < size) {
+			header.Compression = BlobCompression::Zlib;
+			header.StoredSize  = compressedSize;
+			payload = compressed.data();
+		}
+	}
+
+	std::error_code error;
+	fs::create_directories(_directory, error);
+
+	// Write to a temporary file first, so that a partially written blob is never picked up by a reader
+	std::string tempPath = path + ".tmp";
+	{
+		std::ofstream file(tempPath, std::ios::binary);
+		if (!file) {
+			LOG_WARN("Failed to open blob file \"{}\" for writing", tempPath);
+			return false;
+		}
+		file.write(reinterpret_cast<const char*>(&header), sizeof(BlobHeader));
+		file.write(reinterpret_cast<const char*>(payload), header.StoredSize);
+		if (!file) {
+			LOG_WARN("Failed to write blob file \"{}\"", tempPath);
+			return false;
+		}
+	}
+	fs::rename(tempPath, path, error);
+	if (error) {
+		LOG_WARN("Failed to move blob file into place \"{}\": {}", path, error.message());
+		fs::remove(tempPath, error);
+		return false;
+	}
+
+	return true;
+}
+
+bool BlobStore::_ReadHeader(std::ifstream& file, BlobHeader& header) {
+	file.read(reinterpret_cast<char*>(&header), sizeof(BlobHeader));
+	return file && memcmp(header.HeaderBytes, "BLOB", 4) == 0 && header.Version == 1;
+}
+
+size_t BlobStore::GetSize(const std::string& id) {
+	std::ifstream file(GetPath(id), std::ios::binary);
+	BlobHeader header;
+	if (!file || !_ReadHeader(file, header)) {
+		return 0;
+	}
+	return header.Size;
+}
+
+bool BlobStore::Read(const std::string& id, void* buffer, size_t bufferSize) {
+	std::string path = GetPath(id);
+	std::ifstream file(path, std::ios::binary);
+	if (!file) {
+		LOG_WARN("Blob \"{}\" does not exist", path);
+		return false;
+	}
+
+	BlobHeader header;
+	if (!_ReadHeader(file, header)) {
+		LOG_WARN("\"{}\" is not a valid blob file", path);
+		return false;
+	}
+	if (header.Size > bufferSize) {
+		LOG_WARN("Blob \"{}\" is {} bytes, but the buffer is only {} bytes", path, header.Size, bufferSize);
+		return false;
+	}
+
+	switch (header.Compression) {
+		// Raw blobs are read straight into the destination
+		case BlobCompression::Raw:
+			file.read(reinterpret_cast<char*>(buffer), header.Size);
+			if (!file) {
+				LOG_WARN("Blob \"{}\" is truncated", path);
+				return false;
+			}
+			return true;
+		case BlobCompression::Zlib:
+		{
+			std::vector<uint8_t> compressed(header.StoredSize);
+			file.read(reinterpret_cast<char*>(compressed.data()), header.StoredSize);
+			uLongf size = (uLongf)header.Size;
+			if (!file || uncompress(reinterpret_cast<Bytef*>(buffer), &size, compressed.data(), (uLong)header.StoredSize) != Z_OK || size != header.Size) {
+				LOG_WARN("Blob \"{}\" is corrupt", path);
+				return false;
+			}
+			return true;
+		}
+		default:
+			LOG_WARN("Blob \"{}\" has an unknown compression mode", path);
+			return false;
+	}
+}
+
+bool BlobStore::Read(const std::string& id, std::vector<uint8_t>& result) {
+	size_t size = GetSize(id);
+	result.resize(size);
+	return Read(id, result.data(), result.size());
+}
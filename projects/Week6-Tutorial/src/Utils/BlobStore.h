@@ -0,0 +1,101 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <iosfwd>
+
+#include <EnumToString.h>
+
+/// <summary>
+/// How the contents of a blob are stored on disk
+/// </summary>
+ENUM(BlobCompression, uint8_t,
+	Raw  = 0,
+	Zlib = 1
+)
+
+/// <summary>
+/// Stores large binary payloads (ex: the pixels of generated textures) in sidecar files next to
+/// our JSON manifests, so that the JSON only needs to store a reference to the data
+///
+/// Blobs are content addressed, the ID of a blob is the hash of it's contents, so writing the
+/// same data twice will only store it once
+/// </summary>
+class BlobStore {
+public:
+	BlobStore() = delete;
+
+	/// <summary>
+	/// Sets the directory that blobs will be written to and read from, relative to the working
+	/// directory. Default is "blobs"
+	/// </summary>
+	static void SetDirectory(const std::string& directory);
+	/// <summary>
+	/// Gets the directory that blobs will be written to and read from
+	/// </summary>
+	static const std::string& GetDirectory();
+
+	/// <summary>
+	/// Writes a blob to the store, if a blob with the same contents does not already exist
+	/// </summary>
+	/// <param name="data">The data to store</param>
+	/// <param name="size">The size of the data, in bytes</param>
+	/// <param name="compression">How to store the data on disk. If zlib does not shrink the data, it will be stored raw</param>
+	/// <returns>The ID of the blob, or an empty string if the blob could not be written</returns>
+	static std::string Write(const void* data, size_t size, BlobCompression compression = BlobCompression::Zlib);
+	/// <summary>
+	/// Writes a blob to the store under an ID chosen by the caller, replacing any existing blob with that ID.
+	/// This is for data that needs to be referenced before it's contents are available (ex: async GPU
+	/// readbacks), so the caller is responsible for making the ID unique
+	/// </summary>
+	/// <param name="id">The ID to store the blob under, must be a valid file name</param>
+	/// <param name="data">The data to store</param>
+	/// <param name="size">The size of the data, in bytes</param>
+	/// <param name="compression">How to store the data on disk. If zlib does not shrink the data, it will be stored raw</param>
+	/// <returns>True if the blob was written, false if otherwise</returns>
+	static bool WriteAs(const std::string& id, const void* data, size_t size, BlobCompression compression = BlobCompression::Zlib);
+
+	/// <summary>
+	/// Gets the uncompressed size of a blob in bytes, or 0 if the blob does not exist
+	/// </summary>
+	/// <param name="id">The ID of the blob, as returned by Write</param>
+	static size_t GetSize(const std::string& id);
+
+	/// <summary>
+	/// Reads a blob directly into the given buffer, which must be at least GetSize(id) bytes
+	/// </summary>
+	/// <param name="id">The ID of the blob, as returned by Write</param>
+	/// <param name="buffer">The buffer to read the contents into</param>
+	/// <param name="bufferSize">The size of the buffer in bytes</param>
+	/// <returns>True if the blob was read, false if it is missing, corrupt or too large for the buffer</returns>
+	static bool Read(const std::string& id, void* buffer, size_t bufferSize);
+	/// <summary>
+	/// Reads a blob into a vector, resizing it to fit the blob's contents
+	/// </summary>
+	/// <param name="id">The ID of the blob, as returned by Write</param>
+	/// <param name="result">The vector to read the contents into</param>
+	/// <returns>True if the blob was read, false if it is missing or corrupt</returns>
+	static bool Read(const std::string& id, std::vector<uint8_t>& result);
+
+	/// <summary>
+	/// Gets the path to the file that stores the blob with the given ID
+	/// </summary>
+	static std::string GetPath(const std::string& id);
+
+private:
+	// Will be put at the start of each blob file
+	struct BlobHeader {
+		char            HeaderBytes[4] = { 'B', 'L', 'O', 'B' };
+		uint16_t        Version        = 1;
+		BlobCompression Compression    = BlobCompression::Raw;
+		uint8_t         Reserved       = 0;
+		uint64_t        Size           = 0;
+		uint64_t        StoredSize     = 0;
+	};
+
+	static std::string _directory;
+
+	static bool _ReadHeader(std::ifstream& file, BlobHeader& header);
+	static bool _WriteFile(const std::string& path, const void* data, size_t size, BlobCompression compression);
+};
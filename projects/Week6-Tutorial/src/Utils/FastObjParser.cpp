@@ -0,0 +1,360 @@
+#include "Utils/FastObjParser.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "Utils/VirtualFileSystem.h"
+#include "Utils/MeshFactory.h"
+#include "Logging.h"
+
+// Chunks smaller than this aren't worth the cost of spinning up a thread for
+static constexpr size_t MIN_CHUNK_SIZE = 1024 * 1024;
+// Marks a face corner that doesn't reference a UV or normal
+static constexpr int32_t MISSING_INDEX = INT32_MIN;
+
+/// <summary>
+/// A single corner of a face, as 0 based indices into the position, UV and normal lists
+/// </summary>
+struct ObjCorner {
+	int32_t Index[3];
+	// Bit N is set if Index[N] came from a negative reference, and is relative to the start of the chunk
+	uint8_t Relative;
+};
+
+/// <summary>
+/// The attributes and triangulated faces parsed from a single chunk of the file
+/// </summary>
+struct ObjChunk {
+	const char*            Begin;
+	const char*            End;
+	std::vector<glm::vec3> Positions;
+	std::vector<glm::vec2> Uvs;
+	std::vector<glm::vec3> Normals;
+	// 3 per triangle
+	std::vector<ObjCorner> Corners;
+	// The corner index at which each usemtl command took effect, and the material it switched to
+	std::vector<std::pair<size_t, std::string>> MaterialChanges;
+};
+
+static inline const char* __SkipSpaces(const char* ptr, const char* end) {
+	while (ptr < end && (*ptr == ' ' || *ptr == '\t')) { ptr++; }
+	return ptr;
+}
+
+static inline const char* __ParseFloat(const char* ptr, const char* end, float& result) {
+	ptr = __SkipSpaces(ptr, end);
+	// from_chars doesn't accept a leading plus, but some exporters write one
+	if (ptr < end && *ptr == '+') { ptr++; }
+	std::from_chars_result parsed = std::from_chars(ptr, end, result);
+	if (parsed.ec != std::errc()) {
+		result = 0.0f;
+	}
+	return parsed.ptr;
+}
+
+/// <summary>
+/// Parses a 1 based (or negative, relative) OBJ index into a 0 based one, flagging relative indices
+/// </summary>
+static inline const char* __ParseIndex(const char* ptr, const char* end, int32_t count, int32_t& result, uint8_t& relative, uint8_t bit) {
+	int32_t value = 0;
+	std::from_chars_result parsed = std::from_chars(ptr, end, value);
+	if (parsed.ec != std::errc() || value == 0) {
+		result = MISSING_INDEX;
+	} else if (value < 0) {
+		// Relative to the attributes that came before this line, which may be in another chunk
+		result = count + value;
+		relative |= bit;
+	} else {
+		result = value - 1;
+	}
+	return parsed.ptr;
+}
+
+static void __ParseChunk(ObjChunk& chunk) {
+	const char* ptr = chunk.Begin;
+	const char* end = chunk.End;
+
+	// Faces are rarely more than quads, so this almost never needs to grow
+	std::vector<ObjCorner> face;
+	face.reserve(8);
+
+	while (ptr < end) {
+		const char* lineEnd = static_cast<const char*>(memchr(ptr, '\n', end - ptr));
+		if (lineEnd == nullptr) {
+			lineEnd = end;
+		}
+		ptr = __SkipSpaces(ptr, lineEnd);
+
+		if (lineEnd - ptr >= 2 && ptr[0] == 'v') {
+			// Positions may have a 4th component, and some exporters add vertex colors, we skip those
+			if (ptr[1] == ' ' || ptr[1] == '\t') {
+				glm::vec3 position;
+				ptr = __ParseFloat(ptr + 2, lineEnd, position.x);
+				ptr = __ParseFloat(ptr, lineEnd, position.y);
+				ptr = __ParseFloat(ptr, lineEnd, position.z);
+				chunk.Positions.push_back(position);
+			} else if (ptr[1] == 't') {
+				glm::vec2 uv;
+				ptr = __ParseFloat(ptr + 2, lineEnd, uv.x);
+				ptr = __ParseFloat(ptr, lineEnd, uv.y);
+				chunk.Uvs.push_back(uv);
+			} else if (ptr[1] == 'n') {
+				glm::vec3 normal;
+				ptr = __ParseFloat(ptr + 2, lineEnd, normal.x);
+				ptr = __ParseFloat(ptr, lineEnd, normal.y);
+				ptr = __ParseFloat(ptr, lineEnd, normal.z);
+				chunk.Normals.push_back(normal);
+			}
+		}
+		else if (lineEnd - ptr > 7 && memcmp(ptr, "usemtl", 6) == 0 && (ptr[6] == ' ' || ptr[6] == '\t')) {
+			const char* name = __SkipSpaces(ptr + 7, lineEnd);
+			const char* nameEnd = lineEnd;
+			while (nameEnd > name && (nameEnd[-1] == '\r' || nameEnd[-1] == ' ' || nameEnd[-1] == '\t')) { nameEnd--; }
+			chunk.MaterialChanges.emplace_back(chunk.Corners.size(), std::string(name, nameEnd));
+		}
+		else if (lineEnd - ptr >= 2 && ptr[0] == 'f' && (ptr[1] == ' ' || ptr[1] == '\t')) {
+			face.clear();
+			ptr += 2;
+			while (true) {
+				ptr = __SkipSpaces(ptr, lineEnd);
+				if (ptr >= lineEnd || *ptr == '\r' || *ptr == '#') {
+					break;
+				}
+
+				// Corners are v, v/vt, v//vn or v/vt/vn
+				ObjCorner corner = { { MISSING_INDEX, MISSING_INDEX, MISSING_INDEX }, 0 };
+				const char* start = ptr;
+				ptr = __ParseIndex(ptr, lineEnd, (int32_t)chunk.Positions.size(), corner.Index[0], corner.Relative, 1);
+				if (ptr < lineEnd && *ptr == '/') {
+					ptr++;
+					if (ptr < lineEnd && *ptr != '/') {
+						ptr = __ParseIndex(ptr, lineEnd, (int32_t)chunk.Uvs.size(), corner.Index[1], corner.Relative, 2);
+					}
+					if (ptr < lineEnd && *ptr == '/') {
+						ptr = __ParseIndex(ptr + 1, lineEnd, (int32_t)chunk.Normals.size(), corner.Index[2], corner.Relative, 4);
+					}
+				}
+				// Skip anything we didn't understand, so that we can't get stuck on it
+				if (ptr == start) {
+					while (ptr < lineEnd && *ptr != ' ' && *ptr != '\t') { ptr++; }
+					continue;
+				}
+				if (corner.Index[0] != MISSING_INDEX) {
+					face.push_back(corner);
+				}
+			}
+
+			// Triangulate the polygon as a fan around it's first corner
+			for (size_t ix = 2; ix < face.size(); ix++) {
+				chunk.Corners.push_back(face[0]);
+				chunk.Corners.push_back(face[ix - 1]);
+				chunk.Corners.push_back(face[ix]);
+			}
+		}
+
+		ptr = lineEnd + 1;
+	}
+}
+
+static inline uint64_t __HashCorner(const ObjCorner& corner) {
+	uint64_t hash = (uint64_t)(uint32_t)corner.Index[0] * 0x9E3779B97F4A7C15ull;
+	hash ^= (uint64_t)(uint32_t)corner.Index[1] * 0xC2B2AE3D27D4EB4Full;
+	hash ^= (uint64_t)(uint32_t)corner.Index[2] * 0x165667B19E3779F9ull;
+	return hash ^ (hash >> 29);
+}
+
+MeshBuilder<VertexPosNormTexColTangents>* FastObjParser::LoadFromFile(const std::string& filename, uint32_t threadCount, std::vector<ObjMaterialRange>* materials) {
+	VfsFile::Sptr file = VirtualFileSystem::Open(filename);
+	if (file == nullptr) {
+		throw std::runtime_error("Failed to open file");
+	}
+	return Parse(reinterpret_cast<const char*>(file->GetData()), file->GetSize(), threadCount, true, materials);
+}
+
+MeshBuilder<VertexPosNormTexColTangents>* FastObjParser::Parse(const char* data, size_t size, uint32_t threadCount, bool calcTangents, std::vector<ObjMaterialRange>* materials) {
+	// Figure out how many chunks to split into, and make sure each one starts at the beginning of a line
+	if (threadCount == 0) {
+		threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+	}
+	size_t chunkCount = std::max<size_t>(std::min<size_t>(threadCount, size / MIN_CHUNK_SIZE), 1);
+	std::vector<ObjChunk> chunks(chunkCount);
+	const char* end = data + size;
+	const char* cursor = data;
+	for (size_t ix = 0; ix < chunkCount; ix++) {
+		const char* chunkEnd = ix + 1 == chunkCount ? end : std::max(cursor, data + size * (ix + 1) / chunkCount);
+		if (chunkEnd < end) {
+			const char* newline = static_cast<const char*>(memchr(chunkEnd, '\n', end - chunkEnd));
+			chunkEnd = newline != nullptr ? newline + 1 : end;
+		}
+		chunks[ix].Begin = cursor;
+		chunks[ix].End = chunkEnd;
+		cursor = chunkEnd;
+	}
+
+	// The calling thread takes the first chunk while the workers handle the rest
+	std::vector<std::thread> workers;
+	workers.reserve(chunkCount - 1);
+	for (size_t ix = 1; ix < chunkCount; ix++) {
+		workers.emplace_back(__ParseChunk, std::ref(chunks[ix]));
+	}
+	__ParseChunk(chunks[0]);
+	for (auto& worker : workers) {
+		worker.join();
+	}
+
+	// Stitch the attribute lists together, each chunk's indices are offset by the attributes in the chunks before it
+	std::vector<glm::vec3> positions;
+	std::vector<glm::vec2> uvs;
+	std::vector<glm::vec3> normals;
+	size_t cornerCount = 0;
+	{
+		size_t positionCount = 0, uvCount = 0, normalCount = 0;
+		for (const auto& chunk : chunks) {
+			positionCount += chunk.Positions.size();
+			uvCount += chunk.Uvs.size();
+			normalCount += chunk.Normals.size();
+			cornerCount += chunk.Corners.size();
+		}
+		positions.reserve(positionCount);
+		uvs.reserve(uvCount);
+		normals.reserve(normalCount);
+	}
+
+	std::vector<ObjCorner> corners;
+	corners.reserve(cornerCount);
+	std::vector<std::pair<size_t, std::string>> materialChanges;
+	for (auto& chunk : chunks) {
+		const int32_t offsets[3] = { (int32_t)positions.size(), (int32_t)uvs.size(), (int32_t)normals.size() };
+		for (auto& change : chunk.MaterialChanges) {
+			materialChanges.emplace_back(change.first + corners.size(), std::move(change.second));
+		}
+		for (ObjCorner corner : chunk.Corners) {
+			for (int ix = 0; ix < 3; ix++) {
+				if (corner.Relative & (1 << ix)) {
+					corner.Index[ix] += offsets[ix];
+				}
+			}
+			corners.push_back(corner);
+		}
+		positions.insert(positions.end(), chunk.Positions.begin(), chunk.Positions.end());
+		uvs.insert(uvs.end(), chunk.Uvs.begin(), chunk.Uvs.end());
+		normals.insert(normals.end(), chunk.Normals.begin(), chunk.Normals.end());
+
+		// Free up the chunk's memory as we go, large files can have a lot of it
+		chunk = ObjChunk();
+	}
+
+	// Weld corners that share all their attributes into a single vertex. The table stores indices into
+	// uniqueCorners, and is kept at most half full so probe sequences stay short
+	std::vector<ObjCorner> uniqueCorners;
+	uniqueCorners.reserve(positions.size());
+	size_t capacity = 64;
+	while (capacity < positions.size() * 2) { capacity *= 2; }
+	std::vector<uint32_t> table(capacity, UINT32_MAX);
+
+	std::vector<uint32_t> indices;
+	indices.reserve(corners.size());
+	size_t invalidTriangles = 0;
+
+	// Triangles before the first usemtl don't have a material
+	std::vector<ObjMaterialRange> ranges;
+	ranges.push_back({ "", 0, 0 });
+	size_t nextChange = 0;
+
+	for (size_t ix = 0; ix + 2 < corners.size(); ix += 3) {
+		// Start a new range if the material changes here, we count from the triangles that were actually added
+		while (nextChange < materialChanges.size() && materialChanges[nextChange].first <= ix) {
+			uint32_t triangle = static_cast<uint32_t>(indices.size() / 3);
+			if (ranges.back().TriangleCount == 0) {
+				ranges.back().Material = materialChanges[nextChange].second;
+			} else if (ranges.back().Material != materialChanges[nextChange].second) {
+				ranges.push_back({ materialChanges[nextChange].second, triangle, 0 });
+			}
+			nextChange++;
+		}
+
+		// Make sure the whole triangle is in range before we add any of it
+		bool valid = true;
+		for (size_t jx = ix; jx < ix + 3; jx++) {
+			ObjCorner& corner = corners[jx];
+			valid &= corner.Index[0] >= 0 && corner.Index[0] < (int32_t)positions.size();
+			if (corner.Index[1] < 0 || corner.Index[1] >= (int32_t)uvs.size())     { corner.Index[1] = MISSING_INDEX; }
+			if (corner.Index[2] < 0 || corner.Index[2] >= (int32_t)normals.size()) { corner.Index[2] = MISSING_INDEX; }
+			// The flags have done their job, clear them so they don't affect the comparisons
+			corner.Relative = 0;
+		}
+		if (!valid) {
+			invalidTriangles++;
+			continue;
+		}
+
+		ranges.back().TriangleCount++;
+		for (size_t jx = ix; jx < ix + 3; jx++) {
+			const ObjCorner& corner = corners[jx];
+
+			if ((uniqueCorners.size() + 1) * 2 > capacity) {
+				capacity *= 2;
+				table.assign(capacity, UINT32_MAX);
+				for (uint32_t kx = 0; kx < (uint32_t)uniqueCorners.size(); kx++) {
+					size_t slot = __HashCorner(uniqueCorners[kx]) & (capacity - 1);
+					while (table[slot] != UINT32_MAX) { slot = (slot + 1) & (capacity - 1); }
+					table[slot] = kx;
+				}
+			}
+
+			size_t slot = __HashCorner(corner) & (capacity - 1);
+			while (true) {
+				uint32_t existing = table[slot];
+				if (existing == UINT32_MAX) {
+					existing = static_cast<uint32_t>(uniqueCorners.size());
+					uniqueCorners.push_back(corner);
+					table[slot] = existing;
+					indices.push_back(existing);
+					break;
+				}
+				const ObjCorner& other = uniqueCorners[existing];
+				if (other.Index[0] == corner.Index[0] && other.Index[1] == corner.Index[1] && other.Index[2] == corner.Index[2]) {
+					indices.push_back(existing);
+					break;
+				}
+				slot = (slot + 1) & (capacity - 1);
+			}
+		}
+	}
+	if (invalidTriangles > 0) {
+		LOG_WARN("Skipped {} triangles with out of range positions while parsing OBJ", invalidTriangles);
+	}
+	if (materials != nullptr) {
+		materials->clear();
+		for (auto& range : ranges) {
+			if (range.TriangleCount > 0) {
+				materials->push_back(std::move(range));
+			}
+		}
+	}
+
+	MeshBuilder<VertexPosNormTexColTangents>* mesh = new MeshBuilder<VertexPosNormTexColTangents>();
+	mesh->ReserveVertexSpace(uniqueCorners.size());
+	for (const ObjCorner& corner : uniqueCorners) {
+		VertexPosNormTexColTangents vertex;
+		vertex.Position = positions[corner.Index[0]];
+		vertex.UV       = corner.Index[1] != MISSING_INDEX ? uvs[corner.Index[1]] : glm::vec2(0.0f);
+		vertex.Normal   = corner.Index[2] != MISSING_INDEX ? normals[corner.Index[2]] : glm::vec3(0.0f, 0.0f, 1.0f);
+		vertex.Color    = glm::vec4(1.0f);
+		mesh->AddVertex(vertex);
+	}
+	mesh->ReserveIndexSpace(indices.size());
+	for (uint32_t index : indices) {
+		mesh->AddIndex(index);
+	}
+
+	if (calcTangents) {
+		MeshFactory::CalculateTBN(*mesh);
+	}
+
+	return mesh;
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "Graphics/VertexTypes.h"
+#include "Utils/MeshBuilder.h"
+
+/// <summary>
+/// A run of consecutive triangles in a parsed OBJ file that use the same material
+/// </summary>
+struct ObjMaterialRange {
+	// The name given to usemtl, or empty for triangles before the first usemtl
+	std::string Material;
+	uint32_t    FirstTriangle;
+	uint32_t    TriangleCount;
+};
+
+/// <summary>
+/// A multithreaded OBJ parser for importing large meshes. The file is memory mapped and split into chunks
+/// on line boundaries, which are parsed in parallel using std::from_chars. The attributes from each chunk
+/// are then stitched together, fixing up any relative (negative) indices, and the face corners are welded
+/// into unique vertices using a flat open addressing hash table
+///
+/// Supports v, vt, vn, f and usemtl commands, with faces of any number of sides (which are triangulated as
+/// fans). Everything else (groups, material libraries, smoothing groups) is skipped
+/// </summary>
+class FastObjParser {
+public:
+	/// <summary>
+	/// Loads and parses an OBJ file, and calculates the tangents for the resulting mesh
+	/// </summary>
+	/// <param name="filename">The path of the OBJ file to load</param>
+	/// <param name="threadCount">The most threads to parse with, or 0 to use one per hardware thread</param>
+	/// <param name="materials">If not null, will receive the runs of triangles that use each material, in the order they appear</param>
+	/// <returns>A new mesh builder with the file's contents, which the caller is responsible for deleting</returns>
+	static MeshBuilder<VertexPosNormTexColTangents>* LoadFromFile(const std::string& filename, uint32_t threadCount = 0, std::vector<ObjMaterialRange>* materials = nullptr);
+
+	/// <summary>
+	/// Parses the contents of an OBJ file that are already in memory
+	/// </summary>
+	/// <param name="data">The text of the OBJ file, this does not need to be null terminated</param>
+	/// <param name="size">The size of the text in bytes</param>
+	/// <param name="threadCount">The most threads to parse with, or 0 to use one per hardware thread</param>
+	/// <param name="calcTangents">True if the tangents and bitangents should be calculated for the mesh</param>
+	/// <param name="materials">If not null, will receive the runs of triangles that use each material, in the order they appear</param>
+	/// <returns>A new mesh builder with the file's contents, which the caller is responsible for deleting</returns>
+	static MeshBuilder<VertexPosNormTexColTangents>* Parse(const char* data, size_t size, uint32_t threadCount = 0, bool calcTangents = true, std::vector<ObjMaterialRange>* materials = nullptr);
+
+protected:
+	FastObjParser() = default;
+	~FastObjParser() = default;
+};
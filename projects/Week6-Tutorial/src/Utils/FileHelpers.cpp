@@ -4,97 +4,151 @@
 #include <Logging.h>
 
 #include "Utils/StringUtils.h"
+#include "Utils/VirtualFileSystem.h"
 
 std::string FileHelpers::ReadFile(const std::string& filename) {
+	// Files may be coming from a pack, so we go through the VFS rather than opening them ourselves
 	std::string result;
-	std::ifstream in(filename, std::ios::in | std::ios::binary); // ifstream closes itself due to RAII
-
-	if (in) {
-		// Determine how long the file is
-		in.seekg(0, std::ios::end);
-		size_t size = in.tellg();
-
-		// As long as we have a size, we can read it!
-		if (size != -1) {
-			// Resize our string to be able to fit all the data
-			result.resize(size);
-			// Seek to beginning of file, then read contents to string
-			in.seekg(0, std::ios::beg);
-			in.read(&result[0], size);
-		} else {
-			LOG_ERROR("Could not read from file '{}'", filename);
-		}
-	} else {
+	if (!VirtualFileSystem::ReadFile(filename, result)) {
 		LOG_ERROR("Could not open file '{}'", filename);
 	}
+	return result;
+}
+
+std::unordered_map<std::string, FileHelpers::CachedFile> FileHelpers::_includeCache;
+
+std::string FileHelpers::ReadResolveIncludes(const std::string& filename, std::unordered_set<std::string>* dependencies) {
+	std::string result;
+	const std::string path = NormalizePath(filename);
+
+	// Track what we've included so far, so that each file only gets included once (this also protects us from cycles)
+	std::unordered_set<std::string> resolvedPaths;
+	resolvedPaths.insert(path);
+	_ResolveIncludes(path, result, resolvedPaths);
+
+	// Everything we touched is a dependency of the result, including files that could not be found
+	if (dependencies != nullptr) {
+		dependencies->insert(resolvedPaths.begin(), resolvedPaths.end());
+	}
 
 	return result;
 }
 
-std::string FileHelpers::ReadResolveIncludes(const std::string& filename, std::vector<std::string> resolvedPaths) {
+std::filesystem::file_time_type FileHelpers::GetLastWriteTime(const std::string& filename) {
+	std::filesystem::file_time_type result;
+	return VirtualFileSystem::GetLastWriteTime(filename, result) ? result : std::filesystem::file_time_type();
+}
+
+bool FileHelpers::Exists(const std::string& filename) {
+	return VirtualFileSystem::Exists(filename);
+}
+
+std::string FileHelpers::NormalizePath(const std::string& filename) {
+	// Get a lexically normal path (ie with the ../ parts resolved), relative to the working directory
+	std::error_code error;
+	std::filesystem::path result = std::filesystem::path(filename).lexically_normal();
+	std::filesystem::path relative = std::filesystem::relative(result, error);
+	return (error || relative.empty() ? result : relative).string();
+}
+
+void FileHelpers::ClearIncludeCache() {
+	_includeCache.clear();
+}
+
+const FileHelpers::CachedFile& FileHelpers::_GetCachedFile(const std::string& normalizedPath) {
+	std::filesystem::file_time_type writeTime = GetLastWriteTime(normalizedPath);
+
+	// If we have the file cached and it hasn't been touched, we can skip all the work
+	auto it = _includeCache.find(normalizedPath);
+	if (it != _includeCache.end() && it->second.LastWriteTime == writeTime) {
+		return it->second;
+	}
+
+	CachedFile& entry = _includeCache[normalizedPath];
+	entry.LastWriteTime = writeTime;
+	entry.Segments.clear();
+
 	// Read the entire file contents for processing
-	std::string result = ReadFile(filename);
+	const std::string contents = ReadFile(normalizedPath);
 	// Determine where the file we just read resides on the filesystem
-	const std::filesystem::path folder = std::filesystem::path(filename).parent_path();
+	const std::filesystem::path folder = std::filesystem::path(normalizedPath).parent_path();
 
 	// The token we're looking for, and it's length
 	const char* includeToken = "#include";
 	const size_t includeTokenLen = const_strlen(includeToken);
 
-	// Look for the token in the file
-	size_t seek = result.find(includeToken, 0); 
-	// If we found it, there's work to do!
+	// We split the file into runs of text that end in an include, so that expanding
+	// the file later is just a series of appends
+	size_t start = 0;
+	size_t seek = contents.find(includeToken, 0);
 	while (seek != std::string::npos) {
 		// Find the end of the line
-		size_t eol = result.find_first_of("\r\n", seek);
+		size_t eol = contents.find_first_of("\r\n", seek);
 		if (eol == std::string::npos) {
-			eol = result.size();
+			eol = contents.size();
 		}
 
 		// Calculate the area from end of token to end of line, snip out as the path
-		size_t begin = seek + includeTokenLen + 1;
-		std::string path = result.substr(begin, eol - begin);
+		size_t begin = std::min(seek + includeTokenLen + 1, eol);
+		std::string path = contents.substr(begin, eol - begin);
 
 		// Trim whitespace and any quotes 
 		StringTools::Trim(path);
 		StringTools::Trim(path, '"');
 
-		// Determine the file path
-		std::filesystem::path target;
-		// If it starts with '/', relative to application directory
-		if (path[0] == '/') {
-			target = path;
-		}
-		// Otherwise relative to the current directory
-		else {
-			target = folder / path;
+		IncludeSegment segment;
+		segment.Text = contents.substr(start, seek - start);
+
+		if (!path.empty()) {
+			// Determine the file path
+			std::filesystem::path target;
+			// If it starts with '/', relative to application directory
+			if (path[0] == '/') {
+				target = path;
+			}
+			// Otherwise relative to the current directory
+			else {
+				target = folder / path;
+			}
+			segment.IncludePath = NormalizePath(target.string());
+
+			if (!Exists(segment.IncludePath)) {
+				LOG_ERROR("Included file \"{}\" does not exist (included from \"{}\")", segment.IncludePath, normalizedPath);
+			}
+		} else {
+			LOG_WARN("Empty #include directive in \"{}\", ignoring", normalizedPath);
 		}
-		// Get a lexically normal path (ie with the ../ parts resolved)
-		target = target.lexically_normal();
-		target = std::filesystem::relative(target);
 
-		// If we haven't included the file yet, include it now
-		if (std::find(resolvedPaths.begin(), resolvedPaths.end(), target.string()) == resolvedPaths.end()) {
+		entry.Segments.push_back(std::move(segment));
 
-			// Make sure file exists, then load and resolve it's includes
-			LOG_ASSERT(std::filesystem::exists(target), "File does not exist");
-			std::string replacement = FileHelpers::ReadResolveIncludes(target.string(), resolvedPaths);
+		// The include line is dropped, but we keep the line ending
+		start = eol;
+		seek = contents.find(includeToken, eol);
+	}
 
-			// Inject result into our string
-			result.replace(seek, eol - seek, replacement);
-			// Look for more includes!
-			seek = result.find(includeToken, seek + replacement.length());
+	// Whatever is left after the last include
+	IncludeSegment tail;
+	tail.Text = contents.substr(start);
+	entry.Segments.push_back(std::move(tail));
 
-			resolvedPaths.push_back(target.string());
-		}
-		// File already included, remove the line and continue seeking
-		else {
-			result.replace(seek, eol - seek, "");
-			seek = result.find(includeToken, eol);
+	return entry;
+}
+
+void FileHelpers::_ResolveIncludes(const std::string& normalizedPath, std::string& result, std::unordered_set<std::string>& resolvedPaths) {
+	// Note that references into an unordered_map are not invalidated when it grows,
+	// so we can safely recurse while holding on to this
+	const CachedFile& file = _GetCachedFile(normalizedPath);
+
+	for (const IncludeSegment& segment : file.Segments) {
+		result.append(segment.Text);
+
+		// If we haven't included the file yet, include it now, otherwise the line is simply removed
+		if (!segment.IncludePath.empty() && resolvedPaths.insert(segment.IncludePath).second) {
+			if (Exists(segment.IncludePath)) {
+				_ResolveIncludes(segment.IncludePath, result, resolvedPaths);
+			}
 		}
 	}
-
-	return result;
 }
 
 void FileHelpers::WriteContentsToFile(const std::string& filename, const std::string& contents, bool append /*= false*/) {
@@ -2,12 +2,16 @@
 
 #include <string>
 #include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <filesystem>
 
 class FileHelpers {
 public:
 	FileHelpers() = delete;
 	/// <summary>
-	/// Reads the entire contents of a file into a string
+	/// Reads the entire contents of a file into a string, this goes through the VirtualFileSystem
+	/// so files in a mounted pack can be read as if they were loose files
 	/// </summary>
 	/// <param name="filename">The path of the file to load</param>
 	/// <returns>The entire contents of the file stored in a string</returns>
@@ -15,12 +19,40 @@ public:
 
 	/// <summary>
 	/// Reads the entire contents of a file, and will also recursively include
-	/// any other files needed as indicated by a #include fileName on a line
+	/// any other files needed as indicated by a #include fileName on a line. 
+	/// Each file will only be included once, and files are read through a cache
+	/// that is keyed on the file path and last write time, so shared fragments
+	/// are only read and parsed again when they change on disk
 	/// </summary>
 	/// <param name="filename">The path of the file to load</param>
-	/// <param name="resolvedPaths">The list of paths that have already been included</param>
+	/// <param name="dependencies">If not null, will receive the normalized path of every file that contributed to the result, including filename</param>
 	/// <returns>The entire contents of the file, with includes resolved, stored in a string</returns>
-	static std::string ReadResolveIncludes(const std::string& filename, std::vector<std::string> resolvedPaths = std::vector<std::string>());
+	static std::string ReadResolveIncludes(const std::string& filename, std::unordered_set<std::string>* dependencies = nullptr);
+
+	/// <summary>
+	/// Gets the last time that a file was written to, or the default time value
+	/// if the file does not exist. Packed files use the time the pack was written
+	/// </summary>
+	/// <param name="filename">The path of the file to examine</param>
+	static std::filesystem::file_time_type GetLastWriteTime(const std::string& filename);
+
+	/// <summary>
+	/// Returns true if a file exists, either on disk or in a mounted pack
+	/// </summary>
+	/// <param name="filename">The path of the file to check</param>
+	static bool Exists(const std::string& filename);
+
+	/// <summary>
+	/// Normalizes a path so that it can be used as a key for caching and dependency tracking
+	/// (ie with the ../ parts resolved, relative to the working directory)
+	/// </summary>
+	/// <param name="filename">The path to normalize</param>
+	static std::string NormalizePath(const std::string& filename);
+
+	/// <summary>
+	/// Removes all entries from the include cache
+	/// </summary>
+	static void ClearIncludeCache();
 
 	/// <summary>
 	/// Helper for writing the contents of a string into a file
@@ -29,4 +61,35 @@ public:
 	/// <param name="contents">The contents of the file to write</param>
 	/// <param name="append">True if contents should be appended to end of existing files</param>
 	static void WriteContentsToFile(const std::string& filename, const std::string& contents, bool append = false);
-};
\ No newline at end of file
+
+private:
+	/// <summary>
+	/// A run of text from a source file, followed by the (normalized) path
+	/// of the file included at the end of the run, if any
+	/// </summary>
+	struct IncludeSegment {
+		std::string Text;
+		std::string IncludePath;
+	};
+
+	/// <summary>
+	/// A file that has been read and split on it's #include directives
+	/// </summary>
+	struct CachedFile {
+		std::filesystem::file_time_type LastWriteTime;
+		std::vector<IncludeSegment>     Segments;
+	};
+
+	static std::unordered_map<std::string, CachedFile> _includeCache;
+
+	/// <summary>
+	/// Gets the cached, pre-split contents of a file, reading it from disk if
+	/// it is not yet cached or has been modified since it was cached
+	/// </summary>
+	static const CachedFile& _GetCachedFile(const std::string& normalizedPath);
+
+	/// <summary>
+	/// Recursively appends the contents of a file and it's includes to result
+	/// </summary>
+	static void _ResolveIncludes(const std::string& normalizedPath, std::string& result, std::unordered_set<std::string>& resolvedPaths);
+};
@@ -211,6 +211,8 @@ bool ImGuiHelper::HeaderMoveButtons(ImGuiID headerId, int* delta)
 bool ImGuiHelper::DrawTextureDrop(Texture2D::Sptr& image, ImVec2 size)
 {
 	if (image != nullptr) {
+		// Evicted textures have no handle, so make sure it's loaded before ImGui gets a hold of it
+		image->MakeResident();
 		ImGui::Image(
 			(ImTextureID)image->GetHandle(),
 			size,
@@ -250,6 +252,7 @@ void ImGuiHelper::DrawLinearDepthTexture(const Texture2D::Sptr& image, const glm
 		glUseProgram(data->programId);
 		glUniform2fv(1, 1, &data->nearFar.x);
 	}, temp);
+	image->MakeResident();
 	ImGui::Image((ImTextureID)image->GetHandle(), ImVec2(size.x, size.y), ImVec2(0, 1), ImVec2(1, 0));
 	drawList->AddCallback([](const ImDrawList* parent_list, const ImDrawCmd* cmd) {
 		Data* data = static_cast<Data*>(cmd->UserCallbackData);
@@ -67,7 +67,7 @@ public:
 
 	template <typename T>
 	static bool ResourceDragTarget(std::shared_ptr<T>& resourceOut) {
-		std::string typeName = StringTools::SanitizeClassName(typeid(T).name());
+		const std::string& typeName = ResourceManager::GetTypeName<T>();
 		bool result = false;
 
 		if (ImGui::BeginDragDropTarget()) {
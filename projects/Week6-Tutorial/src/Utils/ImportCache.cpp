@@ -0,0 +1,370 @@
+#include "Utils/ImportCache.h"
+
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include <vector>
+#include <chrono>
+
+#include <json.hpp>
+#include <Logging.h>
+
+#include "Utils/MemoryMappedFile.h"
+#include "Utils/VirtualFileSystem.h"
+
+namespace fs = std::filesystem;
+
+const std::string manifestFilename = "manifest.json";
+const int manifestVersion = 1;
+
+std::string ImportCache::_directory = "import-cache";
+uint64_t    ImportCache::_maxSize   = 1024ull * 1024ull * 1024ull;
+uint64_t    ImportCache::_totalSize = 0;
+bool        ImportCache::_isLoaded  = false;
+bool        ImportCache::_isDirty   = false;
+std::mutex  ImportCache::_mutex;
+
+std::unordered_map<std::string, ImportCache::Entry>        ImportCache::_entries;
+std::unordered_map<std::string, ImportCache::SourceRecord> ImportCache::_sources;
+
+void ImportCache::SetDirectory(const std::string& directory) {
+	std::lock_guard<std::mutex> lock(_mutex);
+	if (_isLoaded && _isDirty) {
+		_SaveManifest();
+	}
+	_directory = directory;
+	_entries.clear();
+	_sources.clear();
+	_totalSize = 0;
+	_isLoaded  = false;
+	_isDirty   = false;
+}
+
+const std::string& ImportCache::GetDirectory() {
+	return _directory;
+}
+
+void ImportCache::SetMaxSize(uint64_t bytes) {
+	std::lock_guard<std::mutex> lock(_mutex);
+	_maxSize = bytes;
+	if (_isLoaded) {
+		_Cleanup();
+	}
+}
+
+uint64_t ImportCache::GetMaxSize() {
+	return _maxSize;
+}
+
+uint64_t ImportCache::GetTotalSize() {
+	std::lock_guard<std::mutex> lock(_mutex);
+	_LoadManifest();
+	return _totalSize;
+}
+
+uint64_t ImportCache::HashBytes(const void* data, size_t size, uint64_t seed) {
+	const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+	uint64_t hash = seed;
+	for (size_t ix = 0; ix < size; ix++) {
+		hash ^= bytes[ix];
+		hash *= 0x100000001b3ull;
+	}
+	return hash;
+}
+
+uint64_t ImportCache::HashFile(const std::string& filename) {
+	// Packed files had their hash calculated when the pack was built
+	uint64_t packedHash = 0;
+	if (VirtualFileSystem::TryGetContentHash(filename, packedHash)) {
+		return packedHash;
+	}
+
+	std::error_code error;
+	uint64_t size = fs::file_size(filename, error);
+	if (error) {
+		return 0;
+	}
+	int64_t modifiedTime = fs::last_write_time(filename, error).time_since_epoch().count();
+	if (error) {
+		return 0;
+	}
+	std::string key = fs::path(filename).lexically_normal().generic_string();
+
+	// If the file looks the same as the last time we hashed it, we can skip reading it
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_LoadManifest();
+		auto it = _sources.find(key);
+		if (it != _sources.end() && it->second.ModifiedTime == modifiedTime && it->second.Size == size) {
+			return it->second.Hash;
+		}
+	}
+
+	// We don't hold the lock while hashing, since large files can take a while
+	MemoryMappedFile::Sptr file = MemoryMappedFile::Open(filename);
+	if (file == nullptr) {
+		return 0;
+	}
+	uint64_t hash = HashBytes(file->GetData(), file->GetSize());
+
+	std::lock_guard<std::mutex> lock(_mutex);
+	_sources[key] = SourceRecord{ modifiedTime, size, hash };
+	_isDirty = true;
+	return hash;
+}
+
+std::string ImportCache::MakeKey(const std::string& importer, uint32_t version, uint64_t sourceHash, const std::string& settings, const std::string& extension) {
+	uint64_t hash = HashBytes(&sourceHash, sizeof(uint64_t));
+	hash = HashBytes(&version, sizeof(uint32_t), hash);
+	hash = HashBytes(importer.data(), importer.size(), hash);
+	hash = HashBytes(settings.data(), settings.size(), hash);
+
+	char id[20];
+	snprintf(id, sizeof(id), "%016llx", (unsigned long long)hash);
+	return importer + "-" + id + extension;
+}
+
+std::string ImportCache::GetPath(const std::string& key) {
+	return (fs::path(_directory) / key).string();
+}
+
+bool ImportCache::TryGet(const std::string& key, std::string& path) {
+	std::lock_guard<std::mutex> lock(_mutex);
+	_LoadManifest();
+
+	auto it = _entries.find(key);
+	if (it == _entries.end()) {
+		return false;
+	}
+
+	// Someone may have cleared out the directory behind our back
+	std::string result = GetPath(key);
+	std::error_code error;
+	if (!fs::exists(result, error)) {
+		_totalSize -= std::min(_totalSize, it->second.Size);
+		_entries.erase(it);
+		_isDirty = true;
+		return false;
+	}
+
+	it->second.LastUsed = _Now();
+	_isDirty = true;
+	path = result;
+	return true;
+}
+
+bool ImportCache::Commit(const std::string& key, const std::string& source) {
+	std::lock_guard<std::mutex> lock(_mutex);
+	_LoadManifest();
+
+	std::error_code error;
+	uint64_t size = fs::file_size(GetPath(key), error);
+	if (error) {
+		LOG_WARN("Cannot add \"{}\" to the import cache, the artifact does not exist", key);
+		return false;
+	}
+
+	// We may be replacing an artifact that was corrupt
+	auto it = _entries.find(key);
+	if (it != _entries.end()) {
+		_totalSize -= std::min(_totalSize, it->second.Size);
+	}
+	_entries[key] = Entry{ source, size, _Now() };
+	_totalSize += size;
+	_isDirty = true;
+
+	// Make room for the new artifact, and write the manifest right away so that a crash won't orphan it
+	_Cleanup(key);
+	_SaveManifest();
+	return true;
+}
+
+void ImportCache::Remove(const std::string& key) {
+	std::lock_guard<std::mutex> lock(_mutex);
+	_LoadManifest();
+
+	auto it = _entries.find(key);
+	if (it != _entries.end()) {
+		_totalSize -= std::min(_totalSize, it->second.Size);
+		_entries.erase(it);
+		_isDirty = true;
+	}
+	std::error_code error;
+	fs::remove(GetPath(key), error);
+}
+
+void ImportCache::Cleanup() {
+	std::lock_guard<std::mutex> lock(_mutex);
+	_LoadManifest();
+	_Cleanup();
+	if (_isDirty) {
+		_SaveManifest();
+	}
+}
+
+void ImportCache::SaveManifest() {
+	std::lock_guard<std::mutex> lock(_mutex);
+	if (_isLoaded && _isDirty) {
+		_SaveManifest();
+	}
+}
+
+void ImportCache::_Cleanup(const std::string& keep) {
+	if (_totalSize <= _maxSize) {
+		return;
+	}
+
+	// Sort oldest first, so we can walk forward until we're back under the limit
+	std::vector<std::pair<int64_t, std::string>> order;
+	order.reserve(_entries.size());
+	for (const auto& [key, entry] : _entries) {
+		order.emplace_back(entry.LastUsed, key);
+	}
+	std::sort(order.begin(), order.end());
+
+	size_t evicted = 0;
+	uint64_t evictedSize = 0;
+	for (const auto& [lastUsed, key] : order) {
+		if (_totalSize <= _maxSize) {
+			break;
+		}
+		// The artifact we just imported is about to be loaded, even if it's larger than the whole cache
+		if (key == keep) {
+			continue;
+		}
+		auto it = _entries.find(key);
+		std::error_code error;
+		fs::remove(GetPath(key), error);
+		if (error) {
+			// Most likely someone still has the file open (ex: a mapped mesh), we'll get it next time
+			continue;
+		}
+		evictedSize += it->second.Size;
+		_totalSize -= std::min(_totalSize, it->second.Size);
+		_entries.erase(it);
+		evicted++;
+	}
+
+	if (evicted > 0) {
+		LOG_INFO("Evicted {} artifacts ({} bytes) from the import cache", evicted, evictedSize);
+		_isDirty = true;
+	}
+}
+
+void ImportCache::_LoadManifest() {
+	if (_isLoaded) {
+		return;
+	}
+	_isLoaded = true;
+	_entries.clear();
+	_sources.clear();
+	_totalSize = 0;
+
+	// Importers write straight into the directory, so make sure it's there before anyone asks for a path
+	std::error_code error;
+	fs::create_directories(_directory, error);
+
+	fs::path manifestPath = fs::path(_directory) / manifestFilename;
+	std::ifstream file(manifestPath);
+	if (file) {
+		nlohmann::json manifest = nlohmann::json::parse(file, nullptr, false);
+		if (manifest.is_discarded() || !manifest.is_object() || manifest.value("version", 0) != manifestVersion) {
+			LOG_WARN("Import cache manifest \"{}\" is invalid, the cache will be rebuilt", manifestPath.string());
+		} else {
+			if (manifest.contains("entries") && manifest["entries"].is_object()) {
+				for (const auto& item : manifest["entries"].items()) {
+					const std::string& key = item.key();
+					const nlohmann::json& blob = item.value();
+					Entry entry = Entry();
+					entry.Source   = blob.value("source", "");
+					entry.LastUsed = blob.value("last_used", (int64_t)0);
+
+					// Drop any entries who's files have gone missing, and trust the file system for sizes
+					entry.Size = fs::file_size(GetPath(key), error);
+					if (error) {
+						_isDirty = true;
+						continue;
+					}
+					_entries[key] = entry;
+					_totalSize += entry.Size;
+				}
+			}
+			if (manifest.contains("sources") && manifest["sources"].is_object()) {
+				for (const auto& item : manifest["sources"].items()) {
+					const std::string& path = item.key();
+					const nlohmann::json& blob = item.value();
+					// Source files that have been deleted or moved will never be looked up again
+					if (!fs::exists(path, error)) {
+						_isDirty = true;
+						continue;
+					}
+					SourceRecord& record = _sources[path];
+					record.ModifiedTime = blob.value("modified", (int64_t)0);
+					record.Size         = blob.value("size", (uint64_t)0);
+					record.Hash         = blob.value("hash", (uint64_t)0);
+				}
+			}
+		}
+	}
+
+	// Any files that aren't in the manifest were left behind by an importer that didn't finish (or by
+	// an older manifest), we have no idea what's in them so we get rid of them
+	for (const auto& item : fs::directory_iterator(_directory, error)) {
+		std::string name = item.path().filename().string();
+		if (item.is_regular_file() && name != manifestFilename && _entries.find(name) == _entries.end()) {
+			fs::remove(item.path(), error);
+		}
+	}
+
+	LOG_TRACE("Loaded import cache \"{}\" with {} artifacts ({} bytes)", _directory, _entries.size(), _totalSize);
+}
+
+void ImportCache::_SaveManifest() {
+	nlohmann::json entries = nlohmann::json::object();
+	for (const auto& [key, entry] : _entries) {
+		entries[key] = {
+			{ "source",    entry.Source },
+			{ "size",      entry.Size },
+			{ "last_used", entry.LastUsed }
+		};
+	}
+	nlohmann::json sources = nlohmann::json::object();
+	for (const auto& [path, record] : _sources) {
+		sources[path] = {
+			{ "modified", record.ModifiedTime },
+			{ "size",     record.Size },
+			{ "hash",     record.Hash }
+		};
+	}
+	nlohmann::json manifest = {
+		{ "version", manifestVersion },
+		{ "entries", entries },
+		{ "sources", sources }
+	};
+
+	std::error_code error;
+	fs::create_directories(_directory, error);
+
+	// Write to a temporary file first, so that we never leave a half written manifest behind
+	fs::path manifestPath = fs::path(_directory) / manifestFilename;
+	fs::path tempPath = manifestPath;
+	tempPath += ".tmp";
+	{
+		std::ofstream file(tempPath);
+		if (!file) {
+			LOG_WARN("Failed to open import cache manifest \"{}\" for writing", tempPath.string());
+			return;
+		}
+		file << manifest.dump(1, '\t');
+	}
+	fs::rename(tempPath, manifestPath, error);
+	if (error) {
+		LOG_WARN("Failed to move import cache manifest into place \"{}\": {}", manifestPath.string(), error.message());
+		return;
+	}
+	_isDirty = false;
+}
+
+int64_t ImportCache::_Now() {
+	return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+
+/// <summary>
+/// A single directory that all of our importers store their derived data in (ex: optimized meshes,
+/// compressed textures, binary LUTs and shader binaries), so that we only pay for an import once
+///
+/// Artifacts are keyed by a hash of the source file's bytes, the importer's version and the settings
+/// that were used to import it, so editing a source file, bumping an importer or changing the import
+/// settings all produce a new key, and a stale artifact is never loaded. A manifest in the cache
+/// directory tracks how large each artifact is and when it was last used, so that the cache can be
+/// kept under a size limit by evicting the least recently used artifacts
+///
+/// Importers follow the same pattern:
+///     std::string key = ImportCache::MakeKey("mesh", VERSION, ImportCache::HashFile(source), settings);
+///     std::string path;
+///     if (!ImportCache::TryGet(key, path)) {
+///         // Import source into ImportCache::GetPath(key)
+///         ImportCache::Commit(key, source);
+///     }
+///     // Load from path
+/// </summary>
+class ImportCache {
+public:
+	ImportCache() = delete;
+
+	/// <summary>
+	/// Sets the directory that artifacts and the manifest are stored in, relative to the working
+	/// directory. Default is "import-cache". This should be called before anything is imported
+	/// </summary>
+	static void SetDirectory(const std::string& directory);
+	/// <summary>
+	/// Gets the directory that artifacts and the manifest are stored in
+	/// </summary>
+	static const std::string& GetDirectory();
+
+	/// <summary>
+	/// Sets the maximum total size of all artifacts in the cache, in bytes. When a new artifact would push the
+	/// cache over this size, the least recently used artifacts are deleted. Default is 1GB
+	/// </summary>
+	static void SetMaxSize(uint64_t bytes);
+	/// <summary>
+	/// Gets the maximum total size of all artifacts in the cache, in bytes
+	/// </summary>
+	static uint64_t GetMaxSize();
+	/// <summary>
+	/// Gets the total size of all artifacts that are currently in the cache, in bytes
+	/// </summary>
+	static uint64_t GetTotalSize();
+
+	/// <summary>
+	/// 64 bit FNV-1a hash of a block of memory, can be chained by passing the result of a previous call as the seed
+	/// </summary>
+	/// <param name="data">The data to hash</param>
+	/// <param name="size">The size of the data, in bytes</param>
+	/// <param name="seed">The hash to continue from</param>
+	static uint64_t HashBytes(const void* data, size_t size, uint64_t seed = 0xcbf29ce484222325ull);
+	/// <summary>
+	/// Hashes the contents of a file. The hash is remembered in the manifest along with the file's size and
+	/// modification time, so files that have not changed since the last time they were hashed are not read again.
+	/// Files in a mounted pack use the hash that was stored when the pack was built
+	/// </summary>
+	/// <param name="filename">The path to the file to hash</param>
+	/// <returns>The hash of the file's contents, or 0 if the file could not be read</returns>
+	static uint64_t HashFile(const std::string& filename);
+
+	/// <summary>
+	/// Makes the key that an artifact will be stored under
+	/// </summary>
+	/// <param name="importer">The name of the importer, this will prefix the artifact's file name (ex: "mesh")</param>
+	/// <param name="version">The version of the importer, this should be bumped whenever the importer's output changes</param>
+	/// <param name="sourceHash">The hash of the source data, typically from HashFile</param>
+	/// <param name="settings">Any settings that change the output of the importer, in any stable text format</param>
+	/// <param name="extension">The extension to give the artifact's file</param>
+	static std::string MakeKey(const std::string& importer, uint32_t version, uint64_t sourceHash, const std::string& settings = "", const std::string& extension = ".bin");
+	/// <summary>
+	/// Gets the path that the artifact with the given key is stored at, this is where importers should write
+	/// their artifact before calling Commit
+	/// </summary>
+	static std::string GetPath(const std::string& key);
+
+	/// <summary>
+	/// Looks up an artifact in the cache, marking it as recently used if it exists
+	/// </summary>
+	/// <param name="key">The key of the artifact, from MakeKey</param>
+	/// <param name="path">Will be set to the artifact's path if it was found</param>
+	/// <returns>True if the artifact is in the cache, false if it needs to be imported</returns>
+	static bool TryGet(const std::string& key, std::string& path);
+	/// <summary>
+	/// Records an artifact that an importer has finished writing to GetPath(key), and evicts old artifacts
+	/// if the cache has grown past it's size limit
+	/// </summary>
+	/// <param name="key">The key of the artifact, from MakeKey</param>
+	/// <param name="source">The file the artifact was made from, this is only stored for debugging</param>
+	/// <returns>True if the artifact was recorded, false if it's file does not exist</returns>
+	static bool Commit(const std::string& key, const std::string& source = "");
+	/// <summary>
+	/// Removes an artifact from the cache, for when an importer finds that an artifact is corrupt
+	/// </summary>
+	/// <param name="key">The key of the artifact, from MakeKey</param>
+	static void Remove(const std::string& key);
+
+	/// <summary>
+	/// Deletes the least recently used artifacts until the cache is under it's size limit
+	/// </summary>
+	static void Cleanup();
+	/// <summary>
+	/// Writes the manifest to the cache directory if anything has changed since it was last written. This
+	/// should be called before the application exits so that usage times are not lost
+	/// </summary>
+	static void SaveManifest();
+
+private:
+	// Will be stored in the manifest for every artifact in the cache
+	struct Entry {
+		std::string Source;
+		uint64_t    Size;
+		int64_t     LastUsed;
+	};
+	// Lets us skip re-hashing source files that have not changed
+	struct SourceRecord {
+		int64_t  ModifiedTime;
+		uint64_t Size;
+		uint64_t Hash;
+	};
+
+	static std::string _directory;
+	static uint64_t    _maxSize;
+	static uint64_t    _totalSize;
+	static bool        _isLoaded;
+	static bool        _isDirty;
+	static std::mutex  _mutex;
+
+	static std::unordered_map<std::string, Entry>        _entries;
+	static std::unordered_map<std::string, SourceRecord> _sources;
+
+	static void _LoadManifest();
+	static void _SaveManifest();
+	static void _Cleanup(const std::string& keep = "");
+	static int64_t _Now();
+};
@@ -0,0 +1,97 @@
+#include "Utils/MemoryMappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MemoryMappedFile::MemoryMappedFile() :
+	_data(nullptr),
+	_size(0),
+	_file(nullptr),
+	_mapping(nullptr)
+{ }
+
+MemoryMappedFile::~MemoryMappedFile() {
+#ifdef _WIN32
+	if (_data != nullptr) {
+		UnmapViewOfFile(_data);
+	}
+	if (_mapping != nullptr) {
+		CloseHandle(_mapping);
+	}
+	if (_file != nullptr) {
+		CloseHandle(_file);
+	}
+#else
+	if (_data != nullptr) {
+		munmap(const_cast<uint8_t*>(_data), _size);
+	}
+	if (_file != nullptr) {
+		close(static_cast<int>(reinterpret_cast<intptr_t>(_file)) - 1);
+	}
+#endif
+}
+
+MemoryMappedFile::Sptr MemoryMappedFile::Open(const std::string& filename) {
+	// Constructor is protected, so we can't use make_shared
+	MemoryMappedFile::Sptr result = MemoryMappedFile::Sptr(new MemoryMappedFile());
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		return nullptr;
+	}
+	result->_file = file;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size)) {
+		return nullptr;
+	}
+	result->_size = static_cast<size_t>(size.QuadPart);
+
+	// Windows refuses to map empty files, but there's nothing to read anyways
+	if (result->_size == 0) {
+		return result;
+	}
+
+	result->_mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (result->_mapping == nullptr) {
+		return nullptr;
+	}
+	result->_data = static_cast<const uint8_t*>(MapViewOfFile(result->_mapping, FILE_MAP_READ, 0, 0, 0));
+	if (result->_data == nullptr) {
+		return nullptr;
+	}
+#else
+	int file = open(filename.c_str(), O_RDONLY);
+	if (file < 0) {
+		return nullptr;
+	}
+	// Offset by one so that descriptor 0 isn't mistaken for no file
+	result->_file = reinterpret_cast<void*>(static_cast<intptr_t>(file) + 1);
+
+	struct stat info;
+	if (fstat(file, &info) != 0) {
+		return nullptr;
+	}
+	result->_size = static_cast<size_t>(info.st_size);
+	if (result->_size == 0) {
+		return result;
+	}
+
+	void* data = mmap(nullptr, result->_size, PROT_READ, MAP_PRIVATE, file, 0);
+	if (data == MAP_FAILED) {
+		return nullptr;
+	}
+	result->_data = static_cast<const uint8_t*>(data);
+#endif
+
+	return result;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "Utils/Macros.h"
+
+/// <summary>
+/// A read-only view of a file's contents that is mapped directly into memory, so the OS pages the file
+/// in as it is touched instead of us copying it into a buffer first. The view stays valid for as long
+/// as this object is alive
+/// </summary>
+class MemoryMappedFile final {
+public:
+	MAKE_PTRS(MemoryMappedFile);
+	NO_COPY(MemoryMappedFile);
+	NO_MOVE(MemoryMappedFile);
+
+	~MemoryMappedFile();
+
+	/// <summary>
+	/// Maps the entire contents of a file into memory
+	/// </summary>
+	/// <param name="filename">The path of the file to map</param>
+	/// <returns>The mapped file, or nullptr if the file could not be opened</returns>
+	static MemoryMappedFile::Sptr Open(const std::string& filename);
+
+	/// <summary>
+	/// Gets a pointer to the start of the file's contents, this will be null for empty files
+	/// </summary>
+	const uint8_t* GetData() const { return _data; }
+	/// <summary>
+	/// Gets the size of the file in bytes
+	/// </summary>
+	size_t GetSize() const { return _size; }
+
+protected:
+	MemoryMappedFile();
+
+	const uint8_t* _data;
+	size_t         _size;
+	// Platform handles for the file and it's mapping
+	void*          _file;
+	void*          _mapping;
+};
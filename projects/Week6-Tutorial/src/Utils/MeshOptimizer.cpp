@@ -0,0 +1,290 @@
+#include "Utils/MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Tuning values from Forsyth's paper, the cache being modelled is an LRU cache, which is a reasonable
+// stand-in for the various FIFO caches that are found on actual hardware
+static constexpr uint32_t FORSYTH_CACHE_SIZE   = 32;
+static constexpr float    CACHE_DECAY_POWER    = 1.5f;
+static constexpr float    LAST_TRIANGLE_SCORE  = 0.75f;
+static constexpr float    VALENCE_BOOST_SCALE  = 2.0f;
+static constexpr float    VALENCE_BOOST_POWER  = 0.5f;
+
+// The size of the FIFO cache we simulate when measuring and splitting triangle lists
+static constexpr uint32_t SIMULATED_CACHE_SIZE = 16;
+
+/// <summary>
+/// Scores how much we want to use a vertex next. Vertices that were just used score highly (but not as high
+/// as the ones a bit older, since the triangle they came from is already drawn), and vertices with only a few
+/// triangles left get a boost so that we finish them off instead of leaving lone triangles behind
+/// </summary>
+static float __VertexScore(int cachePosition, uint32_t remainingTriangles) {
+	if (remainingTriangles == 0) {
+		return -1.0f;
+	}
+
+	float score = 0.0f;
+	if (cachePosition >= 0) {
+		if (cachePosition < 3) {
+			score = LAST_TRIANGLE_SCORE;
+		} else {
+			float scale = 1.0f / (FORSYTH_CACHE_SIZE - 3);
+			score = std::pow(1.0f - (cachePosition - 3) * scale, CACHE_DECAY_POWER);
+		}
+	}
+	return score + VALENCE_BOOST_SCALE * std::pow((float)remainingTriangles, -VALENCE_BOOST_POWER);
+}
+
+void MeshOptimizer::OptimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount) {
+	size_t triangleCount = indexCount / 3;
+	if (triangleCount == 0) {
+		return;
+	}
+
+	// Build a list of the triangles that use each vertex, which shrinks as the triangles are drawn
+	std::vector<uint32_t> remaining(vertexCount, 0);
+	for (size_t ix = 0; ix < triangleCount * 3; ix++) {
+		remaining[indices[ix]]++;
+	}
+	std::vector<uint32_t> offsets(vertexCount + 1, 0);
+	for (size_t ix = 0; ix < vertexCount; ix++) {
+		offsets[ix + 1] = offsets[ix] + remaining[ix];
+	}
+	std::vector<uint32_t> adjacency(triangleCount * 3);
+	std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+	for (size_t ix = 0; ix < triangleCount * 3; ix++) {
+		adjacency[cursor[indices[ix]]++] = static_cast<uint32_t>(ix / 3);
+	}
+
+	std::vector<int>   cachePosition(vertexCount, -1);
+	std::vector<float> vertexScores(vertexCount);
+	for (size_t ix = 0; ix < vertexCount; ix++) {
+		vertexScores[ix] = __VertexScore(-1, remaining[ix]);
+	}
+
+	std::vector<float> triangleScores(triangleCount);
+	std::vector<bool>  drawn(triangleCount, false);
+	size_t best = 0;
+	for (size_t ix = 0; ix < triangleCount; ix++) {
+		triangleScores[ix] = vertexScores[indices[ix * 3]] + vertexScores[indices[ix * 3 + 1]] + vertexScores[indices[ix * 3 + 2]];
+		if (triangleScores[ix] > triangleScores[best]) {
+			best = ix;
+		}
+	}
+
+	std::vector<uint32_t> result;
+	result.reserve(triangleCount * 3);
+
+	// The cache has room for the triangle being added, so we can see which vertices fall out of it
+	uint32_t cache[FORSYTH_CACHE_SIZE + 3];
+	uint32_t cacheCount = 0;
+	size_t   nextUndrawn = 0;
+
+	while (result.size() < triangleCount * 3) {
+		// If nothing in the cache has any triangles left, we've finished a piece of the mesh and need to jump
+		if (best == SIZE_MAX) {
+			while (drawn[nextUndrawn]) { nextUndrawn++; }
+			best = nextUndrawn;
+		}
+
+		const uint32_t* triangle = &indices[best * 3];
+		drawn[best] = true;
+		result.insert(result.end(), triangle, triangle + 3);
+
+		// Remove the triangle from the lists of the vertices it uses
+		for (int ix = 0; ix < 3; ix++) {
+			uint32_t vertex = triangle[ix];
+			uint32_t* begin = &adjacency[offsets[vertex]];
+			uint32_t* end = begin + remaining[vertex];
+			uint32_t* it = std::find(begin, end, static_cast<uint32_t>(best));
+			if (it != end) {
+				*it = *(end - 1);
+				remaining[vertex]--;
+			}
+		}
+
+		// The triangle's vertices go to the front of the cache, and the rest get pushed back
+		uint32_t newCache[FORSYTH_CACHE_SIZE + 3];
+		uint32_t newCount = 0;
+		for (int ix = 0; ix < 3; ix++) {
+			if (std::find(newCache, newCache + newCount, triangle[ix]) == newCache + newCount) {
+				newCache[newCount++] = triangle[ix];
+			}
+		}
+		for (uint32_t ix = 0; ix < cacheCount; ix++) {
+			uint32_t vertex = cache[ix];
+			if (vertex != triangle[0] && vertex != triangle[1] && vertex != triangle[2]) {
+				newCache[newCount++] = vertex;
+			}
+		}
+
+		// Rescore everything that moved, including the vertices that just fell out
+		for (uint32_t ix = 0; ix < newCount; ix++) {
+			uint32_t vertex = newCache[ix];
+			cachePosition[vertex] = ix < FORSYTH_CACHE_SIZE ? static_cast<int>(ix) : -1;
+			vertexScores[vertex] = __VertexScore(cachePosition[vertex], remaining[vertex]);
+		}
+
+		// Only the triangles that touch those vertices can have changed, so the next best is one of them
+		best = SIZE_MAX;
+		float bestScore = -1.0f;
+		for (uint32_t ix = 0; ix < newCount; ix++) {
+			uint32_t vertex = newCache[ix];
+			for (uint32_t jx = 0; jx < remaining[vertex]; jx++) {
+				uint32_t other = adjacency[offsets[vertex] + jx];
+				const uint32_t* otherTriangle = &indices[other * 3];
+				float score = vertexScores[otherTriangle[0]] + vertexScores[otherTriangle[1]] + vertexScores[otherTriangle[2]];
+				triangleScores[other] = score;
+				if (score > bestScore) {
+					bestScore = score;
+					best = other;
+				}
+			}
+		}
+
+		cacheCount = std::min(newCount, FORSYTH_CACHE_SIZE);
+		std::copy(newCache, newCache + cacheCount, cache);
+	}
+
+	std::copy(result.begin(), result.end(), indices);
+}
+
+void MeshOptimizer::OptimizeOverdraw(uint32_t* indices, size_t indexCount, const VertexPosNormTexColTangents* vertices, size_t vertexCount, float threshold) {
+	size_t triangleCount = indexCount / 3;
+	if (triangleCount < 2) {
+		return;
+	}
+
+	// Split the list into clusters. Each cluster starts with a cold cache, since it may end up anywhere in the
+	// list, so we only end a cluster once it's ACMR has come back down to within the threshold of the whole
+	// list's. Triangles that miss on all 3 vertices don't share anything with what came before them, so those
+	// are free places to split
+	float targetAcmr = CalculateAcmr(indices, indexCount, vertexCount, SIMULATED_CACHE_SIZE) * threshold;
+	std::vector<uint32_t> clusterStarts;
+	std::vector<uint32_t> timestamps(vertexCount, 0);
+	uint32_t time = SIMULATED_CACHE_SIZE + 1;
+	uint32_t clusterMisses = 0;
+	uint32_t clusterTriangles = 0;
+	for (size_t ix = 0; ix < triangleCount; ix++) {
+		uint32_t misses = 0;
+		for (int jx = 0; jx < 3; jx++) {
+			uint32_t vertex = indices[ix * 3 + jx];
+			if (time - timestamps[vertex] > SIMULATED_CACHE_SIZE) {
+				timestamps[vertex] = time++;
+				misses++;
+			}
+		}
+
+		bool split = clusterTriangles == 0 || misses == 3 || clusterMisses <= targetAcmr * clusterTriangles;
+		if (split) {
+			clusterStarts.push_back(static_cast<uint32_t>(ix));
+			clusterMisses = 0;
+			clusterTriangles = 0;
+			// Starting a new cluster means forgetting everything that's in the cache, but the triangle itself
+			// is still the first one in the new cluster
+			time += SIMULATED_CACHE_SIZE + 1;
+			for (int jx = 0; jx < 3; jx++) {
+				timestamps[indices[ix * 3 + jx]] = time++;
+			}
+			misses = 3;
+		}
+		clusterMisses += misses;
+		clusterTriangles++;
+	}
+	clusterStarts.push_back(static_cast<uint32_t>(triangleCount));
+
+	if (clusterStarts.size() <= 2) {
+		return;
+	}
+
+	// Find the area weighted center and facing of each cluster, and of the mesh as a whole
+	struct Cluster {
+		uint32_t  Start;
+		uint32_t  End;
+		glm::vec3 Center;
+		glm::vec3 Normal;
+		float     Sort;
+	};
+	std::vector<Cluster> clusters;
+	clusters.reserve(clusterStarts.size() - 1);
+	glm::vec3 meshCenter = glm::vec3(0.0f);
+	float     meshArea = 0.0f;
+	for (size_t ix = 0; ix + 1 < clusterStarts.size(); ix++) {
+		Cluster cluster = { clusterStarts[ix], clusterStarts[ix + 1], glm::vec3(0.0f), glm::vec3(0.0f), 0.0f };
+		float area = 0.0f;
+		for (uint32_t jx = cluster.Start; jx < cluster.End; jx++) {
+			const glm::vec3& a = vertices[indices[jx * 3]].Position;
+			const glm::vec3& b = vertices[indices[jx * 3 + 1]].Position;
+			const glm::vec3& c = vertices[indices[jx * 3 + 2]].Position;
+			glm::vec3 normal = glm::cross(b - a, c - a);
+			float triangleArea = glm::length(normal);
+			cluster.Center += (a + b + c) * (triangleArea / 3.0f);
+			cluster.Normal += normal;
+			area += triangleArea;
+		}
+		meshCenter += cluster.Center;
+		meshArea += area;
+		cluster.Center = area > 0.0f ? cluster.Center / area : vertices[indices[cluster.Start * 3]].Position;
+		clusters.push_back(cluster);
+	}
+	meshCenter = meshArea > 0.0f ? meshCenter / meshArea : glm::vec3(0.0f);
+
+	// Clusters that are far out from the center and facing away from it are likely to be in front of the rest
+	// of the mesh from wherever they can be seen, so we draw those first
+	for (auto& cluster : clusters) {
+		float length = glm::length(cluster.Normal);
+		cluster.Sort = length > 0.0f ? glm::dot(cluster.Center - meshCenter, cluster.Normal / length) : 0.0f;
+	}
+	std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster& a, const Cluster& b) {
+		return a.Sort > b.Sort;
+	});
+
+	std::vector<uint32_t> result;
+	result.reserve(triangleCount * 3);
+	for (const auto& cluster : clusters) {
+		result.insert(result.end(), indices + cluster.Start * 3, indices + cluster.End * 3);
+	}
+	std::copy(result.begin(), result.end(), indices);
+}
+
+std::vector<uint32_t> MeshOptimizer::OptimizeVertexFetch(std::vector<VertexPosNormTexColTangents>& vertices, std::vector<uint32_t>& indices) {
+	std::vector<uint32_t> remap(vertices.size(), (uint32_t)-1);
+	uint32_t next = 0;
+	for (uint32_t& index : indices) {
+		if (remap[index] == (uint32_t)-1) {
+			remap[index] = next++;
+		}
+		index = remap[index];
+	}
+
+	std::vector<VertexPosNormTexColTangents> result(next);
+	for (size_t ix = 0; ix < vertices.size(); ix++) {
+		if (remap[ix] != (uint32_t)-1) {
+			result[remap[ix]] = vertices[ix];
+		}
+	}
+	vertices.swap(result);
+	return remap;
+}
+
+float MeshOptimizer::CalculateAcmr(const uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize) {
+	size_t triangleCount = indexCount / 3;
+	if (triangleCount == 0) {
+		return 0.0f;
+	}
+
+	// Rather than keeping an actual queue, we note when each vertex entered the cache. A vertex is still in
+	// the cache if fewer than cacheSize other vertices have entered since
+	std::vector<uint32_t> timestamps(vertexCount, 0);
+	uint32_t time = cacheSize + 1;
+	uint32_t misses = 0;
+	for (size_t ix = 0; ix < triangleCount * 3; ix++) {
+		uint32_t vertex = indices[ix];
+		if (time - timestamps[vertex] > cacheSize) {
+			timestamps[vertex] = time++;
+			misses++;
+		}
+	}
+	return misses / (float)triangleCount;
+}
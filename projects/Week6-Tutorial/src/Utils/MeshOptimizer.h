@@ -0,0 +1,76 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+
+#include "Graphics/VertexTypes.h"
+
+/// <summary>
+/// Controls which stages the import pipeline runs on a mesh before it is written to the binary cache
+/// </summary>
+struct MeshOptimizerSettings {
+	// Reorder triangles so that vertices are re-used while they are still in the post-transform cache
+	bool  OptimizeVertexCache = true;
+	// Reorder clusters of triangles so that ones facing outwards are drawn first, and occlude the rest
+	bool  OptimizeOverdraw    = true;
+	// How much worse the vertex cache is allowed to get to make smaller clusters for the overdraw stage
+	float OverdrawThreshold   = 1.05f;
+	// Reorder vertices into the order they are first used by the indices, so fetches walk through memory
+	bool  OptimizeVertexFetch = true;
+	// Store vertices as VertexPosNormTexColTangentsPacked instead of full floats
+	bool  QuantizeVertices    = true;
+	// Store indices as 16 bits when the mesh has few enough vertices
+	bool  CompactIndices      = true;
+};
+
+/// <summary>
+/// Reorders the triangles and vertices of a mesh to make better use of the GPU when drawing it. These only
+/// change the order things are stored in, the mesh looks identical afterwards
+///
+/// The vertex cache pass uses Tom Forsyth's "Linear-Speed Vertex Cache Optimisation", and the overdraw pass
+/// follows Sander, Nehab and Barczak's "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw"
+/// </summary>
+class MeshOptimizer {
+public:
+	/// <summary>
+	/// Reorders the triangles in a triangle list to reduce the number of vertices that need to be transformed
+	/// more than once
+	/// </summary>
+	/// <param name="indices">The triangle list to reorder in place</param>
+	/// <param name="indexCount">The number of indices in the triangle list</param>
+	/// <param name="vertexCount">The number of vertices referenced by the list</param>
+	static void OptimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount);
+
+	/// <summary>
+	/// Splits a triangle list that has already been optimized for the vertex cache into clusters, and sorts
+	/// the clusters so that the ones on the outside of the mesh are drawn first
+	/// </summary>
+	/// <param name="indices">The triangle list to reorder in place</param>
+	/// <param name="indexCount">The number of indices in the triangle list</param>
+	/// <param name="vertices">The vertices of the mesh</param>
+	/// <param name="vertexCount">The number of vertices in the mesh</param>
+	/// <param name="threshold">How much the ACMR of the list is allowed to grow, ex: 1.05 allows it to be 5% worse</param>
+	static void OptimizeOverdraw(uint32_t* indices, size_t indexCount, const VertexPosNormTexColTangents* vertices, size_t vertexCount, float threshold = 1.05f);
+
+	/// <summary>
+	/// Reorders vertices into the order they are first referenced by a triangle list, and drops any that are
+	/// never used. The indices are updated to match the new order
+	/// </summary>
+	/// <param name="vertices">The vertices to reorder in place, this will be resized to the number of vertices in use</param>
+	/// <param name="indices">The triangle list to determine the order from</param>
+	/// <returns>A table from old vertex indices to new ones, for updating other lists that share the vertices (unused vertices map to -1)</returns>
+	static std::vector<uint32_t> OptimizeVertexFetch(std::vector<VertexPosNormTexColTangents>& vertices, std::vector<uint32_t>& indices);
+
+	/// <summary>
+	/// Calculates the average cache miss ratio (transformed vertices per triangle) of a triangle list, by
+	/// simulating a FIFO cache. Lower is better, 0.5 is the best a regular grid can do and 3 is the worst
+	/// </summary>
+	/// <param name="indices">The triangle list to measure</param>
+	/// <param name="indexCount">The number of indices in the triangle list</param>
+	/// <param name="vertexCount">The number of vertices referenced by the list</param>
+	/// <param name="cacheSize">The number of vertices the simulated cache holds</param>
+	static float CalculateAcmr(const uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize = 16);
+
+protected:
+	MeshOptimizer() = default;
+	~MeshOptimizer() = default;
+};
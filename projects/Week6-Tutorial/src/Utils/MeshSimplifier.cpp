@@ -0,0 +1,562 @@
+#include "Utils/MeshSimplifier.h"
+
+#include <queue>
+#include <unordered_map>
+#include <algorithm>
+#include <cstring>
+#include <cfloat>
+#include <cmath>
+
+// The number of dimensions that our quadrics measure error in, position (3) + normal (3) + UV (2)
+const int QUADRIC_DIMS = 8;
+
+/// <summary>
+/// Measures the sum of squared distances from a point to a set of planes in attribute space,
+/// as Q(v) = vAv + 2bv + c. A is symmetric, so we only store it's upper triangle
+/// </summary>
+struct Quadric {
+	double A[QUADRIC_DIMS * (QUADRIC_DIMS + 1) / 2];
+	double B[QUADRIC_DIMS];
+	double C;
+
+	Quadric() {
+		std::fill(std::begin(A), std::end(A), 0.0);
+		std::fill(std::begin(B), std::end(B), 0.0);
+		C = 0.0;
+	}
+
+	void Add(const Quadric& other) {
+		for (int ix = 0; ix < std::size(A); ix++) {
+			A[ix] += other.A[ix];
+		}
+		for (int ix = 0; ix < QUADRIC_DIMS; ix++) {
+			B[ix] += other.B[ix];
+		}
+		C += other.C;
+	}
+
+	double Evaluate(const double* v) const {
+		double result = C;
+		int ix = 0;
+		for (int row = 0; row < QUADRIC_DIMS; row++) {
+			result += A[ix++] * v[row] * v[row];
+			for (int col = row + 1; col < QUADRIC_DIMS; col++) {
+				result += 2.0 * A[ix++] * v[row] * v[col];
+			}
+			result += 2.0 * B[row] * v[row];
+		}
+		return result;
+	}
+};
+
+/// <summary>
+/// A candidate edge collapse, moving the welded position From onto To
+/// </summary>
+struct Collapse {
+	double   Cost;
+	uint32_t From;
+	uint32_t To;
+	// The version of From when this was calculated, if it has changed since the collapse is stale
+	uint32_t Version;
+
+	// Flipped so that std::priority_queue gives us the cheapest collapse first
+	bool operator <(const Collapse& other) const { return Cost > other.Cost; }
+};
+
+struct PositionHash {
+	size_t operator()(const glm::vec3& position) const {
+		uint32_t bits[3];
+		memcpy(bits, &position, sizeof(bits));
+		return (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+	}
+};
+
+static double __Dot(const double* a, const double* b) {
+	double result = 0.0;
+	for (int ix = 0; ix < QUADRIC_DIMS; ix++) {
+		result += a[ix] * b[ix];
+	}
+	return result;
+}
+
+// Makes a quadric measuring the squared distance to the plane of a triangle in attribute space
+// See section 4 of Garland and Heckbert's paper for the derivation
+static Quadric __TriangleQuadric(const double* p0, const double* p1, const double* p2, double weight) {
+	Quadric result;
+
+	// Find an orthonormal basis for the plane, with e1 along p0->p1 and e2 perpendicular to it
+	double e1[QUADRIC_DIMS], e2[QUADRIC_DIMS];
+	for (int ix = 0; ix < QUADRIC_DIMS; ix++) {
+		e1[ix] = p1[ix] - p0[ix];
+		e2[ix] = p2[ix] - p0[ix];
+	}
+	double length = std::sqrt(__Dot(e1, e1));
+	if (length < 1e-12) {
+		return result;
+	}
+	for (int ix = 0; ix < QUADRIC_DIMS; ix++) {
+		e1[ix] /= length;
+	}
+	double along = __Dot(e2, e1);
+	for (int ix = 0; ix < QUADRIC_DIMS; ix++) {
+		e2[ix] -= e1[ix] * along;
+	}
+	length = std::sqrt(__Dot(e2, e2));
+	if (length < 1e-12) {
+		return result;
+	}
+	for (int ix = 0; ix < QUADRIC_DIMS; ix++) {
+		e2[ix] /= length;
+	}
+
+	double p0e1 = __Dot(p0, e1);
+	double p0e2 = __Dot(p0, e2);
+	int ix = 0;
+	for (int row = 0; row < QUADRIC_DIMS; row++) {
+		for (int col = row; col < QUADRIC_DIMS; col++) {
+			result.A[ix++] = weight * ((row == col ? 1.0 : 0.0) - e1[row] * e1[col] - e2[row] * e2[col]);
+		}
+		result.B[row] = weight * (p0e1 * e1[row] + p0e2 * e2[row] - p0[row]);
+	}
+	result.C = weight * (__Dot(p0, p0) - p0e1 * p0e1 - p0e2 * p0e2);
+	return result;
+}
+
+/// <summary>
+/// Holds the working state of a mesh while it is being simplified. Simplification is progressive,
+/// each call to Simplify continues from where the last one left off
+///
+/// Collapses are done between welded positions rather than vertices, so that all the vertices at a
+/// seam or hard edge move together. Each vertex at the source position moves onto the vertex at the
+/// destination that it shares a triangle with, or failing that, the one with the closest attributes
+/// </summary>
+class SimplifierState {
+public:
+	SimplifierState(const VertexPosNormTexColTangents* vertices, size_t vertexCount, const uint32_t* indices, size_t indexCount, const glm::vec4& sphere, const MeshSimplifierSettings& settings);
+
+	/// <summary>
+	/// Collapses edges until there are at most targetTriangles left, or the next collapse would exceed maxError
+	/// </summary>
+	void Simplify(size_t targetTriangles, float maxError);
+	/// <summary>
+	/// Gets the triangle list of the mesh in it's current state
+	/// </summary>
+	std::vector<uint32_t> GetIndices() const;
+
+	size_t GetTriangleCount() const { return _triangleCount; }
+	float GetError() const { return (float)std::sqrt(_maxCost); }
+
+private:
+	// Each vertex's attributes, normalized so that the mesh fits in a unit sphere, QUADRIC_DIMS per vertex
+	std::vector<double>   _attributes;
+	std::vector<Quadric>  _quadrics;
+	// The welded position of each vertex
+	std::vector<uint32_t> _weld;
+
+	// These are all per welded position. Positions on open borders or non-manifold edges are locked
+	std::vector<uint32_t> _versions;
+	std::vector<bool>     _removed;
+	std::vector<bool>     _locked;
+	// The triangles that touch each welded position
+	std::vector<std::vector<uint32_t>> _adjacency;
+
+	std::vector<uint32_t> _triangles;
+	std::vector<bool>     _triangleRemoved;
+	size_t                _triangleCount;
+
+	std::priority_queue<Collapse> _queue;
+	double                _maxCost;
+
+	// Maps vertices at the source of a collapse to vertices at the destination
+	typedef std::vector<std::pair<uint32_t, uint32_t>> VertexMapping;
+
+	const double* _Attributes(uint32_t vertex) const { return &_attributes[vertex * (size_t)QUADRIC_DIMS]; }
+	glm::dvec3 _Position(uint32_t vertex) const { const double* a = _Attributes(vertex); return glm::dvec3(a[0], a[1], a[2]); }
+	bool _Contains(uint32_t triangle, uint32_t weld) const;
+
+	void _UpdatePosition(uint32_t weld);
+	bool _CanCollapse(uint32_t from, uint32_t to) const;
+	double _PlanCollapse(uint32_t from, uint32_t to, VertexMapping& mapping) const;
+	void _Collapse(const Collapse& collapse);
+};
+
+SimplifierState::SimplifierState(const VertexPosNormTexColTangents* vertices, size_t vertexCount, const uint32_t* indices, size_t indexCount, const glm::vec4& sphere, const MeshSimplifierSettings& settings) :
+	_triangleCount(0),
+	_maxCost(0.0)
+{
+	double radius = glm::max(sphere.w, 1e-6f);
+
+	_attributes.resize(vertexCount * QUADRIC_DIMS);
+	for (size_t ix = 0; ix < vertexCount; ix++) {
+		const VertexPosNormTexColTangents& vertex = vertices[ix];
+		glm::dvec3 position = (glm::dvec3(vertex.Position) - glm::dvec3(sphere)) / radius;
+		glm::dvec3 normal = glm::dvec3(vertex.Normal);
+		normal = glm::length(normal) > 0.0 ? glm::normalize(normal) : normal;
+
+		double* attributes = &_attributes[ix * QUADRIC_DIMS];
+		attributes[0] = position.x;
+		attributes[1] = position.y;
+		attributes[2] = position.z;
+		attributes[3] = normal.x * settings.NormalWeight;
+		attributes[4] = normal.y * settings.NormalWeight;
+		attributes[5] = normal.z * settings.NormalWeight;
+		attributes[6] = vertex.UV.x * settings.UvWeight;
+		attributes[7] = vertex.UV.y * settings.UvWeight;
+	}
+
+	// Weld vertices by position
+	std::unordered_map<glm::vec3, uint32_t, PositionHash> positionIds;
+	_weld.resize(vertexCount);
+	for (size_t ix = 0; ix < vertexCount; ix++) {
+		// Adding 0 turns -0 into +0, so they hash the same
+		glm::vec3 key = vertices[ix].Position + 0.0f;
+		auto it = positionIds.emplace(key, (uint32_t)positionIds.size()).first;
+		_weld[ix] = it->second;
+	}
+	size_t positionCount = positionIds.size();
+	_adjacency.resize(positionCount);
+
+	// Copy in our triangles, dropping any that are already degenerate
+	_triangles.reserve(indexCount);
+	for (size_t ix = 0; ix + 2 < indexCount; ix += 3) {
+		uint32_t a = indices[ix], b = indices[ix + 1], c = indices[ix + 2];
+		if (a >= vertexCount || b >= vertexCount || c >= vertexCount ||
+			_weld[a] == _weld[b] || _weld[b] == _weld[c] || _weld[a] == _weld[c]) {
+			continue;
+		}
+		uint32_t triangle = (uint32_t)(_triangles.size() / 3);
+		_triangles.push_back(a);
+		_triangles.push_back(b);
+		_triangles.push_back(c);
+		_adjacency[_weld[a]].push_back(triangle);
+		_adjacency[_weld[b]].push_back(triangle);
+		_adjacency[_weld[c]].push_back(triangle);
+	}
+	_triangleCount = _triangles.size() / 3;
+	_triangleRemoved.resize(_triangleCount, false);
+
+	// Edges that only have one triangle are on a border, and ones with more than 2 are non-manifold,
+	// neither can be collapsed safely so we lock their ends
+	_locked.resize(positionCount, false);
+	std::unordered_map<uint64_t, uint32_t> edgeCounts;
+	for (size_t ix = 0; ix < _triangles.size(); ix += 3) {
+		for (int corner = 0; corner < 3; corner++) {
+			uint64_t a = _weld[_triangles[ix + corner]];
+			uint64_t b = _weld[_triangles[ix + (corner + 1) % 3]];
+			edgeCounts[(glm::min(a, b) << 32) | glm::max(a, b)]++;
+		}
+	}
+	for (const auto& [edge, count] : edgeCounts) {
+		if (count != 2) {
+			_locked[edge >> 32] = true;
+			_locked[edge & 0xFFFFFFFF] = true;
+		}
+	}
+
+	// Every vertex starts with the quadrics of the triangles around it, weighted by their area so
+	// that lots of small triangles don't outweigh a few large ones
+	_quadrics.resize(vertexCount);
+	for (size_t ix = 0; ix < _triangles.size(); ix += 3) {
+		uint32_t a = _triangles[ix], b = _triangles[ix + 1], c = _triangles[ix + 2];
+		double area = glm::length(glm::cross(_Position(b) - _Position(a), _Position(c) - _Position(a))) * 0.5;
+		Quadric quadric = __TriangleQuadric(_Attributes(a), _Attributes(b), _Attributes(c), area);
+		_quadrics[a].Add(quadric);
+		_quadrics[b].Add(quadric);
+		_quadrics[c].Add(quadric);
+	}
+
+	_versions.resize(positionCount, 0);
+	_removed.resize(positionCount, false);
+	for (uint32_t ix = 0; ix < positionCount; ix++) {
+		_UpdatePosition(ix);
+	}
+}
+
+void SimplifierState::Simplify(size_t targetTriangles, float maxError) {
+	double maxCost = (double)maxError * maxError;
+	while (_triangleCount > targetTriangles && !_queue.empty()) {
+		Collapse collapse = _queue.top();
+		if (_removed[collapse.From] || collapse.Version != _versions[collapse.From]) {
+			_queue.pop();
+			continue;
+		}
+		// Everything left in the queue costs at least this much, leave it for a later call with a higher limit
+		if (collapse.Cost > maxCost) {
+			break;
+		}
+		_queue.pop();
+		_Collapse(collapse);
+	}
+}
+
+std::vector<uint32_t> SimplifierState::GetIndices() const {
+	std::vector<uint32_t> result;
+	result.reserve(_triangleCount * 3);
+	for (size_t ix = 0; ix < _triangleRemoved.size(); ix++) {
+		if (!_triangleRemoved[ix]) {
+			result.push_back(_triangles[ix * 3]);
+			result.push_back(_triangles[ix * 3 + 1]);
+			result.push_back(_triangles[ix * 3 + 2]);
+		}
+	}
+	return result;
+}
+
+bool SimplifierState::_Contains(uint32_t triangle, uint32_t weld) const {
+	return
+		_weld[_triangles[triangle * 3]] == weld ||
+		_weld[_triangles[triangle * 3 + 1]] == weld ||
+		_weld[_triangles[triangle * 3 + 2]] == weld;
+}
+
+void SimplifierState::_UpdatePosition(uint32_t weld) {
+	// Bumping the version invalidates any collapses for this position that are still in the queue
+	_versions[weld]++;
+	if (_removed[weld] || _locked[weld]) {
+		return;
+	}
+
+	Collapse best = { DBL_MAX, weld, weld, _versions[weld] };
+	VertexMapping mapping;
+	std::vector<uint32_t> checked;
+	for (uint32_t triangle : _adjacency[weld]) {
+		if (_triangleRemoved[triangle]) {
+			continue;
+		}
+		for (int corner = 0; corner < 3; corner++) {
+			uint32_t other = _weld[_triangles[triangle * 3 + corner]];
+			if (other == weld || std::find(checked.begin(), checked.end(), other) != checked.end()) {
+				continue;
+			}
+			checked.push_back(other);
+
+			double cost = _PlanCollapse(weld, other, mapping);
+			if (cost < best.Cost && _CanCollapse(weld, other)) {
+				best.Cost = cost;
+				best.To = other;
+			}
+		}
+	}
+
+	if (best.To != weld) {
+		_queue.push(best);
+	}
+}
+
+bool SimplifierState::_CanCollapse(uint32_t from, uint32_t to) const {
+	// Positions that share a triangle with the edge, and all the positions around the source
+	int oppositeCount = 0;
+	std::vector<uint32_t> fromNeighbours;
+
+	glm::dvec3 destination;
+	for (uint32_t triangle : _adjacency[to]) {
+		if (!_triangleRemoved[triangle]) {
+			for (int corner = 0; corner < 3; corner++) {
+				if (_weld[_triangles[triangle * 3 + corner]] == to) {
+					destination = _Position(_triangles[triangle * 3 + corner]);
+				}
+			}
+			break;
+		}
+	}
+
+	for (uint32_t triangle : _adjacency[from]) {
+		if (_triangleRemoved[triangle]) {
+			continue;
+		}
+		const uint32_t* corners = &_triangles[triangle * 3];
+		if (_Contains(triangle, to)) {
+			oppositeCount++;
+		} else {
+			// Make sure that moving this position doesn't fold any of the remaining triangles over
+			glm::dvec3 positions[3] = { _Position(corners[0]), _Position(corners[1]), _Position(corners[2]) };
+			glm::dvec3 before = glm::cross(positions[1] - positions[0], positions[2] - positions[0]);
+			for (int corner = 0; corner < 3; corner++) {
+				if (_weld[corners[corner]] == from) {
+					positions[corner] = destination;
+				}
+			}
+			glm::dvec3 after = glm::cross(positions[1] - positions[0], positions[2] - positions[0]);
+			if (glm::dot(after, after) < 1e-20 || glm::dot(before, after) <= 0.0) {
+				return false;
+			}
+		}
+		for (int corner = 0; corner < 3; corner++) {
+			uint32_t weld = _weld[corners[corner]];
+			if (weld != from && weld != to && std::find(fromNeighbours.begin(), fromNeighbours.end(), weld) == fromNeighbours.end()) {
+				fromNeighbours.push_back(weld);
+			}
+		}
+	}
+
+	// The link condition: the only positions next to both ends should be the ones across the edge's
+	// triangles, otherwise the collapse would pinch the surface into a non-manifold shape
+	std::vector<uint32_t> shared;
+	for (uint32_t triangle : _adjacency[to]) {
+		if (_triangleRemoved[triangle]) {
+			continue;
+		}
+		for (int corner = 0; corner < 3; corner++) {
+			uint32_t weld = _weld[_triangles[triangle * 3 + corner]];
+			if (weld != from && weld != to &&
+				std::find(fromNeighbours.begin(), fromNeighbours.end(), weld) != fromNeighbours.end() &&
+				std::find(shared.begin(), shared.end(), weld) == shared.end()) {
+				shared.push_back(weld);
+			}
+		}
+	}
+	return oppositeCount == 2 && shared.size() == 2;
+}
+
+double SimplifierState::_PlanCollapse(uint32_t from, uint32_t to, VertexMapping& mapping) const {
+	mapping.clear();
+
+	// Gather the vertices in use at either end, and pair up the ones that share a triangle along the edge
+	std::vector<uint32_t> destinations;
+	for (uint32_t triangle : _adjacency[to]) {
+		if (_triangleRemoved[triangle]) {
+			continue;
+		}
+		for (int corner = 0; corner < 3; corner++) {
+			uint32_t vertex = _triangles[triangle * 3 + corner];
+			if (_weld[vertex] == to && std::find(destinations.begin(), destinations.end(), vertex) == destinations.end()) {
+				destinations.push_back(vertex);
+			}
+		}
+	}
+	for (uint32_t triangle : _adjacency[from]) {
+		if (_triangleRemoved[triangle]) {
+			continue;
+		}
+		uint32_t source = UINT32_MAX, partner = UINT32_MAX;
+		for (int corner = 0; corner < 3; corner++) {
+			uint32_t vertex = _triangles[triangle * 3 + corner];
+			source  = _weld[vertex] == from ? vertex : source;
+			partner = _weld[vertex] == to ? vertex : partner;
+		}
+		auto it = std::find_if(mapping.begin(), mapping.end(), [&](const auto& pair) { return pair.first == source; });
+		if (it == mapping.end()) {
+			mapping.push_back({ source, partner });
+		} else if (it->second == UINT32_MAX) {
+			it->second = partner;
+		}
+	}
+
+	double cost = 0.0;
+	std::vector<uint32_t> targets;
+	for (auto& [source, target] : mapping) {
+		// Vertices that don't touch the edge take on whichever destination vertex fits them best
+		if (target == UINT32_MAX) {
+			double best = DBL_MAX;
+			for (uint32_t destination : destinations) {
+				double error = _quadrics[source].Evaluate(_Attributes(destination));
+				if (error < best) {
+					best = error;
+					target = destination;
+				}
+			}
+		}
+		// The moved vertex takes on the attributes of it's target, so that's where we measure the error
+		cost += glm::max(_quadrics[source].Evaluate(_Attributes(target)), 0.0);
+		if (std::find(targets.begin(), targets.end(), target) == targets.end()) {
+			targets.push_back(target);
+			cost += glm::max(_quadrics[target].Evaluate(_Attributes(target)), 0.0);
+		}
+	}
+	return cost;
+}
+
+void SimplifierState::_Collapse(const Collapse& collapse) {
+	VertexMapping mapping;
+	_PlanCollapse(collapse.From, collapse.To, mapping);
+
+	for (uint32_t triangle : _adjacency[collapse.From]) {
+		if (_triangleRemoved[triangle]) {
+			continue;
+		}
+		// Triangles along the edge disappear, the rest get moved onto the destination
+		if (_Contains(triangle, collapse.To)) {
+			_triangleRemoved[triangle] = true;
+			_triangleCount--;
+		} else {
+			for (int corner = 0; corner < 3; corner++) {
+				uint32_t& vertex = _triangles[triangle * 3 + corner];
+				if (_weld[vertex] == collapse.From) {
+					vertex = std::find_if(mapping.begin(), mapping.end(), [&](const auto& pair) { return pair.first == vertex; })->second;
+				}
+			}
+			_adjacency[collapse.To].push_back(triangle);
+		}
+	}
+	for (const auto& [source, target] : mapping) {
+		_quadrics[target].Add(_quadrics[source]);
+	}
+	_adjacency[collapse.From].clear();
+	_removed[collapse.From] = true;
+	_maxCost = glm::max(_maxCost, collapse.Cost);
+
+	// Drop the dead triangles from the destination's list while we're here
+	std::vector<uint32_t>& adjacency = _adjacency[collapse.To];
+	adjacency.erase(std::remove_if(adjacency.begin(), adjacency.end(), [&](uint32_t triangle) { return _triangleRemoved[triangle]; }), adjacency.end());
+
+	// Everything around the destination has a new neighbourhood or new quadrics to collapse onto
+	std::vector<uint32_t> updated;
+	for (uint32_t triangle : adjacency) {
+		for (int corner = 0; corner < 3; corner++) {
+			uint32_t weld = _weld[_triangles[triangle * 3 + corner]];
+			if (std::find(updated.begin(), updated.end(), weld) == updated.end()) {
+				updated.push_back(weld);
+				_UpdatePosition(weld);
+			}
+		}
+	}
+}
+
+std::vector<MeshSimplifier::Level> MeshSimplifier::GenerateLods(const VertexPosNormTexColTangents* vertices, size_t vertexCount, const uint32_t* indices, size_t indexCount, const MeshSimplifierSettings& settings) {
+	std::vector<Level> result;
+	if (vertexCount == 0 || indexCount < 3) {
+		return result;
+	}
+
+	SimplifierState state(vertices, vertexCount, indices, indexCount, CalculateBoundingSphere(vertices, vertexCount), settings);
+
+	size_t previous = state.GetTriangleCount();
+	for (uint32_t level = 0; level < settings.MaxLevels; level++) {
+		if (previous <= settings.MinTriangles) {
+			break;
+		}
+		size_t target = glm::max((size_t)(previous * settings.Reduction), (size_t)settings.MinTriangles);
+		state.Simplify(target, settings.MaxError);
+
+		// If we hit the error limit (or ran out of edges) before making a real dent, this level isn't worth the memory
+		if (state.GetTriangleCount() > previous - (previous - target) / 2) {
+			break;
+		}
+
+		result.push_back({ state.GetIndices(), state.GetError() });
+		previous = state.GetTriangleCount();
+	}
+	return result;
+}
+
+glm::vec4 MeshSimplifier::CalculateBoundingSphere(const VertexPosNormTexColTangents* vertices, size_t vertexCount) {
+	if (vertexCount == 0) {
+		return glm::vec4(0.0f);
+	}
+
+	// Centering on the bounding box isn't the tightest fit, but it's close and cheap
+	glm::vec3 min = vertices[0].Position;
+	glm::vec3 max = vertices[0].Position;
+	for (size_t ix = 1; ix < vertexCount; ix++) {
+		min = glm::min(min, vertices[ix].Position);
+		max = glm::max(max, vertices[ix].Position);
+	}
+	glm::vec3 center = (min + max) * 0.5f;
+
+	float radiusSq = 0.0f;
+	for (size_t ix = 0; ix < vertexCount; ix++) {
+		glm::vec3 offset = vertices[ix].Position - center;
+		radiusSq = glm::max(radiusSq, glm::dot(offset, offset));
+	}
+	return glm::vec4(center, glm::sqrt(radiusSq));
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+
+#include <GLM/glm.hpp>
+
+#include "Graphics/VertexArrayObject.h"
+#include "Graphics/VertexTypes.h"
+
+/// <summary>
+/// A simplified version of a mesh, ready for rendering. All the levels of a mesh share the
+/// same vertex buffer, and only differ in their index buffers
+/// </summary>
+struct MeshLod {
+	// The VAO to draw for this level
+	VertexArrayObject::Sptr Mesh;
+	// How far this level strays from the full detail mesh, relative to the radius of the mesh's bounding sphere
+	float                   Error;
+};
+
+/// <summary>
+/// Controls how many levels are made, and how far they are allowed to simplify the mesh
+/// </summary>
+struct MeshSimplifierSettings {
+	// The most levels to generate, not counting the full detail mesh
+	uint32_t MaxLevels    = 4;
+	// The fraction of triangles each level keeps from the level before it
+	float    Reduction    = 0.5f;
+	// Levels are not generated below this many triangles
+	uint32_t MinTriangles = 32;
+	// Simplification stops once the error reaches this, relative to the radius of the bounding sphere
+	float    MaxError     = 0.25f;
+	// How much a change in normal or UV costs, relative to moving the surface by the bounding radius
+	float    NormalWeight = 0.25f;
+	float    UvWeight     = 0.5f;
+};
+
+/// <summary>
+/// Generates level of detail chains for meshes by collapsing edges in the order of their quadric error
+/// (see Garland and Heckbert, "Simplifying Surfaces with Color and Texture using Quadric Error Metrics")
+///
+/// The quadrics are built over the position, normal and UV of each vertex, so collapses that would smear
+/// the texture or flatten hard edges cost more than ones that only move the surface. Collapses only ever
+/// move a vertex onto one of it's neighbours, so no new vertices are made and every level can be drawn
+/// from the original vertex buffer. Vertices on open borders and non-manifold edges are never removed.
+/// Seams (where vertices have the same position but different normals or UVs) are welded by position, so
+/// all the vertices at a seam collapse together and levels can't crack open along them, but seam vertices
+/// can still be removed
+/// </summary>
+class MeshSimplifier {
+public:
+	/// <summary>
+	/// A single simplified level, as indices into the source mesh's vertices
+	/// </summary>
+	struct Level {
+		std::vector<uint32_t> Indices;
+		// Relative to the radius of the mesh's bounding sphere
+		float                 Error;
+	};
+
+	/// <summary>
+	/// Generates a chain of progressively simpler versions of a triangle mesh. The full detail mesh is not
+	/// included in the result, and the chain may be shorter than MaxLevels (or empty) if the mesh can't be
+	/// reduced any further within the error limit
+	/// </summary>
+	/// <param name="vertices">The vertices of the mesh</param>
+	/// <param name="vertexCount">The number of vertices in the mesh</param>
+	/// <param name="indices">The triangle list to simplify</param>
+	/// <param name="indexCount">The number of indices in the triangle list</param>
+	/// <param name="settings">The settings for generating the chain</param>
+	/// <returns>The simplified levels, from most to least detailed</returns>
+	static std::vector<Level> GenerateLods(const VertexPosNormTexColTangents* vertices, size_t vertexCount, const uint32_t* indices, size_t indexCount, const MeshSimplifierSettings& settings = MeshSimplifierSettings());
+
+	/// <summary>
+	/// Calculates a sphere that encloses all the given vertices
+	/// </summary>
+	/// <returns>The center of the sphere (xyz) and it's radius (w)</returns>
+	static glm::vec4 CalculateBoundingSphere(const VertexPosNormTexColTangents* vertices, size_t vertexCount);
+
+protected:
+	MeshSimplifier() = default;
+	~MeshSimplifier() = default;
+};
@@ -1,14 +1,19 @@
 #include "Utils/OptimizedObjLoader.h"
 
-#include "ObjLoader.h"
+#include "Utils/FastObjParser.h"
+#include "Utils/MeshFactory.h"
 
 #include <string>
 #include <sstream>
 #include <fstream>
 #include <iostream>
 #include <filesystem>
+#include <unordered_map>
+#include <cstring>
+#include <cstddef>
 
 #include "Utils/StringUtils.h"
+#include "Utils/ImportCache.h"
 #include "GLFW/glfw3.h"
 #include "Logging.h"
 
@@ -17,7 +22,24 @@ const std::string binaryExtension = ".bin";
 
 namespace fs = std::filesystem;
 
-VertexArrayObject::Sptr OptimizedObjLoader::LoadFromFile(const std::string& filename) {
+/// <summary>
+/// Makes a stable string out of the optimizer settings, so that changing them gives the import a new cache key
+/// </summary>
+inline std::string __SettingsKey(const MeshOptimizerSettings& settings) {
+	std::stringstream stream;
+	stream << settings.OptimizeVertexCache << settings.OptimizeOverdraw << settings.OverdrawThreshold
+		<< settings.OptimizeVertexFetch << settings.QuantizeVertices << settings.CompactIndices;
+	return stream.str();
+}
+
+/// <summary>
+/// Rounds an offset up to the next multiple of alignment
+/// </summary>
+inline size_t __Align(size_t offset, size_t alignment) {
+	return (offset + alignment - 1) / alignment * alignment;
+}
+
+VertexArrayObject::Sptr OptimizedObjLoader::LoadFromFile(const std::string& filename, MeshFileInfo* info) {
 	// Get the file extension and lowercase it
 	fs::path filePath = std::filesystem::path(filename);
 	std::string extension = filePath.extension().string();
@@ -25,18 +47,24 @@ VertexArrayObject::Sptr OptimizedObjLoader::LoadFromFile(const std::string& file
 
 	// Load regular 'ol OBJ files
 	if (extension == ".obj") {
-		// Get the binary path
-		fs::path binPath = filePath.replace_extension(binaryExtension);
-		// If the file does not exist, convert the OBJ file to a binary file
-		if (!fs::exists(binPath)) {
-			ConvertToBinary(filename, binPath.string());
+		// The converted mesh lives in the import cache, keyed by the OBJ's contents, our version and our settings
+		std::string key = ImportCache::MakeKey("mesh", IMPORTER_VERSION, ImportCache::HashFile(filename), __SettingsKey(MeshOptimizerSettings()));
+		std::string binPath;
+		if (!ImportCache::TryGet(key, binPath)) {
+			binPath = ImportCache::GetPath(key);
+			ConvertToBinary(filename, binPath);
+			ImportCache::Commit(key, filename);
 		}
-		// Load the corresponding binary file
-		return _LoadFromBinFile(binPath.string());
-	} 
+		// Load the corresponding binary file, if it's been corrupted we toss it so the next load will import it again
+		VertexArrayObject::Sptr result = _LoadFromBinFile(binPath, info);
+		if (result == nullptr) {
+			ImportCache::Remove(key);
+		}
+		return result;
+	}
 	// Load our fancy binary files
 	else if (extension == ".bin") {
-		return _LoadFromBinFile(filename);
+		return _LoadFromBinFile(filename, info);
 	}
 	// We've never met this extension in our life
 	else {
@@ -45,15 +73,28 @@ VertexArrayObject::Sptr OptimizedObjLoader::LoadFromFile(const std::string& file
 	}
 }
 
-void OptimizedObjLoader::ConvertToBinary(const std::string& inFile, const std::string& outFile) {
-	// Load in the input file
-	MeshBuilder<VertexPosNormTexColTangents>* mesh = _LoadFromObjFile(inFile);
-
+void OptimizedObjLoader::ConvertToBinary(const std::string& inFile, const std::string& outFile, const MeshOptimizerSettings& settings) {
 	float startTime = static_cast<float>(glfwGetTime());
 
+	// Map in the input file (or read it out of a pack), we hash it's contents so we can tell if it changes later
+	VfsFile::Sptr source = VirtualFileSystem::Open(inFile);
+	if (source == nullptr) {
+		LOG_ERROR("Failed to open OBJ file \"{}\"", inFile);
+		return;
+	}
+	uint64_t sourceHash = ImportCache::HashBytes(source->GetData(), source->GetSize());
+
+	// Large OBJ files can take a long time to parse with streams, so we hand them off to the multithreaded parser
+	std::vector<ObjMaterialRange> materialRanges;
+	MeshBuilder<VertexPosNormTexColTangents>* mesh = FastObjParser::Parse(reinterpret_cast<const char*>(source->GetData()), source->GetSize(), 0, true, &materialRanges);
+	source = nullptr;
+
+	float parseTime = static_cast<float>(glfwGetTime());
+	LOG_TRACE("Loaded OBJ file \"{}\" in {} seconds ({} vertices, {} indices)", inFile, parseTime - startTime, mesh->GetVertexCount(), mesh->GetIndexCount());
+
 	// If we didn't get an output path, just take the input and replace the extension
 	std::string outFileName = outFile;
-	if (outFileName.empty()) { 
+	if (outFileName.empty()) {
 		// Copy input path
 		auto path = std::filesystem::path(inFile);
 		// Change extension
@@ -62,17 +103,571 @@ void OptimizedObjLoader::ConvertToBinary(const std::string& inFile, const std::s
 		outFileName = path.string();
 	}
 
-	// Save the mesh to the file
-	SaveBinaryFile(*mesh, outFileName);
+	// Take a copy of the vertices, since the optimizer will be shuffling them around
+	std::vector<VertexPosNormTexColTangents> vertices(mesh->GetVertexDataPtr(), mesh->GetVertexDataPtr() + mesh->GetVertexCount());
+	const uint32_t* meshIndices = mesh->GetIndexDataPtr();
 
-	float endTime = static_cast<float>(glfwGetTime());
-	LOG_TRACE("Converted OBJ file to binary \"{}\" in {} seconds ({} vertices, {} indices)", inFile, endTime - startTime, mesh->GetVertexCount(), mesh->GetIndexCount());
+	// Gather the triangles for each material into a submesh, in the order the materials first appear
+	std::vector<std::string> materials;
+	std::vector<std::vector<uint32_t>> submeshIndices;
+	std::unordered_map<std::string, size_t> materialLookup;
+	if (materialRanges.empty() && mesh->GetIndexCount() > 0) {
+		materialRanges.push_back({ "", 0, static_cast<uint32_t>(mesh->GetIndexCount() / 3) });
+	}
+	for (const auto& range : materialRanges) {
+		auto it = materialLookup.find(range.Material);
+		if (it == materialLookup.end()) {
+			it = materialLookup.emplace(range.Material, materials.size()).first;
+			materials.push_back(range.Material);
+			submeshIndices.emplace_back();
+		}
+		std::vector<uint32_t>& indices = submeshIndices[it->second];
+		indices.insert(indices.end(), meshIndices + range.FirstTriangle * 3ull, meshIndices + (range.FirstTriangle + (size_t)range.TriangleCount) * 3ull);
+	}
 
 	// We no longer need the mesh data, free it
 	delete mesh;
+
+	// Each submesh gets it's own LOD chain, so that simplification never merges vertices across materials. Every
+	// chain is built from the whole vertex buffer, so the errors are all relative to the same bounding sphere
+	std::vector<std::vector<MeshSimplifier::Level>> submeshLods(submeshIndices.size());
+	size_t maxLods = 0;
+	for (size_t ix = 0; ix < submeshIndices.size(); ix++) {
+		submeshLods[ix] = MeshSimplifier::GenerateLods(vertices.data(), vertices.size(), submeshIndices[ix].data(), submeshIndices[ix].size());
+		maxLods = std::max(maxLods, submeshLods[ix].size());
+	}
+
+	// Reorder the triangles of every level for the vertex cache, then into clusters to reduce overdraw
+	auto optimizeLevel = [&](std::vector<uint32_t>& indices) {
+		if (settings.OptimizeVertexCache) {
+			MeshOptimizer::OptimizeVertexCache(indices.data(), indices.size(), vertices.size());
+		}
+		if (settings.OptimizeOverdraw) {
+			MeshOptimizer::OptimizeOverdraw(indices.data(), indices.size(), vertices.data(), vertices.size(), settings.OverdrawThreshold);
+		}
+	};
+	for (size_t ix = 0; ix < submeshIndices.size(); ix++) {
+		optimizeLevel(submeshIndices[ix]);
+		for (auto& level : submeshLods[ix]) {
+			optimizeLevel(level.Indices);
+		}
+	}
+
+	// Stitch the submeshes together into a single index list per level. Submeshes with shorter chains keep
+	// drawing their simplest level in the later ones
+	MeshFileInfo info;
+	info.Submeshes.resize(submeshIndices.size());
+	std::vector<MeshSimplifier::Level> levels(maxLods + 1);
+	for (size_t levelIx = 0; levelIx < levels.size(); levelIx++) {
+		MeshSimplifier::Level& level = levels[levelIx];
+		level.Error = 0.0f;
+		for (size_t ix = 0; ix < submeshIndices.size(); ix++) {
+			const auto& chain = submeshLods[ix];
+			const MeshSimplifier::Level* lod = nullptr;
+			if (levelIx > 0 && !chain.empty()) {
+				lod = &chain[std::min(levelIx, chain.size()) - 1];
+			}
+			const std::vector<uint32_t>& indices = lod != nullptr ? lod->Indices : submeshIndices[ix];
+			if (lod != nullptr) {
+				level.Error = std::max(level.Error, lod->Error);
+			}
+
+			info.Submeshes[ix].Ranges.push_back(glm::uvec2(level.Indices.size(), indices.size()));
+			level.Indices.insert(level.Indices.end(), indices.begin(), indices.end());
+		}
+	}
+	submeshIndices.clear();
+	submeshLods.clear();
+
+	// The vertex order follows the full detail mesh, since that's the one drawn up close. The LODs only
+	// ever use vertices that the full detail mesh uses, so they can be remapped to match
+	if (settings.OptimizeVertexFetch) {
+		std::vector<uint32_t> remap = MeshOptimizer::OptimizeVertexFetch(vertices, levels[0].Indices);
+		for (size_t levelIx = 1; levelIx < levels.size(); levelIx++) {
+			for (uint32_t& index : levels[levelIx].Indices) {
+				index = remap[index];
+			}
+		}
+	}
+
+	// Calculate the bounds of each submesh from the vertices it's full detail triangles use
+	std::vector<VertexPosNormTexColTangents> used;
+	std::vector<uint8_t> visited(vertices.size());
+	for (size_t ix = 0; ix < info.Submeshes.size(); ix++) {
+		Submesh& submesh = info.Submeshes[ix];
+		submesh.Material = materials[ix];
+
+		used.clear();
+		std::fill(visited.begin(), visited.end(), 0);
+		const glm::uvec2& range = submesh.Ranges[0];
+		for (uint32_t index = range.x; index < range.x + range.y; index++) {
+			uint32_t vertex = levels[0].Indices[index];
+			if (!visited[vertex]) {
+				visited[vertex] = 1;
+				used.push_back(vertices[vertex]);
+			}
+		}
+
+		submesh.BoundsMin = submesh.BoundsMax = used.empty() ? glm::vec3(0.0f) : used[0].Position;
+		for (const auto& vertex : used) {
+			submesh.BoundsMin = glm::min(submesh.BoundsMin, vertex.Position);
+			submesh.BoundsMax = glm::max(submesh.BoundsMax, vertex.Position);
+		}
+		submesh.BoundingSphere = MeshSimplifier::CalculateBoundingSphere(used.data(), used.size());
+	}
+	info.BoundsMin = info.BoundsMax = vertices.empty() ? glm::vec3(0.0f) : vertices[0].Position;
+	for (const auto& vertex : vertices) {
+		info.BoundsMin = glm::min(info.BoundsMin, vertex.Position);
+		info.BoundsMax = glm::max(info.BoundsMax, vertex.Position);
+	}
+	info.BoundingSphere = MeshSimplifier::CalculateBoundingSphere(vertices.data(), vertices.size());
+
+	// 16 bit indices halve the size of the index buffers, which is most meshes in practice
+	IndexType indexType = settings.CompactIndices && vertices.size() <= 0xFFFF ? IndexType::UShort : IndexType::UInt;
+
+	// Save the mesh to the file
+	if (settings.QuantizeVertices) {
+		std::vector<VertexPosNormTexColTangentsPacked> packed(vertices.begin(), vertices.end());
+		_WriteBinaryFile(outFileName, packed.data(), static_cast<uint32_t>(packed.size()), sizeof(VertexPosNormTexColTangentsPacked), VertexPosNormTexColTangentsPacked::V_DECL, levels, info, indexType, sourceHash);
+	} else {
+		_WriteBinaryFile(outFileName, vertices.data(), static_cast<uint32_t>(vertices.size()), sizeof(VertexPosNormTexColTangents), VertexPosNormTexColTangents::V_DECL, levels, info, indexType, sourceHash);
+	}
+
+	float endTime = static_cast<float>(glfwGetTime());
+	LOG_TRACE("Converted OBJ file to binary \"{}\" in {} seconds ({} vertices, {} indices, {} submeshes, {} LODs, ACMR {})", inFile, endTime - startTime, vertices.size(), levels[0].Indices.size(), info.Submeshes.size(), levels.size() - 1, MeshOptimizer::CalculateAcmr(levels[0].Indices.data(), levels[0].Indices.size(), vertices.size()));
+}
+
+void OptimizedObjLoader::_WriteBinaryFile(const std::string& outFilename, const void* vertices, uint32_t vertexCount, uint16_t vertexStride, const std::vector<BufferAttribute>& vertexDeclaration,
+										  const std::vector<MeshSimplifier::Level>& levels, const MeshFileInfo& info, IndexType indexType, uint64_t sourceHash) {
+	// Build up the small tables first, so we know how big every section is
+	MeshSection mesh;
+	mesh.NumVertices = vertexCount;
+	mesh.NumStreams = 1;
+	mesh.IndicesType = indexType;
+	mesh.NumLevels = static_cast<uint32_t>(levels.size());
+	mesh.NumSubmeshes = static_cast<uint32_t>(info.Submeshes.size());
+	mesh.BoundsMin = info.BoundsMin;
+	mesh.BoundsMax = info.BoundsMax;
+	mesh.BoundingSphere = info.BoundingSphere;
+
+	StreamDeclaration stream;
+	stream.Stride = vertexStride;
+	stream.NumAttributes = static_cast<uint32_t>(vertexDeclaration.size());
+
+	std::vector<LevelRecord> levelRecords(levels.size());
+	uint32_t indexCount = 0;
+	for (size_t ix = 0; ix < levels.size(); ix++) {
+		levelRecords[ix].IndexOffset = indexCount;
+		levelRecords[ix].IndexCount = static_cast<uint32_t>(levels[ix].Indices.size());
+		levelRecords[ix].Error = levels[ix].Error;
+		indexCount += levelRecords[ix].IndexCount;
+	}
+
+	std::string strings;
+	std::vector<SubmeshRecord> submeshRecords(info.Submeshes.size());
+	std::vector<glm::uvec2> ranges(levels.size() * info.Submeshes.size(), glm::uvec2(0));
+	for (size_t ix = 0; ix < info.Submeshes.size(); ix++) {
+		const Submesh& submesh = info.Submeshes[ix];
+		submeshRecords[ix].NameOffset = static_cast<uint32_t>(strings.size());
+		submeshRecords[ix].NameLength = static_cast<uint32_t>(submesh.Material.size());
+		submeshRecords[ix].BoundsMin = submesh.BoundsMin;
+		submeshRecords[ix].BoundsMax = submesh.BoundsMax;
+		submeshRecords[ix].BoundingSphere = submesh.BoundingSphere;
+		strings += submesh.Material;
+		// Ranges are stored level by level, so a level's ranges are contiguous
+		for (size_t levelIx = 0; levelIx < levels.size() && levelIx < submesh.Ranges.size(); levelIx++) {
+			ranges[levelIx * info.Submeshes.size() + ix] = submesh.Ranges[levelIx];
+		}
+	}
+
+	// Lay out the sections, each one starts on an aligned offset so they can be handed straight to OpenGL
+	struct PendingSection {
+		SectionHeader Header;
+		const void*   Data;
+	};
+	size_t indexSize = GetIndexTypeSize(indexType);
+	std::vector<PendingSection> sections = {
+		{ { { 'M', 'E', 'S', 'H' }, 0, 0, sizeof(MeshSection) }, &mesh },
+		{ { { 'V', 'D', 'C', 'L' }, 0, 0, sizeof(StreamDeclaration) + vertexDeclaration.size() * sizeof(BufferAttribute) }, nullptr },
+		{ { { 'V', 'E', 'R', 'T' }, 0, 0, (uint64_t)vertexCount * vertexStride }, vertices },
+		{ { { 'L', 'V', 'L', 'S' }, 0, 0, levelRecords.size() * sizeof(LevelRecord) }, levelRecords.data() },
+		{ { { 'I', 'N', 'D', 'X' }, 0, 0, (uint64_t)indexCount * indexSize }, nullptr },
+		{ { { 'S', 'U', 'B', 'M' }, 0, 0, submeshRecords.size() * sizeof(SubmeshRecord) }, submeshRecords.data() },
+		{ { { 'R', 'N', 'G', 'S' }, 0, 0, ranges.size() * sizeof(glm::uvec2) }, ranges.data() },
+		{ { { 'S', 'T', 'R', 'S' }, 0, 0, strings.size() }, strings.data() }
+	};
+	BinaryHeaderV2 header;
+	header.ImporterVersion = IMPORTER_VERSION;
+	header.SourceHash = sourceHash;
+	header.NumSections = static_cast<uint32_t>(sections.size());
+	size_t offset = sizeof(BinaryHeaderV2) + sections.size() * sizeof(SectionHeader);
+	for (auto& section : sections) {
+		offset = __Align(offset, SECTION_ALIGNMENT);
+		section.Header.Offset = offset;
+		offset += section.Header.Size;
+	}
+
+	// Open the output file
+	std::ofstream file(outFilename, std::ios::binary);
+	// If our file fails to open, we will throw an error
+	if (!file) { throw std::runtime_error("Failed to open file"); }
+
+	file.write(reinterpret_cast<const char*>(&header), sizeof(BinaryHeaderV2));
+	for (const auto& section : sections) {
+		file.write(reinterpret_cast<const char*>(&section.Header), sizeof(SectionHeader));
+	}
+
+	static const char padding[SECTION_ALIGNMENT] = { 0 };
+	for (const auto& section : sections) {
+		size_t position = static_cast<size_t>(file.tellp());
+		file.write(padding, section.Header.Offset - position);
+
+		if (memcmp(section.Header.Type, "VDCL", 4) == 0) {
+			file.write(reinterpret_cast<const char*>(&stream), sizeof(StreamDeclaration));
+			file.write(reinterpret_cast<const char*>(vertexDeclaration.data()), vertexDeclaration.size() * sizeof(BufferAttribute));
+		} else if (memcmp(section.Header.Type, "INDX", 4) == 0) {
+			for (const auto& level : levels) {
+				_WriteIndices(file, level.Indices.data(), level.Indices.size(), indexType);
+			}
+		} else if (section.Header.Size > 0) {
+			file.write(reinterpret_cast<const char*>(section.Data), section.Header.Size);
+		}
+	}
+}
+
+void OptimizedObjLoader::_WriteIndices(std::ofstream& file, const uint32_t* indices, size_t count, IndexType type) {
+	switch (type) {
+		case IndexType::UByte:
+		{
+			std::vector<uint8_t> narrowed(indices, indices + count);
+			file.write(reinterpret_cast<const char*>(narrowed.data()), narrowed.size() * sizeof(uint8_t));
+			break;
+		}
+		case IndexType::UShort:
+		{
+			std::vector<uint16_t> narrowed(indices, indices + count);
+			file.write(reinterpret_cast<const char*>(narrowed.data()), narrowed.size() * sizeof(uint16_t));
+			break;
+		}
+		case IndexType::UInt:
+			file.write(reinterpret_cast<const char*>(indices), count * sizeof(uint32_t));
+			break;
+		default:
+			throw std::runtime_error("Unsupported index type");
+	}
+}
+
+VertexArrayObject::Sptr OptimizedObjLoader::_LoadFromBinFile(const std::string& filename, MeshFileInfo* info) {
+	// Map the file into memory (or find it in a pack), the buffers are loaded straight from the mapping
+	VfsFile::Sptr file = VirtualFileSystem::Open(filename);
+	// If our file fails to open, we will throw an error
+	if (file == nullptr) { throw std::runtime_error("Failed to open file"); }
+
+	// Both versions start with the magic bytes and a version number
+	const size_t versionEnd = offsetof(BinaryHeader, Version) + sizeof(uint16_t);
+	if (file->GetSize() < versionEnd || memcmp(file->GetData(), HEADER_BYTES, 4) != 0) {
+		LOG_ERROR("\"{}\" is not a binary mesh file!", filename);
+		return nullptr;
+	}
+	uint16_t version = 0;
+	memcpy(&version, file->GetData() + offsetof(BinaryHeader, Version), sizeof(uint16_t));
+
+	// Handle our version
+	switch (version) {
+		case 0x01: return _LoadFromBinFileV1(filename, file, info);
+		case 0x02: return _LoadFromBinFileV2(filename, file, info);
+		default:
+			LOG_ERROR("Unsupported binary mesh version {} in \"{}\"", version, filename);
+			return nullptr;
+	}
+}
+
+VertexArrayObject::Sptr OptimizedObjLoader::_LoadFromBinFileV1(const std::string& filename, const VfsFile::Sptr& file, MeshFileInfo* info) {
+	float startTime = static_cast<float>(glfwGetTime());
+
+	const uint8_t* data = file->GetData();
+	size_t size = file->GetSize();
+
+	// Read the header from the file
+	BinaryHeader header = BinaryHeader();
+	if (size >= sizeof(BinaryHeader)) {
+		memcpy(&header, data, sizeof(BinaryHeader));
+	} else {
+		LOG_ERROR("Not enough data in the file!");
+		return nullptr;
+	}
+
+	// Determine how many bytes we need in the file
+	size_t indexSize = GetIndexTypeSize(header.IndicesType);
+	size_t requiredBytes =
+		sizeof(BinaryHeader) +
+		(header.NumAttributes * sizeof(BufferAttribute)) +
+		(header.VertexStride * (size_t)header.NumVertices) +
+		(header.NumIndices * indexSize);
+
+	// Make sure there's enough data in the file
+	if (size < requiredBytes) {
+		LOG_ERROR("Not enough data in the file!");
+		return nullptr;
+	}
+
+	// The attributes come right after the header, this is basically our VDECL
+	size_t offset = sizeof(BinaryHeader);
+	std::vector<BufferAttribute> vertexDeclaration;
+	vertexDeclaration.resize(header.NumAttributes);
+	memcpy(vertexDeclaration.data(), data + offset, header.NumAttributes * sizeof(BufferAttribute));
+	offset += header.NumAttributes * sizeof(BufferAttribute);
+
+	// If we have index data, load it
+	IndexBuffer::Sptr indices = nullptr;
+	if (header.NumIndices > 0) {
+		indices = IndexBuffer::Create(BufferUsage::StaticDraw);
+		indices->LoadStorage(data + offset, static_cast<uint32_t>(indexSize), header.NumIndices, header.IndicesType);
+		offset += header.NumIndices * indexSize;
+	}
+
+	// Create a new VBO
+	VertexBuffer::Sptr vertices = VertexBuffer::Create(BufferUsage::StaticDraw);
+	if (header.NumVertices > 0) {
+		vertices->LoadStorage(data + offset, header.VertexStride, header.NumVertices);
+	}
+	offset += header.NumVertices * (size_t)header.VertexStride;
+
+	// Create the VAO and attach our index and vertex buffers
+	VertexArrayObject::Sptr result = VertexArrayObject::Create();
+	result->SetIndexBuffer(indices);
+	result->AddVertexBuffer(vertices, vertexDeclaration);
+
+	// Copy in the vertex declaration we loaded
+	result->SetVDecl(vertexDeclaration);
+
+	// Files written before LODs were added just end here
+	LodHeader lodHeader = LodHeader();
+	if (size - offset >= sizeof(LodHeader)) {
+		memcpy(&lodHeader, data + offset, sizeof(LodHeader));
+		offset += sizeof(LodHeader);
+	}
+	if (info != nullptr) {
+		info->Lods.clear();
+		info->Submeshes.clear();
+	}
+	if (memcmp(lodHeader.HeaderBytes, "LODS", 4) == 0 && lodHeader.NumLevels > 0 && size - offset >= lodHeader.NumLevels * sizeof(LodLevelHeader)) {
+		std::vector<LodLevelHeader> levels;
+		levels.resize(lodHeader.NumLevels);
+		memcpy(levels.data(), data + offset, levels.size() * sizeof(LodLevelHeader));
+		offset += levels.size() * sizeof(LodLevelHeader);
+
+		size_t lodIndices = 0;
+		for (const auto& level : levels) {
+			lodIndices += level.NumIndices;
+		}
+
+		// The levels are stored with the same index type as the full detail mesh
+		if (size - offset < lodIndices * indexSize) {
+			LOG_WARN("LOD data in \"{}\" is truncated, only the full detail mesh will be used", filename);
+		} else if (info != nullptr) {
+			info->Lods.reserve(levels.size());
+			for (const auto& level : levels) {
+				// Every level draws from the same vertex buffer, they only need their own indices
+				IndexBuffer::Sptr lodIndexBuffer = IndexBuffer::Create(BufferUsage::StaticDraw);
+				if (level.NumIndices > 0) {
+					lodIndexBuffer->LoadStorage(data + offset, static_cast<uint32_t>(indexSize), level.NumIndices, header.IndicesType);
+				}
+				offset += level.NumIndices * indexSize;
+
+				VertexArrayObject::Sptr lod = VertexArrayObject::Create();
+				lod->SetIndexBuffer(lodIndexBuffer);
+				lod->AddVertexBuffer(vertices, vertexDeclaration);
+				lod->SetVDecl(vertexDeclaration);
+				info->Lods.push_back({ lod, level.Error });
+			}
+		}
+	}
+
+	// Version 1 files don't have submeshes or a bounding box, so we make them up from the bounding sphere
+	if (info != nullptr) {
+		const glm::vec4& sphere = lodHeader.BoundingSphere;
+		info->BoundingSphere = sphere;
+		info->BoundsMin = glm::vec3(sphere) - glm::vec3(sphere.w);
+		info->BoundsMax = glm::vec3(sphere) + glm::vec3(sphere.w);
+
+		Submesh submesh;
+		submesh.BoundsMin = info->BoundsMin;
+		submesh.BoundsMax = info->BoundsMax;
+		submesh.BoundingSphere = info->BoundingSphere;
+		submesh.Ranges.push_back(glm::uvec2(0, header.NumIndices));
+		for (const auto& lod : info->Lods) {
+			submesh.Ranges.push_back(glm::uvec2(0, lod.Mesh->GetIndexBuffer()->GetElementCount()));
+		}
+		info->Submeshes.push_back(submesh);
+	}
+
+	// Calculate and trace out how long it took us to load
+	float endTime = static_cast<float>(glfwGetTime());
+	LOG_TRACE("Loaded OBJ file \"{}\" in {} seconds ({} vertices, {} indices)", filename, endTime - startTime, header.NumVertices, header.NumIndices);
+
+	return result;
 }
 
-MeshBuilder<VertexPosNormTexColTangents>* OptimizedObjLoader::_LoadFromObjFile(const std::string& filename) {
+VertexArrayObject::Sptr OptimizedObjLoader::_LoadFromBinFileV2(const std::string& filename, const VfsFile::Sptr& file, MeshFileInfo* info) {
+	float startTime = static_cast<float>(glfwGetTime());
+
+	const uint8_t* data = file->GetData();
+	size_t size = file->GetSize();
+
+	// Read the header and the section table
+	BinaryHeaderV2 header = BinaryHeaderV2();
+	if (size < sizeof(BinaryHeaderV2)) {
+		LOG_ERROR("Not enough data in the file!");
+		return nullptr;
+	}
+	memcpy(&header, data, sizeof(BinaryHeaderV2));
+	if (size - sizeof(BinaryHeaderV2) < (size_t)header.NumSections * sizeof(SectionHeader)) {
+		LOG_ERROR("Section table in \"{}\" is truncated!", filename);
+		return nullptr;
+	}
+	std::vector<SectionHeader> sections(header.NumSections);
+	memcpy(sections.data(), data + sizeof(BinaryHeaderV2), sections.size() * sizeof(SectionHeader));
+
+	// Finds a section in the file, returning null if it's missing, too small, or runs off the end of the file
+	auto findSection = [&](const char* type, uint32_t index, uint64_t minSize, uint64_t* sectionSize = nullptr) -> const uint8_t* {
+		for (const auto& section : sections) {
+			if (memcmp(section.Type, type, 4) == 0 && section.Index == index) {
+				if (section.Offset > size || section.Size > size - section.Offset || section.Size < minSize) {
+					LOG_ERROR("Section {} in \"{}\" is invalid!", std::string(type, 4), filename);
+					return nullptr;
+				}
+				if (sectionSize != nullptr) {
+					*sectionSize = section.Size;
+				}
+				return data + section.Offset;
+			}
+		}
+		LOG_ERROR("\"{}\" is missing section {}!", filename, std::string(type, 4));
+		return nullptr;
+	};
+
+	const uint8_t* meshData = findSection("MESH", 0, sizeof(MeshSection));
+	if (meshData == nullptr) {
+		return nullptr;
+	}
+	MeshSection mesh;
+	memcpy(&mesh, meshData, sizeof(MeshSection));
+	if (mesh.NumLevels == 0) {
+		LOG_ERROR("\"{}\" has no levels!", filename);
+		return nullptr;
+	}
+
+	// Create a VBO for each vertex stream, straight from the mapped file
+	VertexArrayObject::VertexDeclaration vertexDeclaration;
+	std::vector<std::pair<VertexBuffer::Sptr, VertexArrayObject::VertexDeclaration>> streams;
+	for (uint32_t ix = 0; ix < mesh.NumStreams; ix++) {
+		const uint8_t* declData = findSection("VDCL", ix, sizeof(StreamDeclaration));
+		if (declData == nullptr) {
+			return nullptr;
+		}
+		StreamDeclaration stream;
+		memcpy(&stream, declData, sizeof(StreamDeclaration));
+
+		VertexArrayObject::VertexDeclaration attributes(stream.NumAttributes);
+		if (findSection("VDCL", ix, sizeof(StreamDeclaration) + attributes.size() * sizeof(BufferAttribute)) == nullptr) {
+			return nullptr;
+		}
+		memcpy(attributes.data(), declData + sizeof(StreamDeclaration), attributes.size() * sizeof(BufferAttribute));
+
+		const uint8_t* vertexData = findSection("VERT", ix, (uint64_t)mesh.NumVertices * stream.Stride);
+		if (vertexData == nullptr) {
+			return nullptr;
+		}
+		VertexBuffer::Sptr vertices = VertexBuffer::Create(BufferUsage::StaticDraw);
+		if (mesh.NumVertices > 0) {
+			vertices->LoadStorage(vertexData, stream.Stride, mesh.NumVertices);
+		}
+
+		vertexDeclaration.insert(vertexDeclaration.end(), attributes.begin(), attributes.end());
+		streams.emplace_back(vertices, attributes);
+	}
+
+	// Every level shares the vertex buffers, and gets a slice of the index section
+	const uint8_t* levelData = findSection("LVLS", 0, (uint64_t)mesh.NumLevels * sizeof(LevelRecord));
+	if (levelData == nullptr) {
+		return nullptr;
+	}
+	std::vector<LevelRecord> levels(mesh.NumLevels);
+	memcpy(levels.data(), levelData, levels.size() * sizeof(LevelRecord));
+
+	uint64_t indexCount = 0;
+	for (const auto& level : levels) {
+		indexCount = std::max(indexCount, (uint64_t)level.IndexOffset + level.IndexCount);
+	}
+	size_t indexSize = GetIndexTypeSize(mesh.IndicesType);
+	const uint8_t* indexData = findSection("INDX", 0, indexCount * indexSize);
+	if (indexData == nullptr) {
+		return nullptr;
+	}
+
+	auto createLevel = [&](const LevelRecord& level) {
+		IndexBuffer::Sptr indices = nullptr;
+		if (level.IndexCount > 0) {
+			indices = IndexBuffer::Create(BufferUsage::StaticDraw);
+			indices->LoadStorage(indexData + level.IndexOffset * indexSize, static_cast<uint32_t>(indexSize), level.IndexCount, mesh.IndicesType);
+		}
+
+		VertexArrayObject::Sptr result = VertexArrayObject::Create();
+		result->SetIndexBuffer(indices);
+		for (const auto& [buffer, attributes] : streams) {
+			result->AddVertexBuffer(buffer, attributes);
+		}
+		result->SetVDecl(vertexDeclaration);
+		return result;
+	};
+	VertexArrayObject::Sptr result = createLevel(levels[0]);
+
+	if (info != nullptr) {
+		info->Lods.clear();
+		info->Submeshes.clear();
+		info->BoundsMin = mesh.BoundsMin;
+		info->BoundsMax = mesh.BoundsMax;
+		info->BoundingSphere = mesh.BoundingSphere;
+
+		for (size_t ix = 1; ix < levels.size(); ix++) {
+			info->Lods.push_back({ createLevel(levels[ix]), levels[ix].Error });
+		}
+
+		// Read in the submesh table, their names, and their index ranges in each level
+		const uint8_t* submeshData = findSection("SUBM", 0, (uint64_t)mesh.NumSubmeshes * sizeof(SubmeshRecord));
+		const uint8_t* rangeData   = findSection("RNGS", 0, (uint64_t)mesh.NumSubmeshes * mesh.NumLevels * sizeof(glm::uvec2));
+		uint64_t stringSize = 0;
+		const uint8_t* stringData  = findSection("STRS", 0, 0, &stringSize);
+		if (submeshData != nullptr && rangeData != nullptr && stringData != nullptr) {
+			info->Submeshes.resize(mesh.NumSubmeshes);
+			for (uint32_t ix = 0; ix < mesh.NumSubmeshes; ix++) {
+				SubmeshRecord record;
+				memcpy(&record, submeshData + ix * sizeof(SubmeshRecord), sizeof(SubmeshRecord));
+
+				Submesh& submesh = info->Submeshes[ix];
+				if ((uint64_t)record.NameOffset + record.NameLength <= stringSize) {
+					submesh.Material.assign(reinterpret_cast<const char*>(stringData) + record.NameOffset, record.NameLength);
+				}
+				submesh.BoundsMin = record.BoundsMin;
+				submesh.BoundsMax = record.BoundsMax;
+				submesh.BoundingSphere = record.BoundingSphere;
+				submesh.Ranges.resize(mesh.NumLevels);
+				for (uint32_t levelIx = 0; levelIx < mesh.NumLevels; levelIx++) {
+					memcpy(&submesh.Ranges[levelIx], rangeData + ((size_t)levelIx * mesh.NumSubmeshes + ix) * sizeof(glm::uvec2), sizeof(glm::uvec2));
+				}
+			}
+		}
+	}
+
+	// Calculate and trace out how long it took us to load
+	float endTime = static_cast<float>(glfwGetTime());
+	LOG_TRACE("Loaded binary mesh \"{}\" in {} seconds ({} vertices, {} indices, {} levels)", filename, endTime - startTime, mesh.NumVertices, levels[0].IndexCount, levels.size());
+
+	return result;
+}
+
+MeshBuilder<VertexPosNormTexColTangents>* OptimizedObjLoader::_LoadLegacy(const std::string& filename) {
 	// Open our file in binary mode
 	std::ifstream file;
 	file.open(filename, std::ios::binary);
@@ -105,8 +700,6 @@ MeshBuilder<VertexPosNormTexColTangents>* OptimizedObjLoader::_LoadFromObjFile(c
 	glm::vec3 vecData;
 	glm::ivec3 vertexIndices;
 
-	float startTime = static_cast<float>(glfwGetTime());
-
 	// Read and process the entire file
 	while (file.peek() != EOF) {
 		// Read in the first part of the line (ex: f, v, vn, etc...)
@@ -124,13 +717,12 @@ MeshBuilder<VertexPosNormTexColTangents>* OptimizedObjLoader::_LoadFromObjFile(c
 			file >> vecData.x >> vecData.y >> vecData.z;
 			positions.push_back(vecData);
 		}
-		// TODO: handle normals and textures
 		else if (command == "vn") {
-			// Read in and store a position
+			// Read in and store a normal
 			file >> vecData.x >> vecData.y >> vecData.z;
 			normals.push_back(vecData);
 		} else if (command == "vt") {
-			// Read in and store a position
+			// Read in and store a texture coordinate
 			file >> vecData.x >> vecData.y;
 			uvs.push_back(vecData);
 		}
@@ -210,8 +802,8 @@ MeshBuilder<VertexPosNormTexColTangents>* OptimizedObjLoader::_LoadFromObjFile(c
 		// Construct a new vertex using the indices for the vertex
 		VertexPosNormTexColTangents vertex;
 		vertex.Position = positions[vertexIndices.x];
-		vertex.UV       = vertexIndices.y != 0 ? uvs[vertexIndices.y] : glm::vec2(0.0f);
-		vertex.Normal   = vertexIndices.z != 0 ? normals[vertexIndices.z] : glm::vec3(0.0f, 0.0f, 1.0f);
+		vertex.UV       = vertexIndices.y >= 0 ? uvs[vertexIndices.y] : glm::vec2(0.0f);
+		vertex.Normal   = vertexIndices.z >= 0 ? normals[vertexIndices.z] : glm::vec3(0.0f, 0.0f, 1.0f);
 		vertex.Color    = color;
 
 		// Add to the mesh, get index of the added vertex
@@ -225,104 +817,5 @@ MeshBuilder<VertexPosNormTexColTangents>* OptimizedObjLoader::_LoadFromObjFile(c
 	// Calculate our tangents
 	MeshFactory::CalculateTBN(*mesh);
 
-	// Calculate and trace out how long it took us to load
-	float endTime = static_cast<float>(glfwGetTime());
-	LOG_TRACE("Loaded OBJ file \"{}\" in {} seconds ({} vertices, {} indices)", filename, endTime - startTime, mesh->GetVertexCount(), mesh->GetIndexCount());
-
-	// Move our data into a VAO and return it
 	return mesh;
 }
-
-VertexArrayObject::Sptr OptimizedObjLoader::_LoadFromBinFile(const std::string& filename) {
-
-	// Open the output file
-	std::ifstream file(filename, std::ios::binary);
-	// If our file fails to open, we will throw an error
-	if (!file) { throw std::runtime_error("Failed to open file"); }
-
-	float startTime = static_cast<float>(glfwGetTime());
-
-	// Get the file size so we can avoid reading past the end
-	file.seekg(0, std::ios::end);
-	size_t size = file.tellg();
-	file.seekg(0, std::ios::beg);
-
-	// Read the header from the file
-	BinaryHeader header = BinaryHeader();
-	if (size >= sizeof(BinaryHeader)) {
-		file.read(reinterpret_cast<char*>(&header), sizeof(BinaryHeader));
-	} else {
-		LOG_ERROR("Not enough data in the file!");
-		return nullptr;
-	}
-
-	// TODO: validate header
-
-	// Handle our version
-	if (header.Version == 0x01) {
-		// Determine how many bytes we need in the file
-		size_t requiredBytes =
-			sizeof(BinaryHeader) +
-			(header.NumAttributes * sizeof(BufferAttribute)) +
-			(header.VertexStride * (size_t)header.NumVertices) +
-			(header.NumIndices * GetIndexTypeSize(header.IndicesType));
-
-		// Make sure there's enough data in the file
-		if (size < requiredBytes) {
-			LOG_ERROR("Not enough data in the file!");
-			return nullptr;
-		}
-
-		// Read all attributes from the file, this is basically our VDECL
-		std::vector<BufferAttribute> vertexDeclaration;
-		vertexDeclaration.resize(header.NumAttributes);
-		for (int ix = 0; ix < header.NumAttributes; ix++) {
-			file.read(reinterpret_cast<char*>(&vertexDeclaration[ix]), sizeof(BufferAttribute));
-		}
-
-		// These will have the buffer pointers
-		IndexBuffer::Sptr indices = nullptr;
-		VertexBuffer::Sptr vertices = nullptr;
-
-		// If we have index data, load it
-		if (header.NumIndices > 0) {
-			// Create index buffer
-			indices = IndexBuffer::Create(BufferUsage::StaticDraw);
-
-			// Create memory to store indices, then read from the file
-			void* dataStore = malloc(header.NumIndices * GetIndexTypeSize(header.IndicesType));
-			file.read(reinterpret_cast<char*>(dataStore), header.NumIndices * GetIndexTypeSize(header.IndicesType));
-			
-			// Load data into OpenGL and free the CPU memory we allocated
-			indices->LoadData(dataStore, GetIndexTypeSize(header.IndicesType), header.NumIndices, header.IndicesType);
-			free(dataStore);
-		}
-
-		// Create a new VBO
-		vertices = VertexBuffer::Create(BufferUsage::StaticDraw);
-
-		// Create memory to store vertices and load from file
-		void* vertexStore = malloc(header.NumVertices * (size_t)header.VertexStride);
-		file.read(reinterpret_cast<char*>(vertexStore), header.NumVertices * (size_t)header.VertexStride);
-
-		// Load data into OpenGL and free the CPU copy
-		vertices->LoadData(vertexStore, header.VertexStride, header.NumVertices);
-		free(vertexStore);
-
-		// Create the VAO and attach our index and vertex buffers
-		VertexArrayObject::Sptr result = VertexArrayObject::Create();
-		result->SetIndexBuffer(indices);
-		result->AddVertexBuffer(vertices, vertexDeclaration);
-
-		// Copy in the vertex declaration we loaded
-		result->SetVDecl(vertexDeclaration);
-
-		// Calculate and trace out how long it took us to load
-		float endTime = static_cast<float>(glfwGetTime());
-		LOG_TRACE("Loaded OBJ file \"{}\" in {} seconds ({} vertices, {} indices)", filename, endTime - startTime, header.NumVertices, header.NumIndices);
-
-		return result;
-	}
-
-	return nullptr;
-}
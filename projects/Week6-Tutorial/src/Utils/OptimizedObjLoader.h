@@ -1,7 +1,7 @@
 /**
  * NOTE: you MAY NOT use this file in your GDW game or graphics assignments
  * (at least for the fall semester)
- * 
+ *
  * You may use this implementation as a reference to implement your own version
  * using similar concepts, and that fit better with your game
  */
@@ -12,26 +12,77 @@
 #include "Graphics/VertexTypes.h"
 
 #include "Utils/MeshBuilder.h"
+#include "Utils/MeshSimplifier.h"
+#include "Utils/MeshOptimizer.h"
+#include "Utils/VirtualFileSystem.h"
+
+/// <summary>
+/// A range of a mesh's triangles that share a material
+/// </summary>
+struct Submesh {
+	// The name of the material the range was assigned in the source file, or empty if it had none
+	std::string             Material;
+	// The first index and number of indices this submesh covers in each level of detail, level 0 being
+	// the full detail mesh. Each level has it's own index buffer, so these are relative to that level
+	std::vector<glm::uvec2> Ranges;
+	// The bounds of the submesh in model space
+	glm::vec3               BoundsMin;
+	glm::vec3               BoundsMax;
+	// The center (xyz) and radius (w) of the sphere enclosing the submesh
+	glm::vec4               BoundingSphere;
+};
+
+/// <summary>
+/// Everything stored in a binary mesh file other than the full detail mesh
+/// </summary>
+struct MeshFileInfo {
+	// The simplified levels of the mesh, not including the full detail mesh
+	std::vector<MeshLod> Lods;
+	// The material ranges of the mesh, there is always at least one for meshes with triangles
+	std::vector<Submesh> Submeshes;
+	// The bounds of the whole mesh in model space
+	glm::vec3            BoundsMin = glm::vec3(0.0f);
+	glm::vec3            BoundsMax = glm::vec3(0.0f);
+	// The center (xyz) and radius (w) of the sphere enclosing the whole mesh
+	glm::vec4            BoundingSphere = glm::vec4(0.0f);
+};
 
 /// <summary>
 /// An optimized OBJ loader that can convert an OBJ file to a binary representation
 /// that we can load significantly faster
+///
+/// When converting, a chain of simplified LODs is generated for the mesh (see MeshSimplifier) and
+/// stored after the vertex data, so we only pay for the simplification once. The mesh and it's LODs
+/// are also reordered for the GPU's caches and can be quantized (see MeshOptimizer)
+///
+/// Version 2 files are a header followed by a table of sections, each of which starts on a 64 byte
+/// boundary. The file is memory mapped when loading, and the vertex and index sections are handed to
+/// OpenGL straight from the mapping. The header stores a hash of the source file and the version of the
+/// importer that wrote it. Version 1 files can still be loaded
 /// </summary>
 class OptimizedObjLoader {
 public:
 	/// <summary>
-	/// Loads a VAO from an OBJ file. On the first time this is called for an OBJ file, will convert the OBJ file 
-	/// to a binary file and load that instead. On subsequent runs, the binary file will be loaded instead
+	/// Bump this whenever the import pipeline changes in a way that should invalidate existing binary files
+	/// </summary>
+	static constexpr uint16_t IMPORTER_VERSION = 1;
+
+	/// <summary>
+	/// Loads a VAO from an OBJ file. On the first time this is called for an OBJ file, will convert the OBJ file
+	/// to a binary file in the ImportCache and load that instead. On subsequent runs, the binary file will be loaded
+	/// instead, unless the OBJ file's contents, the importer or it's settings have changed since it was converted
 	/// </summary>
 	/// <param name="filename">The path to the .obj or .bin file to load</param>
+	/// <param name="info">If not null, will be filled with the LODs, submeshes and bounds stored in the file</param>
 	/// <returns>A VAO loaded from disk</returns>
-	static VertexArrayObject::Sptr LoadFromFile(const std::string& filename);
+	static VertexArrayObject::Sptr LoadFromFile(const std::string& filename, MeshFileInfo* info = nullptr);
 	/// <summary>
 	/// Manually converts an OBJ file into a binary mesh file
 	/// </summary>
 	/// <param name="inFile">The path to OBJ file to convert</param>
 	/// <param name="outFile">The output path for the bin file, or empty to use the inFile path and replace the extension with .bin</param>
-	static void ConvertToBinary(const std::string& inFile, const std::string& outFile = "");
+	/// <param name="settings">Controls which optimizations are applied to the mesh before it is stored</param>
+	static void ConvertToBinary(const std::string& inFile, const std::string& outFile = "", const MeshOptimizerSettings& settings = MeshOptimizerSettings());
 
 	/// <summary>
 	/// Saves a mesh builder of the given type to a binary file
@@ -39,11 +90,30 @@ public:
 	/// <typeparam name="VertexType"></typeparam>
 	/// <param name="mesh"></param>
 	/// <param name="outFilename"></param>
+	/// <param name="lods">The simplified levels of the mesh to store after the vertex data, if any</param>
+	/// <param name="boundingSphere">The mesh's bounding sphere, or a radius of 0 to fit one around it's bounds</param>
+	/// <param name="indexType">The type to store the indices as, must be large enough for the mesh's vertex count</param>
+	template <typename VertexType>
+	static void SaveBinaryFile(MeshBuilder<VertexType>& mesh, const std::string& outFilename, const std::vector<MeshSimplifier::Level>& lods = std::vector<MeshSimplifier::Level>(), const glm::vec4& boundingSphere = glm::vec4(0.0f), IndexType indexType = IndexType::UInt) {
+		SaveBinaryFile(mesh.GetVertexDataPtr(), mesh.GetVertexCount(), mesh.GetIndexDataPtr(), mesh.GetIndexCount(), outFilename, lods, boundingSphere, indexType);
+	}
+	/// <summary>
+	/// Saves raw vertex and index data of the given type to a binary file, as a single submesh
+	/// </summary>
+	/// <typeparam name="VertexType">The type of vertex to store, must have a V_DECL and a Position field</typeparam>
+	/// <param name="vertices">The vertices to store</param>
+	/// <param name="vertexCount">The number of vertices to store</param>
+	/// <param name="indices">The triangle list to store, can be null if indexCount is 0</param>
+	/// <param name="indexCount">The number of indices to store</param>
+	/// <param name="outFilename">The path to write the file to</param>
+	/// <param name="lods">The simplified levels of the mesh to store after the vertex data, if any</param>
+	/// <param name="boundingSphere">The mesh's bounding sphere, or a radius of 0 to fit one around it's bounds</param>
+	/// <param name="indexType">The type to store the indices as, must be large enough for the mesh's vertex count</param>
 	template <typename VertexType>
-	static void SaveBinaryFile(MeshBuilder<VertexType>& mesh, const std::string& outFilename);
+	static void SaveBinaryFile(const VertexType* vertices, size_t vertexCount, const uint32_t* indices, size_t indexCount, const std::string& outFilename, const std::vector<MeshSimplifier::Level>& lods = std::vector<MeshSimplifier::Level>(), const glm::vec4& boundingSphere = glm::vec4(0.0f), IndexType indexType = IndexType::UInt);
 
 protected:
-	// Will be put at the start of the binary file, contains info about the contents of the file
+	// Will be put at the start of version 1 binary files, contains info about the contents of the file
 	struct BinaryHeader {
 		// A check value so we can ensure that we're loading in the right file type
 		char      HeaderBytes[4] ={ 'B', 'O', 'B', 'J' };
@@ -61,42 +131,127 @@ protected:
 		uint8_t   NumAttributes = 0;
 	};
 
+	// Optional section after the vertex data in version 1 files, holding the simplified levels of the mesh
+	struct LodHeader {
+		char      HeaderBytes[4] ={ 'L', 'O', 'D', 'S' };
+		// The number of simplified levels, not counting the full detail mesh
+		uint32_t  NumLevels = 0;
+		// The center (xyz) and radius (w) of the mesh's bounding sphere
+		glm::vec4 BoundingSphere = glm::vec4(0.0f);
+	};
+	// Follows the LodHeader for each level, the indices for all the levels come after these
+	struct LodLevelHeader {
+		uint32_t NumIndices = 0;
+		float    Error = 0.0f;
+	};
+
+	// Sections in version 2 files start on multiples of this many bytes
+	static constexpr size_t SECTION_ALIGNMENT = 64;
+
+	// The start of a version 2 file, the first 6 bytes line up with the version 1 header
+	struct BinaryHeaderV2 {
+		char     HeaderBytes[4] ={ 'B', 'O', 'B', 'J' };
+		uint16_t Version = 2;
+		// The IMPORTER_VERSION that wrote the file
+		uint16_t ImporterVersion = 0;
+		// A hash of the source file's contents, or 0 if the file wasn't imported from one
+		uint64_t SourceHash = 0;
+		// The number of SectionHeaders that follow this header
+		uint32_t NumSections = 0;
+		uint32_t Reserved = 0;
+	};
+	// Describes where a section lives in a version 2 file
+	struct SectionHeader {
+		// A four character code for the type of the section (ex: VERT, INDX)
+		char     Type[4] ={ 0, 0, 0, 0 };
+		// Distinguishes sections of the same type (ex: which vertex stream this is)
+		uint32_t Index = 0;
+		// The offset from the start of the file, and size of the section, in bytes
+		uint64_t Offset = 0;
+		uint64_t Size = 0;
+	};
+	// The MESH section, describes the layout of all the other sections
+	struct MeshSection {
+		uint32_t  NumVertices = 0;
+		// The number of VDCL and VERT sections
+		uint32_t  NumStreams = 0;
+		IndexType IndicesType = IndexType::Unknown;
+		// The number of levels of detail, including the full detail mesh
+		uint32_t  NumLevels = 0;
+		uint32_t  NumSubmeshes = 0;
+		uint32_t  Reserved = 0;
+		glm::vec3 BoundsMin = glm::vec3(0.0f);
+		glm::vec3 BoundsMax = glm::vec3(0.0f);
+		glm::vec4 BoundingSphere = glm::vec4(0.0f);
+	};
+	// The start of a VDCL section, which is followed by NumAttributes BufferAttributes
+	struct StreamDeclaration {
+		uint32_t Stride = 0;
+		uint32_t NumAttributes = 0;
+	};
+	// An entry in the LVLS section, each level's indices live in the INDX section
+	struct LevelRecord {
+		// The first index in the INDX section, and the number of indices
+		uint32_t IndexOffset = 0;
+		uint32_t IndexCount = 0;
+		// How far this level strays from the full detail mesh, relative to the bounding sphere's radius
+		float    Error = 0.0f;
+		uint32_t Reserved = 0;
+	};
+	// An entry in the SUBM section. Each submesh has one RNGS entry per level, stored level by level
+	struct SubmeshRecord {
+		// The material name in the STRS section
+		uint32_t  NameOffset = 0;
+		uint32_t  NameLength = 0;
+		glm::vec3 BoundsMin = glm::vec3(0.0f);
+		glm::vec3 BoundsMax = glm::vec3(0.0f);
+		glm::vec4 BoundingSphere = glm::vec4(0.0f);
+	};
+
 	OptimizedObjLoader() = default;
 	~OptimizedObjLoader() = default;
 
-	static MeshBuilder<VertexPosNormTexColTangents>* _LoadFromObjFile(const std::string& filename);
-	static VertexArrayObject::Sptr _LoadFromBinFile(const std::string& filename);
+	// Writes a version 2 file. Levels includes the full detail mesh, and the submesh ranges index into them
+	static void _WriteBinaryFile(const std::string& outFilename, const void* vertices, uint32_t vertexCount, uint16_t vertexStride, const std::vector<BufferAttribute>& vertexDeclaration,
+								 const std::vector<MeshSimplifier::Level>& levels, const MeshFileInfo& info, IndexType indexType, uint64_t sourceHash);
+	// Writes indices to the file as the given type, narrowing them if needed
+	static void _WriteIndices(std::ofstream& file, const uint32_t* indices, size_t count, IndexType type);
+	static VertexArrayObject::Sptr _LoadFromBinFile(const std::string& filename, MeshFileInfo* info);
+	static VertexArrayObject::Sptr _LoadFromBinFileV1(const std::string& filename, const VfsFile::Sptr& file, MeshFileInfo* info);
+	static VertexArrayObject::Sptr _LoadFromBinFileV2(const std::string& filename, const VfsFile::Sptr& file, MeshFileInfo* info);
+	// The original ifstream/stringstream OBJ parser, imports use FastObjParser now but the benchmark still compares against it
+	static MeshBuilder<VertexPosNormTexColTangents>* _LoadLegacy(const std::string& filename);
+
+	friend class ObjLoaderBenchmarkLayer;
 };
 
 template <typename VertexType>
-void OptimizedObjLoader::SaveBinaryFile(MeshBuilder<VertexType>& mesh, const std::string& outFilename) {
-	// Open the output file
-	std::ofstream file(outFilename, std::ios::binary);
-	if (!file) {
-		throw std::runtime_error("Failed to open output file");
-	}
+void OptimizedObjLoader::SaveBinaryFile(const VertexType* vertices, size_t vertexCount, const uint32_t* indices, size_t indexCount, const std::string& outFilename, const std::vector<MeshSimplifier::Level>& lods, const glm::vec4& boundingSphere, IndexType indexType) {
+	// The full detail mesh is level 0, followed by the LODs
+	std::vector<MeshSimplifier::Level> levels;
+	levels.reserve(lods.size() + 1);
+	levels.push_back({ std::vector<uint32_t>(indices, indices + indexCount), 0.0f });
+	levels.insert(levels.end(), lods.begin(), lods.end());
 
-	// Create the fixed size header for our output file
-	BinaryHeader header  = BinaryHeader();
-	header.Version       = 0x01; // This is version 1! Update this and implement different readers if changes to format are made
-	header.NumIndices    = mesh.GetIndexCount();
-	header.IndicesType   = IndexType::UInt;
-	header.NumVertices   = mesh.GetVertexCount();
-	header.VertexStride  = sizeof(VertexType);
-	header.NumAttributes = VertexType::V_DECL.size();
-
-	// Write header bytes to the stream
-	file.write(reinterpret_cast<const char*>(&header), sizeof(BinaryHeader));
-
-	// Write which attributes we have to the stream
-	for (int ix = 0; ix < VertexType::V_DECL.size(); ix++) {
-		file.write(reinterpret_cast<const char*>(&VertexType::V_DECL[ix]), sizeof(BufferAttribute));
+	MeshFileInfo info;
+	if (vertexCount > 0) {
+		info.BoundsMin = info.BoundsMax = vertices[0].Position;
+		for (size_t ix = 1; ix < vertexCount; ix++) {
+			info.BoundsMin = glm::min(info.BoundsMin, vertices[ix].Position);
+			info.BoundsMax = glm::max(info.BoundsMax, vertices[ix].Position);
+		}
 	}
-	// Write any index data to the file
-	if (mesh.GetIndexCount() > 0) {
-		file.write(reinterpret_cast<const char*>(mesh.GetIndexDataPtr()), mesh.GetIndexCount() * sizeof(uint32_t));
+	info.BoundingSphere = boundingSphere.w > 0.0f ? boundingSphere : glm::vec4((info.BoundsMin + info.BoundsMax) * 0.5f, glm::length(info.BoundsMax - info.BoundsMin) * 0.5f);
+
+	// Everything goes into a single submesh
+	Submesh submesh;
+	submesh.BoundsMin = info.BoundsMin;
+	submesh.BoundsMax = info.BoundsMax;
+	submesh.BoundingSphere = info.BoundingSphere;
+	for (const auto& level : levels) {
+		submesh.Ranges.push_back(glm::uvec2(0, static_cast<uint32_t>(level.Indices.size())));
 	}
+	info.Submeshes.push_back(submesh);
 
-	// Write vertex data to file
-	file.write(reinterpret_cast<const char*>(mesh.GetVertexDataPtr()), mesh.GetVertexCount() * sizeof(VertexType));
+	_WriteBinaryFile(outFilename, vertices, static_cast<uint32_t>(vertexCount), sizeof(VertexType), VertexType::V_DECL, levels, info, indexType, 0);
 }
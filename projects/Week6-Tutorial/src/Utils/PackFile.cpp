@@ -0,0 +1,304 @@
+#include "Utils/PackFile.h"
+
+#include <fstream>
+#include <algorithm>
+#include <cstring>
+#include <chrono>
+
+#include <zlib.h>
+#include <Logging.h>
+
+#include "Utils/ImportCache.h"
+#include "Utils/StringUtils.h"
+
+namespace fs = std::filesystem;
+
+/// <summary>
+/// Rounds an offset up to the next multiple of alignment
+/// </summary>
+inline uint64_t __AlignOffset(uint64_t offset, uint64_t alignment) {
+	return (offset + alignment - 1) / alignment * alignment;
+}
+
+/// <summary>
+/// Returns true if the extension (lowercase, with the dot) is in the list
+/// </summary>
+inline bool __HasExtension(const std::vector<std::string>& extensions, const std::string& extension) {
+	return std::find(extensions.begin(), extensions.end(), extension) != extensions.end();
+}
+
+PackFile::PackFile() :
+	_filename(""),
+	_file(nullptr),
+	_entries(nullptr),
+	_entryCount(0),
+	_names(nullptr),
+	_lastWriteTime()
+{ }
+
+std::string PackFile::NormalizePath(const std::string& path) {
+	std::string result = fs::path(path).lexically_normal().generic_string();
+	StringTools::ToLower(result);
+	if (result.rfind("./", 0) == 0) {
+		result = result.substr(2);
+	}
+	return result;
+}
+
+uint64_t PackFile::HashPath(const std::string& normalizedPath) {
+	return ImportCache::HashBytes(normalizedPath.data(), normalizedPath.size());
+}
+
+PackFile::Sptr PackFile::Open(const std::string& filename) {
+	MemoryMappedFile::Sptr file = MemoryMappedFile::Open(filename);
+	if (file == nullptr) {
+		LOG_WARN("Failed to open pack file \"{}\"", filename);
+		return nullptr;
+	}
+
+	const uint8_t* data = file->GetData();
+	const size_t size = file->GetSize();
+	PackHeader header = PackHeader();
+	if (size < sizeof(PackHeader)) {
+		LOG_WARN("\"{}\" is not a valid pack file", filename);
+		return nullptr;
+	}
+	memcpy(&header, data, sizeof(PackHeader));
+	if (memcmp(header.HeaderBytes, "BPAK", 4) != 0 || header.Version != 1) {
+		LOG_WARN("\"{}\" is not a valid pack file", filename);
+		return nullptr;
+	}
+
+	// Make sure the tables are inside the file, and that the TOC can be read in place
+	const uint64_t tocSize = (uint64_t)header.EntryCount * sizeof(PackEntry);
+	if (header.TocOffset % alignof(PackEntry) != 0 || header.TocOffset + tocSize > size || header.NamesOffset + header.NamesSize > size) {
+		LOG_WARN("Pack file \"{}\" is corrupt, it's table of contents is out of bounds", filename);
+		return nullptr;
+	}
+	const PackEntry* entries = reinterpret_cast<const PackEntry*>(data + header.TocOffset);
+	for (uint32_t ix = 0; ix < header.EntryCount; ix++) {
+		const PackEntry& entry = entries[ix];
+		if (entry.Offset + entry.StoredSize > size || (uint64_t)entry.NameOffset + entry.NameLength > header.NamesSize ||
+			(ix > 0 && entries[ix - 1].PathHash > entry.PathHash)) {
+			LOG_WARN("Pack file \"{}\" is corrupt, entry {} is invalid", filename, ix);
+			return nullptr;
+		}
+	}
+
+	// Constructor is protected, so we can't use make_shared
+	PackFile::Sptr result = PackFile::Sptr(new PackFile());
+	result->_filename   = filename;
+	result->_file       = file;
+	result->_entries    = entries;
+	result->_entryCount = header.EntryCount;
+	result->_names      = reinterpret_cast<const char*>(data + header.NamesOffset);
+	std::error_code error;
+	result->_lastWriteTime = fs::last_write_time(filename, error);
+
+	LOG_INFO("Opened pack file \"{}\" with {} entries", filename, header.EntryCount);
+	return result;
+}
+
+const PackEntry* PackFile::Find(const std::string& path) const {
+	const std::string normalized = NormalizePath(path);
+	const uint64_t hash = HashPath(normalized);
+
+	// The TOC is sorted by hash, so we can binary search it, and then check the names in case of a collision
+	const PackEntry* end = _entries + _entryCount;
+	const PackEntry* it = std::lower_bound(_entries, end, hash, [](const PackEntry& entry, uint64_t value) {
+		return entry.PathHash < value;
+	});
+	for (; it != end && it->PathHash == hash; it++) {
+		if (it->NameLength == normalized.size() && memcmp(_names + it->NameOffset, normalized.data(), normalized.size()) == 0) {
+			return it;
+		}
+	}
+	return nullptr;
+}
+
+const uint8_t* PackFile::GetMappedData(const PackEntry& entry) const {
+	return entry.Compression == BlobCompression::Raw ? _file->GetData() + entry.Offset : nullptr;
+}
+
+bool PackFile::Read(const PackEntry& entry, std::vector<uint8_t>& result) const {
+	const uint8_t* stored = _file->GetData() + entry.Offset;
+	result.resize(entry.Size);
+
+	switch (entry.Compression) {
+		case BlobCompression::Raw:
+			if (entry.Size > 0) {
+				memcpy(result.data(), stored, entry.Size);
+			}
+			return true;
+		case BlobCompression::Zlib:
+		{
+			uLongf size = (uLongf)entry.Size;
+			if (uncompress(result.data(), &size, stored, (uLong)entry.StoredSize) != Z_OK || size != entry.Size) {
+				LOG_WARN("Entry \"{}\" in pack \"{}\" is corrupt", GetEntryName(entry), _filename);
+				return false;
+			}
+			return true;
+		}
+		default:
+			LOG_WARN("Entry \"{}\" in pack \"{}\" has an unknown compression mode", GetEntryName(entry), _filename);
+			return false;
+	}
+}
+
+std::string PackFile::GetEntryName(const PackEntry& entry) const {
+	return std::string(_names + entry.NameOffset, entry.NameLength);
+}
+
+bool PackFile::Build(const std::string& directory, const std::string& outFile, const PackBuildSettings& settings) {
+	// This runs as a build step before GLFW is initialized, so we can't use glfwGetTime
+	auto startTime = std::chrono::steady_clock::now();
+
+	std::error_code error;
+	if (!fs::is_directory(directory, error)) {
+		LOG_ERROR("Cannot pack \"{}\", it is not a directory", directory);
+		return false;
+	}
+
+	// Gather all the files we're packing, and their paths relative to the directory
+	struct SourceFile {
+		std::string Path;
+		std::string Name;
+		PackEntry   Entry;
+	};
+	std::vector<SourceFile> files;
+	for (const auto& item : fs::recursive_directory_iterator(directory, error)) {
+		if (!item.is_regular_file()) {
+			continue;
+		}
+
+		std::string extension = item.path().extension().string();
+		StringTools::ToLower(extension);
+		std::error_code fileError;
+		if (__HasExtension(settings.ExcludeExtensions, extension) || fs::equivalent(item.path(), outFile, fileError)) {
+			continue;
+		}
+
+		SourceFile file;
+		file.Path = item.path().string();
+		file.Name = NormalizePath(item.path().lexically_relative(directory).string());
+		if (file.Name.size() > UINT16_MAX) {
+			LOG_WARN("Skipping \"{}\", it's path is too long", file.Path);
+			continue;
+		}
+		file.Entry.PathHash = HashPath(file.Name);
+		files.push_back(std::move(file));
+	}
+	if (error) {
+		LOG_ERROR("Failed to list files in \"{}\": {}", directory, error.message());
+		return false;
+	}
+
+	// Sort by hash so we can binary search the TOC, and make sure no paths collide
+	std::sort(files.begin(), files.end(), [](const SourceFile& a, const SourceFile& b) {
+		return a.Entry.PathHash < b.Entry.PathHash || (a.Entry.PathHash == b.Entry.PathHash && a.Name < b.Name);
+	});
+	for (size_t ix = 1; ix < files.size(); ix++) {
+		if (files[ix].Name == files[ix - 1].Name) {
+			LOG_ERROR("\"{}\" and \"{}\" map to the same path in the pack (paths are not case sensitive)", files[ix - 1].Path, files[ix].Path);
+			return false;
+		}
+	}
+
+	fs::path outPath = fs::path(outFile);
+	if (outPath.has_parent_path()) {
+		fs::create_directories(outPath.parent_path(), error);
+	}
+
+	// Write to a temporary file first, so that a partially written pack is never picked up by the game
+	std::string tempPath = outFile + ".tmp";
+	std::ofstream out(tempPath, std::ios::binary);
+	if (!out) {
+		LOG_ERROR("Failed to open pack file \"{}\" for writing", tempPath);
+		return false;
+	}
+
+	// We fill in the header at the end, once we know where everything is
+	PackHeader header = PackHeader();
+	header.EntryCount = static_cast<uint32_t>(files.size());
+	out.write(reinterpret_cast<const char*>(&header), sizeof(PackHeader));
+	uint64_t offset = sizeof(PackHeader);
+
+	const char padding[ENTRY_ALIGNMENT] = { 0 };
+	auto pad = [&](uint64_t alignment) {
+		uint64_t aligned = __AlignOffset(offset, alignment);
+		out.write(padding, aligned - offset);
+		offset = aligned;
+	};
+
+	std::string names;
+	uint64_t totalSize = 0;
+	std::vector<uint8_t> compressed;
+	for (SourceFile& file : files) {
+		MemoryMappedFile::Sptr source = MemoryMappedFile::Open(file.Path);
+		if (source == nullptr) {
+			LOG_ERROR("Failed to read \"{}\" while packing", file.Path);
+			return false;
+		}
+
+		PackEntry& entry = file.Entry;
+		entry.Size        = source->GetSize();
+		entry.StoredSize  = source->GetSize();
+		entry.ContentHash = ImportCache::HashBytes(source->GetData(), source->GetSize());
+		entry.NameOffset  = static_cast<uint32_t>(names.size());
+		entry.NameLength  = static_cast<uint16_t>(file.Name.size());
+		names += file.Name;
+		totalSize += entry.Size;
+
+		// Only keep the compressed data if it's worth having to decompress it
+		const uint8_t* payload = source->GetData();
+		std::string extension = fs::path(file.Path).extension().string();
+		StringTools::ToLower(extension);
+		if (entry.Size > 0 && !__HasExtension(settings.StoreExtensions, extension)) {
+			uLongf compressedSize = compressBound((uLong)entry.Size);
+			compressed.resize(compressedSize);
+			if (compress2(compressed.data(), &compressedSize, payload, (uLong)entry.Size, settings.CompressionLevel) == Z_OK &&
+				compressedSize <= entry.Size * settings.MinCompression) {
+				entry.Compression = BlobCompression::Zlib;
+				entry.StoredSize  = compressedSize;
+				payload = compressed.data();
+			}
+		}
+
+		pad(ENTRY_ALIGNMENT);
+		entry.Offset = offset;
+		out.write(reinterpret_cast<const char*>(payload), entry.StoredSize);
+		offset += entry.StoredSize;
+	}
+
+	// Table of contents, then the names
+	pad(alignof(PackEntry));
+	header.TocOffset = offset;
+	for (const SourceFile& file : files) {
+		out.write(reinterpret_cast<const char*>(&file.Entry), sizeof(PackEntry));
+		offset += sizeof(PackEntry);
+	}
+	header.NamesOffset = offset;
+	header.NamesSize   = names.size();
+	out.write(names.data(), names.size());
+	offset += names.size();
+
+	out.seekp(0);
+	out.write(reinterpret_cast<const char*>(&header), sizeof(PackHeader));
+	out.close();
+	if (!out) {
+		LOG_ERROR("Failed to write pack file \"{}\"", tempPath);
+		fs::remove(tempPath, error);
+		return false;
+	}
+
+	fs::rename(tempPath, outFile, error);
+	if (error) {
+		LOG_ERROR("Failed to move pack file into place \"{}\": {}", outFile, error.message());
+		fs::remove(tempPath, error);
+		return false;
+	}
+
+	float seconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - startTime).count();
+	LOG_INFO("Packed {} files from \"{}\" into \"{}\" ({} bytes -> {} bytes) in {} seconds", files.size(), directory, outFile, totalSize, offset, seconds);
+	return true;
+}
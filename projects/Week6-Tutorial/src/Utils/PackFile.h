@@ -0,0 +1,161 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <filesystem>
+
+#include "Utils/Macros.h"
+#include "Utils/BlobStore.h"
+#include "Utils/MemoryMappedFile.h"
+
+/// <summary>
+/// Controls how a directory is packed by PackFile::Build
+/// </summary>
+struct PackBuildSettings {
+	// The zlib level to compress entries with (0-9)
+	int                      CompressionLevel  = 9;
+	// Entries are only stored compressed if that makes them at most this fraction of their original size, since
+	// uncompressed entries can be read straight out of the mapped pack
+	float                    MinCompression    = 0.9f;
+	// Files with these extensions are never compressed, since they are already compressed or we want to map them
+	std::vector<std::string> StoreExtensions   = { ".png", ".jpg", ".jpeg", ".dds", ".bin", ".glb", ".bank", ".ogg", ".mp3", ".wav", ".pak" };
+	// Files with these extensions are left out of the pack entirely
+	std::vector<std::string> ExcludeExtensions = { ".tmp", ".pdb", ".ilk" };
+};
+
+/// <summary>
+/// A single file stored in a pack, these are stored directly in the pack's table of contents
+/// </summary>
+struct PackEntry {
+	// Hash of the entry's normalized path, the table of contents is sorted by this
+	uint64_t        PathHash    = 0;
+	// FNV-1a hash of the entry's uncompressed contents, so importers don't need to read the entry to key their caches
+	uint64_t        ContentHash = 0;
+	// Where the entry's data starts, relative to the start of the pack
+	uint64_t        Offset      = 0;
+	// The size of the entry when uncompressed
+	uint64_t        Size        = 0;
+	// The number of bytes the entry takes up in the pack
+	uint64_t        StoredSize  = 0;
+	// Where the entry's normalized path is in the string table
+	uint32_t        NameOffset  = 0;
+	uint16_t        NameLength  = 0;
+	BlobCompression Compression = BlobCompression::Raw;
+	uint8_t         Reserved    = 0;
+};
+
+/// <summary>
+/// A read-only archive of files, so that we can ship a single file instead of hundreds of loose ones
+///
+/// Packs are a header, followed by the entry data, a table of contents sorted by path hash and a table
+/// of path strings. The whole pack is memory mapped when opened, so looking up an entry is a binary
+/// search over the mapped table of contents, and uncompressed entries can be used straight from the
+/// mapping without copying. Entries can be compressed with zlib, and are aligned so that formats
+/// which are mapped directly (ex: our binary meshes) keep their alignment
+///
+/// Paths are normalized (lowercase, forward slashes, no ./ or ../ parts) before hashing, so lookups
+/// use the same relative paths that we would use to open the loose files
+/// </summary>
+class PackFile final {
+public:
+	MAKE_PTRS(PackFile);
+	NO_COPY(PackFile);
+	NO_MOVE(PackFile);
+
+	~PackFile() = default;
+
+	/// <summary>
+	/// Opens and validates a pack file
+	/// </summary>
+	/// <param name="filename">The path of the pack to open</param>
+	/// <returns>The pack, or nullptr if it could not be opened or is not a valid pack</returns>
+	static PackFile::Sptr Open(const std::string& filename);
+
+	/// <summary>
+	/// Packs every file under a directory into a new pack file, with paths relative to the directory
+	/// </summary>
+	/// <param name="directory">The directory to pack (ex: res)</param>
+	/// <param name="outFile">The path of the pack file to write, this is skipped if it's inside directory</param>
+	/// <param name="settings">Controls which files are compressed</param>
+	/// <returns>True if the pack was written, false if otherwise</returns>
+	static bool Build(const std::string& directory, const std::string& outFile, const PackBuildSettings& settings = PackBuildSettings());
+
+	/// <summary>
+	/// Normalizes a path the same way that paths are normalized when building a pack
+	/// </summary>
+	static std::string NormalizePath(const std::string& path);
+	/// <summary>
+	/// Hashes a path that has been normalized with NormalizePath
+	/// </summary>
+	static uint64_t HashPath(const std::string& normalizedPath);
+
+	/// <summary>
+	/// Finds the entry for a file in the pack
+	/// </summary>
+	/// <param name="path">The path of the file, relative to the directory that was packed</param>
+	/// <returns>The entry, or nullptr if the file is not in the pack</returns>
+	const PackEntry* Find(const std::string& path) const;
+	/// <summary>
+	/// Gets a pointer to an entry's data inside the mapped pack, or nullptr if the entry is compressed
+	/// </summary>
+	const uint8_t* GetMappedData(const PackEntry& entry) const;
+	/// <summary>
+	/// Reads an entry's contents into a buffer, decompressing it if required
+	/// </summary>
+	/// <param name="entry">The entry to read, must belong to this pack</param>
+	/// <param name="result">The buffer to store the contents in, will be resized to fit</param>
+	/// <returns>True if the entry was read, false if it is corrupt</returns>
+	bool Read(const PackEntry& entry, std::vector<uint8_t>& result) const;
+
+	/// <summary>
+	/// Gets the normalized path of an entry
+	/// </summary>
+	std::string GetEntryName(const PackEntry& entry) const;
+	/// <summary>
+	/// Gets the number of entries in the pack
+	/// </summary>
+	uint32_t GetEntryCount() const { return _entryCount; }
+	/// <summary>
+	/// Gets an entry by it's index in the table of contents
+	/// </summary>
+	const PackEntry& GetEntry(uint32_t index) const { return _entries[index]; }
+
+	/// <summary>
+	/// Gets the path that the pack was opened from
+	/// </summary>
+	const std::string& GetFilename() const { return _filename; }
+	/// <summary>
+	/// Gets the mapping that uncompressed entries point into, anything that holds on to entry data should hold on to this
+	/// </summary>
+	const MemoryMappedFile::Sptr& GetMapping() const { return _file; }
+	/// <summary>
+	/// Gets the time that the pack was last written to, entries do not store their own modification times
+	/// </summary>
+	std::filesystem::file_time_type GetLastWriteTime() const { return _lastWriteTime; }
+
+protected:
+	PackFile();
+
+	// Entry data starts on this boundary
+	static constexpr size_t ENTRY_ALIGNMENT = 64;
+
+	// Will be put at the start of each pack file
+	struct PackHeader {
+		char     HeaderBytes[4] = { 'B', 'P', 'A', 'K' };
+		uint16_t Version        = 1;
+		uint16_t Reserved       = 0;
+		uint32_t EntryCount     = 0;
+		uint32_t Reserved2      = 0;
+		uint64_t TocOffset      = 0;
+		uint64_t NamesOffset    = 0;
+		uint64_t NamesSize      = 0;
+	};
+
+	std::string                     _filename;
+	MemoryMappedFile::Sptr          _file;
+	const PackEntry*                _entries;
+	uint32_t                        _entryCount;
+	const char*                     _names;
+	std::filesystem::file_time_type _lastWriteTime;
+};
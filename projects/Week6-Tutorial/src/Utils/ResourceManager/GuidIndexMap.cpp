@@ -0,0 +1,67 @@
+#include "Utils/ResourceManager/GuidIndexMap.h"
+
+// We grow once the map is 3/4 full, linear probing falls apart past that
+#define GUID_MAP_MAX_LOAD_NUM 3
+#define GUID_MAP_MAX_LOAD_DEN 4
+#define GUID_MAP_MIN_SLOTS    16
+
+GuidIndexMap::GuidIndexMap() :
+	_slots(),
+	_count(0)
+{ }
+
+size_t GuidIndexMap::_FindSlot(const Guid& key) const {
+	// GUIDs are random, so std::hash<Guid> spreads them out nicely already
+	const size_t mask = _slots.size() - 1;
+	size_t ix = std::hash<Guid>()(key) & mask;
+	while (_slots[ix].Key.isValid() && _slots[ix].Key != key) {
+		ix = (ix + 1) & mask;
+	}
+	return ix;
+}
+
+bool GuidIndexMap::TryGet(const Guid& key, uint32_t& value) const {
+	if (_count == 0 || !key.isValid()) {
+		return false;
+	}
+	const Slot& slot = _slots[_FindSlot(key)];
+	if (!slot.Key.isValid()) {
+		return false;
+	}
+	value = slot.Value;
+	return true;
+}
+
+bool GuidIndexMap::Set(const Guid& key, uint32_t value) {
+	if (!key.isValid()) {
+		return false;
+	}
+	if ((_count + 1) * GUID_MAP_MAX_LOAD_DEN > _slots.size() * GUID_MAP_MAX_LOAD_NUM) {
+		_Grow();
+	}
+
+	Slot& slot = _slots[_FindSlot(key)];
+	if (!slot.Key.isValid()) {
+		slot.Key = key;
+		_count++;
+	}
+	slot.Value = value;
+	return true;
+}
+
+void GuidIndexMap::Clear() {
+	for (Slot& slot : _slots) {
+		slot.Key.Clear();
+	}
+	_count = 0;
+}
+
+void GuidIndexMap::_Grow() {
+	std::vector<Slot> old = std::move(_slots);
+	_slots = std::vector<Slot>(old.empty() ? GUID_MAP_MIN_SLOTS : old.size() * 2);
+	for (const Slot& slot : old) {
+		if (slot.Key.isValid()) {
+			_slots[_FindSlot(slot.Key)] = slot;
+		}
+	}
+}
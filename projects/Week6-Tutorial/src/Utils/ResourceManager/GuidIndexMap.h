@@ -0,0 +1,58 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+
+#include "Utils/GUID.hpp"
+
+/// <summary>
+/// A hash map from GUIDs to 32 bit indices, using open addressing with linear probing
+///
+/// All the slots live in a single flat array, so a lookup is a hash and usually a single
+/// cache line, instead of the pointer chasing that a tree or bucketed map needs. The invalid
+/// (all zero) GUID marks empty slots, so it cannot be used as a key. Since resources are never
+/// removed individually, this only supports clearing the whole map
+/// </summary>
+class GuidIndexMap {
+public:
+	GuidIndexMap();
+	~GuidIndexMap() = default;
+
+	/// <summary>
+	/// Finds the index stored for the given key
+	/// </summary>
+	/// <param name="key">The GUID to search for</param>
+	/// <param name="value">Will be set to the index if the key exists</param>
+	/// <returns>True if the key was found, false if otherwise</returns>
+	bool TryGet(const Guid& key, uint32_t& value) const;
+	/// <summary>
+	/// Adds or replaces the index stored for the given key
+	/// </summary>
+	/// <param name="key">The GUID to store, must be valid</param>
+	/// <param name="value">The index to store for the key</param>
+	/// <returns>True if the key was stored, false if the key was invalid</returns>
+	bool Set(const Guid& key, uint32_t value);
+	/// <summary>
+	/// Removes all keys from the map, without releasing it's memory
+	/// </summary>
+	void Clear();
+
+	/// <summary>
+	/// Gets the number of keys in the map
+	/// </summary>
+	size_t Size() const { return _count; }
+
+protected:
+	struct Slot {
+		Guid     Key;
+		uint32_t Value = 0;
+	};
+
+	// Always a power of two, so we can mask the hash instead of using modulo
+	std::vector<Slot> _slots;
+	size_t            _count;
+
+	// Finds the slot that a key is in, or the empty slot where it would be inserted
+	size_t _FindSlot(const Guid& key) const;
+	// Doubles the number of slots and re-inserts all the keys
+	void _Grow();
+};
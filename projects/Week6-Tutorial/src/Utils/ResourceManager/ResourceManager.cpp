@@ -3,9 +3,10 @@
 #include "Utils/ObjLoader.h"
 #include "Utils/FileHelpers.h"
 #include "Utils/StringUtils.h"
+#include "Logging.h"
 
-std::map<std::type_index, std::map<Guid, IResource::Sptr>> ResourceManager::_resources;
-std::map<std::string, std::function<Guid(const nlohmann::json&)>> ResourceManager::_typeLoaders;
+std::vector<std::unique_ptr<ResourceManager::ResourceTable>> ResourceManager::_tables;
+std::unordered_map<std::string, uint32_t> ResourceManager::_typeIds;
 
 nlohmann::ordered_json ResourceManager::_manifest;
 
@@ -28,7 +29,11 @@ void ResourceManager::LoadManifest(const std::string& path, bool preloadAssets)
 
 	if (preloadAssets) {
 		for (auto& [typeName, items] : blob.items()) {
-			auto& func = _typeLoaders[typeName];
+			auto it = _typeIds.find(typeName);
+			if (it == _typeIds.end()) {
+				continue;
+			}
+			auto& func = _tables[it->second]->Loader;
 			if (func) {
 				for (auto& [guid, blob] : items.items()) {
 					func(blob);
@@ -40,12 +45,12 @@ void ResourceManager::LoadManifest(const std::string& path, bool preloadAssets)
 
 void ResourceManager::SaveManifest(const std::string& path) {
 	// Update all resources in the manifest so they match their current representation
-	for (auto& [type, map] : _resources) {
-		std::string typeName = StringTools::SanitizeClassName(type.name());
-		for (auto& [guid, res] : map) {
+	for (auto& table : _tables) {
+		for (auto& res : table->Resources) {
 			if (res != nullptr) {
-				_manifest[typeName][guid.str()] = res->ToJson();
-				_manifest[typeName][guid.str()]["guid"] = res->GetGUID().str();
+				std::string guid = res->GetGUID().str();
+				_manifest[table->Name][guid] = res->ToJson();
+				_manifest[table->Name][guid]["guid"] = guid;
 			}
 		}
 	}
@@ -53,8 +58,59 @@ void ResourceManager::SaveManifest(const std::string& path) {
 }
 
 void ResourceManager::Cleanup() {
-	for (auto& [type, map] : _resources) {
-		map.clear();
+	for (auto& table : _tables) {
+		table->Resources.clear();
+		table->Index.Clear();
+	}
+}
+
+uint32_t ResourceManager::_GetTypeId(const std::string& typeName) {
+	auto it = _typeIds.find(typeName);
+	if (it != _typeIds.end()) {
+		return it->second;
+	}
+
+	uint32_t id = static_cast<uint32_t>(_tables.size());
+	_tables.push_back(std::make_unique<ResourceTable>());
+	_tables.back()->Name = typeName;
+	_typeIds[typeName] = id;
+	return id;
+}
+
+uint32_t ResourceManager::_AddResource(ResourceTable& table, const IResource::Sptr& resource) {
+	const Guid guid = resource->GetGUID();
+
+	// If we already have a resource with this GUID, it gets replaced (ex: it was loaded again from the manifest)
+	uint32_t slot = 0;
+	if (table.Index.TryGet(guid, slot)) {
+		table.Resources[slot] = resource;
+		return slot;
 	}
+
+	slot = static_cast<uint32_t>(table.Resources.size());
+	table.Resources.push_back(resource);
+	if (!table.Index.Set(guid, slot)) {
+		LOG_WARN("Resource of type {} has an invalid GUID, it will not be able to be looked up", table.Name);
+	}
+	return slot;
+}
+
+bool ResourceManager::_Resolve(ResourceTable& table, const Guid& id, uint32_t& slot) {
+	if (table.Index.TryGet(id, slot)) {
+		return true;
+	}
+
+	// If the manifest has an entry, we can load it!
+	if (table.Loader && id.isValid()) {
+		std::string guid = id.str();
+		auto typeIt = _manifest.find(table.Name);
+		if (typeIt != _manifest.end() && typeIt->contains(guid)) {
+			// Invoke the loader function with the manifest data, then search again to get the resource
+			table.Loader((*typeIt)[guid]);
+			return table.Index.TryGet(id, slot);
+		}
+	}
+
+	return false;
 }
 
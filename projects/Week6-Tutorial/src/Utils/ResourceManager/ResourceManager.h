@@ -2,10 +2,13 @@
 
 #include <json.hpp>
 #include <unordered_map>
-#include <typeindex>
+#include <vector>
+#include <memory>
+#include <functional>
 
 #include "Utils/GUID.hpp"
 #include "Utils/ResourceManager/IResource.h"
+#include "Utils/ResourceManager/GuidIndexMap.h"
 #include "Utils/StringUtils.h"
 
 /// <summary>
@@ -31,7 +34,8 @@ public:
 	static std::shared_ptr<T> CreateAsset(TArgs&&... args) {
 		// Create and store the asset
 		std::shared_ptr<T> asset = std::make_shared<T>(std::forward<TArgs>(args)...);
-		_resources[std::type_index(typeid(T))][asset->IResource::GetGUID()] = asset;
+		ResourceTable& table = _GetTable<T>();
+		_AddResource(table, asset);
 
 		// Get the JSON representation of the asset so we can store it in the manifest
 		nlohmann::json data = asset->ToJson();
@@ -41,7 +45,7 @@ public:
 		data["guid"] = guid;
 
 		// Store the JSON data in the resource manifest (based on the type's name)
-		_manifest[StringTools::SanitizeClassName(typeid(T).name())][guid] = data;
+		_manifest[table.Name][guid] = data;
 		return asset;
 	}
 
@@ -53,26 +57,12 @@ public:
 	/// <returns>The resource with the given GUID, or nullptr if none exists</returns>
 	template<typename T, typename = std::enable_if<is_valid_resource<T>()>::type>
 	static std::shared_ptr<T> Get(Guid id) {
-		// Try and grab the asset from the resource pool
-		std::shared_ptr<T> result =  std::dynamic_pointer_cast<T>(_resources[std::type_index(typeid(T))][id]);
-
-		// If the asset is null, we can try finding it in the manifest to load it
-		if (result == nullptr) {
-			// Get the type name it'll be stored under
-			std::string typeName = StringTools::SanitizeClassName(typeid(T).name());
-
-			// If the manifest has an entry, we can load it!
-			if (_manifest[typeName].contains(id)) {
-				// Invoke the loader function with the manifest data
-				_typeLoaders[typeName](_manifest[typeName][id]);
-
-				// Search resources again to get the resource
-				return std::dynamic_pointer_cast<T>(_resources[std::type_index(typeid(T))][id]);
-			}
+		uint32_t slot = 0;
+		if (_Resolve(_GetTable<T>(), id, slot)) {
+			// Tables only ever hold resources of their own type, so we don't need a dynamic cast
+			return std::static_pointer_cast<T>(_GetTable<T>().Resources[slot]);
 		}
-
-		// If result wasn't null, or couldn't be found in the manifest, return here
-		return result;
+		return nullptr;
 	}
 
 	/// <summary>
@@ -83,24 +73,46 @@ public:
 	/// <typeparam name=""></typeparam>
 	template <typename T, typename = std::enable_if<is_valid_resource<T>()>::type>
 	static void RegisterType() {
-		// Extract the type name from a sanitized version of they typeid name
-		std::string typeName = StringTools::SanitizeClassName(typeid(T).name());
+		ResourceTable& table = _GetTable<T>();
 
 		// Create the type loader for the type
-		_typeLoaders[typeName] = [](const nlohmann::json& data) {
+		table.Loader = [](const nlohmann::json& data) {
 			IResource::Sptr res = T::FromJson(data);
+			if (res == nullptr) {
+				return Guid();
+			}
 			res->OverrideGUID(Guid(data["guid"]));
-			_resources[std::type_index(typeid(T))][res->GetGUID()] = res;
+			_AddResource(_GetTable<T>(), res);
 			return res->GetGUID();
 		};
 
 		// Make sure we haven't registered the type yet, then add an empty object
 		// to the manifest to ensure it can be saved
-		if (!_manifest.contains(typeName)) {
-			_manifest[typeName] = nlohmann::json();
+		if (!_manifest.contains(table.Name)) {
+			_manifest[table.Name] = nlohmann::json();
 		}
 	}
 
+	/// <summary>
+	/// Gets the ID that the resource manager uses for a resource type. IDs are handed out the
+	/// first time a type is used, so they are not stable between runs and should not be saved
+	/// </summary>
+	template <typename T>
+	static uint32_t GetTypeId() {
+		static const uint32_t id = _GetTypeId(GetTypeName<T>());
+		return id;
+	}
+
+	/// <summary>
+	/// Gets the readable name of a resource type, as it's stored in the manifest. This is only
+	/// calculated once per type
+	/// </summary>
+	template <typename T>
+	static const std::string& GetTypeName() {
+		static const std::string name = StringTools::SanitizeClassName(typeid(T).name());
+		return name;
+	}
+
 	/// <summary>
 	/// Iterates over all resources of the given type and invokes a method with them
 	/// </summary>
@@ -112,15 +124,13 @@ public:
 		typename = typename std::enable_if<std::is_base_of<IResource, ResourceType>::value>::type>
 		static void Each(std::function<void(const std::shared_ptr<ResourceType>&)> callback, bool includeDisabled = false) {
 
-		// We can use typeid and type_index to get a unique ID for our types
-		std::type_index type = std::type_index(typeid(ResourceType));
-
-		// Iterate over all the resources in the store
-		for (auto& [key, value] : _resources[type]) {
-			// If the pointer is alive and matches our enabled criteria, invoke the callback
-			if (value != nullptr) {
+		// Resources are stored densely, so this is just a walk over an array. We iterate by index
+		// in case the callback ends up loading more resources of this type
+		ResourceTable& table = _GetTable<ResourceType>();
+		for (size_t ix = 0; ix < table.Resources.size(); ix++) {
+			if (table.Resources[ix] != nullptr) {
 				// Upcast to resource type and invoke the callback
-				callback(std::dynamic_pointer_cast<ResourceType>(value));
+				callback(std::static_pointer_cast<ResourceType>(table.Resources[ix]));
 			}
 		}
 	}
@@ -149,19 +159,54 @@ public:
 
 protected:
 	/// <summary>
-	/// This is a map of maps
-	/// The top level map uses type_index, so there's a map per resource type
-	/// The inner map handles mapping GUIDs to the corresponding resource
+	/// Stores all the resources of a single type. Resources are kept in a dense array, with
+	/// a hash map from GUID to their slot in the array
+	/// </summary>
+	struct ResourceTable {
+		// The sanitized type name, which is what the type is stored under in the manifest
+		std::string Name;
+		// Loads a resource of this type from it's manifest entry, only set for registered types
+		std::function<Guid(const nlohmann::json&)> Loader;
+		std::vector<IResource::Sptr> Resources;
+		GuidIndexMap Index;
+	};
+
+	/// <summary>
+	/// One table per resource type, indexed by type ID. These are pointers so that tables
+	/// stay put when new types are added
 	/// </summary>
-	static std::map<std::type_index, std::map<Guid, IResource::Sptr>> _resources;
+	static std::vector<std::unique_ptr<ResourceTable>> _tables;
 	/// <summary>
-	/// This map stores registered types, so we can load them from JSON files
+	/// Maps the manifest's type names to type IDs, so we can load manifest entries
 	/// </summary>
-	static std::map<std::string, std::function<Guid(const nlohmann::json&)>> _typeLoaders;
+	static std::unordered_map<std::string, uint32_t> _typeIds;
 
 	/// <summary>
 	/// We use an ORDERED JSON file to allow serializing types in the order they are registered.
 	/// This allows us to register dependencies before the dependent resource
 	/// </summary>
 	static nlohmann::ordered_json _manifest;
-};
\ No newline at end of file
+
+	/// <summary>
+	/// Gets the table for a resource type, the lookup is only done once per type
+	/// </summary>
+	template <typename T>
+	static ResourceTable& _GetTable() {
+		static ResourceTable* table = _tables[GetTypeId<T>()].get();
+		return *table;
+	}
+	/// <summary>
+	/// Gets the ID for a type name, creating a new table if this is the first time it's been used
+	/// </summary>
+	static uint32_t _GetTypeId(const std::string& typeName);
+	/// <summary>
+	/// Adds a resource to a table, replacing any existing resource with the same GUID
+	/// </summary>
+	/// <returns>The slot that the resource was stored in</returns>
+	static uint32_t _AddResource(ResourceTable& table, const IResource::Sptr& resource);
+	/// <summary>
+	/// Finds the slot for a resource, loading the resource from the manifest if it has not been loaded yet
+	/// </summary>
+	/// <returns>True if the resource exists, false if otherwise</returns>
+	static bool _Resolve(ResourceTable& table, const Guid& id, uint32_t& slot);
+};
@@ -0,0 +1,119 @@
+#include "Utils/VirtualFileSystem.h"
+
+#include <mutex>
+#include <Logging.h>
+
+namespace fs = std::filesystem;
+
+std::vector<PackFile::Sptr> VirtualFileSystem::_packs;
+std::shared_mutex           VirtualFileSystem::_mutex;
+
+VfsFile::VfsFile() :
+	_mapping(nullptr),
+	_buffer(),
+	_data(nullptr),
+	_size(0)
+{ }
+
+bool VirtualFileSystem::Mount(const std::string& filename) {
+	PackFile::Sptr pack = PackFile::Open(filename);
+	if (pack == nullptr) {
+		return false;
+	}
+
+	std::unique_lock<std::shared_mutex> lock(_mutex);
+	_packs.push_back(pack);
+	return true;
+}
+
+void VirtualFileSystem::UnmountAll() {
+	std::unique_lock<std::shared_mutex> lock(_mutex);
+	_packs.clear();
+}
+
+const PackEntry* VirtualFileSystem::_Find(const std::string& path, PackFile::Sptr& pack) {
+	std::shared_lock<std::shared_mutex> lock(_mutex);
+	for (auto it = _packs.rbegin(); it != _packs.rend(); it++) {
+		const PackEntry* entry = (*it)->Find(path);
+		if (entry != nullptr) {
+			pack = *it;
+			return entry;
+		}
+	}
+	return nullptr;
+}
+
+bool VirtualFileSystem::Exists(const std::string& path) {
+	std::error_code error;
+	return IsPacked(path) || fs::exists(path, error);
+}
+
+bool VirtualFileSystem::IsPacked(const std::string& path) {
+	PackFile::Sptr pack;
+	return _Find(path, pack) != nullptr;
+}
+
+VfsFile::Sptr VirtualFileSystem::Open(const std::string& path) {
+	// Constructor is protected, so we can't use make_shared
+	VfsFile::Sptr result = VfsFile::Sptr(new VfsFile());
+
+	PackFile::Sptr pack;
+	const PackEntry* entry = _Find(path, pack);
+	if (entry != nullptr) {
+		// Uncompressed entries can be used right out of the pack's mapping
+		const uint8_t* mapped = pack->GetMappedData(*entry);
+		if (mapped != nullptr) {
+			result->_mapping = pack->GetMapping();
+			result->_data    = mapped;
+			result->_size    = entry->Size;
+			return result;
+		}
+
+		if (!pack->Read(*entry, result->_buffer)) {
+			return nullptr;
+		}
+		result->_data = result->_buffer.data();
+		result->_size = result->_buffer.size();
+		return result;
+	}
+
+	// Not packed, fall back to the file system
+	result->_mapping = MemoryMappedFile::Open(path);
+	if (result->_mapping == nullptr) {
+		return nullptr;
+	}
+	result->_data = result->_mapping->GetData();
+	result->_size = result->_mapping->GetSize();
+	return result;
+}
+
+bool VirtualFileSystem::ReadFile(const std::string& path, std::string& result) {
+	VfsFile::Sptr file = Open(path);
+	if (file == nullptr) {
+		return false;
+	}
+	result.assign(reinterpret_cast<const char*>(file->GetData()), file->GetSize());
+	return true;
+}
+
+bool VirtualFileSystem::GetLastWriteTime(const std::string& path, std::filesystem::file_time_type& result) {
+	PackFile::Sptr pack;
+	if (_Find(path, pack) != nullptr) {
+		result = pack->GetLastWriteTime();
+		return true;
+	}
+
+	std::error_code error;
+	result = fs::last_write_time(path, error);
+	return !error;
+}
+
+bool VirtualFileSystem::TryGetContentHash(const std::string& path, uint64_t& result) {
+	PackFile::Sptr pack;
+	const PackEntry* entry = _Find(path, pack);
+	if (entry != nullptr) {
+		result = entry->ContentHash;
+		return true;
+	}
+	return false;
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <shared_mutex>
+#include <filesystem>
+
+#include "Utils/Macros.h"
+#include "Utils/PackFile.h"
+#include "Utils/MemoryMappedFile.h"
+
+/// <summary>
+/// The contents of a file that was opened through the VirtualFileSystem. Depending on where the file
+/// came from, the data is either a view into a mapped pack, a mapped loose file, or a buffer that a
+/// compressed entry was decompressed into. The data stays valid for as long as this object is alive
+/// </summary>
+class VfsFile final {
+public:
+	MAKE_PTRS(VfsFile);
+	NO_COPY(VfsFile);
+	NO_MOVE(VfsFile);
+
+	~VfsFile() = default;
+
+	/// <summary>
+	/// Gets a pointer to the start of the file's contents, this may be null for empty files
+	/// </summary>
+	const uint8_t* GetData() const { return _data; }
+	/// <summary>
+	/// Gets the size of the file in bytes
+	/// </summary>
+	size_t GetSize() const { return _size; }
+	/// <summary>
+	/// Returns true if the data is being read straight from a mapping rather than a copy
+	/// </summary>
+	bool IsMapped() const { return _mapping != nullptr; }
+
+protected:
+	friend class VirtualFileSystem;
+	VfsFile();
+
+	// Keeps the pack or loose file mapped while we're using it's data
+	MemoryMappedFile::Sptr _mapping;
+	// Stores the contents of decompressed entries
+	std::vector<uint8_t>   _buffer;
+	const uint8_t*         _data;
+	size_t                 _size;
+};
+
+/// <summary>
+/// Routes our file reads through any mounted pack files before falling back to the file system, so
+/// that a shipping build can load everything out of a single pack instead of hundreds of loose files
+///
+/// Packs are searched most recently mounted first, and paths are looked up relative to the directory
+/// that was packed (ie our res folder, which is our working directory), so code that loads files with
+/// relative paths does not need to know whether a file is packed or loose
+/// </summary>
+class VirtualFileSystem {
+public:
+	VirtualFileSystem() = delete;
+
+	/// <summary>
+	/// Mounts a pack file, so that it's entries can be read through the VFS
+	/// </summary>
+	/// <param name="filename">The path to the pack file</param>
+	/// <returns>True if the pack was mounted, false if it could not be opened</returns>
+	static bool Mount(const std::string& filename);
+	/// <summary>
+	/// Unmounts all the packs, files that have already been opened remain valid
+	/// </summary>
+	static void UnmountAll();
+
+	/// <summary>
+	/// Returns true if a file exists in a mounted pack or on disk
+	/// </summary>
+	static bool Exists(const std::string& path);
+	/// <summary>
+	/// Returns true if a file will be read from a mounted pack
+	/// </summary>
+	static bool IsPacked(const std::string& path);
+
+	/// <summary>
+	/// Opens a file for reading. Uncompressed pack entries and loose files are memory mapped, compressed pack
+	/// entries are decompressed into memory
+	/// </summary>
+	/// <param name="path">The path of the file to open</param>
+	/// <returns>The file's contents, or nullptr if the file does not exist or could not be read</returns>
+	static VfsFile::Sptr Open(const std::string& path);
+	/// <summary>
+	/// Reads the entire contents of a file into a string
+	/// </summary>
+	/// <param name="path">The path of the file to read</param>
+	/// <param name="result">The string to store the contents in</param>
+	/// <returns>True if the file was read, false if otherwise</returns>
+	static bool ReadFile(const std::string& path, std::string& result);
+
+	/// <summary>
+	/// Gets the last time that a file was written to. For packed files, this is the time the pack was written
+	/// </summary>
+	/// <param name="path">The path of the file to examine</param>
+	/// <param name="result">Will be set to the file's write time</param>
+	/// <returns>True if the file exists, false if otherwise</returns>
+	static bool GetLastWriteTime(const std::string& path, std::filesystem::file_time_type& result);
+	/// <summary>
+	/// Gets the hash that was stored for a packed file when the pack was built, this matches
+	/// ImportCache::HashBytes over the file's contents
+	/// </summary>
+	/// <param name="path">The path of the file to examine</param>
+	/// <param name="result">Will be set to the hash of the file's contents</param>
+	/// <returns>True if the file is in a mounted pack, false if otherwise</returns>
+	static bool TryGetContentHash(const std::string& path, uint64_t& result);
+
+private:
+	static std::vector<PackFile::Sptr> _packs;
+	static std::shared_mutex           _mutex;
+
+	// Finds the pack entry for a path, searching the most recently mounted pack first
+	static const PackEntry* _Find(const std::string& path, PackFile::Sptr& pack);
+};